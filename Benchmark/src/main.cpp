@@ -0,0 +1,358 @@
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "micro_bench.h"
+#include "data/bounds.h"
+#include "data/model.h"
+#include "data/primitive.h"
+#include "data/transform.h"
+#include "rendering/command_list.h"
+#include "rendering/image_cache.h"
+#include "rendering/null_backend.h"
+#include "rendering/shader_program.h"
+#include "utils/string_id.h"
+
+namespace
+{
+	//same seed every run, every run times the same data
+	const unsigned int SEED = 42;
+	const unsigned int TRANSFORM_COUNT = 1024;
+	const unsigned int PACKET_COUNT = 4096;
+	const unsigned int LIST_COUNT = 4;
+	const unsigned int BOX_COUNT = 4096;
+	const unsigned int MESH_VERTICES = 10000;
+	const unsigned int PROGRAM_COUNT = 16;
+	const unsigned int MATERIAL_COUNT = 64;
+	const char* DECODE_PATH = "res/textures/floor/bricks_rough.jpg";
+
+	void bench_transforms(micro_bench& bench)
+	{
+		std::mt19937 rng(SEED);
+		std::uniform_real_distribution<float> range(-100.0f, 100.0f);
+
+		std::vector<transform> transforms;
+		transforms.reserve(TRANSFORM_COUNT);
+		for (unsigned int i = 0; i < TRANSFORM_COUNT; i++)
+			transforms.emplace_back(glm::vec3(range(rng), range(rng), range(rng)), glm::vec3(range(rng), range(rng), 0.0f), glm::vec3(1.0f));
+
+		bench.run("transform/get_model_matrix clean", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+				micro_bench::keep(transforms[i % TRANSFORM_COUNT].get_model_matrix());
+		});
+
+		bench.run("transform/get_model_matrix after set_position", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				transform& t = transforms[i % TRANSFORM_COUNT];
+				t.set_position(glm::vec3(static_cast<float>(i & 0xFF)));
+				micro_bench::keep(t.get_model_matrix());
+			}
+		});
+
+		//set_rotation is the only way in to recalculate_directions
+		bench.run("transform/set_rotation (recalculate_directions)", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				transform& t = transforms[i % TRANSFORM_COUNT];
+				t.set_rotation(glm::vec3(static_cast<float>(i % 90), static_cast<float>(i % 360), 0.0f));
+				micro_bench::keep(t.forward());
+			}
+		});
+	}
+
+	void bench_mesh_conversion(micro_bench& bench)
+	{
+		aiMesh source;
+		source.mNumVertices = MESH_VERTICES;
+		source.mVertices = new aiVector3D[MESH_VERTICES];
+		source.mNormals = new aiVector3D[MESH_VERTICES];
+		source.mTangents = new aiVector3D[MESH_VERTICES];
+		source.mBitangents = new aiVector3D[MESH_VERTICES];
+		source.mTextureCoords[0] = new aiVector3D[MESH_VERTICES];
+		source.mNumUVComponents[0] = 2;
+
+		for (unsigned int i = 0; i < MESH_VERTICES; i++)
+		{
+			const float f = static_cast<float>(i);
+			source.mVertices[i] = aiVector3D(f, f * 0.5f, f * 0.25f);
+			source.mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+			source.mTangents[i] = aiVector3D(1.0f, 0.0f, 0.0f);
+			source.mBitangents[i] = aiVector3D(0.0f, 0.0f, 1.0f);
+			source.mTextureCoords[0][i] = aiVector3D(f / MESH_VERTICES, 1.0f - f / MESH_VERTICES, 0.0f);
+		}
+
+		source.mNumFaces = MESH_VERTICES / 3;
+		source.mFaces = new aiFace[source.mNumFaces];
+		for (unsigned int i = 0; i < source.mNumFaces; i++)
+		{
+			source.mFaces[i].mNumIndices = 3;
+			source.mFaces[i].mIndices = new unsigned int[3]{ i * 3, i * 3 + 1, i * 3 + 2 };
+		}
+
+		std::vector<vertex> vertices;
+		std::vector<unsigned int> indices;
+
+		bench.run("model/convert_geometry 10k vertices", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				model::convert_geometry(&source, vertices, indices);
+				micro_bench::keep(vertices.back());
+			}
+		});
+	}
+
+	void bench_texture_decode(micro_bench& bench)
+	{
+		decoded_image probe = image_cache::acquire(DECODE_PATH, false);
+		if (!probe.data)
+		{
+			std::cout << "Skipping texture decode, " << DECODE_PATH << " did not load" << std::endl;
+			return;
+		}
+		image_cache::release(probe);
+
+		bench.run("image_cache/decode 2k jpg", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				decoded_image image = image_cache::acquire(DECODE_PATH, false);
+				micro_bench::keep(image.width);
+				image_cache::release(image);
+			}
+		});
+	}
+
+	void bench_sorting(micro_bench& bench)
+	{
+		std::mt19937 rng(SEED);
+		std::uniform_int_distribution<unsigned int> programs(1, 16);
+		std::uniform_int_distribution<unsigned int> materials(0, 64);
+		std::uniform_real_distribution<float> depths(0.0f, 200.0f);
+
+		std::vector<unsigned int> key_programs(PACKET_COUNT), key_materials(PACKET_COUNT);
+		std::vector<float> key_depths(PACKET_COUNT);
+		for (unsigned int i = 0; i < PACKET_COUNT; i++)
+		{
+			key_programs[i] = programs(rng);
+			key_materials[i] = materials(rng);
+			key_depths[i] = depths(rng);
+		}
+
+		bench.run("command_list/make_sort_key", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				const unsigned int k = i % PACKET_COUNT;
+				micro_bench::keep(command_list::make_sort_key(key_programs[k], key_materials[k], key_depths[k], (k & 7) == 0));
+			}
+		});
+
+		//the lists as the record jobs leave them, one per worker
+		std::vector<command_list> lists(LIST_COUNT);
+		for (unsigned int i = 0; i < PACKET_COUNT; i++)
+		{
+			command_list& list = lists[i % LIST_COUNT];
+			list.begin_packet(command_list::make_sort_key(key_programs[i], key_materials[i], key_depths[i], (i & 7) == 0));
+			list.draw(draw_call{});
+			list.end_packet();
+		}
+
+		std::vector<command_list::packet_ref> order;
+		bench.run("command_list/sort_packets 4096", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				command_list::sort_packets(lists, order);
+				micro_bench::keep(order.front());
+			}
+		});
+	}
+
+	void bench_submit(micro_bench& bench)
+	{
+		//everything submit asks for lands in the null backend, what is timed is the engine side of each draw
+		null_backend backend;
+		render_backend::set(&backend);
+
+		{
+			const shader vertex, fragment;
+			std::vector<std::unique_ptr<shader_program>> programs;
+			for (unsigned int i = 0; i < PROGRAM_COUNT; i++)
+				programs.push_back(std::unique_ptr<shader_program>(new shader_program(&vertex, &fragment)));
+
+			const string_id samplers[] = { string_id("mat.diffuseTexture0"), string_id("mat.normalTexture0"), string_id("mat.specularTexture0") };
+			std::vector<std::vector<material_slot>> materials(MATERIAL_COUNT);
+			for (unsigned int i = 0; i < MATERIAL_COUNT; i++)
+				for (unsigned int slot = 0; slot < 3; slot++)
+					materials[i].push_back({ samplers[slot], GL_TEXTURE_2D, i * 3 + slot + 1 });
+
+			std::mt19937 rng(SEED);
+			std::uniform_int_distribution<unsigned int> pick_program(0, PROGRAM_COUNT - 1);
+			std::uniform_int_distribution<unsigned int> pick_material(0, MATERIAL_COUNT - 1);
+			std::uniform_real_distribution<float> depths(0.0f, 200.0f);
+
+			const string_id model("model");
+			draw_call call;
+			call.vao = 1;
+			call.element_count = 36;
+			call.is_indexed = true;
+
+			std::vector<command_list> lists(LIST_COUNT);
+			for (unsigned int i = 0; i < PACKET_COUNT; i++)
+			{
+				const unsigned int program = pick_program(rng);
+				const unsigned int material = pick_material(rng);
+
+				command_list& list = lists[i % LIST_COUNT];
+				list.begin_packet(command_list::make_sort_key(program, material, depths(rng), false));
+				list.bind_program(programs[program].get());
+				list.bind_material(&materials[material]);
+				list.set_mat4(model, glm::mat4(1.0f));
+				list.draw(call);
+				list.end_packet();
+			}
+
+			bench.run("command_list/submit 4096 (null backend)", [&](const unsigned long long ops)
+			{
+				for (unsigned long long i = 0; i < ops; i++)
+					command_list::submit(lists);
+				micro_bench::keep(backend.get_total());
+			});
+		}
+
+		render_backend::set(nullptr);
+	}
+
+	void bench_frustum(micro_bench& bench)
+	{
+		std::mt19937 rng(SEED);
+		std::uniform_real_distribution<float> range(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+		std::vector<aabb> boxes(BOX_COUNT);
+		for (aabb& box : boxes)
+		{
+			const glm::vec3 center(range(rng), range(rng), range(rng));
+			box.expand(center - glm::vec3(size(rng)));
+			box.expand(center + glm::vec3(size(rng)));
+		}
+
+		const glm::mat4 view_proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f)
+			* glm::lookAt(glm::vec3(0.0f, 10.0f, -50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		bench.run("frustum/from_matrix", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+				micro_bench::keep(frustum::from_matrix(view_proj));
+		});
+
+		const frustum view_frustum = frustum::from_matrix(view_proj);
+		bench.run("frustum/intersects", [&](const unsigned long long ops)
+		{
+			unsigned int visible = 0;
+			for (unsigned long long i = 0; i < ops; i++)
+				visible += view_frustum.intersects(boxes[i % BOX_COUNT]) ? 1 : 0;
+			micro_bench::keep(visible);
+		});
+
+		const glm::mat4 model_matrix = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(3.0f)), 0.7f, glm::vec3(0.0f, 1.0f, 0.0f));
+		bench.run("aabb/transformed", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+				micro_bench::keep(boxes[i % BOX_COUNT].transformed(model_matrix));
+		});
+	}
+
+	void bench_uniform_names(micro_bench& bench)
+	{
+		//the per light names the forward shaders were sent with every frame before light clustering
+		bench.run("uniform names/point light string", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				std::string str = "pointLights[";
+				str.append(std::to_string(i & 3));
+				str.append("].");
+				const std::string name(str + "diffuseIntensity");
+				micro_bench::keep(name.size());
+			}
+		});
+
+		bench.run("uniform names/string_id intern", [&](const unsigned long long ops)
+		{
+			const std::string names[] = { "model", "view", "projection", "mat.diffuse0", "pointLights[0].lightPos" };
+			for (unsigned long long i = 0; i < ops; i++)
+				micro_bench::keep(string_id(names[i % 5]).get_id());
+		});
+
+		//material slot names, rebuilt whenever a mesh gets new textures
+		mesh m(primitive::create_cube().get_geometry());
+		const std::vector<texture> textures(3);
+		bench.run("uniform names/mesh material slots x3", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+			{
+				m.replace_textures(textures);
+				micro_bench::keep(m.get_material_slots().size());
+			}
+		});
+	}
+
+	void bench_primitives(micro_bench& bench)
+	{
+		bench.run("primitive/create_cube", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+				micro_bench::keep(primitive::create_cube().get_vertices().size());
+		});
+
+		bench.run("primitive/create_quad", [&](const unsigned long long ops)
+		{
+			for (unsigned long long i = 0; i < ops; i++)
+				micro_bench::keep(primitive::create_quad().get_vertices().size());
+		});
+	}
+}
+
+int main(const int argc, char** argv)
+{
+	std::string filter;
+	std::string output = "micro_bench.json";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			output = argv[++i];
+		else
+		{
+			std::cout << "usage: Benchmark [--filter text] [--output file]" << std::endl;
+			return 1;
+		}
+	}
+
+	micro_bench bench(filter);
+
+	bench_transforms(bench);
+	bench_mesh_conversion(bench);
+	bench_texture_decode(bench);
+	bench_sorting(bench);
+	bench_submit(bench);
+	bench_frustum(bench);
+	bench_uniform_names(bench);
+	bench_primitives(bench);
+
+	return bench.write_json(output) ? 0 : 1;
+}
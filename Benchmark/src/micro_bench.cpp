@@ -0,0 +1,78 @@
+#include "micro_bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+volatile char micro_bench::sink = 0;
+
+micro_bench::micro_bench(std::string filter) : filter(std::move(filter))
+{
+}
+
+void micro_bench::run(const std::string& name, const std::function<void(unsigned long long ops)>& body)
+{
+	if (!filter.empty() && name.find(filter) == std::string::npos)
+		return;
+
+	//doubling until a sample is long enough for the clock, also serves as the warmup
+	unsigned long long ops = 1;
+	while (time_ns(body, ops) < MIN_SAMPLE_NS && ops < (1ull << 40))
+		ops *= 2;
+
+	std::vector<double> samples;
+	samples.reserve(SAMPLES);
+
+	for (unsigned int i = 0; i < SAMPLES; i++)
+		samples.push_back(static_cast<double>(time_ns(body, ops)) / ops);
+
+	std::sort(samples.begin(), samples.end());
+	results.push_back({ name, samples[SAMPLES / 2], samples.front(), samples.back(), ops });
+
+	const result& r = results.back();
+	std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(2)
+		<< std::setw(14) << r.ns_per_op << " ns/op  (min " << r.min_ns_per_op << ", max " << r.max_ns_per_op << ", "
+		<< ops << " ops per sample)" << std::endl;
+}
+
+const std::vector<micro_bench::result>& micro_bench::get_results() const
+{
+	return results;
+}
+
+bool micro_bench::write_json(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << path << " for the benchmark results" << std::endl;
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\n\"samples\":" << SAMPLES << ",\n\"benchmarks\":[";
+
+	for (std::size_t i = 0; i < results.size(); i++)
+	{
+		const result& r = results[i];
+		file << (i == 0 ? "\n" : ",\n") << "{\"name\":\"" << r.name << "\",\"ns_per_op\":" << r.ns_per_op
+			<< ",\"min_ns_per_op\":" << r.min_ns_per_op << ",\"max_ns_per_op\":" << r.max_ns_per_op
+			<< ",\"ops_per_sample\":" << r.ops_per_sample << "}";
+	}
+
+	file << "\n]\n}\n";
+	std::cout << "Wrote " << results.size() << " results to " << path << std::endl;
+	return true;
+}
+
+unsigned long long micro_bench::time_ns(const std::function<void(unsigned long long ops)>& body, const unsigned long long ops)
+{
+	const auto start = std::chrono::steady_clock::now();
+	body(ops);
+	const auto end = std::chrono::steady_clock::now();
+
+	return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+// tiny timing harness for engine hot paths, no gl context involved
+// each case is calibrated until one sample runs for at least MIN_SAMPLE_NS, then timed SAMPLES times;
+// the median is what gets reported so a single preempted sample does not move the number
+class micro_bench
+{
+public:
+	static const unsigned int SAMPLES = 15;
+	static const unsigned long long MIN_SAMPLE_NS = 10000000;
+
+	struct result
+	{
+		std::string name;
+		double ns_per_op;
+		double min_ns_per_op;
+		double max_ns_per_op;
+		unsigned long long ops_per_sample;
+	};
+
+	//only cases whose name contains the filter run, empty runs everything
+	explicit micro_bench(std::string filter);
+
+	//body has to do exactly the given number of operations
+	void run(const std::string& name, const std::function<void(unsigned long long ops)>& body);
+
+	const std::vector<result>& get_results() const;
+	bool write_json(const std::string& path) const;
+
+	//reads the value through a volatile so the work producing it can not be optimized away
+	template <typename T>
+	static void keep(const T& value)
+	{
+		sink = *reinterpret_cast<const volatile char*>(&value);
+	}
+
+private:
+	static volatile char sink;
+
+	std::string filter;
+	std::vector<result> results;
+
+	static unsigned long long time_ns(const std::function<void(unsigned long long ops)>& body, unsigned long long ops);
+};
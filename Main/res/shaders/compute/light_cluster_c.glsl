@@ -0,0 +1,104 @@
+#version 430 core
+
+//one invocation per screen tile, one work group per depth slice, the same layout light_clusters uses on the cpu
+layout (local_size_x = 16, local_size_y = 9, local_size_z = 1) in;
+
+#define MAX_LIGHTS_PER_CLUSTER 256
+
+struct ClusterLight
+{
+	vec4 positionRange;
+	vec4 diffuseLinear;
+	vec4 specularQuadratic;
+	vec4 directionCosOuter;
+	vec4 cone;
+};
+
+layout(std430, binding = 2) readonly buffer ClusterLights
+{
+	ClusterLight clusterLights[];
+};
+
+layout(std430, binding = 3) writeonly buffer ClusterRanges
+{
+	uvec2 clusterRanges[];
+};
+
+layout(std430, binding = 4) writeonly buffer ClusterIndices
+{
+	uint clusterIndices[];
+};
+
+layout(std430, binding = 5) buffer ClusterCounter
+{
+	uint indexCount;
+};
+
+uniform mat4 clusterView;
+uniform vec4 clusterFrustum; //tan of the half fov along x and y, near and far
+uniform int lightCount;
+uniform int indexCapacity;
+
+bool Intersects(vec3 center, float radius, vec3 boxMin, vec3 boxMax)
+{
+	vec3 d = max(boxMin - center, 0.0) + max(center - boxMax, 0.0);
+	return dot(d, d) <= radius * radius;
+}
+
+//the light's cone against the box's bounding sphere, point lights have no axis and always pass
+bool IntersectsCone(ClusterLight light, vec3 apex, vec3 sphereCenter, float sphereRadius)
+{
+	vec3 axis = mat3(clusterView) * light.directionCosOuter.xyz * vec3(1, 1, -1);
+	vec3 v = sphereCenter - apex;
+	float along = dot(v, axis);
+	float closest = light.directionCosOuter.w * sqrt(max(dot(v, v) - along * along, 0.0)) - along * light.cone.z;
+
+	return closest <= sphereRadius && along <= sphereRadius + light.positionRange.w && along >= -sphereRadius;
+}
+
+bool Reaches(int i, vec3 boxMin, vec3 boxMax, vec3 sphereCenter, float sphereRadius)
+{
+	vec3 center = (clusterView * vec4(clusterLights[i].positionRange.xyz, 1.0)).xyz * vec3(1, 1, -1);
+	return Intersects(center, clusterLights[i].positionRange.w, boxMin, boxMax) &&
+		IntersectsCone(clusterLights[i], center, sphereCenter, sphereRadius);
+}
+
+void main()
+{
+	uvec3 grid = gl_NumWorkGroups * gl_WorkGroupSize;
+	uvec3 id = gl_GlobalInvocationID;
+	uint cluster = id.x + grid.x * (id.y + grid.y * id.z);
+
+	//view space box with depth positive into the screen
+	float z0 = clusterFrustum.z * pow(clusterFrustum.w / clusterFrustum.z, float(id.z) / float(grid.z));
+	float z1 = clusterFrustum.z * pow(clusterFrustum.w / clusterFrustum.z, float(id.z + 1u) / float(grid.z));
+	vec2 ndc0 = vec2(id.xy) / vec2(grid.xy) * 2.0 - 1.0;
+	vec2 ndc1 = vec2(id.xy + 1u) / vec2(grid.xy) * 2.0 - 1.0;
+
+	vec3 boxMin = vec3(min(ndc0 * clusterFrustum.xy * z0, ndc0 * clusterFrustum.xy * z1), z0);
+	vec3 boxMax = vec3(max(ndc1 * clusterFrustum.xy * z0, ndc1 * clusterFrustum.xy * z1), z1);
+	vec3 sphereCenter = (boxMin + boxMax) * 0.5;
+	float sphereRadius = length(boxMax - sphereCenter);
+
+	//counted first so a single atomic reserves the cluster's whole run in the index list
+	uint count = 0;
+	for(int i = 0; i < lightCount && count < MAX_LIGHTS_PER_CLUSTER; i++)
+	{
+		if(Reaches(i, boxMin, boxMax, sphereCenter, sphereRadius))
+			count++;
+	}
+
+	uint offset = atomicAdd(indexCount, count);
+	count = uint(clamp(indexCapacity - int(offset), 0, int(count)));
+	clusterRanges[cluster] = uvec2(offset, count);
+
+	uint written = 0;
+	for(int i = 0; i < lightCount && written < count; i++)
+	{
+		if(Reaches(i, boxMin, boxMax, sphereCenter, sphereRadius))
+		{
+			clusterIndices[offset + written] = uint(i);
+			written++;
+		}
+	}
+}
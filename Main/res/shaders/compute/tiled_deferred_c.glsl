@@ -0,0 +1,206 @@
+#version 430 core
+
+//one work group per screen tile, one invocation per pixel
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+#define TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 256
+
+struct ClusterLight
+{
+	vec4 positionRange;
+	vec4 diffuseLinear;
+	vec4 specularQuadratic;
+	vec4 directionCosOuter;
+	vec4 cone;
+};
+
+float when_gt(float x, float y);
+bool Intersects(vec3 center, float radius, vec3 boxMin, vec3 boxMax);
+bool IntersectsCone(ClusterLight light, vec3 apex, vec3 sphereCenter, float sphereRadius);
+float CalculatePointShadow(vec3 worldPos, vec3 normal, vec3 lightPos);
+vec3 CalculatePointLight(vec3 normal, vec3 worldPos, vec4 diffSpec, ClusterLight light);
+
+layout(std140, binding = 1) uniform VP
+{
+	mat4 view;
+	mat4 projection;
+};
+
+layout(std430, binding = 2) readonly buffer ClusterLights
+{
+	ClusterLight clusterLights[];
+};
+
+//the directional light is already in there, point lights add onto it
+layout(rgba16f, binding = 0) uniform image2D litColor;
+
+uniform sampler2D gPos;
+uniform sampler2D gNormal;
+uniform sampler2D gDiffSpec;
+uniform sampler2D gDepth;
+uniform samplerCube pointShadowMap;
+
+uniform vec3 viewPos;
+uniform float farPlane;
+uniform int pointShadowLight; //-1 when no light casts a point shadow
+uniform int lightCount;
+uniform float useDebug;
+
+shared uint tileMinDepth;
+shared uint tileMaxDepth;
+shared uint tileLightCount;
+shared uint tileLights[MAX_LIGHTS_PER_TILE];
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(litColor);
+
+	if(gl_LocalInvocationIndex == 0)
+	{
+		tileMinDepth = 0xFFFFFFFFu;
+		tileMaxDepth = 0u;
+		tileLightCount = 0u;
+	}
+	barrier();
+
+	//the depth buffer only tells geometry from sky, view depth comes from the stored position
+	bool isGeometry = all(lessThan(pixel, size)) && texelFetch(gDepth, pixel, 0).r < 1.0;
+	vec3 worldPos = vec3(0);
+
+	if(isGeometry)
+	{
+		worldPos = texelFetch(gPos, pixel, 0).rgb;
+
+		//depth is positive in front of the camera, positive floats order the same as their bits
+		float depth = max(-(view * vec4(worldPos, 1.0)).z, 0.0);
+		atomicMin(tileMinDepth, floatBitsToUint(depth));
+		atomicMax(tileMaxDepth, floatBitsToUint(depth));
+	}
+	barrier();
+
+	//a tile of only sky keeps its min above its max and skips culling
+	if(tileMinDepth <= tileMaxDepth)
+	{
+		float minDepth = uintBitsToFloat(tileMinDepth);
+		float maxDepth = uintBitsToFloat(tileMaxDepth);
+
+		//view space box around the tile's depth range, the same test the light clusters use
+		vec2 tanHalfFov = vec2(1.0 / projection[0][0], 1.0 / projection[1][1]);
+		vec2 ndc0 = vec2(gl_WorkGroupID.xy * TILE_SIZE) / vec2(size) * 2.0 - 1.0;
+		vec2 ndc1 = vec2((gl_WorkGroupID.xy + 1u) * TILE_SIZE) / vec2(size) * 2.0 - 1.0;
+
+		vec3 boxMin = vec3(min(ndc0 * tanHalfFov * minDepth, ndc0 * tanHalfFov * maxDepth), minDepth);
+		vec3 boxMax = vec3(max(ndc1 * tanHalfFov * minDepth, ndc1 * tanHalfFov * maxDepth), maxDepth);
+		vec3 sphereCenter = (boxMin + boxMax) * 0.5;
+		float sphereRadius = length(boxMax - sphereCenter);
+
+		for(uint i = gl_LocalInvocationIndex; i < uint(lightCount); i += TILE_SIZE * TILE_SIZE)
+		{
+			vec3 center = (view * vec4(clusterLights[i].positionRange.xyz, 1.0)).xyz * vec3(1, 1, -1);
+			if(!Intersects(center, clusterLights[i].positionRange.w, boxMin, boxMax) ||
+				!IntersectsCone(clusterLights[i], center, sphereCenter, sphereRadius))
+				continue;
+
+			uint slot = atomicAdd(tileLightCount, 1u);
+			if(slot < MAX_LIGHTS_PER_TILE)
+				tileLights[slot] = i;
+		}
+	}
+	barrier();
+
+	if(!isGeometry)
+		return;
+
+	//the only read of this pixel's g-buffer however many lights reach it
+	vec3 normal = texelFetch(gNormal, pixel, 0).rgb;
+	vec4 diffSpec = texelFetch(gDiffSpec, pixel, 0);
+
+	uint count = min(tileLightCount, uint(MAX_LIGHTS_PER_TILE));
+	vec3 color = vec3(0);
+
+	for(uint i = 0; i < count; i++)
+	{
+		uint lightIndex = tileLights[i];
+		ClusterLight light = clusterLights[lightIndex];
+
+		vec3 contribution = CalculatePointLight(normal, worldPos, diffSpec, light);
+		if(int(lightIndex) == pointShadowLight)
+			contribution *= 1.0 - CalculatePointShadow(worldPos, normal, light.positionRange.xyz);
+
+		color += contribution;
+	}
+
+	//lights per tile from blue to red
+	vec3 heat = mix(vec3(0, 0, 1), vec3(1, 0, 0), clamp(float(count) / 32.0, 0.0, 1.0));
+	color = mix(color, heat, useDebug * 0.5);
+
+	imageStore(litColor, pixel, imageLoad(litColor, pixel) + vec4(color, 0.0));
+}
+
+bool Intersects(vec3 center, float radius, vec3 boxMin, vec3 boxMax)
+{
+	vec3 d = max(boxMin - center, 0.0) + max(center - boxMax, 0.0);
+	return dot(d, d) <= radius * radius;
+}
+
+//the same cone test the light clusters use, point lights have no axis and always pass
+bool IntersectsCone(ClusterLight light, vec3 apex, vec3 sphereCenter, float sphereRadius)
+{
+	vec3 axis = mat3(view) * light.directionCosOuter.xyz * vec3(1, 1, -1);
+	vec3 v = sphereCenter - apex;
+	float along = dot(v, axis);
+	float closest = light.directionCosOuter.w * sqrt(max(dot(v, v) - along * along, 0.0)) - along * light.cone.z;
+
+	return closest <= sphereRadius && along <= sphereRadius + light.positionRange.w && along >= -sphereRadius;
+}
+
+vec3 CalculatePointLight(vec3 normal, vec3 worldPos, vec4 diffSpec, ClusterLight light)
+{
+	vec3 lightPos = light.positionRange.xyz;
+	vec3 fragToLight = normalize(lightPos - worldPos);
+
+	vec3 fragToView = normalize(viewPos - worldPos);
+	vec3 halfwayDir = normalize(fragToLight + fragToView);
+
+	float distance = length(lightPos - worldPos);
+	float attenuation = 1.0f /(1 + distance * light.diffuseLinear.w + distance * distance * light.specularQuadratic.w);
+
+	//the light volumes used to cut the light off at its range
+	attenuation *= 1.0 - step(light.positionRange.w, distance);
+
+	//spot lights fade out between their inner and outer cutoff, point lights keep 1
+	attenuation *= clamp(dot(-fragToLight, light.directionCosOuter.xyz) * light.cone.x + light.cone.y, 0.0, 1.0);
+
+	float diffuseStrength = max(dot(normal, fragToLight), 0);
+	vec3 diffuse = diffuseStrength * light.diffuseLinear.rgb;
+
+	float specularStrength = pow(max(dot(halfwayDir, normal), 0.0), 32.0f);
+	vec3 specular = specularStrength * light.specularQuadratic.rgb * 0;
+
+	vec3 diffColor = diffuse * diffSpec.rgb;
+	vec3 specColor = specular * diffSpec.a;
+
+	vec3 result = diffColor + specColor;
+	result *= attenuation;
+	return result;
+}
+
+float CalculatePointShadow(vec3 worldPos, vec3 normal, vec3 lightPos)
+{
+	vec3 fragToLight = (worldPos - lightPos);
+
+	//no derivatives outside a fragment shader, the cube map has a single level anyway
+	float closestDepth = textureLod(pointShadowMap, fragToLight, 0.0).r;
+	closestDepth *= farPlane;
+
+	float bias = max(0.05 * (1.0 - dot(normal, normalize(fragToLight))), 0.005);
+	float currentDepth = length(fragToLight);
+	return when_gt(currentDepth - bias, closestDepth);
+}
+
+float when_gt(float x, float y)
+{
+  return max(sign(x - y), 0.0f);
+}
@@ -1,7 +1,5 @@
 #version 430 core
 
-#define NR_PT_LIGHTS 4
-
 float when_gt(float x, float y);
 float when_lt(float x, float y);
 
@@ -51,50 +49,74 @@ struct PointLight
 	float quadratic;
 };
 
-struct SpotLight
+struct ClusterLight
 {
-	vec3 lightPos;
-	vec3 diffuseColor;
-	vec3 specularColor;
-	float diffuseIntensity;
-	float specularIntensity;
-
-	vec3 spotDirection;
-	float cutOffValue;
-	float innerCutOffValue;
+	vec4 positionRange;
+	vec4 diffuseLinear;
+	vec4 specularQuadratic;
+	vec4 directionCosOuter;
+	vec4 cone;
 }; // Structs
 
 vec3 CalculateDirectionalLight();
 vec3 CalculatePointLight(PointLight light);
-vec3 CalculateSpotLightContrib(SpotLight light);
 vec3 CalculateReflectionContrib();
 float CalculateDirectionalShadow();
 float CalculatePointShadow();
 vec2 GetTexCoords(float useParallaxLocal);
+uvec2 GetClusterRange();
+PointLight GetPointLight(uint index, mat3 worldToTangent);
+float GetRangeFade(uint index);
+float GetConeFade(uint index);
 
 in DirLight DirLightTangent;
-in PointLight PointLightsTangent[4];
-in SpotLight SpotLightTangent;
 in vec3 ViewPosTangent;
 in vec3 FragPosTangent;
+in vec3 FragPos;
 in vec2 TexCoord;
 in vec3 NormalTangent;
 in vec4 FragPosDirLightSpace;
 in mat3 TBN;
 out vec4 FragColor;
 
+layout(std140, binding = 1) uniform VP
+{
+	mat4 view;
+	mat4 projection;
+};
+
+//point and spot lights and the per cluster lists of the ones that reach it, filled by light_clusters
+layout(std430, binding = 2) readonly buffer ClusterLights
+{
+	ClusterLight clusterLights[];
+};
+
+layout(std430, binding = 3) readonly buffer ClusterRanges
+{
+	uvec2 clusterRanges[];
+};
+
+layout(std430, binding = 4) readonly buffer ClusterIndices
+{
+	uint clusterIndices[];
+};
+
 
 uniform Material mat;
 uniform vec3 ambientColor;
 uniform float time;
-uniform float isFlashlightOn;
 uniform vec2 tiling;
 uniform vec2 offset;
 uniform samplerCube pointShadowMap;
 uniform float farPlane;
 uniform float useShadow;
+uniform int pcfHalfKernel; //0 is a single tap, 2 is the full 5x5 kernel
 uniform float useNormalMaps;
 uniform float useParallax;
+uniform vec3 clusterGrid; //tiles across, tiles up, depth slices
+uniform vec2 clusterTileSize; //in pixels
+uniform vec2 clusterSlicing; //slice = log(view depth) * x + y
+uniform int pointShadowLight; //the light the point shadow map belongs to, -1 for none
 
 void main()
 {
@@ -103,26 +125,31 @@ void main()
 	float pointShadow = 0.0;
 	float dirShadow = 0.0;
 
-	if(useShadow) // static branch
+	if(useShadow > 0.0) // static branch
 	{
-		pointShadow = CalculatePointShadow();
+		if(pointShadowLight >= 0)
+			pointShadow = CalculatePointShadow();
 		dirShadow = CalculateDirectionalShadow();
 	}
 	
 
-	vec3 pointLightContrib;
+	vec3 pointLightContrib = vec3(0);
+	uvec2 cluster = GetClusterRange();
+	mat3 worldToTangent = transpose(TBN);
 
-	for(int i = 0; i < NR_PT_LIGHTS; i++)
+	for(uint i = cluster.x; i < cluster.x + cluster.y; i++)
 	{
-		pointLightContrib += (1 - pointShadow * when_lt(i, 1)) * CalculatePointLight(PointLightsTangent[i]);
+		uint lightIndex = clusterIndices[i];
+		float shadow = int(lightIndex) == pointShadowLight ? pointShadow : 0.0;
+		float fade = GetRangeFade(lightIndex) * GetConeFade(lightIndex);
+		pointLightContrib += (1 - shadow) * fade * CalculatePointLight(GetPointLight(lightIndex, worldToTangent));
 	}
 
 
 	vec3 dirLightContrib = CalculateDirectionalLight() * (1 - dirShadow);
-	vec3 spotLightContrib = CalculateSpotLightContrib(SpotLightTangent) * isFlashlightOn;
 	vec3 ambientContrib = diffColor.rgb * ambientColor;
 
-	FragColor =  vec4((dirLightContrib) + pointLightContrib + spotLightContrib + ambientContrib, diffColor.a);
+	FragColor =  vec4((dirLightContrib) + pointLightContrib + ambientContrib, diffColor.a);
 }
 
 vec3 CalculateDirectionalLight()
@@ -183,34 +210,6 @@ vec3 CalculatePointLight(PointLight light)
 	return result;
 } // Point Light
 
-vec3 CalculateSpotLightContrib(SpotLight light)
-{
-	vec3 normal = texture(mat.normalTexture0, GetTexCoords(1.0)).rgb;
-	normal = normalize(normal * 2 - 1.0);
-
-	vec3 fragToLight = normalize(light.lightPos - FragPosTangent);
-
-	vec3 fragToView = normalize(ViewPosTangent - FragPosTangent);
-	vec3 halfwayDir = normalize(fragToLight + fragToView);
-
-	float diffuseStrength = max(dot(normal, fragToLight), 0);
-	vec3 diffuse = diffuseStrength * light.diffuseColor * light.diffuseIntensity * mat.diffuseColor;
-
-	float specularStrength = pow(max(dot(halfwayDir, normal), 0), mat.shininess);
-	vec3 specular = specularStrength * light.specularColor * light.specularIntensity * mat.specularColor;
-
-	vec3 diffColor = texture(mat.diffuseTexture0, GetTexCoords(1.0)).rgb;
-	vec3 specColor = texture(mat.specularTexture0, GetTexCoords(1.0)).rgb;
-
-	float theta = dot(normalize(-light.spotDirection), fragToLight); 
-	float epsilon = light.innerCutOffValue - light.cutOffValue;
-	float intensity = clamp((theta - light.cutOffValue)/epsilon, 0.0f, 1.0f);
-
-	vec3 result = diffColor * diffuse + specColor * specular; 
-	result *= intensity;
-	return result;
-} // Spotlight
-
 vec3 CalculateReflectionContrib()
 {
 //	vec3 incident = normalize(FragPos - viewPos);
@@ -237,7 +236,7 @@ float CalculateDirectionalShadow()
 	float bias = max(0.0005 * (1.0 - dot(normal, fragToLight)), 0.00005);
 
 	vec2 texelSize = 1.0/textureSize(mat.shadowMap0, 0);
-	const int halfKernelWidth = 2;
+	int halfKernelWidth = pcfHalfKernel;
 	float shadow = 0;
 
 	for(int i = -halfKernelWidth; i <= halfKernelWidth; i++)
@@ -256,8 +255,8 @@ float CalculateDirectionalShadow()
 
 float CalculatePointShadow()
 {
-	//convert back to world space because the shadow map was done in world space
-	vec3 fragToLight = TBN * (FragPosTangent - PointLightsTangent[0].lightPos);
+	//the shadow map was done in world space
+	vec3 fragToLight = FragPos - clusterLights[pointShadowLight].positionRange.xyz;
 	
 
 	float closestDepth = texture(pointShadowMap, fragToLight).r;
@@ -273,6 +272,44 @@ float CalculatePointShadow()
 	return when_gt(currentDepth - bias, closestDepth);
 }
 
+uvec2 GetClusterRange()
+{
+	float depth = -(view * vec4(FragPos, 1.0)).z;
+	float slice = clamp(floor(log(depth) * clusterSlicing.x + clusterSlicing.y), 0.0, clusterGrid.z - 1.0);
+	vec2 tile = min(floor(gl_FragCoord.xy / clusterTileSize), clusterGrid.xy - 1.0);
+
+	return clusterRanges[uint(tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice))];
+}
+
+PointLight GetPointLight(uint index, mat3 worldToTangent)
+{
+	PointLight light;
+	light.lightPos = worldToTangent * clusterLights[index].positionRange.xyz;
+	light.diffuseColor = clusterLights[index].diffuseLinear.rgb;
+	light.specularColor = clusterLights[index].specularQuadratic.rgb;
+	light.diffuseIntensity = 1.0; // colors come premultiplied
+	light.specularIntensity = 1.0;
+	light.linear = clusterLights[index].diffuseLinear.w;
+	light.quadratic = clusterLights[index].specularQuadratic.w;
+	return light;
+}
+
+//reaches zero at the range the light was assigned to clusters with, so cluster edges never show
+float GetRangeFade(uint index)
+{
+	float ratio = length(clusterLights[index].positionRange.xyz - FragPos) / clusterLights[index].positionRange.w;
+	float fade = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+	return fade * fade;
+}
+
+//1 for point lights, spot lights fade out between their inner and outer cutoff
+float GetConeFade(uint index)
+{
+	vec3 lightToFrag = normalize(FragPos - clusterLights[index].positionRange.xyz);
+	float theta = dot(lightToFrag, clusterLights[index].directionCosOuter.xyz);
+	return clamp(theta * clusterLights[index].cone.x + clusterLights[index].cone.y, 0.0, 1.0);
+}
+
 vec2 GetTexCoords(float useParallaxLocal)
 {
 	vec2 texCoord = vec2(TexCoord.x * tiling.x + offset.x , TexCoord.y * tiling.y + offset.y);
@@ -26,6 +26,7 @@ uniform vec3 viewPos;
 uniform mat4 lightView;
 uniform mat4 lightProjection;
 uniform float useShadow;
+uniform int pcfHalfKernel; //0 is a single tap, 2 is the full 5x5 kernel
 
 void main()
 {
@@ -88,7 +89,7 @@ float CalculateDirectionalShadow(vec3 fragPos, vec3 norm)
 	float bias = max(0.0005 * (1.0 - dot(normal, fragToLight)), 0.00005);
 
 	vec2 texelSize = 1.0/textureSize(shadowMap, 0);
-	const int halfKernelWidth = 2;
+	int halfKernelWidth = pcfHalfKernel;
 	float shadow = 0;
 
 	for(int i = -halfKernelWidth; i <= halfKernelWidth; i++)
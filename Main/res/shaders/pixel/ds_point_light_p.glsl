@@ -33,7 +33,8 @@ uniform float useDebug;
 
 void main()
 {
-	vec2 coord = gl_FragCoord.xy/vec2(1280, 720);
+	//the g-buffer can be smaller than the window under dynamic resolution
+	vec2 coord = gl_FragCoord.xy/vec2(textureSize(gPos, 0));
 	vec3 worldPos = texture(gPos, coord).rgb;
 	vec3 normal = texture(gNormal, coord).rgb;
 	vec4 diffSpec = texture(gDiffSpec, coord);
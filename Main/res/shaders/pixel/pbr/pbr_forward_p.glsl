@@ -21,18 +21,14 @@ struct PointLight
 	float quadratic;
 };
 
-struct SpotLight
+struct ClusterLight
 {
-	vec3 lightPos;
-	vec3 diffuseColor;
-	vec3 specularColor;
-	float diffuseIntensity;
-	float specularIntensity;
-
-	vec3 spotDirection;
-	float cutOffValue;
-	float innerCutOffValue;
-}; 
+	vec4 positionRange;
+	vec4 diffuseLinear;
+	vec4 specularQuadratic;
+	vec4 directionCosOuter;
+	vec4 cone;
+};
 
 struct Material
 {
@@ -55,12 +51,15 @@ struct Material
 vec2 GetTexCoordWithOffset();
 vec3 CalculateDirectionalLight(DirLight light, vec3 normal, vec3 fragToView, vec3 albedo, float metallic, float roughness, vec3 f0);
 vec3 CalculatePointLightContrib(PointLight light, vec3 normal, vec3 fragToView, vec3 albedo, float metallic, float roughness, vec3 f0);
-vec3 CalculateSpotLightContrib(SpotLight light, vec3 normal, vec3 fragToView, vec3 albedo, float metallic, float roughness, vec3 f0);
 vec3 CalculateAmbientDiffuse(samplerCube irradianceMap, vec3 normal, vec3 fragToView, vec3 albedo, vec3 f0, float ao, float roughness);
 float CalculateDirectionalShadow(vec3 normal);
 //float CalculatePointShadow();
 //vec2 GetTexCoords(float useParallaxLocal);
 float when_gt(float x, float y);
+uvec2 GetClusterRange();
+PointLight GetPointLight(uint index, mat3 worldToTangent);
+float GetRangeFade(uint index);
+float GetConeFade(uint index);
 
 float DistributionGGX(vec3 normal, vec3 halfwayVector, float roughness);
 float GeometrySchlickGGX(float NdotV, float roughness);
@@ -74,24 +73,48 @@ in vec4 FragPosDirLightSpace;
 
 in vec3 ViewPosTangent;
 in vec3 FragPosTangent;
+in vec3 FragPos;
 in DirLight DirLightTangent;
-in PointLight PointLightsTangent[4];
-in SpotLight SpotLightTangent;
 in mat3 TBN; //in
 
 
 out vec4 FragColor;
 
+layout(std140, binding = 1) uniform VP
+{
+	mat4 view;
+	mat4 projection;
+};
+
+//point and spot lights and the per cluster lists of the ones that reach it, filled by light_clusters
+layout(std430, binding = 2) readonly buffer ClusterLights
+{
+	ClusterLight clusterLights[];
+};
+
+layout(std430, binding = 3) readonly buffer ClusterRanges
+{
+	uvec2 clusterRanges[];
+};
+
+layout(std430, binding = 4) readonly buffer ClusterIndices
+{
+	uint clusterIndices[];
+};
+
 uniform Material mat;
 uniform samplerCube pointShadowMap;
-uniform float isFlashlightOn;
 uniform vec2 tiling;
 uniform vec2 offset;
 uniform float farPlane;
 uniform float useShadow;
+uniform int pcfHalfKernel; //0 is a single tap, 2 is the full 5x5 kernel
 uniform float useNormalMaps;
 uniform float useIBL;
 uniform float useParallax; //uniforms
+uniform vec3 clusterGrid; //tiles across, tiles up, depth slices
+uniform vec2 clusterTileSize; //in pixels
+uniform vec2 clusterSlicing; //slice = log(view depth) * x + y
 
 uniform samplerCube prefilter;
 uniform sampler2D brdfLut;
@@ -119,21 +142,20 @@ void main()
 	f0 = mix(f0, albedo, metallic);
 
 	vec3 point_light_contrib = vec3(0);
-	for(int i = 0; i < 4; i++)
+	uvec2 cluster = GetClusterRange();
+	mat3 worldToTangent = transpose(TBN);
+
+	for(uint i = cluster.x; i < cluster.x + cluster.y; i++)
 	{
-		point_light_contrib += CalculatePointLightContrib(PointLightsTangent[i], normal, fragToView, albedo, metallic, roughness, f0);
+		uint lightIndex = clusterIndices[i];
+		point_light_contrib += GetRangeFade(lightIndex) * GetConeFade(lightIndex) * CalculatePointLightContrib(GetPointLight(lightIndex, worldToTangent), normal, fragToView, albedo, metallic, roughness, f0);
 	}
 
 	vec3 dirLightContrib = CalculateDirectionalLight(DirLightTangent,  normal, fragToView, albedo, metallic, roughness, f0);
-	vec3 spotLightContrib = CalculateSpotLightContrib(SpotLightTangent, normal, fragToView, albedo, metallic, roughness, f0);
 	float dirShadow = CalculateDirectionalShadow(normal) * useShadow;
 
 	dirLightContrib *= (1 - dirShadow);
 
-	spotLightContrib = max(spotLightContrib, vec3(0));
-
-	spotLightContrib *= isFlashlightOn;
-
 	vec3 ambient = CalculateAmbientDiffuse(mat.diffIrradianceTexture0, normal, fragToView, albedo, f0, ao, roughness) * useIBL * 4;
 
 	FragColor = vec4(point_light_contrib + dirLightContrib + ambient , 1.0);
@@ -144,6 +166,44 @@ vec2 GetTexCoordWithOffset()
 	return vec2(TexCoord.x * tiling.x + offset.x, TexCoord.y * tiling.y + offset.y);
 }
 
+uvec2 GetClusterRange()
+{
+	float depth = -(view * vec4(FragPos, 1.0)).z;
+	float slice = clamp(floor(log(depth) * clusterSlicing.x + clusterSlicing.y), 0.0, clusterGrid.z - 1.0);
+	vec2 tile = min(floor(gl_FragCoord.xy / clusterTileSize), clusterGrid.xy - 1.0);
+
+	return clusterRanges[uint(tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice))];
+}
+
+PointLight GetPointLight(uint index, mat3 worldToTangent)
+{
+	PointLight light;
+	light.lightPos = worldToTangent * clusterLights[index].positionRange.xyz;
+	light.diffuseColor = clusterLights[index].diffuseLinear.rgb;
+	light.specularColor = clusterLights[index].specularQuadratic.rgb;
+	light.diffuseIntensity = 1.0; // colors come premultiplied
+	light.specularIntensity = 1.0;
+	light.linear = clusterLights[index].diffuseLinear.w;
+	light.quadratic = clusterLights[index].specularQuadratic.w;
+	return light;
+}
+
+//reaches zero at the range the light was assigned to clusters with, so cluster edges never show
+float GetRangeFade(uint index)
+{
+	float ratio = length(clusterLights[index].positionRange.xyz - FragPos) / clusterLights[index].positionRange.w;
+	float fade = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+	return fade * fade;
+}
+
+//1 for point lights, spot lights fade out between their inner and outer cutoff
+float GetConeFade(uint index)
+{
+	vec3 lightToFrag = normalize(FragPos - clusterLights[index].positionRange.xyz);
+	float theta = dot(lightToFrag, clusterLights[index].directionCosOuter.xyz);
+	return clamp(theta * clusterLights[index].cone.x + clusterLights[index].cone.y, 0.0, 1.0);
+}
+
 vec3 CalculatePointLightContrib(PointLight light, vec3 normal, vec3 fragToView, vec3 albedo, float metallic, float roughness, vec3 f0)
 {
 	//calculate radiance
@@ -206,40 +266,6 @@ vec3 CalculateDirectionalLight(DirLight light, vec3 normal, vec3 fragToView, vec
 	return Lo;
 }
 
-vec3 CalculateSpotLightContrib(SpotLight light, vec3 normal, vec3 fragToView, vec3 albedo, float metallic, float roughness, vec3 f0)
-{
-	//calculate radiance
-	vec3 radiance = vec3(0);
-
-	vec3 fragToLight = normalize(light.lightPos - FragPosTangent);
-	vec3 halfwayVector = normalize(fragToLight + fragToView);
-
-	float theta = max(dot(normalize(-light.spotDirection), fragToLight), 0.0); 
-	float epsilon = light.innerCutOffValue - light.cutOffValue;
-	float intensity = clamp((theta - light.cutOffValue)/epsilon, 0.01f, 1.0f);
-
-	radiance = light.diffuseColor * light.diffuseIntensity * intensity;
-
-	//cook-torrance brdf
-	float D = DistributionGGX(normal, halfwayVector, roughness);
-	float G = GeometrySmith(normal, fragToView, fragToLight, roughness);
-	vec3 F = FresnelSchlick(max(dot(halfwayVector, fragToView), 0.0), f0);
-
-	vec3 kS = F;
-	vec3 kD = vec3(1.0) - kS;
-
-	kD *= 1.0 - metallic; // this is to take into account that metallic surfaces absorbs all refracted light
-
-	vec3 numerator = D*F*G;
-	float denominator = 4.0 * max(dot(normal, fragToView), 0.0) * max(dot(normal, fragToLight), 0.0) + 0.001;
-	vec3 specular = numerator / denominator;
-
-	float nDotL = max(dot(normal, fragToLight), 0.0);
-	vec3 Lo = (kD * albedo / PI + specular) * radiance * nDotL; // BRDF * RADIANCE * NDOTL
-
-	return Lo;
-}
-
 vec3 CalculateAmbientDiffuse(samplerCube irradianceMap, vec3 normal, vec3 fragToView, vec3 albedo, vec3 f0, float ao, float roughness)
 {
 	vec3 kS = FresnelSchlickRoughness(max(dot(normal, fragToView), 0.0), f0, roughness);
@@ -318,7 +344,7 @@ float CalculateDirectionalShadow(vec3 normal)
 	float bias = max(0.05 * (1.0 - dot(normal, fragToLight)), 0.005);
 
 	vec2 texelSize = 1.0/textureSize(mat.shadowMap0, 0);
-	const int halfKernelWidth = 2;
+	int halfKernelWidth = pcfHalfKernel;
 	float shadow = 0;
 
 	for(int i = -halfKernelWidth; i <= halfKernelWidth; i++)
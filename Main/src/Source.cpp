@@ -5,7 +5,9 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <cstdio>
 #include <iostream>
+#include <unordered_set>
 #include "rendering/shader.h"
 #include "rendering/shader_program.h"
 #include "rendering/texture.h"
@@ -21,51 +23,90 @@
 #include "data/model.h"
 #include "data/mvp.h"
 #include "data/primitive.h"
-#include "light/light.h"
+#include "data/transform_system.h"
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
-#include "light/directional_light.h"
-#include "light/point_light.h"
-#include "light/spot_light.h"
+#include "light/light_component.h"
+#include "engine/benchmark.h"
+#include "engine/camera_path.h"
+#include "engine/components.h"
+#include "engine/flight_recorder.h"
+#include "engine/job_system.h"
+#include "engine/stress_scene.h"
+#include "engine/registry.h"
+#include "rendering/command_list.h"
+#include "rendering/dynamic_resolution.h"
 #include "rendering/frame_buffer.h"
+#include "rendering/frame_graph.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/gpu_profiler.h"
+#include "rendering/gpu_resource.h"
+#include "rendering/gpu_timer.h"
+#include "rendering/image_cache.h"
+#include "rendering/light_clusters.h"
 #include "rendering/material.h"
+#include "rendering/null_backend.h"
+#include "rendering/quality_governor.h"
+#include "rendering/recording_backend.h"
 #include "rendering/renderer.h"
 #include "rendering/render_buffer.h"
+#include "rendering/render_stats.h"
 #include "rendering/uniform_buffer_object.h"
+#include "utils/cpu_profiler.h"
 #include "utils/config.h"
+#include "utils/frame_arena.h"
+#include "utils/memory_tracker.h"
+#include "utils/process_memory.h"
 
 #pragma region function declarations
 
+struct gathered_light;
+
+struct g_buffer_textures
+{
+	const texture* position{ nullptr };
+	const texture* normal{ nullptr };
+	const texture* diff_spec{ nullptr };
+	const texture* depth{ nullptr };
+};
+
 void set_vp_from_camera();
 std::string get_tex(const std::string& path);
 
 void render_light_sources(model &m, const shader_program &light_shader_program);
 void render_model(model& m, const shader_program& program);
+void send_model_pass_uniforms(const shader_program& program);
 void render_model(model& m, const tiling_and_offset &tiling_and_offset, const shader_program& program);
 void render_asteroids(model& m, const shader_program& program);
 void render_model_outline(model& m, const shader_program& program);
 void render_transparent_quads(const std::vector<game_object> &quads, const renderer& rend, const shader_program& program);
 void render_skybox(const renderer& rend, const shader_program& program);
-void render_pp_quad(const renderer& rend, const shader_program& program);
+void render_pp_quad(const renderer& rend, const shader_program& program, const texture* scene_color, const texture* bloom);
 void render_forward(const shader_program& program);
-void render_directional_shadow_map(std::vector<model> &models, const shader_program& program);
-void render_omnidirectional_shadow_map(std::vector<model>& models, const shader_program& program);
-void bloom_postprocess(const frame_buffer& fb, const renderer& rend, const shader_program& bloom_brightness, const shader_program& blur);
+void render_directional_shadow_map(const shader_program& program);
+void resize_shadow_maps(texture& directional, texture& point, unsigned int resolution);
+void render_omnidirectional_shadow_map(const shader_program& program);
+void bloom_postprocess(frame_graph& graph, frame_graph_resource source, const frame_graph_resource ping_pong[2], const renderer& rend, const shader_program& bloom_brightness, const shader_program& blur);
 
 void render_debug_point_lights(model& m, shader_program& program);
 
 void render_ds_geometry(const shader_program& program);
-void render_ds_dir_light_pass(const shader_program& program, model& quad);
-void render_ds_point_light_pass(const shader_program& stencil_program, const shader_program& point_light_program, model& sphere);
-void render_shadow_maps(std::vector<model>& models, const shader_program& dir_program, const shader_program& point_program);
+void render_ds_dir_light_pass(const shader_program& program, model& quad, const g_buffer_textures& g_buffer);
+void render_ds_point_light_pass(const shader_program& stencil_program, const shader_program& point_light_program, model& sphere, const g_buffer_textures& g_buffer);
+void render_ds_tiled_light_pass(const shader_program& program, const g_buffer_textures& g_buffer, const texture& lit_color);
 
 void send_dir_light_to_shader(const shader_program& program);
-void send_point_lights_to_shader(const shader_program& program);
-void send_point_light_to_shader(const shader_program& program, const point_light& light);
-void send_spot_light_to_shader(const shader_program& program);
+void send_point_light_to_shader(const shader_program& program, const gathered_light& light);
 void send_material_data_to_shader(const shader_program& program);
-float calculate_point_light_radius(point_light& light);
+
+entity add_model_entity(const model& m, bool use_scale_tiling);
+entity add_model_entity(const model& m, const transform& t, bool use_scale_tiling);
+entity add_light_entity(const std::string& name, const light_component& l, const transform& t);
+void gather_lights();
+void prepare_cluster_lights();
+void cull_scene();
+void record_scene(const std::function<void(command_list&, const mesh_renderer_component&, const transform&)>& record, bool visible_only);
 
 void deallocate();
 void init_imgui();
@@ -78,6 +119,11 @@ static void mouse_callback(GLFWwindow* window, double x_pos, double y_pos);
 static void scroll_callback(GLFWwindow* window, double x_offset, double y_offset);
 
 void render_debug_windows();
+void render_profiler_window();
+void render_cpu_flame_window();
+void render_memory_window();
+bool report_frame_allocations(std::unordered_set<const void*>& reported);
+ImTextureID get_frame_texture_id(const char* name);
 
 #pragma endregion
 
@@ -95,6 +141,9 @@ static const unsigned int WIDTH = 1280;
 static const unsigned int HEIGHT = 720;
 static const unsigned int SAMPLES = 8;
 static const float RADIUS = 25.0f;
+static const unsigned int CULL_BATCH = 512;
+static const unsigned int LIGHT_TILE_SIZE = 16;
+static const unsigned int RECORD_BATCH = 64;
 
 #pragma endregion
 
@@ -108,10 +157,13 @@ double last_y = HEIGHT * 0.5;
 float key_press_cooldown = 0.25f;
 float last_cursor_swap = 0.0f;
 float last_flash_light_swap = 0.0f;
+float last_hitch_trigger = 0.0f;
 
 int cursor_mode = GLFW_CURSOR_NORMAL;
 bool first_mouse;
 bool is_flash_light_on = false;
+//the spot light that follows the camera, F switches it
+entity flashlight;
 bool is_open;
 
 #pragma endregion
@@ -127,27 +179,51 @@ bool use_gamma_correction = true;
 bool use_hdr = true;
 bool use_bloom = false;
 bool use_deferred = false;
+bool use_tiled_lighting = true;
 bool use_light_debug = false;
 bool use_pbr = true;
 bool use_ibl = true; // debug values
 
 color ambient_color;
-std::map<float, transform> sorted;
 mvp mvp_matrix;
 mvp dir_shadow_map_mvp_matrix;
 
 //glfw
 GLFWwindow* window;
 
+//framebuffer size in pixels, every screen sized target follows it
+unsigned int screen_width = WIDTH;
+unsigned int screen_height = HEIGHT;
+
 //Game Related Instances
-point_light point_lights[4];
-directional_light dir_light;
-spot_light spotlight;
 material cube_mat;
 
-std::vector<light*> lights;
-std::vector<game_object*> game_objects;
-std::vector<model> game_models;
+registry scene;
+
+//active lights pulled out of the registry once per frame
+//the shadow casting point light always lands in slot 0, that is the one the shaders shadow
+struct gathered_light
+{
+	const light_component* data{ nullptr };
+	glm::vec3 position{ 0 };
+};
+
+struct gathered_lights
+{
+	gathered_light directional;
+	std::vector<gathered_light> points;
+	std::vector<gathered_light> spots;
+	bool has_point_shadow{ false };
+};
+
+gathered_lights frame_lights;
+
+//point and spot lights the forward shaders shade, listed per froxel
+light_clusters clusters;
+
+//one list per job thread so recording never shares a list, reused by every pass
+std::vector<command_list> pass_lists;
+unsigned int visible_count = 0;
 
 
 texture cerberus_color;
@@ -156,17 +232,42 @@ texture cerberus_mask;
 
 FB shadow_fb = FB();
 FB point_shadow_fb = FB();
-FB bloom_fb = FB();
-FB ms_fb = FB();
-FB hdr_fb = FB();
-FB destination_fb = FB();
-FB debug_fb = FB();
-FB pingpong_fb[] = { FB(), FB() };
-FB geometry_fb = FB();
-FB ds_light_fb = FB();
 FB precompute_fb = FB();
 //FB conv_fb = FB();
 
+//rebuilt every frame, screen sized targets only exist while a live pass needs them
+frame_graph frame;
+bool keep_debug_targets = false;
+
+//scene targets render at a fraction of the screen size when the gpu runs over budget, composite upscales them
+gpu_timer frame_gpu_timer;
+dynamic_resolution resolution;
+unsigned int render_width = WIDTH;
+unsigned int render_height = HEIGHT;
+
+//sheds features once the resolution scale has nowhere left to go
+quality_governor quality;
+unsigned int shadow_resolution = SHADOW_RESOLUTION;
+
+//keeps the last few hundred frames around so a hitch can be dumped after the fact, F9 dumps on demand
+flight_recorder recorder;
+
+//command line benchmark run, and the fly-through it plays back (F8 records a new one)
+benchmark::settings bench_settings;
+camera_path cam_path;
+bool is_recording_path = false;
+float path_record_start = 0.0f;
+float last_path_toggle = 0.0f;
+
+//--null-backend submits the benchmark loop here; the stats window can capture one frame of backend calls
+null_backend null_submit;
+recording_backend frame_capture(render_backend::get());
+bool is_capture_requested = false;
+
+//--capture records everything from startup with its data for the Replay tool
+recording_backend stream_capture(render_backend::get());
+bool is_capturing_stream = false;
+
 uniform_buffer_object vp_ubo;
 
 float values[9] = { 1.0f,1.0f,1.0f,1.0f, -9.0f, 1.0f, 1.0f, 1.0f, 1.0f };
@@ -209,8 +310,17 @@ glm::mat4 origin_capture_views[] =
 
 #pragma endregion 
 
-int main()  // NOLINT(bugprone-exception-escape)
+int main(const int argc, char** argv)  // NOLINT(bugprone-exception-escape)
 {
+	if (!benchmark::parse_args(argc, argv, bench_settings))
+		return 1;
+
+	benchmark bench(bench_settings);
+	gpu_memory::set_budget(static_cast<std::size_t>(bench_settings.gpu_budget_mb) * 1024 * 1024);
+
+	//startup is one span with a child per section, closed right before the loop
+	cpu_profiler::get().push("Startup");
+
 	#pragma region Init GLFW
 
 	glfwSetErrorCallback(glfw_error_callback);
@@ -223,7 +333,18 @@ int main()  // NOLINT(bugprone-exception-escape)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	window = glfwCreateWindow(WIDTH, HEIGHT, "Main", nullptr, nullptr);
+
+	//a benchmark renders at a fixed size; headless keeps the window hidden so it only hosts the context
+	if (bench_settings.is_enabled)
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	if (bench_settings.is_headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	if (bench_settings.use_egl)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+
+	window = bench_settings.is_enabled
+		? glfwCreateWindow(bench_settings.width, bench_settings.height, "Main", nullptr, nullptr)
+		: glfwCreateWindow(WIDTH, HEIGHT, "Main", nullptr, nullptr);
 	
 	if (!window)
 	{
@@ -245,11 +366,21 @@ int main()  // NOLINT(bugprone-exception-escape)
 		return -1;
 	}
 
+	if (!bench_settings.capture_path.empty())
+	{
+		stream_capture.set_target(render_backend::get());
+		stream_capture.is_capturing_payloads = true;
+		render_backend::set(&stream_capture);
+		is_capturing_stream = true;
+	}
+
 	#pragma endregion
 
 	#pragma region Viewport and Callbacks
 
-	glViewport(0, 0, WIDTH, HEIGHT);
+	int framebuffer_width, framebuffer_height;
+	glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+	frame_buffer_resize_callback(window, framebuffer_width, framebuffer_height);
 	glfwSetFramebufferSizeCallback(window, frame_buffer_resize_callback);
 
 	glfwSwapInterval(0);
@@ -264,6 +395,33 @@ int main()  // NOLINT(bugprone-exception-escape)
 	#pragma region ImGui Init
 
 	init_imgui();
+	frame_gpu_timer.init();
+	quality.init();
+
+	#pragma endregion
+
+	#pragma region Benchmark Init
+
+	if (bench_settings.is_enabled)
+	{
+		//nothing may change what is rendered between runs
+		resolution.is_enabled = false;
+		quality.is_enabled = false;
+
+		if (!bench_settings.camera_path.empty() && !cam_path.load(bench_settings.camera_path))
+		{
+			glfwTerminate();
+			return 1;
+		}
+	}
+
+	#pragma endregion
+
+	#pragma region Job System Init
+
+	//one worker per core besides this thread, the main thread keeps the gl context and only submits
+	job_system::get().init();
+	pass_lists.resize(job_system::get().get_thread_count());
 
 	#pragma endregion
 
@@ -281,6 +439,8 @@ int main()  // NOLINT(bugprone-exception-escape)
 
 	#pragma region Shaders
 
+	cpu_profiler::get().push("Shaders");
+
 	// *********** shaders *****************
 	shader basic_shader_vertex = shader("basic_v", GL_VERTEX_SHADER);
 	shader basic_shader_pixel = shader("basic_p", GL_FRAGMENT_SHADER);
@@ -351,6 +511,9 @@ int main()  // NOLINT(bugprone-exception-escape)
 	shader brdf_lut_pixel = shader("pbr/brdf_lut_p", GL_FRAGMENT_SHADER);
 	//shader brdf_lut_pixel = shader("src/testing/2.2.1.brdf.fs", GL_FRAGMENT_SHADER, false);
 
+	shader light_cluster_compute = shader("light_cluster_c", GL_COMPUTE_SHADER);
+	shader tiled_deferred_compute = shader("tiled_deferred_c", GL_COMPUTE_SHADER);
+
 	// ************** shader programs **************
 	shader_program basic_shader_program = shader_program(&basic_shader_vertex, &basic_shader_pixel);
 	shader_program basic_shader_program_2 = shader_program(&basic_shader_vertex, &basic_shader_pixel);
@@ -379,17 +542,40 @@ int main()  // NOLINT(bugprone-exception-escape)
 	shader_program irradiance_diffuse_shader_program = shader_program(&irradiance_vertex, &irradiance_pixel);
 	shader_program prefilter_shader_program = shader_program(&prefilter_vertex, &prefilter_pixel);
 	shader_program brdf_lut_shader_program = shader_program(&brdf_lut_vertex, &brdf_lut_pixel);
+	shader_program light_cluster_shader_program = shader_program(&light_cluster_compute);
+	shader_program tiled_deferred_shader_program = shader_program(&tiled_deferred_compute);
 	
 	#pragma endregion
 
+	cpu_profiler::get().pop();
+
 	#pragma region Colors, Textures, Materials & Meshes
 
-	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+	render_backend::get().set_capability(GL_TEXTURE_CUBE_MAP_SEAMLESS, true);
 	
 	ambient_color = color(0.0f, 0.0f, 0.0f, 1.0f);
 	cube_mat = material(color::WHITE, color::WHITE);
 
 	#pragma region Loaded Textures
+
+	cpu_profiler::get().push("Textures");
+
+	//decode everything as jobs first, the constructors below then only upload
+	image_cache::prefetch(
+		{
+			get_tex("pavement/pavement_color.jpg"),
+			get_tex("pavement/pavement_normal.jpg"),
+			get_tex("pavement/pavement_mask.jpg"),
+			get_tex("gold/gold_color_boosted.png"),
+			get_tex("gold/gold_normal.png"),
+			get_tex("gold/gold_mask.png"),
+			"res/models/cerberus/Cerberus_A.tga",
+			"res/models/cerberus/Cerberus_N.tga",
+			"res/models/cerberus/Cerberus_Mask.tga",
+			"res/models/len_canon/textures/len_low_lambert2SG_metallicRoughness.png",
+			"res/models/viking_shield/textures/lambert1_metallicRoughness.png"
+		},
+		{ get_tex("hdr/fireplace_4k.hdr") });
 	
 	const texture floor_tex = texture(get_tex("pavement/pavement_color.jpg"), TEX_T::diffuse, GL_UNSIGNED_BYTE, true);
 	const texture floor_normal_tex = texture(get_tex("pavement/pavement_normal.jpg"), TEX_T::normal, GL_UNSIGNED_BYTE, true);
@@ -426,44 +612,22 @@ int main()  // NOLINT(bugprone-exception-escape)
 	texture irradiance_map = texture({}, TEX_T::cube, GL_RGB16F, GL_RGB, GL_FLOAT, IRRADIANCE_RES, false, GL_LINEAR);
 	texture prefilter_map = texture({}, TEX_T::cube, GL_RGB16F, GL_RGB, GL_FLOAT, PREFILTER_RES, true, GL_LINEAR_MIPMAP_LINEAR); // IBL
 
+	gpu_memory::set_owner(gpu_memory_category::render_target, brdf_lut_map.get_id(), "BRDF LUT");
+	gpu_memory::set_owner(gpu_memory_category::render_target, hdri_cube_map.get_id(), "Environment Cube Map");
+	gpu_memory::set_owner(gpu_memory_category::render_target, irradiance_map.get_id(), "Irradiance Map");
+	gpu_memory::set_owner(gpu_memory_category::render_target, prefilter_map.get_id(), "Prefilter Map");
+
 	#pragma endregion
 
+	cpu_profiler::get().pop();
+
 	#pragma region Texture Buffers
 	
-	//basically unnecessary
-	texture bloom_fb_color_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, false);
-	texture bloom_fb_brightness_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, false);
-
-	texture pingpong_color_tex[2];
-	for (auto& i : pingpong_color_tex)
-		i = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, true);
-
-	texture debug_fb_color_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, false);
-	texture debug_fb_depth_tex = texture(TEX_T::depth, WIDTH, HEIGHT, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT32F, GL_FLOAT, false);
-
-	texture ms_color_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, false, SAMPLES);
-	texture ms_depth_tex = texture(TEX_T::depth, WIDTH, HEIGHT, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, false, SAMPLES);
-
-	texture hdr_color_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, false);
-
+	//screen sized targets come from the frame graph
 	texture shadow_depth_tex = texture(TEX_T::depth, SHADOW_RESOLUTION, SHADOW_RESOLUTION, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, false);
 
 	texture point_shadow_depth_tex = texture(TEX_T::cube, SHADOW_RESOLUTION, SHADOW_RESOLUTION, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, false);
-	
-	texture destination_fb_color_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, false);
-	texture destination_fb_depth_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, false);
-
-
 
-	//deferred
-	texture geometry_pos_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGB, GL_RGB16F, GL_FLOAT, true);
-	texture geometry_norm_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGB, GL_RGB16F, GL_FLOAT, true);
-	texture geometry_diff_spec_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, true);
-	texture geometry_depth_stencil_tex = texture(TEX_T::depth, WIDTH, HEIGHT, GL_DEPTH_STENCIL, GL_DEPTH32F_STENCIL8, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, false);
-	
-	texture ds_light_color_tex = texture(TEX_T::color, WIDTH, HEIGHT, GL_RGBA, GL_RGBA16F, GL_FLOAT, false);
-	texture ds_light_depth_stencil_tex = texture(TEX_T::depth, WIDTH, HEIGHT, GL_DEPTH_STENCIL, GL_DEPTH32F_STENCIL8, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, false);
-	
 	#pragma endregion
 	
 	#pragma region Meshes
@@ -481,9 +645,7 @@ int main()  // NOLINT(bugprone-exception-escape)
 	floor_mesh.is_indexed = false;
 	floor_mesh.should_cull_face = false;
 
-	std::vector<texture> destination_quad_textures = { destination_fb_color_tex };
 	mesh destination_quad_mesh = primitive::get_quad();
-	destination_quad_mesh.replace_textures(destination_quad_textures);
 	destination_quad_mesh.is_indexed = false;
 	destination_quad_mesh.should_cull_face = false;
 
@@ -516,6 +678,8 @@ int main()  // NOLINT(bugprone-exception-escape)
 
 	#pragma region Renderers and  Model
 
+	cpu_profiler::get().push("Models");
+
 	renderer skybox_renderer = renderer(std::make_shared<mesh>(skybox_cube_mesh));
 	renderer screen_space_quad_renderer = renderer(std::make_shared<mesh>(destination_quad_mesh));
 	renderer screen_space_raw_quad_renderer = renderer(std::make_shared<mesh>(bloom_quad_mesh));
@@ -573,7 +737,7 @@ int main()  // NOLINT(bugprone-exception-escape)
 	for (int i = 0; i < 4; i++)
 	{
 		sphere_models[i].set_name(std::string("Sphere ").append(std::to_string(i)));
-		//game_models.push_back(sphere_models[i]);
+		//add_model_entity(sphere_models[i], false);
 	}
 	sphere_models[0].get_mesh_ptr(0)->replace_textures({ gold_color, gold_normal, gold_mask , irradiance_map});
 	cerberus.get_mesh_ptr(0)->replace_textures({ cerberus_color, cerberus_mask, cerberus_normal, irradiance_map });
@@ -581,15 +745,17 @@ int main()  // NOLINT(bugprone-exception-escape)
 	cerberus.get_transform()->set_rotation(glm::vec3(-90, 0, 0));
 	cerberus.get_transform()->set_position(glm::vec3(0, 1, 0));
 
-	game_models.push_back(floor_model);
-	game_models.push_back(cerberus);
-	//game_models.push_back(canon_lens);
-	game_models.push_back(viking_shield);
+	add_model_entity(floor_model, true);
+	add_model_entity(cerberus, false);
+	//add_model_entity(canon_lens, false);
+	add_model_entity(viking_shield, false);
 
 	
 
 	#pragma endregion
 
+	cpu_profiler::get().pop();
+
 	#pragma region FrameBuffers and RenderBuffers and Uniform Buffer Objects
 
 	precompute_fb.generate();
@@ -597,60 +763,11 @@ int main()  // NOLINT(bugprone-exception-escape)
 	
 	render_buffer precompute_rb = render_buffer(GL_DEPTH_COMPONENT24, ENV_MAP_RES, ENV_MAP_RES);
 	precompute_fb.attach_render_buffer(precompute_rb, GL_DEPTH_ATTACHMENT);
+	gpu_memory::set_owner(gpu_memory_category::renderbuffer, precompute_rb.get_id(), "IBL Precompute Depth");
 
 	std::cout << "HDR to Cube Map Frame Buffer " << FB::validate() << std::endl;
 	FB::unbind();
 
-	geometry_fb.generate();
-	geometry_fb.bind();
-	geometry_fb.attach_texture_2d_color(geometry_pos_tex, GL_COLOR_ATTACHMENT0);
-	geometry_fb.attach_texture_2d_color(geometry_norm_tex, GL_COLOR_ATTACHMENT1);
-	geometry_fb.attach_texture_2d_color(geometry_diff_spec_tex, GL_COLOR_ATTACHMENT2);
-	geometry_fb.attach_texture_2d_depth_stencil(geometry_depth_stencil_tex, GL_DEPTH_STENCIL_ATTACHMENT);
-	geometry_fb.set_draw_buffers(3, nullptr);
-
-	std::cout << "Geometry Frame buffer " << FB::validate() << std::endl;
-
-	FB::unbind(); // geometry fb
-	
-	ds_light_fb.generate();
-	ds_light_fb.bind();
-	ds_light_fb.attach_texture_2d_color(ds_light_color_tex, GL_COLOR_ATTACHMENT0);
-	ds_light_fb.attach_texture_2d_depth_stencil(ds_light_depth_stencil_tex, GL_DEPTH_STENCIL_ATTACHMENT);
-	//ds_light_fb.attach_render_buffer(ds_light_rb, GL_DEPTH_STENCIL_ATTACHMENT);
-
-	std::cout << "Deferred Shading Frame Buffer " << FB::validate() << std::endl;
-	FB::unbind(); // DS Light pass fb
-	
-	ms_fb.generate();
-	ms_fb.bind();
-	ms_fb.attach_texture_2d_color(ms_color_tex, GL_COLOR_ATTACHMENT0);
-	ms_fb.attach_texture_2d_depth(ms_depth_tex, GL_DEPTH_ATTACHMENT);
-	std::cout << "frame buffer with multi sampled color and depth texture " << FB::validate() << std::endl;;
-	FB::unbind(); // Multi sampled fb
-	
-	bloom_fb.generate();
-	bloom_fb.bind();
-	bloom_fb.attach_texture_2d_color(bloom_fb_color_tex, GL_COLOR_ATTACHMENT0);
-	bloom_fb.attach_texture_2d_color(bloom_fb_brightness_tex, GL_COLOR_ATTACHMENT1);
-	bloom_fb.set_draw_buffers(2, nullptr);
-
-	std::cout << "Bloom Frame buffer " << FB::validate() << std::endl;
-	
-	FB::unbind(); // bloom fb
-
-	for(int i = 0; i < 2; i++)
-	{
-		pingpong_fb[i].generate();
-		pingpong_fb[i].bind();
-
-		pingpong_fb[i].attach_texture_2d_color(pingpong_color_tex[i], GL_COLOR_ATTACHMENT0);
-
-		std::cout << "Pingpong texture " << std::to_string(i) << ", " << FB::validate() << std::endl;
-
-		FB::unbind();
-	} // pingpong fb
-
 	shadow_fb.generate();
 	shadow_fb.bind();
 	shadow_fb.attach_texture_2d_depth(shadow_depth_tex, GL_DEPTH_ATTACHMENT);
@@ -668,48 +785,20 @@ int main()  // NOLINT(bugprone-exception-escape)
 	std::cout << "frame buffer for point shadow " << FB::validate() << std::endl;
 	FB::unbind(); // point shadow fb
 
-	hdr_fb.generate();
-	hdr_fb.bind();
-	hdr_fb.attach_texture_2d_color(hdr_color_tex, GL_COLOR_ATTACHMENT0);
-	
-	render_buffer hdr_rb = render_buffer(GL_DEPTH24_STENCIL8, WIDTH, HEIGHT);
-	hdr_fb.attach_render_buffer(hdr_rb, GL_DEPTH_STENCIL_ATTACHMENT);
-
-	std::cout << "HDR frame buffer " << FB::validate() << std::endl;
-
-	FB::unbind(); // hdr fb
-
-	debug_fb.generate();
-	debug_fb.bind();
-
-	debug_fb.attach_texture_2d_color(debug_fb_color_tex, GL_COLOR_ATTACHMENT0);
-	//debug_fb.attach_texture_2d_stencil(debug_fb_stencil_tex, GL_STENCIL_ATTACHMENT);
-	debug_fb.attach_texture_2d_depth(debug_fb_depth_tex, GL_DEPTH_ATTACHMENT);
-
-	std::cout << "Debug Frame Buffer " << FB::validate() << std::endl;
-	FB::unbind(); // debug fb
-
-	destination_fb.generate();
-	destination_fb.bind();
-
-	destination_fb.attach_texture_2d_color(destination_fb_color_tex, GL_COLOR_ATTACHMENT0);
-	destination_fb.attach_texture_2d_depth(destination_fb_depth_tex, GL_DEPTH_ATTACHMENT);
-
-	std::cout << "Destination Frame Buffer " << FB::validate() << std::endl;
-
-	FB::unbind(); //destination fb
-
 	vp_ubo = uniform_buffer_object(2 * sizeof(glm::mat4), GL_STATIC_DRAW);
+	gpu_memory::set_owner(gpu_memory_category::uniform_buffer, vp_ubo.get_id(), "View Projection");
 
 	//bind ubo to binding point 1
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, vp_ubo.get_id());
+	render_backend::get().bind_buffer_base(GL_UNIFORM_BUFFER, 1, vp_ubo.get_id());
 
 	//in opengl 4.x binding point can be specified in shader
 	//bind shader program to binding point 1
-	unsigned int vp_index = glGetUniformBlockIndex(basic_shader_program.id, "VP");
-	glUniformBlockBinding(basic_shader_program.id, vp_index, 1); // UBOs
-	glUniformBlockBinding(basic_shader_program_2.id, vp_index, 1); // UBOs
-	glUniformBlockBinding(basic_shader_program_3.id, vp_index, 1); // UBOs
+	render_backend::get().uniform_block_binding(basic_shader_program.id, "VP", 1); // UBOs
+	render_backend::get().uniform_block_binding(basic_shader_program_2.id, "VP", 1); // UBOs
+	render_backend::get().uniform_block_binding(basic_shader_program_3.id, "VP", 1); // UBOs
+
+	clusters.init();
+	clusters.set_compute_program(&light_cluster_shader_program);
 	
 	#pragma endregion
 
@@ -722,37 +811,34 @@ int main()  // NOLINT(bugprone-exception-escape)
 
 	#pragma region Initialize Game Objects and Lights
 	
-	dir_light = directional_light();
-	dir_light.set_name("directional_light");
-	dir_light.get_transform()->set_position(glm::vec3(0, 1, 4));
+	light_component dir_light;
+	dir_light.type = light_type::directional;
 	dir_light.diff_intensity = 10.0f;
-	game_objects.push_back(&dir_light);
-	lights.push_back(&dir_light);
+	dir_light.casts_shadow = true;
+	add_light_entity("directional_light", dir_light, transform(glm::vec3(0, 1, 4), glm::vec3(0), glm::vec3(1)));
 	dir_shadow_map_mvp_matrix.projection = glm::ortho(-200.0f, 200.0f, -200.0f, 200.0f, 1.0f, 200.f);
 	
 	for (size_t i = 0; i < 4 ; i++)
 	{
-		point_lights[i].get_transform()->set_position(point_light_positions[i]);
-		point_lights[i].get_transform()->set_scale(glm::vec3(5.0f));
-		point_lights[i].linear = 0.0f;
-		point_lights[i].set_uniform_scale();
-		point_lights[i].set_radius_from_scale();
-		point_lights[i].diff_intensity = 150.0f;
-		point_lights[i].set_name(std::string("point_light_").append(std::to_string(i)));
-		game_objects.push_back(&point_lights[i]);
-		lights.push_back(&point_lights[i]);
+		light_component point;
+		point.type = light_type::point;
+		point.linear = 0.0f;
+		point.set_radius(5.0f);
+		point.diff_intensity = 150.0f;
+		point.casts_shadow = i == 0;
+		add_light_entity(std::string("point_light_").append(std::to_string(i)), point,
+			transform(point_light_positions[i], glm::vec3(0), glm::vec3(5.0f)));
 
 		sphere_models[i].get_transform()->set_position(point_light_positions[i]);
 	}
 
-	spotlight = spot_light();
-	spotlight.diffuse = color(250 / 255.0f, 1.0f, 107 / 255.0f, 1.0f);
+	//scale is the range like the point lights, position and direction are taken from the camera every frame
+	light_component spotlight;
+	spotlight.type = light_type::spot;
 	spotlight.diffuse = color(250 / 255.0f, 1.0f, 107 / 255.0f, 1.0f);
 	spotlight.diff_intensity = 50.0f;
-	
-	spotlight.set_name("spot_light");
-	lights.push_back(&spotlight);
-	game_objects.push_back(&spotlight);
+	spotlight.is_active = is_flash_light_on;
+	flashlight = add_light_entity("spot_light", spotlight, transform(glm::vec3(0), glm::vec3(0), glm::vec3(20.0f)));
 	
 
 	floor_model.get_transform()->set_rotation(glm::vec3(-90.0f, 0.0f, 0.0f));
@@ -766,12 +852,94 @@ int main()  // NOLINT(bugprone-exception-escape)
 
 	#pragma endregion
 
+	#pragma region Stress Scene
+
+	//every prototype exists once per material so instances share meshes and only differ by transform
+	const stress_scene::settings& stress_settings = bench_settings.stress;
+	std::vector<texture> stress_textures;
+	std::vector<model> stress_models;
+
+	if (stress_settings.object_count > 0 || stress_settings.light_count > 0)
+	{
+		cpu_profiler::get().push("Stress Scene");
+
+		struct stress_prototype
+		{
+			const mesh* source;
+			glm::vec3 rotation;
+			float scale;
+		};
+
+		const stress_prototype prototypes[] =
+		{
+			{ cerberus.get_mesh_ptr(0), glm::vec3(-90, 0, 0), 0.025f },
+			{ viking_shield.get_mesh_ptr(0), glm::vec3(90, 0, 0), 0.25f },
+			{ &sphere_mesh, glm::vec3(0), 0.5f },
+			{ &debug_eq_to_cube_mesh, glm::vec3(0), 0.5f }
+		};
+		const unsigned int prototype_count = sizeof(prototypes) / sizeof(prototypes[0]);
+
+		const stress_scene layout = stress_scene::generate(stress_settings, prototype_count);
+
+		for (const color& c : layout.get_material_colors())
+		{
+			const unsigned char pixel[4] = { static_cast<unsigned char>(c.r * 255), static_cast<unsigned char>(c.g * 255), static_cast<unsigned char>(c.b * 255), 255 };
+			stress_textures.emplace_back(TEX_T::diffuse, 1, 1, GL_RGBA, GL_RGBA8, GL_UNSIGNED_BYTE, false);
+			stress_textures.back().set_data(pixel, GL_RGBA, GL_UNSIGNED_BYTE);
+		}
+
+		stress_models.reserve(prototype_count * stress_textures.size());
+		for (const stress_prototype& p : prototypes)
+		{
+			for (const texture& material_tex : stress_textures)
+			{
+				mesh m = p.source ? *p.source : primitive::get_cube();
+				m.replace_textures({ material_tex, gold_mask, gold_normal, irradiance_map });
+				stress_models.emplace_back(std::vector<mesh>{ m });
+				stress_models.back().set_name("Stress Object");
+			}
+		}
+
+		for (const stress_scene::object_placement& o : layout.get_objects())
+		{
+			const stress_prototype& p = prototypes[o.prototype];
+			add_model_entity(stress_models[o.prototype * stress_textures.size() + o.material],
+				transform(o.position, p.rotation + o.rotation, glm::vec3(p.scale * o.scale)), false);
+		}
+
+		for (unsigned int i = 0; i < layout.get_lights().size(); i++)
+		{
+			const stress_scene::light_placement& l = layout.get_lights()[i];
+
+			light_component point;
+			point.type = light_type::point;
+			point.diffuse = l.diffuse;
+			point.diff_intensity = 50.0f;
+			add_light_entity(std::string("stress_light_").append(std::to_string(i)), point,
+				transform(l.position, glm::vec3(0), glm::vec3(l.radius)));
+		}
+
+		//looking down over the near edge unless a camera path takes over
+		const float distance = std::min(layout.get_half_extent(), 60.0f);
+		cam.get_transform()->set_position(glm::vec3(0, 10 + distance * 0.25f, -distance));
+		cam.get_transform()->set_rotation(glm::vec3(-20, 90, 0));
+
+		std::cout << "Stress scene: " << layout.get_objects().size() << " objects, " << layout.get_lights().size() << " lights, "
+			<< stress_textures.size() << " materials, seed " << stress_settings.seed << std::endl;
+
+		cpu_profiler::get().pop();
+	}
+
+	#pragma endregion
+
 	#pragma region Environment Map Precompute
 
+	cpu_profiler::get().push("IBL Precompute");
+
 	glm::mat4 capture_proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
 	precompute_fb.bind();
 	
-	glViewport(0, 0, 512, 512);
+	render_backend::get().viewport(0, 0, 512, 512);
 	
 	eq_to_cube_shader_program.use();
 	eq_to_cube_shader_program.set_int("equirectangularMap", 0);
@@ -793,10 +961,10 @@ int main()  // NOLINT(bugprone-exception-escape)
 	} // convert .hdr to cubemap
 
 	hdri_cube_map.bind();
-	glGenerateMipmap(GL_TEXTURE_CUBE_MAP); // hdr to cube map
+	render_backend::get().generate_mipmap(GL_TEXTURE_CUBE_MAP); // hdr to cube map
 	
 	
-	glViewport(0, 0, IRRADIANCE_RES, IRRADIANCE_RES);
+	render_backend::get().viewport(0, 0, IRRADIANCE_RES, IRRADIANCE_RES);
 	precompute_rb.reallocate(GL_DEPTH_COMPONENT24, IRRADIANCE_RES, IRRADIANCE_RES);
 	
 	irradiance_diffuse_shader_program.use();
@@ -831,7 +999,7 @@ int main()  // NOLINT(bugprone-exception-escape)
 	{
 		unsigned int mip_res = PREFILTER_RES * std::pow(0.5, mip);
 		precompute_rb.reallocate(GL_DEPTH_COMPONENT24, mip_res, mip_res);
-		glViewport(0, 0, mip_res, mip_res);
+		render_backend::get().viewport(0, 0, mip_res, mip_res);
 
 		float roughness = static_cast<float>(mip) / static_cast<float>(max_mip_level - 1);
 		prefilter_shader_program.set_float("roughness", roughness);
@@ -853,7 +1021,7 @@ int main()  // NOLINT(bugprone-exception-escape)
 	// prefilter env map
 
 
-	glViewport(0, 0, LUT_RES, LUT_RES);
+	render_backend::get().viewport(0, 0, LUT_RES, LUT_RES);
 	precompute_rb.reallocate(GL_DEPTH_COMPONENT24, LUT_RES, LUT_RES);
 	precompute_fb.attach_texture_2d_color(brdf_lut_map, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0);
 
@@ -863,81 +1031,352 @@ int main()  // NOLINT(bugprone-exception-escape)
 	
 	
 	FB::unbind();
-	glViewport(0, 0, WIDTH, HEIGHT);
+	render_backend::get().viewport(0, 0, screen_width, screen_height);
 	#pragma endregion
 
+	//ibl precompute, then startup
+	cpu_profiler::get().pop();
+	cpu_profiler::get().pop();
+
 	#pragma region Loop
 
-	while(!glfwWindowShouldClose(window))
+	if (bench_settings.use_null_backend)
+		render_backend::set(&null_submit);
+
+	//frames past the warmup that allocated while rendering, each offending callsite is printed the first time it shows up
+	unsigned int loop_frames = 0;
+	unsigned int allocating_frames = 0;
+	std::unordered_set<const void*> reported_callsites;
+
+	if (bench_settings.assert_no_allocations)
+	{
+		frame_arena::set_is_poisoning(true);
+		if (!memory_tracker::is_hooked())
+			std::cout << "--assert-no-alloc without MEMORY_TRACKING only sees imgui and image decoding" << std::endl;
+	}
+
+	while(!glfwWindowShouldClose(window) && !(bench_settings.is_enabled && bench.is_done()))
 	{
-		process_input(window);
+		if (screen_width == 0 || screen_height == 0)
+		{
+			//minimized, there is nothing to render into
+			glfwWaitEvents();
+			continue;
+		}
+
+		cpu_profiler::get().begin_frame();
+		render_stats::begin_frame();
+		memory_tag_scope frame_tag(memory_tag::rendering);
+
+		render_backend* const frame_backend = &render_backend::get();
+		if (is_capture_requested)
+		{
+			frame_capture.set_target(*frame_backend);
+			frame_capture.clear_stream();
+			render_backend::set(&frame_capture);
+		}
+		recorder.begin_frame(gpu_profiler::get().get_frame_index());
+		cpu_profile_scope frame_scope("Frame");
+		const unsigned long long frame_start = cpu_profiler::now_ns();
+
+		if (bench_settings.is_enabled)
+		{
+			//the clock follows the path so time driven shaders match between runs too
+			const float path_time = bench.get_progress() * cam_path.get_duration();
+			glfwSetTime(path_time);
+
+			if (!cam_path.is_empty())
+			{
+				const camera_path::keyframe k = cam_path.sample(path_time);
+				cam.get_transform()->set_position(k.position);
+				cam.get_transform()->set_rotation(k.rotation);
+			}
+		}
+		else
+			process_input(window);
+
+		//every pass after this reads cached world matrices
+		{
+			cpu_profile_scope scope("Update Transforms");
+			transform_system::get().update();
+		}
 
 		set_vp_from_camera();
+		gather_lights();
+		prepare_cluster_lights();
+		cull_scene();
+
+		if (quality.get_tier().shadow_resolution != shadow_resolution)
+			resize_shadow_maps(shadow_depth_tex, point_shadow_depth_tex, quality.get_tier().shadow_resolution);
+
+		#pragma region Frame Graph
+
+		cpu_profiler::get().push("Build Frame Graph");
+		frame.reset();
+
+		render_width = resolution.scale_dimension(screen_width);
+		render_height = resolution.scale_dimension(screen_height);
+
+		const frame_graph_resource backbuffer = frame.import_backbuffer("Backbuffer", screen_width, screen_height);
+		const frame_graph_resource shadow_map = frame.import_texture("Shadow Map", shadow_depth_tex);
+		const frame_graph_resource point_shadow_map = frame.import_texture("Point Shadow Map", point_shadow_depth_tex);
+
+		const render_target_desc hdr_desc{ render_width, render_height, GL_RGBA, GL_RGBA16F, GL_FLOAT, 0 };
+
+		//filled in by the setup callbacks, read back by the execute callbacks later this frame
+		frame_graph_resource g_buffer[3] = { INVALID_RESOURCE, INVALID_RESOURCE, INVALID_RESOURCE };
+		frame_graph_resource g_depth = INVALID_RESOURCE;
+		frame_graph_resource scene_color = INVALID_RESOURCE;
+		frame_graph_resource bloom_ping_pong[2] = { INVALID_RESOURCE, INVALID_RESOURCE };
 
-		render_shadow_maps(game_models, shadow_shader_program, point_shadow_shader_program);
+		//nothing reads the shadow maps while shadows are off, so both passes get culled
+		const auto read_shadow_maps = [&](frame_graph_builder& builder)
+		{
+			if (!use_shadow)
+				return;
+
+			builder.read(shadow_map);
+			builder.read(point_shadow_map);
+		};
+
+		frame.add_pass("Directional Shadow", [&](frame_graph_builder& builder)
+		{
+			builder.write(shadow_map);
+		}, [&](frame_graph&)
+		{
+			//both shadow passes live and die together, one timer spans them
+			quality.begin(quality_feature::shadows);
+			render_directional_shadow_map(shadow_shader_program);
+		});
+
+		frame.add_pass("Point Shadow", [&](frame_graph_builder& builder)
+		{
+			builder.write(point_shadow_map);
+		}, [&](frame_graph&)
+		{
+			render_omnidirectional_shadow_map(point_shadow_shader_program);
+			quality.end(quality_feature::shadows);
+		});
 		
 		if(use_deferred)
 		{
-			render_ds_geometry(ds_geometry_shader_program);
-			
-			ds_light_fb.bind();
-			glBlendFunc(GL_ONE, GL_ONE);
-			FB::clear_color_buffer();
+			frame.add_pass("G-Buffer", [&](frame_graph_builder& builder)
+			{
+				g_buffer[0] = builder.write(builder.create("G Position", render_target_desc{ render_width, render_height, GL_RGB, GL_RGB16F, GL_FLOAT, 0 }), GL_COLOR_ATTACHMENT0);
+				g_buffer[1] = builder.write(builder.create("G Normal", render_target_desc{ render_width, render_height, GL_RGB, GL_RGB16F, GL_FLOAT, 0 }), GL_COLOR_ATTACHMENT1);
+				g_buffer[2] = builder.write(builder.create("G DiffSpec", render_target_desc{ render_width, render_height, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, 0 }), GL_COLOR_ATTACHMENT2);
+				g_depth = builder.write(builder.create("G Depth", render_target_desc{ render_width, render_height, GL_DEPTH_STENCIL, GL_DEPTH32F_STENCIL8, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, 0 }), GL_DEPTH_STENCIL_ATTACHMENT);
+			}, [&](frame_graph&)
+			{
+				quality.begin(quality_feature::shading);
+				render_ds_geometry(ds_geometry_shader_program);
+			});
 
-			render_ds_dir_light_pass(ds_dir_light_shader_program, ds_dir_light_quad_model);
-			render_ds_point_light_pass(ds_point_light_stcl_shader_program, ds_point_light_shader_program, ds_point_light_sphere_model);
-			render_skybox(skybox_renderer, skybox_shader_program);
-			
-			render_debug_point_lights(ds_point_light_sphere_model, debug_light_shader_program);
-			FB::set_depth_testing(true);
-			FB::set_depth_writing(true);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			frame.add_pass("Deferred Lighting", [&](frame_graph_builder& builder)
+			{
+				for (const frame_graph_resource g : g_buffer)
+					builder.read(g);
+				read_shadow_maps(builder);
+
+				scene_color = builder.write(builder.create("Lit Color", hdr_desc), GL_COLOR_ATTACHMENT0);
+				//light volumes stencil against the geometry depth in place instead of a copy of it, the tiled pass reads it for its depth ranges
+				builder.write(g_depth, GL_DEPTH_STENCIL_ATTACHMENT);
+			}, [&](frame_graph& graph)
+			{
+				const g_buffer_textures textures{ graph.get_texture(g_buffer[0]), graph.get_texture(g_buffer[1]), graph.get_texture(g_buffer[2]), graph.get_texture(g_depth) };
+
+				render_backend::get().blend_func(GL_ONE, GL_ONE);
+				FB::clear_color_buffer();
+
+				render_ds_dir_light_pass(ds_dir_light_shader_program, ds_dir_light_quad_model, textures);
+				if (use_tiled_lighting)
+					render_ds_tiled_light_pass(tiled_deferred_shader_program, textures, *graph.get_texture(scene_color));
+				else
+					render_ds_point_light_pass(ds_point_light_stcl_shader_program, ds_point_light_shader_program, ds_point_light_sphere_model, textures);
+				render_skybox(skybox_renderer, skybox_shader_program);
+				
+				render_debug_point_lights(ds_point_light_sphere_model, debug_light_shader_program);
+				FB::set_depth_testing(true);
+				FB::set_depth_writing(true);
+				render_backend::get().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				quality.end(quality_feature::shading);
+			});
 		}
 		else
 		{
-			//ibl
-			pbr_forward_shader_program.use();
-			pbr_forward_shader_program.set_int("prefilter", 10);
-			texture::activate(GL_TEXTURE10);
-			prefilter_map.bind();
-
-			pbr_forward_shader_program.set_int("brdfLut", 11);
-			texture::activate(GL_TEXTURE11);
-			brdf_lut_map.bind();
-			render_forward(use_pbr ? pbr_forward_shader_program : basic_shader_program);
-			render_skybox(skybox_renderer, skybox_shader_program);
-			render_debug_point_lights(ds_point_light_sphere_model, debug_light_shader_program);
+			frame.add_pass("Forward", [&](frame_graph_builder& builder)
+			{
+				read_shadow_maps(builder);
+
+				if (use_hdr)
+				{
+					scene_color = builder.write(builder.create("Scene Color", hdr_desc), GL_COLOR_ATTACHMENT0);
+					builder.write(builder.create("Scene Depth", render_target_desc{ render_width, render_height, GL_DEPTH_STENCIL, GL_DEPTH24_STENCIL8, GL_UNSIGNED_INT_24_8, 0 }), GL_DEPTH_STENCIL_ATTACHMENT);
+				}
+				else
+				{
+					//multisampled, the graph resolves it for whoever samples it
+					scene_color = builder.write(builder.create("Scene Color", render_target_desc{ render_width, render_height, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, SAMPLES }), GL_COLOR_ATTACHMENT0);
+					builder.write(builder.create("Scene Depth", render_target_desc{ render_width, render_height, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, SAMPLES }), GL_DEPTH_ATTACHMENT);
+				}
+			}, [&](frame_graph&)
+			{
+				quality.begin(quality_feature::shading);
+
+				//ibl
+				pbr_forward_shader_program.use();
+				pbr_forward_shader_program.set_int("prefilter", 10);
+				texture::activate(GL_TEXTURE10);
+				prefilter_map.bind();
+
+				pbr_forward_shader_program.set_int("brdfLut", 11);
+				texture::activate(GL_TEXTURE11);
+				brdf_lut_map.bind();
+				render_forward(use_pbr ? pbr_forward_shader_program : basic_shader_program);
+				render_skybox(skybox_renderer, skybox_shader_program);
+				render_debug_point_lights(ds_point_light_sphere_model, debug_light_shader_program);
+				quality.end(quality_feature::shading);
+			});
 		}
 
-		//blit to bloom buffer
-		bloom_fb.bind_draw();
-		glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		frame.add_pass("Bloom", [&](frame_graph_builder& builder)
+		{
+			builder.read(scene_color);
+			bloom_ping_pong[0] = builder.write(builder.create("Bloom Ping", hdr_desc));
+			bloom_ping_pong[1] = builder.write(builder.create("Bloom Pong", hdr_desc));
+		}, [&](frame_graph& graph)
+		{
+			quality.begin(quality_feature::bloom);
+			bloom_postprocess(graph, scene_color, bloom_ping_pong, screen_space_raw_quad_renderer, bloom_brightness_shader_program, blur_shader_program);
+			quality.end(quality_feature::bloom);
+		});
 
-		
-		destination_fb.bind_draw();
-		glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-		glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-		glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+		frame.add_pass("Composite", [&](frame_graph_builder& builder)
+		{
+			builder.read(scene_color);
+			if (use_bloom)
+				builder.read(bloom_ping_pong[0]);
+			builder.write(backbuffer, GL_COLOR_ATTACHMENT0);
+		}, [&](frame_graph& graph)
+		{
+			FB::clear_frame();
+			render_pp_quad(screen_space_quad_renderer, screen_space_shader_program, graph.get_texture(scene_color),
+				use_bloom ? graph.get_texture(bloom_ping_pong[0]) : nullptr);
+		});
 
-		debug_fb.bind_draw();
-		glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-		
-		FB::unbind(); // blit
+		//headless has nothing to show the ui on
+		if (!bench_settings.is_headless)
+		{
+			frame.add_pass("ImGui", [&](frame_graph_builder& builder)
+			{
+				//reading the debug views stretches their lifetime to the end of the frame so nothing aliases them
+				if (keep_debug_targets)
+				{
+					for (const char* name : { "G Position", "G Normal", "G DiffSpec", "G Depth", "Lit Color", "Bloom Ping" })
+						builder.read(frame.find(string_id(name)));
+				}
+				builder.write(backbuffer, GL_COLOR_ATTACHMENT0);
+			}, [&](frame_graph&)
+			{
+				render_debug_windows();
+			});
+		}
+
+		frame.compile();
+		cpu_profiler::get().pop();
+
+		gpu_profiler::get().begin_frame();
+		frame_gpu_timer.begin();
+		frame.execute();
+		frame_gpu_timer.end();
+		gpu_profiler::get().end_frame();
+		render_stats::end_frame();
 
-		if (use_bloom)
+		if (is_capture_requested)
 		{
-			if(use_deferred)
-				bloom_postprocess(ds_light_fb, screen_space_raw_quad_renderer, bloom_brightness_shader_program, blur_shader_program);
-			else
-				bloom_postprocess(use_hdr ? hdr_fb : ms_fb, screen_space_raw_quad_renderer, bloom_brightness_shader_program, blur_shader_program);
+			render_backend::set(frame_backend);
+			is_capture_requested = false;
 		}
+
+		//the first frame still allocates the frame graph targets, so its mark ends the setup rather than a replayed frame
+		if (is_capturing_stream)
+		{
+			stream_capture.mark_frame();
+
+			if (stream_capture.get_mark_count() > bench_settings.capture_frames)
+			{
+				if (stream_capture.write(bench_settings.capture_path))
+					std::cout << "Captured " << bench_settings.capture_frames << " frames, " << stream_capture.get_command_count() << " calls and "
+						<< stream_capture.get_payloads().size() / (1024 * 1024) << " MB of data to " << bench_settings.capture_path << std::endl;
+
+				render_backend::set(nullptr);
+				stream_capture.clear_stream();
+				is_capturing_stream = false;
+			}
+		}
+
+		float gpu_ms;
+		if (frame_gpu_timer.take_result(gpu_ms))
+		{
+			resolution.add_sample(gpu_ms);
+
+			quality.budget_ms = resolution.budget_ms;
+			quality.add_sample(gpu_ms, !resolution.is_enabled || resolution.get_scale() <= resolution.min_scale);
+
+			if (bench_settings.is_enabled)
+				bench.add_gpu_sample(gpu_ms);
+		}
+
+		recorder.set_counter("GPU ms", frame_gpu_timer.get_last_ms());
+		recorder.set_counter("Visible Objects", static_cast<float>(visible_count));
+		recorder.set_counter("Render Scale", resolution.get_scale());
+		recorder.set_counter("Quality Tier", static_cast<float>(quality.get_tier_index()));
+		recorder.set_counter("Transient MB", frame.get_stats().transient_bytes / (1024.0f * 1024.0f));
+		recorder.set_counter("Draw Calls", static_cast<float>(render_stats::counters.draw_calls));
+		recorder.set_counter("Triangles", static_cast<float>(render_stats::counters.triangles));
+
+		#pragma endregion
 		
-		FB::clear_frame();
-		render_pp_quad(screen_space_quad_renderer, screen_space_shader_program);
-		render_debug_windows();
-		
-		glfwSwapBuffers(window);
+		{
+			cpu_profile_scope scope("Swap Buffers");
+			glfwSwapBuffers(window);
+		}
 		glfwPollEvents();
+
+		recorder.end_frame();
+		memory_tracker::end_frame();
+		frame_arena::end_frame();
+		if (bench_settings.assert_no_allocations && ++loop_frames > bench_settings.warmup_frames && report_frame_allocations(reported_callsites))
+			allocating_frames++;
+		gpu_resources::get().end_frame();
+		gpu_memory::check_budget();
+
+		if (bench_settings.is_enabled)
+			bench.end_frame((cpu_profiler::now_ns() - frame_start) / 1000000.0f, render_stats::get_frame(), render_stats::get_passes());
+	}
+
+	#pragma endregion
+
+	#pragma region Benchmark Report
+
+	const std::string backend_name = render_backend::get().get_name();
+	render_backend::set(nullptr);
+
+	int exit_code = 0;
+
+	if (bench_settings.is_enabled && bench.is_done())
+	{
+		if (!bench.write_report(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), backend_name))
+			exit_code = 1;
+		else if (!bench_settings.baseline.empty() && !bench.compare_baseline())
+			exit_code = 2;
+	}
+
+	if (allocating_frames > 0)
+	{
+		std::cout << allocating_frames << " frames after the warmup allocated while rendering" << std::endl;
+		if (exit_code == 0)
+			exit_code = 3;
 	}
 
 	#pragma endregion
@@ -946,9 +1385,18 @@ int main()  // NOLINT(bugprone-exception-escape)
 
 	deallocate();
 	destroy_imgui();
+	//the scene's textures and meshes are locals of main and globals, they outlive the context and are freed with it
+	gpu_resources::get().shutdown();
+	job_system::get().shutdown();
 	glfwTerminate();
+
+	//what is left is held by globals and statics, anything that grows between runs is a leak
+	if (memory_tracker::is_hooked())
+		memory_tracker::write_leak_report(std::cout);
 	
 	#pragma endregion
+
+	return exit_code;
 }
 
 #pragma region Render Functions
@@ -957,43 +1405,65 @@ void render_light_sources(model& m, const shader_program& light_shader_program)
 {
 	light_shader_program.use();
 
- 	for (auto& i : lights)
-    {
-		light& l = (*i);
- 		
-		if (l.get_name() == "spot_light" || !l.is_active)
-			continue;
-
-		light_shader_program.set_vec3("color", l.diffuse.to_vec3() * l.diff_intensity);
-		m.get_transform()->set_position(l.get_transform()->position());
+	const auto render_light_source = [&m, &light_shader_program](const gathered_light& l)
+	{
+		light_shader_program.set_vec3("color", l.data->diffuse.to_vec3() * l.data->diff_intensity);
+		m.get_transform()->set_position(l.position);
 
 		render_model(m, light_shader_program);
-	}
+	};
+
+	if (frame_lights.directional.data)
+		render_light_source(frame_lights.directional);
+
+	for (const gathered_light& point_light : frame_lights.points)
+		render_light_source(point_light);
 }
 
 void render_model(model &m, const shader_program &program)
 {
+	cpu_profile_scope scope("render_model");
+
 	FB::set_depth_writing(true);
 	FB::set_depth_testing(true);
 	FB::set_stencil_writing(false);
 	FB::set_stencil_testing(false);
+
+	send_model_pass_uniforms(program);
+	program.set_model(m.get_transform()->get_model_matrix());
+
+	/*FB::set_stencil_writing(true);
+	FB::set_stencil_op(GL_KEEP, GL_KEEP, GL_REPLACE);
+	FB::set_stencil_func(GL_ALWAYS, 1, 0xFF);*/
 	
+	m.draw(program);
+
+	/*FB::set_stencil_writing(false);
+	FB::set_stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
+	FB::set_stencil_func(GL_ALWAYS, 1, 0xFF);*/
+}
+
+//everything render_model sends that does not change between models
+void send_model_pass_uniforms(const shader_program& program)
+{
+	cpu_profile_scope scope("send_model_pass_uniforms");
+
 	program.use();
 	program.set_float("useShadow", use_shadow ? 1 : 0);
+	program.set_int("pcfHalfKernel", quality.get_tier().pcf_half_kernel);
 	program.set_float("useNormalMaps", use_normal_maps ? 1 : 0);
-	program.set_float("useParallax", use_parallax ? 1 : 0);
-	program.set_float("useIBL", use_ibl ? 1 : 0);
+	program.set_float("useParallax", use_parallax && quality.get_tier().allow_parallax ? 1 : 0);
+	program.set_float("useIBL", use_ibl && quality.get_tier().allow_ibl ? 1 : 0);
 	program.set_vec3("viewPos", cam.get_transform()->position());
 
 	
 	
-	send_point_lights_to_shader(program);
+	static const string_id point_shadow_light_name("pointShadowLight");
+
+	clusters.bind(program, render_width, render_height);
+	program.set_int(point_shadow_light_name, frame_lights.has_point_shadow ? 0 : -1);
 	send_dir_light_to_shader(program);
-	send_spot_light_to_shader(program);
 	send_material_data_to_shader(program);
-	
-
-	program.set_model(m.get_transform()->get_model_matrix());
 
 	program.set_matrix("lightView", dir_shadow_map_mvp_matrix.view);
 	program.set_matrix("lightProjection", dir_shadow_map_mvp_matrix.projection);
@@ -1015,16 +1485,6 @@ void render_model(model &m, const shader_program &program)
 		//program.set_vec3("pointLights[0].lightPos", point_lights[0].get_transform()->position());
 	}
 	program.set_float("farPlane", RADIUS);
-
-	/*FB::set_stencil_writing(true);
-	FB::set_stencil_op(GL_KEEP, GL_KEEP, GL_REPLACE);
-	FB::set_stencil_func(GL_ALWAYS, 1, 0xFF);*/
-	
-	m.draw(program);
-
-	/*FB::set_stencil_writing(false);
-	FB::set_stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
-	FB::set_stencil_func(GL_ALWAYS, 1, 0xFF);*/
 }
 
 void render_model(model& m, const tiling_and_offset& tiling_and_offset, const shader_program& program)
@@ -1062,9 +1522,9 @@ void render_asteroids(model& m, const shader_program& program)
 
 void render_model_outline(model &m, const shader_program &program)
 {
-	glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-	glStencilMask(0x00);
-	glDisable(GL_DEPTH_TEST);
+	render_backend::get().stencil_func(GL_FRONT_AND_BACK, GL_NOTEQUAL, 1, 0xFF);
+	render_backend::get().stencil_mask(0x00);
+	render_backend::get().set_capability(GL_DEPTH_TEST, false);
 
 	program.use();
 
@@ -1076,29 +1536,29 @@ void render_model_outline(model &m, const shader_program &program)
 	program.set_vec3("outlineColor", glm::vec3(0, 0, 1));
 	m.draw(program);
 
-	glStencilMask(0xFF);
-	glStencilFunc(GL_ALWAYS, 1, 0xFF);
-	glEnable(GL_DEPTH_TEST);
+	render_backend::get().stencil_mask(0xFF);
+	render_backend::get().stencil_func(GL_FRONT_AND_BACK, GL_ALWAYS, 1, 0xFF);
+	render_backend::get().set_capability(GL_DEPTH_TEST, true);
 }
 
 void render_transparent_quads(const std::vector<game_object> &quads, const renderer& rend, const shader_program& program)
 {
 	FB::set_stencil_testing(false);
 	FB::set_stencil_writing(false);
-	sorted.clear();
+	frame_map<float, const transform*> sorted;
 	for (const auto& quad : quads)
 	{
 		float distance = length(cam.get_transform()->position() - quad.get_transform()->position());
-		sorted[distance] = *(quad.get_transform());
+		sorted[distance] = quad.get_transform();
 	}
 
 	program.use();
 
-	for (std::map<float, transform>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it)
+	for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
 	{
 		program.use();
-		it->second.set_scale(glm::vec3(0.25f));
-		mvp_matrix.model_matrix = it->second.get_model_matrix();
+		//quads are drawn at a fixed scale without touching the shared transform
+		mvp_matrix.model_matrix = glm::scale(glm::translate(glm::mat4(1.0f), it->second->position()) * it->second->rotation_mat(), glm::vec3(0.25f));
 		program.set_mvp(mvp_matrix);
 		program.set_vec3("tiling", glm::vec3(1));
 		rend.draw(program);
@@ -1110,10 +1570,13 @@ void render_transparent_quads(const std::vector<game_object> &quads, const rende
 
 void render_skybox(const renderer& rend, const shader_program& program)
 {
+	cpu_profile_scope cpu_scope("render_skybox");
+	gpu_profile_scope gpu_scope("Skybox");
+
 	FB::set_depth_testing(true);
 	FB::set_depth_writing(false);
 	
-	glDepthFunc(GL_LEQUAL);
+	render_backend::get().depth_func(GL_LEQUAL);
 	mvp_matrix.view = glm::mat4(glm::mat3(cam.get_view_matrix()));
 	program.use();
 	program.set_mvp(mvp_matrix);
@@ -1121,121 +1584,146 @@ void render_skybox(const renderer& rend, const shader_program& program)
 	rend.draw_cube_map(program);
 	
 	FB::set_depth_writing(true);
-	glDepthFunc(GL_LESS);
+	render_backend::get().depth_func(GL_LESS);
 
 	mvp_matrix.view = cam.get_view_matrix();
 }
 
-void render_pp_quad(const renderer& rend, const shader_program& program)
+void render_pp_quad(const renderer& rend, const shader_program& program, const texture* scene_color, const texture* bloom)
 {
+	cpu_profile_scope scope("render_pp_quad");
+
 	program.use();
+	program.set_int("screenColor", 0);
+	texture::activate(GL_TEXTURE0);
+	if (scene_color)
+		scene_color->bind();
+
 	program.set_float_array("kernel", 9, kernel.kernel);
 	program.set_vec2_array("offsets", 9, &kernel.offset[0].x);
 	program.set_float("exposure", hdr_exposure);
-	program.set_float("useGammaCorrection", use_gamma_correction ? 1 : 0);
+	static const string_id gamma_correction_name("useGammaCorrection");
+	program.set_float(gamma_correction_name, use_gamma_correction ? 1 : 0);
 	program.set_float("useHDR", use_gamma_correction ? 1 : 0);
 	program.set_float("useBloom", use_bloom);
 
-	if(use_bloom)
+	if(bloom)
 	{
 		texture::activate(GL_TEXTURE1);
-		pingpong_fb[1].get_color_attachment_tex(GL_COLOR_ATTACHMENT0)->bind();
-		//glActiveTexture(GL_TEXTURE1);
-		//pingpong_color_tex[1].bind();
+		bloom->bind();
 		program.set_int("bloomBlur", 1);
 	}
 	else
 	{
 		texture::activate(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		render_backend::get().bind_texture(GL_TEXTURE_2D, 0);
 	}
 	rend.draw(program);
 }
 
 void render_forward(const shader_program& program)
 {
-	if (use_hdr)
-		hdr_fb.bind();
-	else
-		ms_fb.bind();
+	cpu_profile_scope scope("render_forward");
 
 	FB::clear_frame();
-	
-	for (auto && game_model : game_models)
-	{
-		if (!game_model.is_active)
-			continue;
-		
-		auto model_name = game_model.get_name();
 
+	FB::set_depth_writing(true);
+	FB::set_depth_testing(true);
+	FB::set_stencil_writing(false);
+	FB::set_stencil_testing(false);
+	send_model_pass_uniforms(program);
+
+	const glm::vec3 view_pos = cam.get_transform()->position();
+
+	record_scene([&program, &view_pos](command_list& list, const mesh_renderer_component& r, const transform& transform)
+	{
 		tiling_and_offset t;
 
-		if (model_name == "Floor")
+		if (r.use_scale_tiling)
 		{
-			t.tiling = glm::vec2(game_model.get_transform()->scale());
+			t.tiling = glm::vec2(transform.scale());
 			t.offset = glm::vec2(0);
 		}
-		else
-			t = tiling_and_offset();
 
 		if (glm::abs(t.tiling.x) < 1)
 			t.tiling.x = 1;
 
 		if (glm::abs(t.tiling.y) < 1)
 			t.tiling.y = 1;
-		
-		render_model(game_model, t, program);
-	}
-}
 
-void render_shadow_maps(std::vector<model>& models, const shader_program& dir_program, const shader_program& point_program)
-{
-	if(use_shadow)
-	{
-		render_directional_shadow_map(models, dir_program);
-		render_omnidirectional_shadow_map(models, point_program);
-	}
+		const glm::mat4& model_matrix = transform.get_cached_model_matrix();
+		r.source.record(list, program, model_matrix, &t, glm::length(glm::vec3(model_matrix[3]) - view_pos));
+	}, true);
+
+	command_list::submit(pass_lists);
 }
 
-void render_directional_shadow_map(std::vector<model>& models, const shader_program& program)
+void render_directional_shadow_map(const shader_program& program)
 {
-	glViewport(0, 0, SHADOW_RESOLUTION, SHADOW_RESOLUTION);
+	cpu_profile_scope scope("render_directional_shadow_map");
+
+	render_backend::get().viewport(0, 0, shadow_resolution, shadow_resolution);
 	shadow_fb.bind();
 
 	FB::clear_depth_buffer();
 
-	dir_shadow_map_mvp_matrix.view = glm::lookAt(dir_light.get_transform()->position(), glm::vec3(0), glm::vec3(0, 1, 0));
+	if (!frame_lights.directional.data || !frame_lights.directional.data->casts_shadow)
+	{
+		FB::unbind();
+		render_backend::get().viewport(0, 0, screen_width, screen_height);
+		return;
+	}
+
+	dir_shadow_map_mvp_matrix.view = glm::lookAt(frame_lights.directional.position, glm::vec3(0), glm::vec3(0, 1, 0));
 
 	program.use();
 	program.set_view(dir_shadow_map_mvp_matrix.view);
 	program.set_proj(dir_shadow_map_mvp_matrix.projection);
 
-	glCullFace(GL_FRONT);
+	render_backend::get().cull_face(GL_FRONT);
 
-	for (auto &value : models)
+	record_scene([&program](command_list& list, const mesh_renderer_component& r, const transform& t)
 	{
-		if (!value.is_active)
-			continue;
-		program.set_model(value.get_transform()->get_model_matrix());
-		value.draw_shadow(program);
-	}
+		if (r.casts_shadow)
+			r.source.record_shadow(list, program, t.get_cached_model_matrix());
+	}, false);
+	command_list::submit(pass_lists);
 
-	glCullFace(GL_BACK);
+	render_backend::get().cull_face(GL_BACK);
 
 	FB::unbind();
 
-	glViewport(0, 0, WIDTH, HEIGHT);
+	render_backend::get().viewport(0, 0, screen_width, screen_height);
 
 }
 
 
-static std::vector<glm::mat4> shadow_view_matrices;
-void render_omnidirectional_shadow_map(std::vector<model>& models, const shader_program &program)
+//recreates both shadow maps at a new size, the framebuffers keep their own copies of the attachments
+void resize_shadow_maps(texture& directional, texture& point, const unsigned int resolution)
 {
-	if (!point_lights[0].is_active)
+	directional.delete_texture();
+	point.delete_texture();
+
+	directional = texture(TEX_T::depth, resolution, resolution, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, false);
+	point = texture(TEX_T::cube, resolution, resolution, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, false);
+
+	shadow_fb.bind();
+	shadow_fb.attach_texture_2d_depth(directional, GL_DEPTH_ATTACHMENT);
+	point_shadow_fb.bind();
+	point_shadow_fb.attach_texture(point, GL_DEPTH_ATTACHMENT);
+	FB::unbind();
+
+	shadow_resolution = resolution;
+}
+
+void render_omnidirectional_shadow_map(const shader_program &program)
+{
+	cpu_profile_scope scope("render_omnidirectional_shadow_map");
+
+	if (!frame_lights.has_point_shadow)
 		return;
 	
-	glViewport(0, 0, SHADOW_RESOLUTION, SHADOW_RESOLUTION);
+	render_backend::get().viewport(0, 0, shadow_resolution, shadow_resolution);
 
 	point_shadow_fb.bind();
 	FB::clear_depth_buffer();
@@ -1243,15 +1731,12 @@ void render_omnidirectional_shadow_map(std::vector<model>& models, const shader_
 
 	const glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, RADIUS);
 
-	const glm::vec3 pos = point_lights[0].get_transform()->position();
+	const glm::vec3 pos = frame_lights.points[0].position;
 
-	shadow_view_matrices.clear();
-	shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[0], capture_up_directions[0]));
-	shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[1], capture_up_directions[1]));
-	shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[2], capture_up_directions[2]));
-	shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[3], capture_up_directions[3]));
-	shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[4], capture_up_directions[4]));
-	shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[5], capture_up_directions[5]));
+	frame_vector<glm::mat4> shadow_view_matrices;
+	shadow_view_matrices.reserve(6);
+	for (unsigned int i = 0; i < 6; i++)
+		shadow_view_matrices.push_back(glm::lookAt(pos, pos + capture_forward_directions[i], capture_up_directions[i]));
 
 	program.use();
 	program.set_float("farPlane",RADIUS);
@@ -1263,60 +1748,52 @@ void render_omnidirectional_shadow_map(std::vector<model>& models, const shader_
 		program.set_matrix(std::string("lightView[").append(std::to_string(i).append("]")), shadow_view_matrices[i]);
 	}
 
-	glCullFace(GL_FRONT);
-	for (std::vector<model>::value_type& value : models)
+	render_backend::get().cull_face(GL_FRONT);
+	record_scene([&program](command_list& list, const mesh_renderer_component& r, const transform& t)
 	{
-		if (!value.is_active)
-			continue;
-		program.set_model(value.get_transform()->get_model_matrix());
-		value.draw_shadow(program);
-		
-	}
-	glCullFace(GL_BACK);
+		if (r.casts_shadow)
+			r.source.record_shadow(list, program, t.get_cached_model_matrix());
+	}, false);
+	command_list::submit(pass_lists);
+	render_backend::get().cull_face(GL_BACK);
 	
 	FB::unbind();
 
-	glViewport(0, 0, WIDTH, HEIGHT);
+	render_backend::get().viewport(0, 0, screen_width, screen_height);
 }
 
-void bloom_postprocess(const frame_buffer& fb, const renderer& rend, const shader_program &bloom_brightness, const shader_program &blur)
+void bloom_postprocess(frame_graph& graph, const frame_graph_resource source, const frame_graph_resource ping_pong[2], const renderer& rend, const shader_program &bloom_brightness, const shader_program &blur)
 {
-	bloom_fb.bind();
+	cpu_profile_scope scope("bloom_postprocess");
+
+	//bright pixels go straight into the first ping pong target, no copy needed
+	graph.bind_target({ ping_pong[0] });
 	bloom_brightness.use();
 
-	texture* pre_bloom_color_tex = fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT0);
+	const texture* pre_bloom_color_tex = graph.get_texture(source);
 
 	texture::activate(GL_TEXTURE0);
 	if (pre_bloom_color_tex)
 		pre_bloom_color_tex->bind();
 	
 	bloom_brightness.set_float("useBloom", use_bloom);
-	bloom_brightness.set_float("brightnessThreshold", brightness_threshold);
+	static const string_id threshold_name("brightnessThreshold");
+	bloom_brightness.set_float(threshold_name, brightness_threshold);
 	rend.draw(bloom_brightness); // render quad to extract bright pixels
 
-	//copy extracted bright pixels to first pingpong fbo
-	bloom_fb.bind_read();
-	pingpong_fb[0].bind_draw();
-	glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-
-	FB::unbind();
-
-	bool horizontal = true, first_iteration = true;
-	const int amount = 10;
+	bool horizontal = true;
+	const int amount = static_cast<int>(quality.get_tier().bloom_blur_passes);
 
 	blur.use();
 
+	//an even amount leaves the result in ping_pong[0]
 	for(int i = 0; i < amount; i++)
 	{
-		pingpong_fb[horizontal].bind();
+		graph.bind_target({ ping_pong[horizontal] });
 
 		//redundant but here to be more explicit
 		texture::activate(GL_TEXTURE0);
-
-		if (first_iteration)
-			pingpong_fb[0].get_color_attachment_tex(GL_COLOR_ATTACHMENT0)->bind();
-		else
-			pingpong_fb[!horizontal].get_color_attachment_tex(GL_COLOR_ATTACHMENT0)->bind();
+		graph.get_texture(ping_pong[!horizontal])->bind();
 
 		blur.set_float("isHorizontal", horizontal);
 		blur.set_int("image", 0);
@@ -1324,15 +1801,13 @@ void bloom_postprocess(const frame_buffer& fb, const renderer& rend, const shade
 		rend.draw(blur);
 		
 		horizontal = !horizontal;
-		if (first_iteration)
-			first_iteration = false;
 	}
-
-	FB::unbind();
 }
 
 void render_debug_point_lights(model& m, shader_program& program)
 {
+	cpu_profile_scope scope("render_debug_point_lights");
+
 	if (!use_light_debug)
 		return;
 	
@@ -1342,25 +1817,26 @@ void render_debug_point_lights(model& m, shader_program& program)
 	program.use();
 	
 	m.get_mesh_ptr(0)->should_cull_face = false;
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	render_backend::get().polygon_mode(GL_LINE);
 
-	for (auto& point_light : point_lights)
+	for (unsigned int i = 0; i < frame_lights.points.size(); i++)
 	{
-		if(point_light.is_active)
-		{
-			m.get_transform()->set_position(point_light.get_transform()->position());
-			m.get_transform()->set_scale(glm::vec3(point_light.radius));
-			program.set_model(m.get_transform()->get_model_matrix());
-			program.set_vec3("color", point_light.diffuse.to_vec3());
-			m.draw(program);
-		}
+		const gathered_light& point_light = frame_lights.points[i];
+		m.get_transform()->set_position(point_light.position);
+		m.get_transform()->set_scale(glm::vec3(point_light.data->radius));
+		program.set_model(m.get_transform()->get_model_matrix());
+		program.set_vec3("color", point_light.data->diffuse.to_vec3());
+		m.draw(program);
 	}
 
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	render_backend::get().polygon_mode(GL_FILL);
 }
 
 void render_debug_windows()
 {
+	cpu_profile_scope scope("render_debug_windows");
+	memory_tag_scope tag(memory_tag::imgui);
+
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -1369,15 +1845,18 @@ void render_debug_windows()
 
 	ImGui::Begin("Debug Textures");
 
-	const ImTextureID bloom_color_tex_id = reinterpret_cast<void*>(bloom_fb.get_color_attachment(GL_COLOR_ATTACHMENT0)); // NOLINT(misc-misplaced-const)
+	//transient targets may share memory with later passes unless they are kept alive
+	ImGui::Checkbox("Keep Targets Alive", &keep_debug_targets);
 
-	const ImTextureID g_pos = reinterpret_cast<void*>(geometry_fb.get_color_attachment(GL_COLOR_ATTACHMENT0));// NOLINT(misc-misplaced-const)
-	const ImTextureID g_normal = reinterpret_cast<void*>(geometry_fb.get_color_attachment(GL_COLOR_ATTACHMENT1));// NOLINT(misc-misplaced-const)
-	const ImTextureID g_diff_spec = reinterpret_cast<void*>(geometry_fb.get_color_attachment(GL_COLOR_ATTACHMENT2));// NOLINT(misc-misplaced-const)
+	const ImTextureID bloom_color_tex_id = get_frame_texture_id("Bloom Ping"); // NOLINT(misc-misplaced-const)
 
-	const ImTextureID g_depth = reinterpret_cast<void*>(geometry_fb.get_depth_attachment());// NOLINT(misc-misplaced-const)
+	const ImTextureID g_pos = get_frame_texture_id("G Position");// NOLINT(misc-misplaced-const)
+	const ImTextureID g_normal = get_frame_texture_id("G Normal");// NOLINT(misc-misplaced-const)
+	const ImTextureID g_diff_spec = get_frame_texture_id("G DiffSpec");// NOLINT(misc-misplaced-const)
 
-	const ImTextureID ds_dir_light = reinterpret_cast<void*>(ds_light_fb.get_color_attachment(GL_COLOR_ATTACHMENT0));// NOLINT(misc-misplaced-const)
+	const ImTextureID g_depth = get_frame_texture_id("G Depth");// NOLINT(misc-misplaced-const)
+
+	const ImTextureID ds_dir_light = get_frame_texture_id("Lit Color");// NOLINT(misc-misplaced-const)
 
 	const ImTextureID brdf_lut_id = reinterpret_cast<void*>(precompute_fb.get_color_attachment(GL_COLOR_ATTACHMENT0));// NOLINT(misc-misplaced-const)
 
@@ -1388,7 +1867,7 @@ void render_debug_windows()
 	const float width = 400;
 	const float height = 225;
 
-	if(ImGui::TreeNode("Bloom FB Color"))
+	if(ImGui::TreeNode("Bloom Blur"))
 	{
 		ImGui::Image(bloom_color_tex_id, ImVec2(width, height), ImVec2(0, 1), ImVec2(1, 0), ImVec4(1.0f, 1.0f, 1.0f, 1.0f), ImVec4(1.0f, 1.0f, 1.0f, 0.5f));
 		ImGui::TreePop();
@@ -1461,9 +1940,21 @@ void render_debug_windows()
 	ImGui::Checkbox("Use Gamma Correction", &use_gamma_correction);
 	ImGui::Checkbox("Use Bloom", &use_bloom);
 	ImGui::Checkbox("Use Deferred", &use_deferred);
+	ImGui::Checkbox("Use Tiled Lighting", &use_tiled_lighting);
 	ImGui::Checkbox("Use Light Debug", &use_light_debug);
 	ImGui::Checkbox("Use PBR", &use_pbr);
 	ImGui::Checkbox("Use IBL", &use_ibl);
+	ImGui::Checkbox("Use Compute Clustering", &clusters.is_using_compute);
+
+	//the gpu paths leave their lists on the gpu, there is nothing to count here
+	const light_cluster_stats& cluster_stats = clusters.get_stats();
+	if (use_deferred)
+		ImGui::Text("Tiles: %u lights, %u x %u px per tile", cluster_stats.light_count, LIGHT_TILE_SIZE, LIGHT_TILE_SIZE);
+	else if (clusters.is_using_compute)
+		ImGui::Text("Clusters: %u lights, lists built on the gpu", cluster_stats.light_count);
+	else
+		ImGui::Text("Clusters: %u lights, %u refs, max %u, %u empty, %u dropped", cluster_stats.light_count, cluster_stats.index_count,
+			cluster_stats.max_per_cluster, cluster_stats.empty_clusters, cluster_stats.dropped);
 	
 
 	ImGui::Spacing();
@@ -1476,16 +1967,18 @@ void render_debug_windows()
 	
 	if (ImGui::TreeNode("Basic Lights"))
 	{
-		for (size_t i = 0; i < lights.size(); i++)
+		scene.each<light_component, name_component>([](const entity e, light_component& l, const name_component& n)
 		{
-			light& l = *lights[i];
-			
-			if (ImGui::TreeNode(l.get_name().c_str()))
+			if (ImGui::TreeNode(n.name.c_str()))
 			{
+				transform* t = scene.get<transform>(e);
+
 				ImGui::Checkbox("Enabled", &(l.is_active));
-				ImGui::DragFloat3("position", &(l.get_transform()->position_ptr()->x), 0.1f);
-				
-				ImGui::DragFloat3("scale", &(l.get_transform()->scale_ptr()->x), 0.1f);
+				ImGui::DragFloat3("position", &(t->position_ptr()->x), 0.1f);
+
+				//point lights keep a uniform scale that doubles as their radius
+				if (ImGui::DragFloat3("scale", &(t->scale_ptr()->x), 0.1f) && l.type == light_type::point)
+					t->set_scale(glm::vec3(t->scale().x));
 				
 				ImGui::ColorEdit4("diffuse", &(l.diffuse.r));
 				ImGui::ColorEdit4("specular", &(l.specular.r));
@@ -1496,7 +1989,7 @@ void render_debug_windows()
 				ImGui::DragFloat("diffuse intensity", &(l.diff_intensity));
 				ImGui::TreePop();
 			}
-		}
+		});
 
 		if (ImGui::TreeNode("ambient_light"))
 		{
@@ -1506,200 +1999,525 @@ void render_debug_windows()
 		ImGui::TreePop();
 	}
 
-	for (auto& point_light : point_lights)
-	{
-		point_light.set_uniform_scale();
-		point_light.set_radius_from_scale();
-	}
-	
 	ImGui::End();
 
 	ImGui::Begin("Game Objects");
 
-	for (auto &game_model : game_models)
+	scene.each<mesh_renderer_component, name_component>([](const entity, mesh_renderer_component& r, const name_component& n)
 	{
-		if (ImGui::TreeNode(game_model.get_name().c_str()))
+		if (ImGui::TreeNode(n.name.c_str()))
 		{
-			ImGui::Checkbox("Enabled", &(game_model.is_active));
-			ImGui::DragFloat3("position", &(game_model.get_transform()->position_ptr()->x), 0.1f);
-			ImGui::DragFloat3("rotation", &(game_model.get_transform()->rotation_ptr()->x), 0.1f);
-			ImGui::DragFloat3("scale", &(game_model.get_transform()->scale_ptr()->x), 0.1f);
+			ImGui::Checkbox("Enabled", &(r.is_active));
+			ImGui::DragFloat3("position", &(r.source.get_transform()->position_ptr()->x), 0.1f);
+			ImGui::DragFloat3("rotation", &(r.source.get_transform()->rotation_ptr()->x), 0.1f);
+			ImGui::DragFloat3("scale", &(r.source.get_transform()->scale_ptr()->x), 0.1f);
 
 			ImGui::Spacing();
 
 			ImGui::TreePop();
 		}
-	}
+	});
 
 	ImGui::End();
 
 
 
+	render_profiler_window();
+
 	ImGui::Begin("Stats");
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	ImGui::Text("Visible objects %u / %u", visible_count, scene.get_pool<mesh_renderer_component>().size());
+	if (ImGui::TreeNode("Jobs"))
+	{
+		auto& jobs = job_system::get();
+		for (unsigned int i = 0; i < jobs.get_thread_count(); i++)
+			ImGui::Text("%s %u: %u jobs", i == 0 ? "main" : "worker", i, jobs.get_jobs_executed(i));
+		ImGui::TreePop();
+	}
+	job_system::get().reset_stats();
+
+	if (ImGui::TreeNode("Dynamic Resolution"))
+	{
+		ImGui::Checkbox("Enabled", &resolution.is_enabled);
+		ImGui::SliderFloat("Budget (ms)", &resolution.budget_ms, 4.0f, 33.0f);
+		ImGui::SliderFloat("Min Scale", &resolution.min_scale, 0.25f, 1.0f);
+		ImGui::Text("GPU %.2f ms (avg %.2f ms), headroom %.0f%%", frame_gpu_timer.get_last_ms(), resolution.get_average_ms(), resolution.get_headroom() * 100.0f);
+		ImGui::Text("Scale %.2f, %u x %u", resolution.get_scale(), render_width, render_height);
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Quality"))
+	{
+		ImGui::Checkbox("Governor", &quality.is_enabled);
+
+		int tier = static_cast<int>(quality.get_tier_index());
+		if (ImGui::SliderInt("Tier", &tier, 0, static_cast<int>(quality.get_tier_count()) - 1, quality.get_tier().name.c_str()))
+			quality.set_tier(static_cast<unsigned int>(tier));
+
+		ImGui::Text("GPU avg %.2f ms / %.2f ms", quality.get_average_ms(), quality.budget_ms);
+		for (unsigned int i = 0; i < static_cast<unsigned int>(quality_feature::count); i++)
+			ImGui::Text("%s %.2f ms", quality_governor::feature_to_string(static_cast<quality_feature>(i)), quality.get_feature_ms(static_cast<quality_feature>(i)));
+
+		const quality_tier& current = quality.get_tier();
+		ImGui::Text("Blur %u, shadow %u, pcf %dx%d", current.bloom_blur_passes, current.shadow_resolution, current.pcf_half_kernel * 2 + 1, current.pcf_half_kernel * 2 + 1);
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Render Counters"))
+	{
+		const render_counters& total = render_stats::get_frame();
+		ImGui::Text("Draws %u, instances %u, triangles %llu", total.draw_calls, total.instances, total.triangles);
+		ImGui::Text("Binds: program %u, vao %u, texture %u, framebuffer %u", total.program_binds, total.vao_binds, total.texture_binds, total.framebuffer_binds);
+		ImGui::Text("Uniforms %u, lookups %u, blits %u", total.uniform_calls, total.uniform_lookups, total.blits);
+		ImGui::Text("Uploaded %.1f KB", total.buffer_upload_bytes / 1024.0f);
+
+		ImGui::Columns(5, "pass counters");
+		ImGui::Text("Pass"); ImGui::NextColumn();
+		ImGui::Text("Draws"); ImGui::NextColumn();
+		ImGui::Text("Triangles"); ImGui::NextColumn();
+		ImGui::Text("Programs"); ImGui::NextColumn();
+		ImGui::Text("Textures"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (const pass_counters& pass : render_stats::get_passes())
+		{
+			ImGui::Text("%s", pass.name.c_str()); ImGui::NextColumn();
+			ImGui::Text("%u", pass.counters.draw_calls); ImGui::NextColumn();
+			ImGui::Text("%llu", pass.counters.triangles); ImGui::NextColumn();
+			ImGui::Text("%u", pass.counters.program_binds); ImGui::NextColumn();
+			ImGui::Text("%u", pass.counters.texture_binds); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Render Backend"))
+	{
+		ImGui::Text("Submitting to %s", render_backend::get().get_name());
+		if (ImGui::Button("Capture Next Frame"))
+			is_capture_requested = true;
+
+		if (frame_capture.get_command_count() > 0)
+		{
+			ImGui::Text("Captured %u calls, %.1f KB", frame_capture.get_command_count(), frame_capture.get_stream().size() * 4 / 1024.0f);
+			for (unsigned int i = 0; i < static_cast<unsigned int>(backend_command::count); i++)
+			{
+				const backend_command command = static_cast<backend_command>(i);
+				if (frame_capture.get_count(command) > 0)
+					ImGui::Text("%s %u", render_backend::command_to_string(command), frame_capture.get_count(command));
+			}
+		}
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Frame Graph"))
+	{
+		const frame_graph::stats& stats = frame.get_stats();
+		ImGui::Text("Passes %u, culled %u, resolves %u", stats.pass_count, stats.culled_count, stats.resolve_count);
+		ImGui::Text("Output %u x %u, render %u x %u", screen_width, screen_height, render_width, render_height);
+		ImGui::Text("Targets %u, pooled textures %u, %.1f MB", stats.resource_count, stats.physical_count, stats.transient_bytes / (1024.0f * 1024.0f));
+
+		for (unsigned int i = 0; i < frame.get_pass_count(); i++)
+			ImGui::Text("%s%s", frame.get_pass_name(i).c_str(), frame.is_pass_culled(i) ? " (culled)" : "");
+		ImGui::TreePop();
+	}
 	ImGui::End();
 
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
-void send_dir_light_to_shader(const shader_program& program)
+void render_profiler_window()
 {
-	program.use();
-	if (dir_light.is_active)
-	{
-		program.set_vec3("dirLight.lightDir", glm::normalize(-dir_light.get_transform()->position()));
-		program.set_vec3("dirLight.specularColor", dir_light.specular.to_vec3());
-		program.set_vec3("dirLight.diffuseColor", dir_light.diffuse.to_vec3());
-		program.set_float("dirLight.diffuseIntensity", dir_light.diff_intensity);
-		program.set_float("dirLight.specularIntensity", dir_light.spec_intensity);
-	}
-	else
+	gpu_profiler& profiler = gpu_profiler::get();
+
+	ImGui::Begin("GPU Profiler");
+	ImGui::Checkbox("Enabled", &profiler.is_enabled);
+	ImGui::SameLine();
+	if (ImGui::Button("Export CSV"))
+		profiler.export_csv("gpu_profile.csv");
+
+	ImGui::Text("GPU frame %.2f ms, last %u frames, exclusive times", profiler.get_frame_ms(), gpu_profiler::HISTORY);
+
+	const std::vector<gpu_profiler::scope_stats> stats = profiler.get_stats();
+
+	//bars share one scale so passes compare at a glance
+	float longest = 0.001f;
+	for (const auto& s : stats)
+		longest = std::max(longest, s.p99_ms);
+
+	for (const auto& s : stats)
 	{
-		program.set_vec3("dirLight.specularColor", dir_light.specular.to_vec3() * 0.0f);
-		program.set_vec3("dirLight.diffuseColor", dir_light.diffuse.to_vec3() * 0.0f);
+		char overlay[32];
+		snprintf(overlay, sizeof(overlay), "%.2f ms", s.avg_ms);
+
+		ImGui::Text("%*s%s", static_cast<int>(s.depth * 2), "", s.name.c_str());
+		ImGui::SameLine(160);
+		ImGui::ProgressBar(s.avg_ms / longest, ImVec2(160, 0), overlay);
+		ImGui::SameLine();
+		ImGui::Text("min %.2f  p99 %.2f", s.min_ms, s.p99_ms);
 	}
+
+	ImGui::End();
+
+	render_cpu_flame_window();
+	render_memory_window();
 }
 
-void send_point_lights_to_shader(const shader_program& program)
+void render_cpu_flame_window()
 {
-	program.use();
-	for (int j = 0; j < 4; j++)
+	cpu_profiler& profiler = cpu_profiler::get();
+
+	ImGui::Begin("CPU Profiler");
+
+	bool is_enabled = cpu_profiler::is_enabled();
+	if (ImGui::Checkbox("Enabled", &is_enabled))
+		cpu_profiler::set_enabled(is_enabled);
+	ImGui::SameLine();
+	if (ImGui::Button("Export Chrome Trace"))
+		profiler.export_chrome_trace("cpu_trace.json");
+
+	const unsigned long long start = profiler.get_frame_start_ns();
+	const unsigned long long end = profiler.get_frame_end_ns();
+
+	if (start == 0 || end <= start)
+	{
+		ImGui::End();
+		return;
+	}
+
+	const double frame_ns = static_cast<double>(end - start);
+	ImGui::Text("Last frame %.3f ms", frame_ns / 1000000.0);
+
+	if (ImGui::TreeNode("Flight Recorder"))
+	{
+		ImGui::Checkbox("Recording", &recorder.is_enabled);
+		ImGui::SliderFloat("Hitch (ms)", &recorder.threshold_ms, 16.0f, 200.0f);
+		ImGui::SliderFloat("Spike Ratio", &recorder.spike_ratio, 1.5f, 10.0f);
+		if (ImGui::Button("Dump Now (F9)"))
+			recorder.trigger("manual");
+		ImGui::Text("Average %.2f ms, %u dumps %s", recorder.get_average_ms(), recorder.get_dump_count(), recorder.get_last_dump().c_str());
+		ImGui::TreePop();
+	}
+
+	//one row of nested bars per thread, x is time within the last frame, y is nesting depth
+	const float row_height = 18.0f;
+	const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+	ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+	static std::vector<cpu_profiler::event> events;
+
+	for (unsigned int thread = 0; thread < profiler.get_thread_count(); thread++)
 	{
-		if (point_lights[j].is_active)
+		profiler.get_events(thread, start, end, events);
+		if (events.empty())
+			continue;
+
+		unsigned int depth = 0;
+		for (const auto& e : events)
+			depth = std::max(depth, e.depth + 1);
+
+		const std::string label = thread == 0 ? std::string("main") : std::string("thread ").append(std::to_string(thread));
+		ImGui::Text("%s", label.c_str());
+
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		const ImVec2 size(width, depth * row_height);
+		ImGui::InvisibleButton(std::string("##").append(label).c_str(), size);
+		draw_list->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+
+		for (const auto& e : events)
 		{
-			std::string  str = "pointLights[";
-			str.append(std::to_string(j));
-			str.append("].");
+			const double from = (static_cast<double>(std::max(e.start_ns, start)) - start) / frame_ns;
+			const double to = (static_cast<double>(std::min(e.end_ns, end)) - start) / frame_ns;
+
+			const ImVec2 min(origin.x + static_cast<float>(from * width), origin.y + e.depth * row_height);
+			const ImVec2 max(std::max(origin.x + static_cast<float>(to * width), min.x + 1.0f), min.y + row_height - 1.0f);
+
+			//hue from the name pointer so a scope keeps its colour between frames
+			const float hue = static_cast<float>(reinterpret_cast<uintptr_t>(e.name) % 97) / 97.0f;
+			draw_list->AddRectFilled(min, max, ImColor::HSV(hue, 0.5f, 0.7f));
+
+			if (max.x - min.x > 30.0f)
+			{
+				draw_list->PushClipRect(min, max, true);
+				draw_list->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f), IM_COL32_WHITE, e.name);
+				draw_list->PopClipRect();
+			}
 
-			program.set_vec3(std::string(str + "lightPos"), point_lights[j].get_transform()->position());
-			program.set_vec3(std::string(str + "specularColor"), point_lights[j].specular.to_vec3());
-			program.set_vec3(std::string(str + "diffuseColor"), point_lights[j].diffuse.to_vec3());
+			if (ImGui::IsMouseHoveringRect(min, max))
+				ImGui::SetTooltip("%s %.3f ms", e.name, (e.end_ns - e.start_ns) / 1000000.0);
+		}
+
+		draw_list->PopClipRect();
+	}
 
-			program.set_float(std::string(str + "diffuseIntensity"), point_lights[j].diff_intensity);
+	ImGui::End();
+}
 
-			program.set_float(std::string(str + "specularIntensity"), point_lights[j].spec_intensity);
+void render_memory_window()
+{
+	ImGui::Begin("Memory");
+
+	long long tracked = 0;
+	for (unsigned int i = 0; i < static_cast<unsigned int>(memory_tag::count); i++)
+		tracked += memory_tracker::get_stats(static_cast<memory_tag>(i)).live_bytes;
+
+	ImGui::Text("Resident %.1f MB, tracked %.1f MB", get_process_memory_bytes() / (1024.0f * 1024.0f), tracked / (1024.0f * 1024.0f));
+	ImGui::Text("Allocations last frame %llu", memory_tracker::get_frame_allocations());
+	if (!memory_tracker::is_hooked())
+		ImGui::Text("Built without MEMORY_TRACKING, only imgui and image decoding are counted");
+
+	ImGui::Columns(6, "memory tags");
+	ImGui::Text("Tag"); ImGui::NextColumn();
+	ImGui::Text("Live KB"); ImGui::NextColumn();
+	ImGui::Text("Peak KB"); ImGui::NextColumn();
+	ImGui::Text("Blocks"); ImGui::NextColumn();
+	ImGui::Text("Allocs/frame"); ImGui::NextColumn();
+	ImGui::Text("KB/frame"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (unsigned int i = 0; i < static_cast<unsigned int>(memory_tag::count); i++)
+	{
+		const memory_tag tag = static_cast<memory_tag>(i);
+		const memory_tag_stats stats = memory_tracker::get_stats(tag);
+		ImGui::Text("%s", memory_tracker::tag_to_string(tag)); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.live_bytes / 1024.0f); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.peak_bytes / 1024.0f); ImGui::NextColumn();
+		ImGui::Text("%lld", stats.live_allocations); ImGui::NextColumn();
+		ImGui::Text("%llu", stats.frame_allocations); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.frame_bytes / 1024.0f); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
 
-			program.set_float(std::string(str + "linear"), point_lights[j].linear);
+	ImGui::Text("Frame arena %u threads, %.1f KB reserved, %.1f KB peak, %llu overflowed", frame_arena::get_thread_count(),
+		frame_arena::get_capacity() / 1024.0f, frame_arena::get_peak_bytes() / 1024.0f, frame_arena::get_overflow_count());
 
-			program.set_float(std::string(str + "quadratic"), point_lights[j].quadratic);
+	if (ImGui::TreeNode("Hotspots"))
+	{
+		//busiest callsites of the last frame first, the rest by how often they ever allocated
+		std::vector<memory_callsite> sites = memory_tracker::get_callsites();
+		std::sort(sites.begin(), sites.end(), [](const memory_callsite& a, const memory_callsite& b)
+		{
+			return a.frame_allocations != b.frame_allocations ? a.frame_allocations > b.frame_allocations : a.total_allocations > b.total_allocations;
+		});
+		if (sites.size() > 20)
+			sites.resize(20);
+
+		//symbol lookups are slow, each address is resolved once
+		static std::unordered_map<const void*, std::string> names;
+
+		ImGui::Columns(5, "memory callsites");
+		ImGui::Text("Callsite"); ImGui::NextColumn();
+		ImGui::Text("Tag"); ImGui::NextColumn();
+		ImGui::Text("Allocs/frame"); ImGui::NextColumn();
+		ImGui::Text("Total"); ImGui::NextColumn();
+		ImGui::Text("Live KB"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (const memory_callsite& site : sites)
+		{
+			auto name = names.find(site.address);
+			if (name == names.end())
+				name = names.emplace(site.address, memory_tracker::get_callsite_name(site.address)).first;
+
+			ImGui::Text("%s", name->second.c_str()); ImGui::NextColumn();
+			ImGui::Text("%s", memory_tracker::tag_to_string(site.tag)); ImGui::NextColumn();
+			ImGui::Text("%llu", site.frame_allocations); ImGui::NextColumn();
+			ImGui::Text("%llu", site.total_allocations); ImGui::NextColumn();
+			ImGui::Text("%.1f", site.live_bytes / 1024.0f); ImGui::NextColumn();
 		}
-		else
+		ImGui::Columns(1);
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("GPU", "GPU %.1f MB", gpu_memory::get_total() / (1024.0f * 1024.0f)))
+	{
+		int budget_mb = static_cast<int>(gpu_memory::get_budget() / (1024 * 1024));
+		if (ImGui::InputInt("Budget MB", &budget_mb, 64, 512))
+			gpu_memory::set_budget(static_cast<std::size_t>(std::max(budget_mb, 0)) * 1024 * 1024);
+		ImGui::Text("%u objects, %u waiting on a fence", gpu_resources::get().get_live_count(), gpu_resources::get().get_pending_count());
+		if (ImGui::Button("Write gpu_memory.json"))
+			gpu_memory::write_json("gpu_memory.json");
+		if (gpu_memory::is_over_budget())
 		{
-			std::string  str = "pointLights[";
-			str.append(std::to_string(j));
-			str.append("].");
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Over budget");
+		}
 
-			program.set_vec3(std::string(str + "specularColor"), point_lights[j].specular.to_vec3() * 0.0f);
-			program.set_vec3(std::string(str + "diffuseColor"), point_lights[j].diffuse.to_vec3() * 0.0f);
+		ImGui::Columns(3, "gpu memory categories");
+		ImGui::Text("Category"); ImGui::NextColumn();
+		ImGui::Text("MB"); ImGui::NextColumn();
+		ImGui::Text("Objects"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (unsigned int i = 0; i < static_cast<unsigned int>(gpu_memory_category::count); i++)
+		{
+			const gpu_memory_category category = static_cast<gpu_memory_category>(i);
+			ImGui::Text("%s", gpu_memory::category_to_string(category)); ImGui::NextColumn();
+			ImGui::Text("%.2f", gpu_memory::get_total(category) / (1024.0f * 1024.0f)); ImGui::NextColumn();
+			ImGui::Text("%u", gpu_memory::get_count(category)); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+
+		ImGui::Separator();
+		ImGui::Columns(4, "gpu memory largest");
+		ImGui::Text("Owner"); ImGui::NextColumn();
+		ImGui::Text("Category"); ImGui::NextColumn();
+		ImGui::Text("Size"); ImGui::NextColumn();
+		ImGui::Text("MB"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (const gpu_allocation& allocation : gpu_memory::get_largest(20))
+		{
+			ImGui::Text("%s", allocation.owner.c_str()); ImGui::NextColumn();
+			ImGui::Text("%s", gpu_memory::category_to_string(allocation.category)); ImGui::NextColumn();
+			if (allocation.width > 0)
+				ImGui::Text("%u x %u", allocation.width, allocation.height);
+			ImGui::NextColumn();
+			ImGui::Text("%.2f", allocation.bytes / (1024.0f * 1024.0f)); ImGui::NextColumn();
 		}
+		ImGui::Columns(1);
+		ImGui::TreePop();
 	}
+
+	ImGui::End();
 }
 
-void send_point_light_to_shader(const shader_program& program, const point_light& light)
+bool report_frame_allocations(std::unordered_set<const void*>& reported)
 {
-	program.use();
-	if (light.is_active)
+	if (memory_tracker::get_stats(memory_tag::rendering).frame_allocations == 0)
+		return false;
+
+	//runs inside the frame's rendering tag, the report itself should not show up in the next one
+	memory_tag_scope tag(memory_tag::other);
+
+	for (const memory_callsite& site : memory_tracker::get_callsites())
 	{
-		const std::string  str = "pointLight.";
+		if (site.tag != memory_tag::rendering || site.frame_allocations == 0 || !reported.insert(site.address).second)
+			continue;
 
-		program.set_vec3(std::string(str + "lightPos"), light.get_transform()->position());
-		program.set_vec3(std::string(str + "specularColor"), light.specular.to_vec3());
-		program.set_vec3(std::string(str + "diffuseColor"), light.diffuse.to_vec3());
+		std::cout << "Allocation while rendering: " << site.frame_allocations << "x " << memory_tracker::get_callsite_name(site.address) << std::endl;
+	}
 
-		program.set_float(std::string(str + "diffuseIntensity"), light.diff_intensity);
+	return true;
+}
 
-		program.set_float(std::string(str + "specularIntensity"), light.spec_intensity);
+ImTextureID get_frame_texture_id(const char* name)
+{
+	const texture* tex = frame.get_texture(frame.find(string_id(name)));
+	return tex ? reinterpret_cast<void*>(static_cast<intptr_t>(tex->get_id())) : nullptr;
+}
 
-		program.set_float(std::string(str + "linear"), light.linear);
+void send_dir_light_to_shader(const shader_program& program)
+{
+	static const string_id light_dir_name("dirLight.lightDir");
+	static const string_id specular_color_name("dirLight.specularColor");
+	static const string_id diffuse_color_name("dirLight.diffuseColor");
+	static const string_id diffuse_intensity_name("dirLight.diffuseIntensity");
+	static const string_id specular_intensity_name("dirLight.specularIntensity");
 
-		program.set_float(std::string(str + "quadratic"), light.quadratic);
+	program.use();
+	const light_component* dir_light = frame_lights.directional.data;
+	if (dir_light)
+	{
+		program.set_vec3(light_dir_name, glm::normalize(-frame_lights.directional.position));
+		program.set_vec3(specular_color_name, dir_light->specular.to_vec3());
+		program.set_vec3(diffuse_color_name, dir_light->diffuse.to_vec3());
+		program.set_float(diffuse_intensity_name, dir_light->diff_intensity);
+		program.set_float(specular_intensity_name, dir_light->spec_intensity);
 	}
 	else
 	{
-		const std::string  str = "pointLight.";
-
-		program.set_vec3(std::string(str + "specularColor"), light.specular.to_vec3() * 0.0f);
-		program.set_vec3(std::string(str + "diffuseColor"), light.diffuse.to_vec3() * 0.0f);
+		program.set_vec3(specular_color_name, glm::vec3(0.0f));
+		program.set_vec3(diffuse_color_name, glm::vec3(0.0f));
 	}
 }
 
-void send_spot_light_to_shader(const shader_program& program)
+//uniform names of one point light struct, built once instead of per light per frame
+struct point_light_uniforms
 {
-	program.use();
-	if (spotlight.is_active)
+	string_id light_pos;
+	string_id specular_color;
+	string_id diffuse_color;
+	string_id diffuse_intensity;
+	string_id specular_intensity;
+	string_id linear;
+	string_id quadratic;
+
+	explicit point_light_uniforms(const std::string& prefix) :
+		light_pos(prefix + "lightPos"),
+		specular_color(prefix + "specularColor"),
+		diffuse_color(prefix + "diffuseColor"),
+		diffuse_intensity(prefix + "diffuseIntensity"),
+		specular_intensity(prefix + "specularIntensity"),
+		linear(prefix + "linear"),
+		quadratic(prefix + "quadratic")
 	{
-		spotlight.get_transform()->set_position(cam.get_transform()->position());
-		spotlight.get_transform()->set_rotation(cam.get_transform()->rotation());
-		spotlight.spot_direction = cam.get_transform()->forward();
-	}
-	
-	program.set_float("isFlashlightOn", is_flash_light_on ? 1.0f : 0.0f);
-	if (is_flash_light_on)
-	{
-		program.set_vec3("spotLight.spotDirection", cam.get_transform()->forward());
-		program.set_float("spotLight.cutOffValue", glm::cos(glm::radians(spotlight.cutoff_angle)));
-		program.set_float("spotLight.innerCutOffValue",
-			glm::cos(glm::radians(spotlight.inner_cutoff_angle)));
-		program.set_vec3("spotLight.lightPos", cam.get_transform()->position());
-		program.set_vec3("spotLight.specularColor", spotlight.specular.to_vec3());
-		program.set_vec3("spotLight.diffuseColor", spotlight.diffuse.to_vec3());
-		program.set_float("spotLight.diffuseIntensity", spotlight.diff_intensity);
-		program.set_float("spotLight.specularIntensity", spotlight.spec_intensity);
 	}
+};
+
+void set_point_light_uniforms(const shader_program& program, const point_light_uniforms& names, const gathered_light& light)
+{
+	program.set_vec3(names.light_pos, light.position);
+	program.set_vec3(names.specular_color, light.data->specular.to_vec3());
+	program.set_vec3(names.diffuse_color, light.data->diffuse.to_vec3());
+	program.set_float(names.diffuse_intensity, light.data->diff_intensity);
+	program.set_float(names.specular_intensity, light.data->spec_intensity);
+	program.set_float(names.linear, light.data->linear);
+	program.set_float(names.quadratic, light.data->quadratic);
+}
+
+void send_point_light_to_shader(const shader_program& program, const gathered_light& light)
+{
+	static const point_light_uniforms names("pointLight.");
+
+	program.use();
+	set_point_light_uniforms(program, names, light);
 }
 
 void send_material_data_to_shader(const shader_program& program)
 {
+	static const string_id specular_color_name("mat.specularColor");
+	static const string_id diffuse_color_name("mat.diffuseColor");
+	static const string_id specular_intensity_name("mat.specularIntensity");
+
 	program.use();
 	program.set_float("mat.shininess", cube_mat.shininess);
-	program.set_vec3("mat.specularColor", cube_mat.specular_tint.to_vec3());
-	program.set_vec3("mat.diffuseColor", cube_mat.diffuse_tint.to_vec3());
-	program.set_vec3("mat.specularIntensity", cube_mat.diffuse_tint.to_vec3());
+	program.set_vec3(specular_color_name, cube_mat.specular_tint.to_vec3());
+	program.set_vec3(diffuse_color_name, cube_mat.diffuse_tint.to_vec3());
+	program.set_vec3(specular_intensity_name, cube_mat.diffuse_tint.to_vec3());
 
 	program.set_vec3("ambientColor", ambient_color.to_vec3());
 	program.set_float("time", static_cast<float>(glfwGetTime()));
 }
 
-float calculate_point_light_radius(point_light& light)
-{
-	const float max_channel = fmax(fmax(light.diffuse.r, light.diffuse.g), light.diffuse.b);
-
-	const float ret = (-light.linear + sqrtf(light.linear * light.linear -
-		4.0f * light.quadratic * (1.0f - (256.0f/0.5f) * max_channel * light.diff_intensity)))
-		/
-		(2.0f * light.quadratic);
-	return ret;
-}
-
 #pragma endregion
 
 #pragma region Deferred Shading
 
 void render_ds_geometry(const shader_program& program)
 {
-	geometry_fb.bind();
+	cpu_profile_scope scope("render_ds_geometry");
+
 	FB::clear_frame();
 
 	program.use();
 	program.set_float("useNormalMaps", use_normal_maps);
-	program.set_float("useParallax", use_parallax);
+	program.set_float("useParallax", use_parallax && quality.get_tier().allow_parallax);
 	program.set_vec3("viewPos", cam.get_transform()->position());
 	
-	for (auto& game_model : game_models)
+	const glm::vec3 view_pos = cam.get_transform()->position();
+
+	record_scene([&program, &view_pos](command_list& list, const mesh_renderer_component& r, const transform& transform)
 	{
-		tiling_and_offset t = tiling_and_offset{ glm::vec2(game_model.get_transform()->scale()), glm::vec2(0) };
+		tiling_and_offset t = tiling_and_offset{ glm::vec2(transform.scale()), glm::vec2(0) };
 
 		if (glm::abs(t.tiling.x) < 1)
 			t.tiling.x = 1;
 
 		if (glm::abs(t.tiling.y) < 1)
 			t.tiling.y = 1;
-		
-		program.set_model(game_model.get_transform()->get_model_matrix());
-		program.set_tiling_and_offset(t);
-		game_model.draw(program);
-	}
+
+		const glm::mat4& model_matrix = transform.get_cached_model_matrix();
+		r.source.record(list, program, model_matrix, &t, glm::length(glm::vec3(model_matrix[3]) - view_pos));
+	}, true);
+
+	command_list::submit(pass_lists);
 	
 	/*ds_geometry_shader_program.set_model(barrel_model.get_transform()->get_model_matrix());
 	barrel_model.draw(ds_geometry_shader_program);
@@ -1710,20 +2528,14 @@ void render_ds_geometry(const shader_program& program)
 	ds_geometry_shader_program.set_model(floor_model.get_transform()->get_model_matrix());
 	ds_geometry_shader_program.set_tiling_and_offset(floor_tiling_and_offset);
 	floor_model.draw(ds_geometry_shader_program);*/
-
-	debug_fb.bind_draw();
-	glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-
-	ds_light_fb.bind_draw();
-	glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-	glBlitFramebuffer(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, GL_STENCIL_BUFFER_BIT, GL_NEAREST);
-
-	FB::unbind();
 }
 
-void render_ds_dir_light_pass(const shader_program& program, model& quad)
+void render_ds_dir_light_pass(const shader_program& program, model& quad, const g_buffer_textures& g_buffer)
 {
-	if (dir_light.is_active)
+	cpu_profile_scope cpu_scope("render_ds_dir_light_pass");
+	gpu_profile_scope gpu_scope("Directional Light");
+
+	if (frame_lights.directional.data)
 	{
 		FB::set_depth_testing(false);
 		FB::set_depth_writing(false);
@@ -1738,15 +2550,16 @@ void render_ds_dir_light_pass(const shader_program& program, model& quad)
 		program.set_int("gDiffSpec", 2);
 		program.set_int("shadowMap", 3);
 		program.set_float("useShadow", use_shadow);
+		program.set_int("pcfHalfKernel", quality.get_tier().pcf_half_kernel);
 
 		texture::activate(GL_TEXTURE0);
-		geometry_fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT0)->bind();
+		g_buffer.position->bind();
 
 		texture::activate(GL_TEXTURE1);
-		geometry_fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT1)->bind();
+		g_buffer.normal->bind();
 
 		texture::activate(GL_TEXTURE2);
-		geometry_fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT2)->bind();
+		g_buffer.diff_spec->bind();
 
 		texture::activate(GL_TEXTURE3);
 		shadow_fb.get_depth_attachment_tex()->bind();
@@ -1756,102 +2569,328 @@ void render_ds_dir_light_pass(const shader_program& program, model& quad)
 
 }
 
-void render_ds_point_light_pass(const shader_program& stencil_program, const shader_program& point_light_program, model& sphere)
+void render_ds_point_light_pass(const shader_program& stencil_program, const shader_program& point_light_program, model& sphere, const g_buffer_textures& g_buffer)
 {
-	for (unsigned int i = 0; i < 4; i++)
+	cpu_profile_scope cpu_scope("render_ds_point_light_pass");
+	gpu_profile_scope gpu_scope("Point Lights");
+
+	for (unsigned int i = 0; i < frame_lights.points.size(); i++)
 	{
-		if (point_lights[i].is_active)
-		{
-			FB::clear_stencil_buffer();
-			FB::enable_depth_testing();
-			FB::set_depth_writing(false);
-			FB::enable_stencil_testing();
-			FB::set_stencil_writing(true);
+		const gathered_light& point_light = frame_lights.points[i];
 
-			sphere.get_mesh_ptr(0)->should_cull_face = false;
+		FB::clear_stencil_buffer();
+		FB::enable_depth_testing();
+		FB::set_depth_writing(false);
+		FB::enable_stencil_testing();
+		FB::set_stencil_writing(true);
 
-			FB::set_stencil_func(GL_ALWAYS, 0, 0);
-			FB::set_stencil_op_sep(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
-			FB::set_stencil_op_sep(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+		sphere.get_mesh_ptr(0)->should_cull_face = false;
 
+		FB::set_stencil_func(GL_ALWAYS, 0, 0);
+		FB::set_stencil_op_sep(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+		FB::set_stencil_op_sep(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
 
-			stencil_program.use();
-			sphere.get_transform()->set_position(point_lights[i].get_transform()->position());
-			sphere.get_transform()->set_scale(point_lights[i].get_transform()->scale());
-			stencil_program.set_model(sphere.get_transform()->get_model_matrix());
-			sphere.draw(stencil_program); // stencil pass
 
-			FB::enable_stencil_testing();
-			FB::disable_depth_testing();
-			FB::set_stencil_func(GL_NOTEQUAL, 0, 0xFF);
-			FB::set_stencil_writing(false);
-			FB::set_depth_writing(false);
-			sphere.get_mesh_ptr(0)->should_cull_face = true;
-			sphere.get_mesh_ptr(0)->cull_face = GL_FRONT;
+		stencil_program.use();
+		sphere.get_transform()->set_position(point_light.position);
+		sphere.get_transform()->set_scale(glm::vec3(point_light.data->radius));
+		stencil_program.set_model(sphere.get_transform()->get_model_matrix());
+		sphere.draw(stencil_program); // stencil pass
 
+		FB::enable_stencil_testing();
+		FB::disable_depth_testing();
+		FB::set_stencil_func(GL_NOTEQUAL, 0, 0xFF);
+		FB::set_stencil_writing(false);
+		FB::set_depth_writing(false);
+		sphere.get_mesh_ptr(0)->should_cull_face = true;
+		sphere.get_mesh_ptr(0)->cull_face = GL_FRONT;
 
-			point_light_program.use();
-			send_point_light_to_shader(point_light_program, point_lights[i]);
-			point_light_program.set_vec3("viewPos", cam.get_transform()->position());
-			point_light_program.set_int("gPos", 0);
-			point_light_program.set_int("gNormal", 1);
-			point_light_program.set_int("gDiffSpec", 2);
-			point_light_program.set_int("pointShadowMap", 3);
-			point_light_program.set_float("useShadow", i == 0);
-			point_light_program.set_float("farPlane", RADIUS);
-			point_light_program.set_float("useDebug", false);
 
+		point_light_program.use();
+		send_point_light_to_shader(point_light_program, point_light);
+		point_light_program.set_vec3("viewPos", cam.get_transform()->position());
+		point_light_program.set_int("gPos", 0);
+		point_light_program.set_int("gNormal", 1);
+		point_light_program.set_int("gDiffSpec", 2);
+		point_light_program.set_int("pointShadowMap", 3);
+		point_light_program.set_float("useShadow", i == 0 && frame_lights.has_point_shadow);
+		point_light_program.set_float("farPlane", RADIUS);
+		point_light_program.set_float("useDebug", false);
 
-			point_light_program.set_model(sphere.get_transform()->get_model_matrix());
 
-			texture::activate(GL_TEXTURE0);
-			geometry_fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT0)->bind();
+		point_light_program.set_model(sphere.get_transform()->get_model_matrix());
 
-			texture::activate(GL_TEXTURE1);
-			geometry_fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT1)->bind();
+		texture::activate(GL_TEXTURE0);
+		g_buffer.position->bind();
+
+		texture::activate(GL_TEXTURE1);
+		g_buffer.normal->bind();
 
-			texture::activate(GL_TEXTURE2);
-			geometry_fb.get_color_attachment_tex(GL_COLOR_ATTACHMENT2)->bind();
+		texture::activate(GL_TEXTURE2);
+		g_buffer.diff_spec->bind();
 
-			texture::activate(GL_TEXTURE3);
-			point_shadow_fb.get_depth_attachment_tex()->bind();
+		texture::activate(GL_TEXTURE3);
+		point_shadow_fb.get_depth_attachment_tex()->bind();
 
-			//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-			sphere.draw(point_light_program); // lighting pass
+		//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		sphere.draw(point_light_program); // lighting pass
 
-			FB::clear_stencil_buffer();
-			FB::disable_stencil_testing();
-			FB::set_depth_writing(false);
-			FB::enable_depth_testing();
+		FB::clear_stencil_buffer();
+		FB::disable_stencil_testing();
+		FB::set_depth_writing(false);
+		FB::enable_depth_testing();
 
 
-			//if(use_light_debug)
-			//{
-			//	sphere.get_mesh_ptr(0)->should_cull_face = false;
-			//	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-			//	point_light_program.set_float("useDebug", true);
-			//	sphere.draw(point_light_program);
-			//	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			//} // debug visual pass
-			
-			FB::set_depth_writing(true);
-			FB::set_stencil_writing(false);
-		}
+		//if(use_light_debug)
+		//{
+		//	sphere.get_mesh_ptr(0)->should_cull_face = false;
+		//	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		//	point_light_program.set_float("useDebug", true);
+		//	sphere.draw(point_light_program);
+		//	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		//} // debug visual pass
+		
+		FB::set_depth_writing(true);
+		FB::set_stencil_writing(false);
 	}
 }
 
+void render_ds_tiled_light_pass(const shader_program& program, const g_buffer_textures& g_buffer, const texture& lit_color)
+{
+	cpu_profile_scope cpu_scope("render_ds_tiled_light_pass");
+	gpu_profile_scope gpu_scope("Point Lights");
+
+	if (clusters.get_light_count() == 0)
+		return;
+
+	render_backend& backend = render_backend::get();
+
+	static const string_id point_shadow_light_name("pointShadowLight");
+
+	clusters.bind_lights();
+	backend.bind_image_texture(0, lit_color.get_id(), GL_READ_WRITE, GL_RGBA16F);
+
+	program.use();
+	program.set_vec3("viewPos", cam.get_transform()->position());
+	program.set_int("gPos", 0);
+	program.set_int("gNormal", 1);
+	program.set_int("gDiffSpec", 2);
+	program.set_int("gDepth", 3);
+	program.set_int("pointShadowMap", 4);
+	program.set_int(point_shadow_light_name, use_shadow && frame_lights.has_point_shadow ? 0 : -1);
+	program.set_int("lightCount", static_cast<int>(clusters.get_light_count()));
+	program.set_float("farPlane", RADIUS);
+	program.set_float("useDebug", use_light_debug);
+
+	texture::activate(GL_TEXTURE0);
+	g_buffer.position->bind();
+
+	texture::activate(GL_TEXTURE1);
+	g_buffer.normal->bind();
+
+	texture::activate(GL_TEXTURE2);
+	g_buffer.diff_spec->bind();
+
+	texture::activate(GL_TEXTURE3);
+	g_buffer.depth->bind();
+
+	texture::activate(GL_TEXTURE4);
+	point_shadow_fb.get_depth_attachment_tex()->bind();
+
+	const unsigned int tiles_x = (lit_color.get_width() + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+	const unsigned int tiles_y = (lit_color.get_height() + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+	backend.dispatch_compute(tiles_x, tiles_y, 1);
+
+	//the skybox draws into the same target next and bloom samples it after
+	backend.memory_barrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
 #pragma endregion
 
 #pragma region Other functions
 
 void set_vp_from_camera()
 {
+	cpu_profile_scope scope("set_vp_from_camera");
+
 	mvp_matrix.view = cam.get_view_matrix();
 	mvp_matrix.projection = cam.get_proj_matrix();
 	vp_ubo.buffer_data_range(0, sizeof(glm::mat4), glm::value_ptr(mvp_matrix.view));
 	vp_ubo.buffer_data_range(sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(mvp_matrix.projection)); // view projection
 }
 
+entity add_model_entity(const model& m, const bool use_scale_tiling)
+{
+	return add_model_entity(m, *m.get_transform(), use_scale_tiling);
+}
+
+entity add_model_entity(const model& m, const transform& t, const bool use_scale_tiling)
+{
+	const entity e = scene.create();
+
+	scene.add(e, name_component{ string_id(m.get_name()) });
+	scene.add(e, t);
+
+	mesh_renderer_component r{ m };
+	r.use_scale_tiling = use_scale_tiling;
+	r.is_active = m.is_active;
+	scene.add(e, r);
+
+	bounds_component b;
+	b.local = m.get_bounds();
+	scene.add(e, b);
+
+	return e;
+}
+
+entity add_light_entity(const std::string& name, const light_component& l, const transform& t)
+{
+	const entity e = scene.create();
+
+	scene.add(e, name_component{ string_id(name) });
+	scene.add(e, t);
+	scene.add(e, l);
+
+	return e;
+}
+
+void gather_lights()
+{
+	cpu_profile_scope scope("gather_lights");
+
+	if (light_component* l = scene.get<light_component>(flashlight))
+	{
+		l->is_active = is_flash_light_on;
+		l->spot_direction = cam.get_transform()->forward();
+		scene.get<transform>(flashlight)->set_position(cam.get_transform()->position());
+	}
+
+	//cleared in place so the lists keep their capacity from frame to frame
+	frame_lights.directional = gathered_light();
+	frame_lights.points.clear();
+	frame_lights.spots.clear();
+	frame_lights.has_point_shadow = false;
+
+	scene.each<light_component, transform>([](const entity, light_component& l, const transform& t)
+	{
+		if (!l.is_active)
+			return;
+
+		switch (l.type)
+		{
+		case light_type::directional:
+			frame_lights.directional = gathered_light{ &l, t.position() };
+			break;
+		case light_type::spot:
+			l.set_radius(t.scale().x);
+			frame_lights.spots.push_back(gathered_light{ &l, t.position() });
+			break;
+		case light_type::point:
+			l.set_radius(t.scale().x);
+			frame_lights.points.push_back(gathered_light{ &l, t.position() });
+
+			if (l.casts_shadow && !frame_lights.has_point_shadow)
+			{
+				std::swap(frame_lights.points.front(), frame_lights.points.back());
+				frame_lights.has_point_shadow = true;
+			}
+			break;
+		}
+	});
+}
+
+void prepare_cluster_lights()
+{
+	cpu_profile_scope scope("prepare_cluster_lights");
+
+	//same order as frame_lights so the shadow caster stays index 0, spot lights go after every point light
+	clusters.begin_frame();
+	for (const gathered_light& point_light : frame_lights.points)
+	{
+		const light_component& l = *point_light.data;
+		clusters.add_point_light(point_light.position, l.radius, l.diffuse.to_vec3() * l.diff_intensity, l.specular.to_vec3() * l.spec_intensity, l.linear, l.quadratic);
+	}
+
+	for (const gathered_light& spot_light : frame_lights.spots)
+	{
+		const light_component& l = *spot_light.data;
+		clusters.add_spot_light(spot_light.position, l.radius, l.spot_direction,
+			glm::cos(glm::radians(l.cutoff_angle)), glm::cos(glm::radians(l.inner_cutoff_angle)),
+			l.diffuse.to_vec3() * l.diff_intensity, l.specular.to_vec3() * l.spec_intensity, l.linear, l.quadratic);
+	}
+
+	//deferred shading culls per screen tile against the g-buffer depth, only the light list is needed
+	if (use_deferred)
+		clusters.upload_lights();
+	else
+		clusters.build(mvp_matrix.view, cam.fov, cam.aspect, cam.near, cam.far);
+}
+
+void cull_scene()
+{
+	cpu_profile_scope scope("cull_scene");
+
+	const frustum view_frustum = frustum::from_matrix(mvp_matrix.projection * mvp_matrix.view);
+
+	auto& bounds_pool = scene.get_pool<bounds_component>();
+	auto& transform_pool = scene.get_pool<transform>();
+	std::atomic<unsigned int> visible{ 0 };
+
+	job_system::get().parallel_for(bounds_pool.size(), CULL_BATCH, [&](const unsigned int begin, const unsigned int end)
+	{
+		unsigned int batch_visible = 0;
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			bounds_component& b = bounds_pool.get_components()[i];
+			const transform* t = transform_pool.get(bounds_pool.get_entities()[i]);
+
+			b.world = t ? b.local.transformed(t->get_cached_model_matrix()) : b.local;
+			b.is_visible = view_frustum.intersects(b.world);
+			batch_visible += b.is_visible ? 1 : 0;
+		}
+
+		visible += batch_visible;
+	});
+
+	visible_count = visible;
+}
+
+void record_scene(const std::function<void(command_list&, const mesh_renderer_component&, const transform&)>& record, const bool visible_only)
+{
+	cpu_profile_scope scope("record_scene");
+
+	for (auto& list : pass_lists)
+		list.reset();
+
+	const auto& renderer_pool = scene.get_pool<mesh_renderer_component>();
+	const auto& transform_pool = scene.get_pool<transform>();
+	const auto& bounds_pool = scene.get_pool<bounds_component>();
+
+	//each job fills the list of the thread it runs on, submit() merges and sorts them afterwards
+	job_system::get().parallel_for(renderer_pool.size(), RECORD_BATCH, [&](const unsigned int begin, const unsigned int end)
+	{
+		command_list& list = pass_lists[job_system::get_thread_index()];
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const entity e = renderer_pool.get_entities()[i];
+			const mesh_renderer_component& r = renderer_pool.get_components()[i];
+
+			if (!r.is_active)
+				continue;
+
+			const bounds_component* b = bounds_pool.get(e);
+			if (visible_only && b && !b->is_visible)
+				continue;
+
+			const transform* t = transform_pool.get(e);
+			if (t)
+				record(list, r, *t);
+		}
+	});
+}
+
 std::string get_tex(const std::string& path)
 {
 	return std::string("res/textures/").append(path);
@@ -1859,12 +2898,24 @@ std::string get_tex(const std::string& path)
 
 void deallocate()
 {
-	
+	frame.release();
+	frame_gpu_timer.release();
+	quality.release();
+	gpu_profiler::get().release();
 }
 
 void init_imgui()
 {
 	IMGUI_CHECKVERSION();
+	//imgui allocates through malloc unless told otherwise, this puts it on the memory tracker
+	ImGui::SetAllocatorFunctions([](const size_t size, void*)
+	{
+		memory_tag_scope tag(memory_tag::imgui);
+		return memory_tracker::allocate(size, reinterpret_cast<const void*>(&ImGui::MemAlloc));
+	}, [](void* block, void*)
+	{
+		memory_tracker::release(block);
+	});
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
@@ -1890,6 +2941,30 @@ void process_input(GLFWwindow* window)
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
+	if (glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS && this_frame - last_hitch_trigger > key_press_cooldown)
+	{
+		last_hitch_trigger = this_frame;
+		recorder.trigger("hotkey");
+	}
+
+	if (glfwGetKey(window, GLFW_KEY_F8) == GLFW_PRESS && this_frame - last_path_toggle > key_press_cooldown)
+	{
+		last_path_toggle = this_frame;
+		is_recording_path = !is_recording_path;
+
+		if (is_recording_path)
+		{
+			cam_path.clear();
+			path_record_start = this_frame;
+			std::cout << "Recording camera path" << std::endl;
+		}
+		else if (cam_path.save("camera_path.txt"))
+			std::cout << "Saved " << cam_path.get_duration() << " s camera path to camera_path.txt" << std::endl;
+	}
+
+	if (is_recording_path)
+		cam_path.add(this_frame - path_record_start, cam.get_transform()->position(), cam.get_transform()->rotation());
+
 	if(cursor_mode == GLFW_CURSOR_DISABLED)
 	{
 		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
@@ -1961,7 +3036,15 @@ void glfw_error_callback(int error, const char* description)
 
 void frame_buffer_resize_callback(GLFWwindow* window, const int width, int const height)
 {
-	glViewport(0, 0, width, height);
+	screen_width = static_cast<unsigned int>(std::max(width, 0));
+	screen_height = static_cast<unsigned int>(std::max(height, 0));
+
+	if (screen_height > 0)
+		cam.aspect = screen_width / static_cast<float>(screen_height);
+
+	//targets are reallocated lazily by the next frame at the new size
+	frame.release_unused_targets();
+	render_backend::get().viewport(0, 0, width, height);
 }
 
 void mouse_callback(GLFWwindow* window, const double x_pos, const double y_pos)
@@ -0,0 +1,92 @@
+#include "data/bounds.h"
+
+bool aabb::is_valid() const
+{
+	return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+glm::vec3 aabb::get_center() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 aabb::get_extents() const
+{
+	return (max - min) * 0.5f;
+}
+
+void aabb::expand(const glm::vec3& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void aabb::expand(const aabb& other)
+{
+	if (!other.is_valid())
+		return;
+
+	min = glm::min(min, other.min);
+	max = glm::max(max, other.max);
+}
+
+aabb aabb::transformed(const glm::mat4& matrix) const
+{
+	if (!is_valid())
+		return *this;
+
+	const glm::vec3 center = glm::vec3(matrix * glm::vec4(get_center(), 1.0f));
+	const glm::vec3 extents = get_extents();
+
+	const glm::vec3 new_extents =
+		glm::abs(glm::vec3(matrix[0])) * extents.x +
+		glm::abs(glm::vec3(matrix[1])) * extents.y +
+		glm::abs(glm::vec3(matrix[2])) * extents.z;
+
+	aabb result;
+	result.min = center - new_extents;
+	result.max = center + new_extents;
+	return result;
+}
+
+frustum frustum::from_matrix(const glm::mat4& view_proj)
+{
+	const glm::vec4 row0 = glm::vec4(view_proj[0][0], view_proj[1][0], view_proj[2][0], view_proj[3][0]);
+	const glm::vec4 row1 = glm::vec4(view_proj[0][1], view_proj[1][1], view_proj[2][1], view_proj[3][1]);
+	const glm::vec4 row2 = glm::vec4(view_proj[0][2], view_proj[1][2], view_proj[2][2], view_proj[3][2]);
+	const glm::vec4 row3 = glm::vec4(view_proj[0][3], view_proj[1][3], view_proj[2][3], view_proj[3][3]);
+
+	frustum f{};
+	f.planes[0] = row3 + row0;
+	f.planes[1] = row3 - row0;
+	f.planes[2] = row3 + row1;
+	f.planes[3] = row3 - row1;
+	f.planes[4] = row3 + row2;
+	f.planes[5] = row3 - row2;
+
+	for (auto& plane : f.planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	return f;
+}
+
+bool frustum::intersects(const aabb& box) const
+{
+	if (!box.is_valid())
+		return true;
+
+	const glm::vec3 center = box.get_center();
+	const glm::vec3 extents = box.get_extents();
+
+	for (const auto& plane : planes)
+	{
+		const glm::vec3 normal = glm::vec3(plane);
+		const float distance = glm::dot(normal, center) + plane.w;
+		const float radius = glm::dot(glm::abs(normal), extents);
+
+		if (distance + radius < 0.0f)
+			return false;
+	}
+
+	return true;
+}
@@ -13,8 +13,7 @@ bool check_if_transparent(std::vector<texture>& textures)
 
 mesh::mesh(const std::vector<vertex>& v)
 {
-	vertices = v;
-	indices = std::vector<unsigned int>();
+	geometry = std::make_shared<mesh_data>(v, std::vector<unsigned int>());
 	textures = std::vector<texture>();
 
 	is_indexed = false;
@@ -22,42 +21,61 @@ mesh::mesh(const std::vector<vertex>& v)
 	should_cull_face = true;
 
 	//is_transparent = check_if_transparent(textures);
+	rebuild_material_slots();
 }
 
 mesh::mesh(const std::vector<vertex>& v, std::vector<texture>& t)
 {
-	vertices = v;
-	indices = std::vector<unsigned int>();
+	geometry = std::make_shared<mesh_data>(v, std::vector<unsigned int>());
 	textures = t;
 
 	is_indexed = false;
 	cull_face = GL_BACK;
 	should_cull_face = true;
 	//is_transparent = check_if_transparent(textures);
+	rebuild_material_slots();
 }
 
 mesh::mesh(const std::vector<vertex>& v, std::vector<unsigned>& i)
 {
-	vertices = v;
-	indices = i;
+	geometry = std::make_shared<mesh_data>(v, i);
 	textures = std::vector<texture>();
 
 	is_indexed = false;
 	cull_face = GL_BACK;
 	should_cull_face = true;
 	//is_transparent = check_if_transparent(textures);
+	rebuild_material_slots();
 }
 
 mesh::mesh(const std::vector<vertex>& v, std::vector<unsigned>& i, std::vector<texture>& t)
 {
-	vertices = v;
-	indices = i;
+	geometry = std::make_shared<mesh_data>(v, i);
 	textures = t;
 
 	is_indexed = false;
 	cull_face = GL_BACK;
 	should_cull_face = true;
 	//is_transparent = check_if_transparent(textures);
+	rebuild_material_slots();
+}
+
+mesh::mesh(std::shared_ptr<mesh_data> geometry) : geometry(std::move(geometry))
+{
+	is_indexed = this->geometry->get_index_count() > 0;
+	cull_face = GL_BACK;
+	should_cull_face = true;
+	rebuild_material_slots();
+}
+
+mesh::mesh(std::shared_ptr<mesh_data> geometry, std::vector<texture> textures) :
+	textures(std::move(textures)),
+	geometry(std::move(geometry))
+{
+	is_indexed = this->geometry->get_index_count() > 0;
+	cull_face = GL_BACK;
+	should_cull_face = true;
+	rebuild_material_slots();
 }
 
 void mesh::replace_textures(const std::vector<texture>& textures)
@@ -65,11 +83,57 @@ void mesh::replace_textures(const std::vector<texture>& textures)
 	this->textures.clear();
 	this->textures.insert(this->textures.begin(), textures.begin(), textures.end());
 	//is_transparent = check_if_transparent(this->textures);
+	rebuild_material_slots();
 }
 
 void mesh::insert_texture(const texture& texture)
 {
 	this->textures.push_back(texture);
 	//is_transparent = check_if_transparent(this->textures);
+	rebuild_material_slots();
+}
+
+const std::vector<vertex>& mesh::get_vertices() const
+{
+	return geometry->get_vertices();
+}
+
+const std::vector<unsigned>& mesh::get_indices() const
+{
+	return geometry->get_indices();
+}
+
+std::shared_ptr<mesh_data> mesh::get_geometry() const
+{
+	return geometry;
+}
+
+void mesh::set_cpu_access(const bool flag) const
+{
+	geometry->set_cpu_access(flag);
 }
 
+bool mesh::get_cpu_access() const
+{
+	return geometry->get_cpu_access();
+}
+
+const std::vector<material_slot>& mesh::get_material_slots() const
+{
+	return material_slots;
+}
+
+void mesh::rebuild_material_slots()
+{
+	material_slots.clear();
+	std::vector<int> numbers(15, -1);
+
+	for (const auto& t : textures)
+	{
+		const texture_type type = t.get_type();
+		const std::string name = std::string("mat.").append(texture::type_to_string(type))
+			.append(std::to_string(++numbers[static_cast<unsigned int>(type)]));
+
+		material_slots.push_back(material_slot{ string_id(name), t.get_target(), t.get_id() });
+	}
+}
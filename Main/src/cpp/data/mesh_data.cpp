@@ -0,0 +1,72 @@
+#include "data/mesh_data.h"
+
+mesh_data::mesh_data(std::vector<vertex> vertices, std::vector<unsigned int> indices) :
+	vertices(std::move(vertices)),
+	indices(std::move(indices))
+{
+	vertex_count = static_cast<unsigned int>(this->vertices.size());
+	index_count = static_cast<unsigned int>(this->indices.size());
+
+	for (const auto& v : this->vertices)
+		bounds.expand(v.position);
+}
+
+const std::vector<vertex>& mesh_data::get_vertices() const
+{
+	return vertices;
+}
+
+const std::vector<unsigned>& mesh_data::get_indices() const
+{
+	return indices;
+}
+
+unsigned mesh_data::get_vertex_count() const
+{
+	return vertex_count;
+}
+
+unsigned mesh_data::get_index_count() const
+{
+	return index_count;
+}
+
+const aabb& mesh_data::get_bounds() const
+{
+	return bounds;
+}
+
+bool mesh_data::get_is_resident() const
+{
+	return vertex_count == 0 || !vertices.empty();
+}
+
+bool mesh_data::get_cpu_access() const
+{
+	return cpu_access;
+}
+
+void mesh_data::set_cpu_access(const bool flag)
+{
+	cpu_access = flag;
+}
+
+void mesh_data::release()
+{
+	if (cpu_access)
+		return;
+
+	//swap with empty vectors so the capacity is actually given back
+	std::vector<vertex>().swap(vertices);
+	std::vector<unsigned int>().swap(indices);
+}
+
+std::shared_ptr<gpu_mesh> mesh_data::get_gpu_mesh() const
+{
+	return gpu;
+}
+
+void mesh_data::set_gpu_mesh(const std::shared_ptr<gpu_mesh>& gpu)
+{
+	this->gpu = gpu;
+}
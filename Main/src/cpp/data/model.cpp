@@ -1,4 +1,6 @@
 #include "data/model.h"
+#include "utils/cpu_profiler.h"
+#include "utils/memory_tracker.h"
 #include <assimp/postprocess.h>
 
 model::model(const std::string &path, const bool auto_load)
@@ -36,20 +38,7 @@ model::model(const std::vector<mesh>& meshes)
 	this->is_instanced = false;
 
 	for (const auto& m : meshes)
-	{
-		this->meshes.push_back(m);
-
-		if (is_instanced)
-		{
-			instanced_renderer instanced_rnd = instanced_renderer(std::make_shared<mesh>(m), this->data, this->buffer_size);
-			instanced_renderers.push_back(instanced_rnd);
-		}
-
-		shadow_renderer shadow_rnd = shadow_renderer(std::make_shared<mesh>(m));
-		shadow_renderers.push_back(shadow_rnd);
-
-		renderers.emplace_back(std::make_shared<mesh>(m));
-	}
+		add_mesh(std::make_shared<mesh>(m));
 }
 
 
@@ -80,9 +69,51 @@ void model::draw_shadow(const shader_program& program)
 		renderer.draw(program);
 }
 
+void model::record(command_list& list, const shader_program& program, const glm::mat4& model_matrix, const tiling_and_offset* tiling, const float depth) const
+{
+	static const string_id model_uniform("model");
+	static const string_id tiling_uniform("tiling");
+	static const string_id offset_uniform("offset");
+
+	for (const auto& renderer : renderers)
+	{
+		const draw_call call = renderer.get_draw_call();
+		const std::vector<material_slot>& material = renderer.get_material_slots();
+		const unsigned int material_key = material.empty() ? 0 : material[0].texture_id;
+
+		list.begin_packet(command_list::make_sort_key(program.id, material_key, depth, call.is_transparent));
+		list.bind_program(&program);
+		list.set_mat4(model_uniform, model_matrix);
+		if (tiling)
+		{
+			list.set_vec2(tiling_uniform, tiling->tiling);
+			list.set_vec2(offset_uniform, tiling->offset);
+		}
+		list.bind_material(&material);
+		list.draw(call);
+		list.end_packet();
+	}
+}
+
+void model::record_shadow(command_list& list, const shader_program& program, const glm::mat4& model_matrix) const
+{
+	static const string_id model_uniform("model");
+
+	for (const auto& renderer : shadow_renderers)
+	{
+		list.begin_packet(command_list::make_sort_key(program.id, 0, 0.0f, false));
+		list.bind_program(&program);
+		list.set_mat4(model_uniform, model_matrix);
+		list.draw(renderer.get_draw_call());
+		list.end_packet();
+	}
+}
 
 void model::load_model(const std::string& path)
 {
+	cpu_profile_scope scope("Load Model");
+	memory_tag_scope tag(memory_tag::asset_import);
+
 	Assimp::Importer importer;
 	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate |  aiProcess_CalcTangentSpace);
 
@@ -110,21 +141,10 @@ void model::process_node(aiNode* node, const aiScene* scene)
 		//node->mMeshes contains indices of meshes on the global meshes collection scene->mMeshes
 		aiMesh* ai_mesh = scene->mMeshes[node->mMeshes[i]];
 
-		mesh m = process_mesh(ai_mesh, scene);
-		m.should_cull_face = true;
-		m.is_indexed = true;
-		meshes.push_back(m);
-
-		if(is_instanced)
-		{
-			instanced_renderer instanced_rnd = instanced_renderer(std::make_shared<mesh>(m), this->data, this->buffer_size);
-			instanced_renderers.push_back(instanced_rnd);
-		}
-		
-		shadow_renderer shadow_rnd = shadow_renderer(std::make_shared<mesh>(m));
-		shadow_renderers.push_back(shadow_rnd);
-		
-		renderers.emplace_back(std::make_shared<mesh>(m));
+		const std::shared_ptr<mesh> m = std::make_shared<mesh>(process_mesh(ai_mesh, scene));
+		m->should_cull_face = true;
+		m->is_indexed = true;
+		add_mesh(m);
 	}
 
 	for (unsigned int i = 0; i< node->mNumChildren; i++)
@@ -133,12 +153,69 @@ void model::process_node(aiNode* node, const aiScene* scene)
 	}
 }
 
+void model::add_mesh(const std::shared_ptr<mesh>& m)
+{
+	if (cpu_access)
+		m->set_cpu_access(true);
+	
+	meshes.push_back(m);
+
+	//one set of buffers per mesh geometry, every pass gets its own vao over it
+	//all passes share the same mesh instance instead of a copy each
+	const std::shared_ptr<gpu_mesh> gpu = gpu_mesh::acquire(*m);
+
+	if (is_instanced)
+	{
+		instanced_renderer instanced_rnd = instanced_renderer(m, gpu, this->data, this->buffer_size);
+		instanced_renderers.push_back(instanced_rnd);
+	}
+
+	shadow_renderer shadow_rnd = shadow_renderer(m, gpu);
+	shadow_renderers.push_back(shadow_rnd);
+
+	renderers.emplace_back(m, gpu);
+}
+
 mesh model::process_mesh(aiMesh* m, const aiScene* scene)
 {
 	std::vector<vertex> vertices;
 	std::vector<unsigned int> indices;
 	std::vector<texture> textures;
 
+	convert_geometry(m, vertices, indices);
+
+	if(m->mMaterialIndex >= 0)
+	{
+		aiMaterial* material = scene->mMaterials[m->mMaterialIndex];
+		
+
+		
+		std::vector<texture> diffuse_textures = load_material_textures(material, aiTextureType_DIFFUSE, texture_type::diffuse);
+		textures.insert(textures.end(), diffuse_textures.begin(), diffuse_textures.end());
+
+		std::vector<texture> specular_textures = load_material_textures(material, aiTextureType_SPECULAR, texture_type::specular);
+		textures.insert(textures.end(), specular_textures.begin(), specular_textures.end());
+
+		std::vector<texture> normal_textures = load_material_textures(material, aiTextureType_NORMALS, texture_type::normal);
+		textures.insert(textures.end(), normal_textures.begin(), normal_textures.end());
+
+		/*std::vector<texture> reflection_textures = load_material_textures(material, aiTextureType_AMBIENT, texture_type::reflection);
+		textures.insert(textures.end(), reflection_textures.begin(), reflection_textures.end());*/
+	}
+
+	std::cout << "Processed mesh " << m->mName.C_Str() << std::endl << std::endl;
+	return mesh(std::make_shared<mesh_data>(std::move(vertices), std::move(indices)), std::move(textures));
+}
+
+void model::convert_geometry(const aiMesh* m, std::vector<vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	memory_tag_scope tag(memory_tag::meshes);
+
+	vertices.clear();
+	indices.clear();
+	vertices.reserve(m->mNumVertices);
+	indices.reserve(static_cast<size_t>(m->mNumFaces) * 3);
+
 	//process vertices
 	for (unsigned int i = 0; i < m->mNumVertices; i++)
 	{
@@ -179,28 +256,6 @@ mesh model::process_mesh(aiMesh* m, const aiScene* scene)
 			indices.push_back(face.mIndices[j]);
 		}
 	}
-
-	if(m->mMaterialIndex >= 0)
-	{
-		aiMaterial* material = scene->mMaterials[m->mMaterialIndex];
-		
-
-		
-		std::vector<texture> diffuse_textures = load_material_textures(material, aiTextureType_DIFFUSE, texture_type::diffuse);
-		textures.insert(textures.end(), diffuse_textures.begin(), diffuse_textures.end());
-
-		std::vector<texture> specular_textures = load_material_textures(material, aiTextureType_SPECULAR, texture_type::specular);
-		textures.insert(textures.end(), specular_textures.begin(), specular_textures.end());
-
-		std::vector<texture> normal_textures = load_material_textures(material, aiTextureType_NORMALS, texture_type::normal);
-		textures.insert(textures.end(), normal_textures.begin(), normal_textures.end());
-
-		/*std::vector<texture> reflection_textures = load_material_textures(material, aiTextureType_AMBIENT, texture_type::reflection);
-		textures.insert(textures.end(), reflection_textures.begin(), reflection_textures.end());*/
-	}
-
-	std::cout << "Processed mesh " << m->mName.C_Str() << std::endl << std::endl;
-	return mesh(vertices, indices, textures);
 }
 
 std::vector<texture> model::load_material_textures(aiMaterial* mat, aiTextureType type, texture_type tex_type)
@@ -244,15 +299,33 @@ void model::deallocate()
 			rend.deallocate();
 }
 
-std::vector<mesh> model::get_meshes() const
+const std::vector<std::shared_ptr<mesh>>& model::get_meshes() const
 {
 	return meshes;
 }
 
+aabb model::get_bounds() const
+{
+	aabb bounds;
+
+	for (const auto& m : meshes)
+		bounds.expand(m->get_geometry()->get_bounds());
+
+	return bounds;
+}
+
+void model::set_cpu_access(const bool flag)
+{
+	cpu_access = flag;
+
+	for (auto& m : meshes)
+		m->set_cpu_access(flag);
+}
+
 mesh* model::get_mesh_ptr(const int index)
 {
 	if (!is_model_loaded)
 		return nullptr;
-	return renderers[index].get_mesh_ptr().get();
+	return meshes[index].get();
 }
 
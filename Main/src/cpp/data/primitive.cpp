@@ -2,7 +2,7 @@
 
 
 
-mesh create_cube()
+mesh primitive::create_cube()
 {
 	std::vector<vertex> cube_vertices = {
 
@@ -140,7 +140,7 @@ mesh create_cube()
 	return m; // cube
 }
 
-mesh create_quad()
+mesh primitive::create_quad()
 {
 	std::vector<vertex> quad_vertices =
 	{
@@ -223,12 +223,13 @@ mesh create_quad()
 	return m; // Quad
 }
 
-mesh create_sphere()
+mesh primitive::create_sphere()
 {
 	
 	model sphere_model = model("res/models/sphere/scene.gltf", true);
-	sphere_model.get_mesh_ptr(0)->replace_textures({});
-	return *sphere_model.get_mesh_ptr(0);
+	mesh m = *sphere_model.get_mesh_ptr(0);
+	m.replace_textures({});
+	return m;
 }
 
 
@@ -238,7 +239,7 @@ mesh primitive::quad_cache{ std::vector<vertex>() };
 bool primitive::is_initialized{ false };
 
 
-mesh primitive::get_cube()
+const mesh& primitive::get_cube()
 {
 	if(!is_initialized)
 	{
@@ -250,7 +251,7 @@ mesh primitive::get_cube()
 	return cube_cache;
 }
 
-mesh primitive::get_quad()
+const mesh& primitive::get_quad()
 {
 	if (!is_initialized)
 	{
@@ -262,7 +263,7 @@ mesh primitive::get_quad()
 	return quad_cache;
 }
 
-mesh primitive::get_sphere()
+const mesh& primitive::get_sphere()
 {
 	if (!is_initialized)
 	{
@@ -3,146 +3,160 @@
 
 transform::transform(const glm::vec3 pos, const glm::vec3 rot, const glm::vec3 scale)
 {
-	_position = pos;
-	_rotation = rot;
-	_scale = scale;
-	recalculate_directions();
+	index = transform_system::get().create(pos, rot, scale);
 }
 
 transform::transform() : transform(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f))
 {
-	recalculate_directions();
 }
 
-void transform::recalculate_directions()
+transform::transform(const transform& other)
 {
-	_forward.x = cos(glm::radians(_rotation.x)) * cos(glm::radians(_rotation.y));
-	_forward.y = sin(glm::radians(_rotation.x));
-	_forward.z = cos(glm::radians(_rotation.x)) * sin(glm::radians(_rotation.y));
-
-	_forward = glm::normalize(_forward);
-
-	_right = glm::cross(glm::vec3(0, 1, 0), _forward);
-	_right = glm::normalize(_right);
-
-	_up = glm::cross(_forward, _right);
+	index = other.index;
+	transform_system::get().retain(index);
+}
 
-	/*_forward.x = cos(glm::radians(_rotation.x)) * cos(glm::radians(_rotation.y));
-	_forward.y = sin(glm::radians(_rotation.x));
-	_forward.z = cos(glm::radians(_rotation.x)) * sin(glm::radians(_rotation.y));*/
-	
-	/*_forward = glm::vec3((_rotation_mat * glm::vec4(0, 0, 1, 1)));
-	_forward = glm::normalize(_forward);
+transform& transform::operator=(const transform& other)
+{
+	if (index == other.index)
+		return *this;
 
-	_right = glm::cross(glm::vec3(0, 1, 0), _forward);
-	_right = glm::vec3(_rotation_mat * glm::vec4(1, 0, 0, 1));
-	_right = glm::normalize(_right);
+	transform_system::get().retain(other.index);
+	transform_system::get().release(index);
+	index = other.index;
+	return *this;
+}
 
-	_up = glm::cross(_forward, _right);*/
+transform::~transform()
+{
+	transform_system::get().release(index);
+}
 
-	//_forward = glm::vec3((_rotation_mat * glm::vec4(0, 1, 0, 1)));
+transform transform::clone() const
+{
+	return transform(position(), rotation(), scale());
+}
 
+unsigned int transform::get_index() const
+{
+	return index;
 }
 
 glm::mat4 transform::get_model_matrix() const
 {
-	auto model = glm::mat4(1.0f);
+	return transform_system::get().get_world_matrix(index);
+}
 
-	//order is actually scale -> rotate -> translate
-	//glm matrices
-	
-	model = glm::translate(model, this->position());
-	model = glm::rotate(model, glm::radians(_rotation.x), right_basis);
-	model = glm::rotate(model, glm::radians(_rotation.y), up_basis);
-	model = glm::rotate(model, glm::radians(_rotation.z), forward_basis);
-	model = glm::scale(model, this->_scale);
-	return model;
+const glm::mat4& transform::get_cached_model_matrix() const
+{
+	return transform_system::get().get_cached_world_matrix(index);
 }
 
 void transform::set_position(const glm::vec3 pos)
 {
-	_position = pos;
+	auto& system = transform_system::get();
+	system.positions[index] = pos;
+	system.mark_dirty(index);
 }
 
 void transform::set_rotation(const glm::vec3 rot)
 {
-	_rotation = rot;
-	_rotation_mat = glm::yawPitchRoll(rot.x, rot.y, rot.z);
-	recalculate_directions();
+	auto& system = transform_system::get();
+	system.euler_angles[index] = rot;
+	system.rotations[index] = transform_system::euler_to_quat(rot);
+	system.recalculate_directions(index);
+	system.mark_dirty(index);
+}
+
+void transform::set_rotation(const glm::quat& rot)
+{
+	auto& system = transform_system::get();
+	system.rotations[index] = rot;
+	system.euler_angles[index] = glm::degrees(glm::eulerAngles(rot));
+	system.recalculate_directions(index);
+	system.mark_dirty(index);
 }
 
 void transform::set_scale(const glm::vec3 scale)
 {
-	_scale = scale;
+	auto& system = transform_system::get();
+	system.scales[index] = scale;
+	system.mark_dirty(index);
 }
 
-glm::vec3 transform::position() const
+void transform::set_parent(const transform* parent)
 {
-	return _position;
+	transform_system::get().set_parent(index, parent != nullptr ? static_cast<int>(parent->index) : transform_system::NO_PARENT);
 }
 
+bool transform::has_parent() const
+{
+	return transform_system::get().get_parent(index) != transform_system::NO_PARENT;
+}
 
+glm::vec3 transform::position() const
+{
+	return transform_system::get().positions[index];
+}
 
 glm::vec3 transform::rotation() const
 {
-	return _rotation;
+	return transform_system::get().euler_angles[index];
 }
 
-glm::mat4x4 transform::rotation_mat() const
+glm::quat transform::rotation_quat() const
 {
-	return _rotation_mat;
+	return transform_system::get().rotations[index];
 }
 
+glm::mat4x4 transform::rotation_mat() const
+{
+	return glm::mat4_cast(transform_system::get().rotations[index]);
+}
 
 glm::vec3 transform::scale() const
 {
-	return _scale;
+	return transform_system::get().scales[index];
 }
 
 glm::vec3* transform::position_ptr()
 {
-	return &_position;
+	auto& system = transform_system::get();
+	system.mark_dirty(index);
+	return &system.positions[index];
 }
 
 glm::vec3* transform::rotation_ptr()
 {
-	return &_rotation;
+	auto& system = transform_system::get();
+	system.mark_dirty(index);
+	system.flags[index] |= transform_system::EULER_DIRTY;
+	return &system.euler_angles[index];
 }
 
-
 glm::vec3* transform::scale_ptr()
 {
-	return &_scale;
+	auto& system = transform_system::get();
+	system.mark_dirty(index);
+	return &system.scales[index];
 }
 
-
 glm::vec3 transform::forward() const
 {
-	return _forward;
+	return transform_system::get().forwards[index];
 }
 
 glm::vec3 transform::right() const
 {
-	return _right;
+	return transform_system::get().rights[index];
 }
 
 glm::vec3 transform::up() const
 {
-	return _up;
+	return transform_system::get().ups[index];
 }
 
 glm::vec3* transform::forward_ptr()
 {
-	return &_forward;
+	return &transform_system::get().forwards[index];
 }
-
-
-
-
-
-
-
-
-
-
-
@@ -0,0 +1,401 @@
+#include "data/transform_system.h"
+
+#include <algorithm>
+
+#include "engine/job_system.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSFORM_SYSTEM_SSE
+#endif
+
+transform_system& transform_system::get()
+{
+	static transform_system system;
+	return system;
+}
+
+unsigned int transform_system::create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+{
+	unsigned int index;
+
+	if (!free_slots.empty())
+	{
+		index = free_slots.back();
+		free_slots.pop_back();
+	}
+	else
+	{
+		index = static_cast<unsigned int>(positions.size());
+		positions.emplace_back();
+		euler_angles.emplace_back();
+		rotations.emplace_back();
+		scales.emplace_back();
+		forwards.emplace_back();
+		ups.emplace_back();
+		rights.emplace_back();
+		local_matrices.emplace_back();
+		world_matrices.emplace_back();
+		parents.emplace_back();
+		depths.emplace_back();
+		flags.emplace_back();
+		ref_counts.emplace_back();
+	}
+
+	positions[index] = position;
+	euler_angles[index] = rotation;
+	rotations[index] = euler_to_quat(rotation);
+	scales[index] = scale;
+	parents[index] = NO_PARENT;
+	depths[index] = 0;
+	ref_counts[index] = 1;
+	flags[index] = LOCAL_DIRTY;
+	compose(position, rotations[index], scale, local_matrices[index]);
+	world_matrices[index] = local_matrices[index];
+	recalculate_directions(index);
+
+	dirty_count++;
+	is_order_dirty = true;
+	return index;
+}
+
+void transform_system::retain(const unsigned int index)
+{
+	ref_counts[index]++;
+}
+
+void transform_system::release(const unsigned int index)
+{
+	if (ref_counts[index] == 0 || --ref_counts[index] > 0)
+		return;
+
+	if (flags[index] & LOCAL_DIRTY)
+		dirty_count--;
+	flags[index] = 0;
+
+	//orphans keep their local transform and become roots
+	for (unsigned int i = 0; i < parents.size(); i++)
+	{
+		if (parents[i] == static_cast<int>(index))
+		{
+			parents[i] = NO_PARENT;
+			mark_dirty(i);
+		}
+	}
+
+	parents[index] = NO_PARENT;
+	free_slots.push_back(index);
+	is_order_dirty = true;
+}
+
+void transform_system::set_parent(const unsigned int index, const int parent)
+{
+	if (parent == static_cast<int>(index))
+		return;
+
+	//refuse links that would close a loop
+	for (int p = parent; p != NO_PARENT; p = parents[p])
+	{
+		if (p == static_cast<int>(index))
+			return;
+	}
+
+	parents[index] = parent;
+	mark_dirty(index);
+	is_order_dirty = true;
+}
+
+int transform_system::get_parent(const unsigned int index) const
+{
+	return parents[index];
+}
+
+void transform_system::mark_dirty(const unsigned int index)
+{
+	if (!(flags[index] & LOCAL_DIRTY))
+	{
+		flags[index] |= LOCAL_DIRTY;
+		dirty_count++;
+	}
+}
+
+bool transform_system::has_dirty() const
+{
+	return dirty_count > 0 || is_order_dirty;
+}
+
+void transform_system::update()
+{
+	if (!has_dirty())
+		return;
+
+	rebuild_order();
+
+	for (unsigned int level = 0; level < get_level_count(); level++)
+	{
+		unsigned int begin, end;
+		get_level_range(level, begin, end);
+
+		//slots within a level never depend on each other, only on the level above
+		job_system::get().parallel_for(end - begin, PARALLEL_BATCH, [this, begin](const unsigned int first, const unsigned int last)
+			{
+				update_range(begin + first, begin + last);
+			});
+	}
+
+	clear_dirty();
+}
+
+void transform_system::rebuild_order()
+{
+	if (!is_order_dirty)
+		return;
+
+	order.clear();
+	unsigned int max_depth = 0;
+
+	for (unsigned int i = 0; i < positions.size(); i++)
+	{
+		if (ref_counts[i] == 0)
+			continue;
+
+		depths[i] = compute_depth(i);
+		max_depth = std::max(max_depth, depths[i]);
+		order.push_back(i);
+	}
+
+	std::stable_sort(order.begin(), order.end(), [this](const unsigned int a, const unsigned int b)
+		{
+			return depths[a] < depths[b];
+		});
+
+	level_offsets.assign(max_depth + 2, static_cast<unsigned int>(order.size()));
+	for (unsigned int i = static_cast<unsigned int>(order.size()); i-- > 0;)
+		level_offsets[depths[order[i]]] = i;
+
+	//empty levels start where the next one does
+	for (unsigned int level = max_depth; level-- > 0;)
+		level_offsets[level] = std::min(level_offsets[level], level_offsets[level + 1]);
+
+	is_order_dirty = false;
+}
+
+unsigned int transform_system::get_level_count() const
+{
+	return level_offsets.empty() ? 0 : static_cast<unsigned int>(level_offsets.size()) - 1;
+}
+
+void transform_system::get_level_range(const unsigned int level, unsigned int& begin, unsigned int& end) const
+{
+	begin = level_offsets[level];
+	end = level_offsets[level + 1];
+}
+
+void transform_system::update_range(const unsigned int begin, const unsigned int end)
+{
+	//local matrices first, gathered four at a time for the batched compose
+	unsigned int batch[4];
+	unsigned int batch_count = 0;
+
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const unsigned int index = order[i];
+		const unsigned char flag = flags[index];
+
+		if (flag & EULER_DIRTY)
+		{
+			rotations[index] = euler_to_quat(euler_angles[index]);
+			recalculate_directions(index);
+		}
+
+		if (!(flag & LOCAL_DIRTY))
+			continue;
+
+		batch[batch_count++] = index;
+		if (batch_count == 4)
+		{
+			compose_batch(batch);
+			batch_count = 0;
+		}
+	}
+
+	for (unsigned int i = 0; i < batch_count; i++)
+		compose(positions[batch[i]], rotations[batch[i]], scales[batch[i]], local_matrices[batch[i]]);
+
+	//then world matrices, the parents are a level up and already final
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const unsigned int index = order[i];
+		const unsigned char flag = flags[index];
+
+		const int parent = parents[index];
+		const bool parent_changed = parent != NO_PARENT && (flags[parent] & WORLD_CHANGED);
+
+		if (!(flag & LOCAL_DIRTY) && !parent_changed)
+			continue;
+
+		if (parent == NO_PARENT)
+			world_matrices[index] = local_matrices[index];
+		else
+			multiply(world_matrices[parent], local_matrices[index], world_matrices[index]);
+
+		flags[index] |= WORLD_CHANGED;
+	}
+}
+
+void transform_system::clear_dirty()
+{
+	for (const unsigned int index : order)
+		flags[index] = 0;
+
+	dirty_count = 0;
+}
+
+glm::mat4 transform_system::get_world_matrix(const unsigned int index) const
+{
+	if (!has_dirty())
+		return world_matrices[index];
+
+	glm::mat4 world(1.0f);
+	for (int i = static_cast<int>(index); i != NO_PARENT; i = parents[i])
+	{
+		const glm::quat rotation = flags[i] & EULER_DIRTY ? euler_to_quat(euler_angles[i]) : rotations[i];
+
+		glm::mat4 local;
+		compose(positions[i], rotation, scales[i], local);
+
+		const glm::mat4 child = world;
+		multiply(local, child, world);
+	}
+
+	return world;
+}
+
+const glm::mat4& transform_system::get_cached_world_matrix(const unsigned int index) const
+{
+	return world_matrices[index];
+}
+
+unsigned int transform_system::get_count() const
+{
+	return static_cast<unsigned int>(positions.size() - free_slots.size());
+}
+
+void transform_system::recalculate_directions(const unsigned int index)
+{
+	const glm::vec3& rotation = euler_angles[index];
+	glm::vec3 forward;
+
+	forward.x = cos(glm::radians(rotation.x)) * cos(glm::radians(rotation.y));
+	forward.y = sin(glm::radians(rotation.x));
+	forward.z = cos(glm::radians(rotation.x)) * sin(glm::radians(rotation.y));
+
+	forwards[index] = glm::normalize(forward);
+	rights[index] = glm::normalize(glm::cross(glm::vec3(0, 1, 0), forwards[index]));
+	ups[index] = glm::cross(forwards[index], rights[index]);
+}
+
+unsigned int transform_system::compute_depth(const unsigned int index) const
+{
+	unsigned int depth = 0;
+	for (int p = parents[index]; p != NO_PARENT; p = parents[p])
+		depth++;
+	return depth;
+}
+
+glm::quat transform_system::euler_to_quat(const glm::vec3& euler_degrees)
+{
+	//same x -> y -> z order the old translate/rotate/rotate/rotate/scale chain used
+	return glm::angleAxis(glm::radians(euler_degrees.x), glm::vec3(1, 0, 0)) *
+		glm::angleAxis(glm::radians(euler_degrees.y), glm::vec3(0, 1, 0)) *
+		glm::angleAxis(glm::radians(euler_degrees.z), glm::vec3(0, 0, 1));
+}
+
+void transform_system::compose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& out)
+{
+	const glm::mat3 r = glm::mat3_cast(rotation);
+
+	out[0] = glm::vec4(r[0] * scale.x, 0.0f);
+	out[1] = glm::vec4(r[1] * scale.y, 0.0f);
+	out[2] = glm::vec4(r[2] * scale.z, 0.0f);
+	out[3] = glm::vec4(position, 1.0f);
+}
+
+void transform_system::compose_batch(const unsigned int* indices)
+{
+#ifdef TRANSFORM_SYSTEM_SSE
+	const glm::quat& q0 = rotations[indices[0]];
+	const glm::quat& q1 = rotations[indices[1]];
+	const glm::quat& q2 = rotations[indices[2]];
+	const glm::quat& q3 = rotations[indices[3]];
+
+	//lane k holds slot indices[k]
+	const __m128 x = _mm_set_ps(q3.x, q2.x, q1.x, q0.x);
+	const __m128 y = _mm_set_ps(q3.y, q2.y, q1.y, q0.y);
+	const __m128 z = _mm_set_ps(q3.z, q2.z, q1.z, q0.z);
+	const __m128 w = _mm_set_ps(q3.w, q2.w, q1.w, q0.w);
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+	const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+	const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+	const __m128 sx = _mm_set_ps(scales[indices[3]].x, scales[indices[2]].x, scales[indices[1]].x, scales[indices[0]].x);
+	const __m128 sy = _mm_set_ps(scales[indices[3]].y, scales[indices[2]].y, scales[indices[1]].y, scales[indices[0]].y);
+	const __m128 sz = _mm_set_ps(scales[indices[3]].z, scales[indices[2]].z, scales[indices[1]].z, scales[indices[0]].z);
+
+	//the same terms glm::mat3_cast produces, column by column, each column scaled by its axis
+	__m128 terms[9];
+	terms[0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+	terms[1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+	terms[2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+	terms[3] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+	terms[4] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+	terms[5] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+	terms[6] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+	terms[7] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+	terms[8] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+	alignas(16) float lanes[9][4];
+	for (int t = 0; t < 9; t++)
+		_mm_store_ps(lanes[t], terms[t]);
+
+	for (int k = 0; k < 4; k++)
+	{
+		glm::mat4& out = local_matrices[indices[k]];
+		out[0] = glm::vec4(lanes[0][k], lanes[1][k], lanes[2][k], 0.0f);
+		out[1] = glm::vec4(lanes[3][k], lanes[4][k], lanes[5][k], 0.0f);
+		out[2] = glm::vec4(lanes[6][k], lanes[7][k], lanes[8][k], 0.0f);
+		out[3] = glm::vec4(positions[indices[k]], 1.0f);
+	}
+#else
+	for (int k = 0; k < 4; k++)
+		compose(positions[indices[k]], rotations[indices[k]], scales[indices[k]], local_matrices[indices[k]]);
+#endif
+}
+
+void transform_system::multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+#ifdef TRANSFORM_SYSTEM_SSE
+	const float* pa = &a[0][0];
+	const float* pb = &b[0][0];
+	float* po = &out[0][0];
+
+	const __m128 a0 = _mm_loadu_ps(pa);
+	const __m128 a1 = _mm_loadu_ps(pa + 4);
+	const __m128 a2 = _mm_loadu_ps(pa + 8);
+	const __m128 a3 = _mm_loadu_ps(pa + 12);
+
+	for (int c = 0; c < 4; c++)
+	{
+		__m128 column = _mm_mul_ps(a0, _mm_set1_ps(pb[c * 4 + 0]));
+		column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(pb[c * 4 + 1])));
+		column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(pb[c * 4 + 2])));
+		column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(pb[c * 4 + 3])));
+		_mm_storeu_ps(po + c * 4, column);
+	}
+#else
+	out = a * b;
+#endif
+}
@@ -0,0 +1,365 @@
+#include "engine/benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+#include "rendering/gpu_memory.h"
+#include "rendering/gpu_profiler.h"
+#include "utils/cpu_profiler.h"
+#include "utils/memory_tracker.h"
+#include "utils/process_memory.h"
+
+const float benchmark::NOISE_FLOOR = 0.05f;
+
+namespace
+{
+	void print_usage()
+	{
+		std::cout << "usage: Main [--benchmark] [--headless] [--egl] [--null-backend] [--frames n] [--warmup n] [--width w] [--height h]\n"
+			"            [--camera-path file] [--output file] [--baseline file] [--tolerance t]\n"
+			"            [--objects n] [--lights n] [--materials n] [--seed n] [--capture file] [--capture-frames n]\n"
+			"            [--gpu-budget-mb n] [--assert-no-alloc]" << std::endl;
+	}
+
+	bool read_unsigned(const int argc, char** argv, int& i, unsigned int& out)
+	{
+		if (i + 1 >= argc)
+			return false;
+
+		char* end;
+		const unsigned long value = std::strtoul(argv[++i], &end, 10);
+		if (*end != '\0')
+			return false;
+
+		out = static_cast<unsigned int>(value);
+		return true;
+	}
+}
+
+bool benchmark::parse_args(const int argc, char** argv, settings& out)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		bool is_valid = true;
+
+		if (std::strcmp(arg, "--benchmark") == 0)
+			out.is_enabled = true;
+		else if (std::strcmp(arg, "--headless") == 0)
+			out.is_enabled = out.is_headless = true;
+		else if (std::strcmp(arg, "--egl") == 0)
+			out.use_egl = true;
+		else if (std::strcmp(arg, "--null-backend") == 0)
+			out.use_null_backend = true;
+		else if (std::strcmp(arg, "--frames") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.frames);
+		else if (std::strcmp(arg, "--warmup") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.warmup_frames);
+		else if (std::strcmp(arg, "--width") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.width);
+		else if (std::strcmp(arg, "--height") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.height);
+		else if (std::strcmp(arg, "--camera-path") == 0 && i + 1 < argc)
+			out.camera_path = argv[++i];
+		else if (std::strcmp(arg, "--output") == 0 && i + 1 < argc)
+			out.output = argv[++i];
+		else if (std::strcmp(arg, "--baseline") == 0 && i + 1 < argc)
+			out.baseline = argv[++i];
+		else if (std::strcmp(arg, "--tolerance") == 0 && i + 1 < argc)
+			out.tolerance = std::strtof(argv[++i], nullptr);
+		else if (std::strcmp(arg, "--objects") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.stress.object_count);
+		else if (std::strcmp(arg, "--lights") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.stress.light_count);
+		else if (std::strcmp(arg, "--materials") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.stress.material_count) && out.stress.material_count > 0;
+		else if (std::strcmp(arg, "--seed") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.stress.seed);
+		else if (std::strcmp(arg, "--capture") == 0 && i + 1 < argc)
+			out.capture_path = argv[++i];
+		else if (std::strcmp(arg, "--capture-frames") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.capture_frames) && out.capture_frames > 0;
+		else if (std::strcmp(arg, "--gpu-budget-mb") == 0)
+			is_valid = read_unsigned(argc, argv, i, out.gpu_budget_mb);
+		else if (std::strcmp(arg, "--assert-no-alloc") == 0)
+			out.assert_no_allocations = true;
+		else
+			is_valid = false;
+
+		if (!is_valid)
+		{
+			std::cout << "Bad argument " << arg << std::endl;
+			print_usage();
+			return false;
+		}
+	}
+
+	if (out.frames == 0 || out.width == 0 || out.height == 0)
+	{
+		std::cout << "Frames and resolution have to be above zero" << std::endl;
+		print_usage();
+		return false;
+	}
+
+	if (!out.capture_path.empty() && out.use_null_backend)
+	{
+		std::cout << "A capture records the gl calls, it cannot run on the null backend" << std::endl;
+		print_usage();
+		return false;
+	}
+
+	return true;
+}
+
+benchmark::benchmark(const settings& s) : config(s)
+{
+	cpu_ms.reserve(config.frames);
+	gpu_ms.reserve(config.frames);
+}
+
+const benchmark::settings& benchmark::get_settings() const
+{
+	return config;
+}
+
+bool benchmark::is_done() const
+{
+	return frame >= config.warmup_frames + config.frames;
+}
+
+bool benchmark::is_measuring() const
+{
+	return frame >= config.warmup_frames;
+}
+
+float benchmark::get_progress() const
+{
+	const unsigned int total = config.warmup_frames + config.frames;
+	return total > 1 ? std::min(frame / static_cast<float>(total - 1), 1.0f) : 0.0f;
+}
+
+void benchmark::add_gpu_sample(const float gpu_ms)
+{
+	//the timer lags a few frames, close enough for cutting the warmup off
+	if (is_measuring())
+		this->gpu_ms.push_back(gpu_ms);
+}
+
+void benchmark::end_frame(const float cpu_ms, const render_counters& total, const std::vector<pass_counters>& passes)
+{
+	//the run's own bookkeeping, kept out of the rendering allocations it is measuring
+	memory_tag_scope tag(memory_tag::other);
+
+	if (is_measuring())
+	{
+		this->cpu_ms.push_back(cpu_ms);
+		totals += total;
+		allocations += memory_tracker::get_frame_allocations();
+		peak_gpu_memory = std::max(peak_gpu_memory, gpu_memory::get_total());
+
+		for (const pass_counters& pass : passes)
+		{
+			const auto it = std::find_if(pass_totals.begin(), pass_totals.end(),
+				[&](const pass_counters& p) { return p.name == pass.name; });
+
+			if (it == pass_totals.end())
+				pass_totals.push_back(pass);
+			else
+				it->counters += pass.counters;
+		}
+
+		if ((frame - config.warmup_frames) % MEMORY_SAMPLE_INTERVAL == 0)
+			peak_memory = std::max(peak_memory, get_process_memory_bytes());
+	}
+
+	frame++;
+}
+
+bool benchmark::write_report(const std::string& renderer, const std::string& backend) const
+{
+	std::ofstream file(config.output);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << config.output << " for the benchmark report" << std::endl;
+		return false;
+	}
+
+	const double frames = std::max<std::size_t>(cpu_ms.size(), 1);
+	const std::vector<gpu_profiler::scope_stats> gpu_stats = gpu_profiler::get().get_stats();
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\n\"renderer\":";
+	cpu_profiler::write_json_string(file, renderer.c_str());
+	file << ",\"backend\":";
+	cpu_profiler::write_json_string(file, backend.c_str());
+	file << ",\n\"width\":" << config.width << ",\"height\":" << config.height
+		<< ",\"frames\":" << cpu_ms.size() << ",\"warmup_frames\":" << config.warmup_frames << ",\n\"camera_path\":";
+	cpu_profiler::write_json_string(file, config.camera_path.c_str());
+	file << ",\n\"objects\":" << config.stress.object_count << ",\"lights\":" << config.stress.light_count
+		<< ",\"materials\":" << config.stress.material_count << ",\"seed\":" << config.stress.seed;
+
+	file << ",\n\"metrics\":{";
+	const std::vector<std::pair<std::string, double>> metrics = get_metrics();
+	for (std::size_t i = 0; i < metrics.size(); i++)
+	{
+		file << (i == 0 ? "\n" : ",\n");
+		cpu_profiler::write_json_string(file, metrics[i].first.c_str());
+		file << ":" << metrics[i].second;
+	}
+	file << "\n},\n\"passes\":[";
+
+	//gpu times are the profiler's rolling window, the tail of the run
+	for (std::size_t i = 0; i < pass_totals.size(); i++)
+	{
+		const pass_counters& pass = pass_totals[i];
+		const auto stats = std::find_if(gpu_stats.begin(), gpu_stats.end(),
+			[&](const gpu_profiler::scope_stats& s) { return s.name == pass.name.get_string(); });
+
+		file << (i == 0 ? "\n{\"name\":" : ",\n{\"name\":");
+		cpu_profiler::write_json_string(file, pass.name.c_str());
+		if (stats != gpu_stats.end())
+			file << ",\"gpu_avg_ms\":" << stats->avg_ms << ",\"gpu_p99_ms\":" << stats->p99_ms;
+		file << ",\"draw_calls\":" << pass.counters.draw_calls / frames
+			<< ",\"triangles\":" << pass.counters.triangles / frames
+			<< ",\"program_binds\":" << pass.counters.program_binds / frames
+			<< ",\"texture_binds\":" << pass.counters.texture_binds / frames
+			<< ",\"uniform_calls\":" << pass.counters.uniform_calls / frames << "}";
+	}
+	file << "\n]\n}\n";
+
+	std::cout << "Benchmark: " << cpu_ms.size() << " frames at " << config.width << " x " << config.height
+		<< ", wrote " << config.output << std::endl;
+	return true;
+}
+
+bool benchmark::compare_baseline() const
+{
+	std::vector<std::pair<std::string, double>> baseline;
+
+	if (!read_metrics(config.baseline, baseline))
+	{
+		std::cout << "Failed to read baseline metrics from " << config.baseline << std::endl;
+		return false;
+	}
+
+	unsigned int regressions = 0;
+
+	for (const auto& metric : get_metrics())
+	{
+		const auto base = std::find_if(baseline.begin(), baseline.end(),
+			[&](const std::pair<std::string, double>& b) { return b.first == metric.first; });
+
+		if (base == baseline.end())
+			continue;
+
+		//every metric is lower is better
+		const bool is_regression = metric.second > base->second * (1.0 + config.tolerance)
+			&& metric.second - base->second > NOISE_FLOOR;
+		regressions += is_regression ? 1 : 0;
+
+		std::cout << (is_regression ? "REGRESSED " : "          ") << metric.first << ": " << base->second << " -> " << metric.second
+			<< " (" << std::showpos << (base->second > 0 ? (metric.second / base->second - 1.0) * 100.0 : 0.0) << std::noshowpos << "%)" << std::endl;
+	}
+
+	std::cout << regressions << " regressions against " << config.baseline << " at " << config.tolerance * 100.0f << "% tolerance" << std::endl;
+	return regressions == 0;
+}
+
+std::vector<std::pair<std::string, double>> benchmark::get_metrics() const
+{
+	std::vector<std::pair<std::string, double>> metrics;
+	const double frames = std::max<std::size_t>(cpu_ms.size(), 1);
+
+	const auto add_times = [&](const char* prefix, const std::vector<float>& samples)
+	{
+		if (samples.empty())
+			return;
+
+		const std::string name(prefix);
+		metrics.emplace_back(name + "_avg", std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size());
+		metrics.emplace_back(name + "_p50", percentile(samples, 0.5f));
+		metrics.emplace_back(name + "_p90", percentile(samples, 0.9f));
+		metrics.emplace_back(name + "_p99", percentile(samples, 0.99f));
+		metrics.emplace_back(name + "_max", *std::max_element(samples.begin(), samples.end()));
+	};
+
+	add_times("cpu_ms", cpu_ms);
+	add_times("gpu_ms", gpu_ms);
+
+	metrics.emplace_back("draw_calls", totals.draw_calls / frames);
+	metrics.emplace_back("triangles", totals.triangles / frames);
+	metrics.emplace_back("program_binds", totals.program_binds / frames);
+	metrics.emplace_back("texture_binds", totals.texture_binds / frames);
+	metrics.emplace_back("uniform_calls", totals.uniform_calls / frames);
+	metrics.emplace_back("buffer_upload_bytes", totals.buffer_upload_bytes / frames);
+	metrics.emplace_back("peak_memory_mb", peak_memory / (1024.0 * 1024.0));
+	metrics.emplace_back("gpu_memory_mb", peak_gpu_memory / (1024.0 * 1024.0));
+	//without the global hooks the count would only be imgui and decoding, not worth gating on
+	if (memory_tracker::is_hooked())
+		metrics.emplace_back("allocations_per_frame", allocations / frames);
+
+	for (const gpu_profiler::scope_stats& stats : gpu_profiler::get().get_stats())
+		metrics.emplace_back(stats.name + " gpu_ms", stats.avg_ms);
+
+	return metrics;
+}
+
+bool benchmark::read_metrics(const std::string& path, std::vector<std::pair<std::string, double>>& metrics)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open())
+		return false;
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	const std::string json = stream.str();
+
+	//only the flat "metrics" object of a report written by write_report is read
+	std::size_t at = json.find("\"metrics\"");
+	if (at == std::string::npos || (at = json.find('{', at)) == std::string::npos)
+		return false;
+
+	const std::size_t end = json.find('}', at);
+
+	while (true)
+	{
+		const std::size_t key_start = json.find('"', at + 1);
+		if (key_start == std::string::npos || key_start > end)
+			break;
+
+		std::string key;
+		std::size_t c = key_start + 1;
+		for (; c < json.size() && json[c] != '"'; c++)
+		{
+			if (json[c] == '\\' && c + 1 < json.size())
+				c++;
+			key += json[c];
+		}
+
+		const std::size_t colon = json.find(':', c);
+		if (colon == std::string::npos || colon > end)
+			return false;
+
+		char* value_end;
+		const double value = std::strtod(json.c_str() + colon + 1, &value_end);
+		metrics.emplace_back(key, value);
+		at = static_cast<std::size_t>(value_end - json.c_str());
+	}
+
+	return !metrics.empty();
+}
+
+float benchmark::percentile(std::vector<float> samples, const float p)
+{
+	const std::size_t index = std::min(static_cast<std::size_t>(p * samples.size()), samples.size() - 1);
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
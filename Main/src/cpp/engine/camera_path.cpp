@@ -0,0 +1,94 @@
+#include "engine/camera_path.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+bool camera_path::load(const std::string& path)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open camera path " << path << std::endl;
+		return false;
+	}
+
+	keyframes.clear();
+
+	keyframe k{};
+	while (file >> k.time >> k.position.x >> k.position.y >> k.position.z >> k.rotation.x >> k.rotation.y >> k.rotation.z)
+		add(k.time, k.position, k.rotation);
+
+	if (keyframes.empty())
+	{
+		std::cout << "Camera path " << path << " has no keyframes" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool camera_path::save(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to write camera path " << path << std::endl;
+		return false;
+	}
+
+	for (const keyframe& k : keyframes)
+	{
+		file << k.time << " " << k.position.x << " " << k.position.y << " " << k.position.z << " "
+			<< k.rotation.x << " " << k.rotation.y << " " << k.rotation.z << "\n";
+	}
+
+	return true;
+}
+
+void camera_path::clear()
+{
+	keyframes.clear();
+}
+
+void camera_path::add(const float time, const glm::vec3& position, const glm::vec3& rotation)
+{
+	if (!keyframes.empty() && time <= keyframes.back().time)
+		return;
+
+	keyframes.push_back({ time, position, rotation });
+}
+
+camera_path::keyframe camera_path::sample(const float time) const
+{
+	if (keyframes.empty())
+		return { time, glm::vec3(0.0f), glm::vec3(0.0f) };
+
+	const float at = keyframes.front().time + time;
+
+	if (at <= keyframes.front().time)
+		return keyframes.front();
+
+	if (at >= keyframes.back().time)
+		return keyframes.back();
+
+	const auto next = std::upper_bound(keyframes.begin(), keyframes.end(), at,
+		[](const float t, const keyframe& k) { return t < k.time; });
+	const keyframe& a = *(next - 1);
+	const keyframe& b = *next;
+
+	const float t = (at - a.time) / (b.time - a.time);
+	return { at, glm::mix(a.position, b.position, t), glm::mix(a.rotation, b.rotation, t) };
+}
+
+float camera_path::get_duration() const
+{
+	return keyframes.empty() ? 0.0f : keyframes.back().time - keyframes.front().time;
+}
+
+bool camera_path::is_empty() const
+{
+	return keyframes.empty();
+}
@@ -0,0 +1,191 @@
+#include "engine/flight_recorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "rendering/gpu_profiler.h"
+#include "utils/cpu_profiler.h"
+#include "utils/memory_tracker.h"
+
+namespace
+{
+	//trace thread the per frame spans and counters go on, clear of real thread indices
+	const unsigned int FRAMES_TID = 1000;
+	const float AVERAGE_WEIGHT = 0.05f;
+}
+
+flight_recorder::flight_recorder()
+{
+	frames.resize(FRAME_COUNT);
+
+	for (frame_record& frame : frames)
+		frame.counters.reserve(16);
+}
+
+void flight_recorder::begin_frame(const unsigned long long gpu_frame)
+{
+	if (!is_enabled)
+		return;
+
+	frame_record& frame = get_current();
+	frame.number = frame_count;
+	frame.gpu_frame = gpu_frame;
+	frame.start_ns = cpu_profiler::now_ns();
+	frame.end_ns = 0;
+	frame.counters.clear();
+}
+
+void flight_recorder::set_counter(const char* name, const float value)
+{
+	if (!is_enabled)
+		return;
+
+	auto& counters = get_current().counters;
+
+	for (auto& counter : counters)
+	{
+		if (counter.first == name)
+		{
+			counter.second = value;
+			return;
+		}
+	}
+
+	counters.emplace_back(name, value);
+}
+
+void flight_recorder::end_frame()
+{
+	frame_record& frame = get_current();
+
+	//switched on mid frame, there is no start to measure from
+	if (!is_enabled || frame.number != frame_count || frame.start_ns == 0)
+		return;
+
+	frame.end_ns = cpu_profiler::now_ns();
+	const float ms = static_cast<float>(frame.end_ns - frame.start_ns) / 1000000.0f;
+
+	if (frame_count >= WARMUP_FRAMES && !is_dump_pending)
+	{
+		if (ms > threshold_ms)
+			trigger("over threshold");
+		else if (average_ms > 0 && ms > average_ms * spike_ratio)
+			trigger("spike over average");
+	}
+
+	average_ms = average_ms > 0 ? average_ms + (ms - average_ms) * AVERAGE_WEIGHT : ms;
+	frame_count++;
+
+	if (is_dump_pending && frame_count > spike_frame + CONTEXT_AFTER)
+	{
+		write_dump();
+		is_dump_pending = false;
+	}
+}
+
+void flight_recorder::trigger(const char* reason)
+{
+	//a hitch inside the context of the previous one is already in that dump
+	if (is_dump_pending)
+		return;
+
+	is_dump_pending = true;
+	spike_frame = frame_count;
+	spike_reason = reason;
+}
+
+unsigned int flight_recorder::get_dump_count() const
+{
+	return dump_count;
+}
+
+const std::string& flight_recorder::get_last_dump() const
+{
+	return last_dump;
+}
+
+float flight_recorder::get_average_ms() const
+{
+	return average_ms;
+}
+
+flight_recorder::frame_record& flight_recorder::get_current()
+{
+	return frames[frame_count % FRAME_COUNT];
+}
+
+void flight_recorder::write_dump()
+{
+	//the dump runs inside a frame but is not part of rendering it
+	memory_tag_scope tag(memory_tag::other);
+
+	const unsigned long long oldest = frame_count > FRAME_COUNT ? frame_count - FRAME_COUNT : 0;
+	const unsigned long long first = std::max(oldest, spike_frame > CONTEXT_BEFORE ? spike_frame - CONTEXT_BEFORE : 0);
+	const unsigned long long last = frame_count - 1;
+
+	const frame_record& spike = frames[spike_frame % FRAME_COUNT];
+	const std::string path = std::string("hitch_").append(std::to_string(spike_frame)).append(".json");
+
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << path << " for the flight recorder" << std::endl;
+		return;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"flight recorder\"}}";
+	file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << FRAMES_TID << ",\"args\":{\"name\":\"frames\"}}";
+
+	cpu_profiler::get().write_trace_events(file, frames[first % FRAME_COUNT].start_ns, frames[last % FRAME_COUNT].end_ns);
+
+	std::vector<std::pair<std::string, float>> gpu_timings;
+
+	for (unsigned long long n = first; n <= last; n++)
+	{
+		const frame_record& frame = frames[n % FRAME_COUNT];
+		const double ts = frame.start_ns / 1000.0;
+
+		file << ",\n{\"name\":\"Frame " << frame.number << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << FRAMES_TID
+			<< ",\"ts\":" << ts << ",\"dur\":" << (frame.end_ns - frame.start_ns) / 1000.0
+			<< ",\"args\":{\"gpu frame\":" << frame.gpu_frame << "}}";
+
+		if (!frame.counters.empty())
+		{
+			file << ",\n{\"name\":\"Counters\",\"ph\":\"C\",\"pid\":0,\"ts\":" << ts << ",\"args\":{";
+			for (std::size_t i = 0; i < frame.counters.size(); i++)
+			{
+				file << (i == 0 ? "" : ",");
+				cpu_profiler::write_json_string(file, frame.counters[i].first);
+				file << ":" << frame.counters[i].second;
+			}
+			file << "}}";
+		}
+
+		//the last few frames are still in flight on the gpu and simply have no timings yet
+		if (gpu_profiler::get().get_frame_timings(frame.gpu_frame, gpu_timings) && !gpu_timings.empty())
+		{
+			file << ",\n{\"name\":\"GPU ms\",\"ph\":\"C\",\"pid\":0,\"ts\":" << ts << ",\"args\":{";
+			for (std::size_t i = 0; i < gpu_timings.size(); i++)
+			{
+				file << (i == 0 ? "" : ",");
+				cpu_profiler::write_json_string(file, gpu_timings[i].first.c_str());
+				file << ":" << gpu_timings[i].second;
+			}
+			file << "}}";
+		}
+	}
+
+	file << ",\n{\"name\":\"Hitch: " << spike_reason << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":" << FRAMES_TID
+		<< ",\"ts\":" << spike.start_ns / 1000.0 << "}";
+	file << "\n]}\n";
+
+	dump_count++;
+	last_dump = path;
+
+	std::cout << "Hitch at frame " << spike_frame << " (" << spike_reason << ", "
+		<< (spike.end_ns - spike.start_ns) / 1000000.0 << " ms), wrote frames " << first << "-" << last << " to " << path << std::endl;
+}
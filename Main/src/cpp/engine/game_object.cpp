@@ -2,23 +2,26 @@
 
 game_object::game_object()
 {
-	this->_transform = std::make_shared<transform>(transform());
 	name = "unnamed game_object";
 	is_active = true;
 }
 
 // ReSharper disable once CppParameterNamesMismatch
-game_object::game_object(const transform& t_form)
+game_object::game_object(const transform& t_form) : _transform(t_form.clone())
 {
-	_transform = std::make_shared<transform>(t_form);
 	name = "unnamed game_object";
 	is_active = true;
 }
 
 
-transform* game_object::get_transform() const
+transform* game_object::get_transform()
 {
-	return this->_transform.get();
+	return &this->_transform;
+}
+
+const transform* game_object::get_transform() const
+{
+	return &this->_transform;
 }
 
 std::string game_object::get_name() const
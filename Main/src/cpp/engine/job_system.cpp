@@ -0,0 +1,266 @@
+#include "engine/job_system.h"
+#include "utils/cpu_profiler.h"
+
+#include <algorithm>
+
+namespace
+{
+	thread_local unsigned int thread_index = 0;
+}
+
+job_system& job_system::get()
+{
+	static job_system system;
+	return system;
+}
+
+job_system::~job_system()
+{
+	shutdown();
+}
+
+void job_system::init(unsigned int worker_count)
+{
+	if (!queues.empty())
+		return;
+
+	if (worker_count == 0)
+	{
+		const unsigned int hardware_threads = std::thread::hardware_concurrency();
+		worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+	}
+
+	for (unsigned int i = 0; i < worker_count + 1; i++)
+	{
+		queues.push_back(std::make_unique<worker_queue>());
+		queues.back()->pool = std::vector<job>(JOBS_PER_THREAD);
+	}
+
+	is_running = true;
+
+	for (unsigned int i = 1; i < worker_count + 1; i++)
+		workers.emplace_back(&job_system::worker_loop, this, i);
+}
+
+void job_system::shutdown()
+{
+	if (!is_running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		is_running = false;
+	}
+	wake_condition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+
+	workers.clear();
+	queues.clear();
+}
+
+job* job_system::create(std::function<void()> function, job* parent)
+{
+	if (queues.empty())
+		init();
+
+	worker_queue& queue = *queues[get_thread_index()];
+	job* j = nullptr;
+
+	//only the owning thread creates in its ring, a slot is free once its job and all children are done
+	while (!j)
+	{
+		for (unsigned int tries = 0; tries < JOBS_PER_THREAD && !j; tries++)
+		{
+			job* candidate = &queue.pool[queue.next_job++ & (JOBS_PER_THREAD - 1)];
+			if (is_done(candidate))
+				j = candidate;
+		}
+
+		//every slot is queued or running, help until one frees up
+		if (!j)
+		{
+			job* next = get_job();
+
+			if (next)
+				execute(next);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	j->function = std::move(function);
+	j->parent = parent;
+	j->unfinished = 1;
+
+	if (parent)
+		parent->unfinished++;
+
+	return j;
+}
+
+void job_system::run(job* j)
+{
+	worker_queue& queue = *queues[get_thread_index()];
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(j);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		pending++;
+	}
+	wake_condition.notify_one();
+}
+
+void job_system::wait(const job* j)
+{
+	while (!is_done(j))
+	{
+		job* next = get_job();
+
+		if (next)
+			execute(next);
+		else
+			std::this_thread::yield();
+	}
+}
+
+bool job_system::is_done(const job* j)
+{
+	return j->unfinished.load() <= 0;
+}
+
+void job_system::run_batches(const unsigned int count, unsigned int batch_size, const std::function<void(unsigned int, unsigned int)>& function)
+{
+	if (count == 0)
+		return;
+
+	batch_size = std::max(batch_size, 1u);
+	//keeps the job count well inside the ring however large count gets
+	batch_size = std::max(batch_size, (count + MAX_PARALLEL_JOBS - 1) / MAX_PARALLEL_JOBS);
+
+	if (workers.empty() || count <= batch_size)
+	{
+		function(0, count);
+		return;
+	}
+
+	job* root = create(nullptr);
+
+	for (unsigned int begin = 0; begin < count; begin += batch_size)
+	{
+		const unsigned int end = std::min(begin + batch_size, count);
+		run(create([&function, begin, end]() { function(begin, end); }, root));
+	}
+
+	//the root has no work of its own, it only waits on its children
+	finish(root);
+	wait(root);
+}
+
+unsigned int job_system::get_worker_count() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+unsigned int job_system::get_thread_count() const
+{
+	return static_cast<unsigned int>(queues.size());
+}
+
+unsigned int job_system::get_thread_index()
+{
+	return thread_index;
+}
+
+unsigned int job_system::get_jobs_executed(const unsigned int thread) const
+{
+	return thread < queues.size() ? queues[thread]->executed.load() : 0;
+}
+
+void job_system::reset_stats()
+{
+	for (auto& queue : queues)
+		queue->executed = 0;
+}
+
+void job_system::worker_loop(const unsigned int index)
+{
+	thread_index = index;
+
+	while (is_running)
+	{
+		job* j = get_job();
+
+		if (j)
+		{
+			execute(j);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake_condition.wait(lock, [this]() { return pending.load() > 0 || !is_running; });
+	}
+}
+
+job* job_system::get_job()
+{
+	const unsigned int own = get_thread_index();
+	const unsigned int count = static_cast<unsigned int>(queues.size());
+
+	//own work first, newest first since it is most likely still in cache
+	{
+		worker_queue& queue = *queues[own];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.jobs.empty())
+		{
+			job* j = queue.jobs.back();
+			queue.jobs.pop_back();
+			pending--;
+			return j;
+		}
+	}
+
+	//steal the oldest job from the next busy thread
+	for (unsigned int i = 1; i < count; i++)
+	{
+		worker_queue& victim = *queues[(own + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.jobs.empty())
+		{
+			job* j = victim.jobs.front();
+			victim.jobs.pop_front();
+			pending--;
+			return j;
+		}
+	}
+
+	return nullptr;
+}
+
+void job_system::execute(job* j)
+{
+	if (j->function)
+	{
+		cpu_profile_scope scope("Job");
+		j->function();
+	}
+
+	queues[get_thread_index()]->executed++;
+	finish(j);
+}
+
+void job_system::finish(job* j)
+{
+	//read before the count drops, the slot can be handed out again the moment it reaches 0
+	job* parent = j->parent;
+
+	if (j->unfinished.fetch_sub(1) == 1 && parent)
+		finish(parent);
+}
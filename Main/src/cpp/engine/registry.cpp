@@ -0,0 +1,51 @@
+#include "engine/registry.h"
+
+entity registry::create()
+{
+	entity e;
+
+	if (!free_indices.empty())
+	{
+		e.index = free_indices.back();
+		free_indices.pop_back();
+	}
+	else
+	{
+		e.index = static_cast<unsigned int>(generations.size());
+		generations.push_back(0);
+	}
+
+	e.generation = generations[e.index];
+	return e;
+}
+
+void registry::destroy(const entity e)
+{
+	if (!is_alive(e))
+		return;
+
+	for (auto& pool : pools)
+	{
+		if (pool)
+			pool->remove(e);
+	}
+
+	generations[e.index]++;
+	free_indices.push_back(e.index);
+}
+
+bool registry::is_alive(const entity e) const
+{
+	return e.index < generations.size() && generations[e.index] == e.generation;
+}
+
+unsigned int registry::get_entity_count() const
+{
+	return static_cast<unsigned int>(generations.size() - free_indices.size());
+}
+
+unsigned int registry::next_type_id()
+{
+	static unsigned int next = 0;
+	return next++;
+}
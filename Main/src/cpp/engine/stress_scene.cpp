@@ -0,0 +1,93 @@
+#include "engine/stress_scene.h"
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+	//mt19937 output is the same everywhere, the std distributions are not, so ranges are mapped by hand
+	float next_float(std::mt19937& rng, const float lo, const float hi)
+	{
+		return lo + (hi - lo) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	unsigned int next_index(std::mt19937& rng, const unsigned int count)
+	{
+		return count > 1 ? static_cast<unsigned int>(rng() % count) : 0;
+	}
+
+	//channels drawn one at a time, arguments to one call would be evaluated in a compiler dependent order
+	color next_color(std::mt19937& rng)
+	{
+		const float r = next_float(rng, 0.2f, 1.0f);
+		const float g = next_float(rng, 0.2f, 1.0f);
+		const float b = next_float(rng, 0.2f, 1.0f);
+		return color(r, g, b, 1.0f);
+	}
+}
+
+stress_scene stress_scene::generate(const settings& s, const unsigned int prototype_count)
+{
+	stress_scene scene;
+	std::mt19937 rng(s.seed);
+
+	const unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(s.object_count))));
+	scene.half_extent = side * s.spacing * 0.5f;
+
+	const float jitter = 0.25f * s.spacing;
+
+	scene.objects.reserve(s.object_count);
+	for (unsigned int i = 0; i < s.object_count; i++)
+	{
+		const float x = (i % side + 0.5f) * s.spacing - scene.half_extent + next_float(rng, -jitter, jitter);
+		const float z = (i / side + 0.5f) * s.spacing - scene.half_extent + next_float(rng, -jitter, jitter);
+
+		object_placement o{};
+		o.prototype = next_index(rng, prototype_count);
+		o.material = next_index(rng, s.material_count);
+		o.position = glm::vec3(x, 0.0f, z);
+		o.rotation = glm::vec3(0.0f, next_float(rng, 0.0f, 360.0f), 0.0f);
+		o.scale = next_float(rng, 0.5f, 1.5f);
+		scene.objects.push_back(o);
+	}
+
+	scene.lights.reserve(s.light_count);
+	for (unsigned int i = 0; i < s.light_count; i++)
+	{
+		const float x = next_float(rng, -scene.half_extent, scene.half_extent);
+		const float y = next_float(rng, 2.0f, 6.0f);
+		const float z = next_float(rng, -scene.half_extent, scene.half_extent);
+
+		light_placement l{};
+		l.position = glm::vec3(x, y, z);
+		l.diffuse = next_color(rng);
+		l.radius = next_float(rng, 2.0f * s.spacing, 4.0f * s.spacing);
+		scene.lights.push_back(l);
+	}
+
+	scene.material_colors.reserve(s.material_count);
+	for (unsigned int i = 0; i < s.material_count; i++)
+		scene.material_colors.push_back(next_color(rng));
+
+	return scene;
+}
+
+const std::vector<stress_scene::object_placement>& stress_scene::get_objects() const
+{
+	return objects;
+}
+
+const std::vector<stress_scene::light_placement>& stress_scene::get_lights() const
+{
+	return lights;
+}
+
+const std::vector<color>& stress_scene::get_material_colors() const
+{
+	return material_colors;
+}
+
+float stress_scene::get_half_extent() const
+{
+	return half_extent;
+}
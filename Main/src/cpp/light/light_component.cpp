@@ -0,0 +1,19 @@
+#include "light/light_component.h"
+
+#include <cmath>
+
+void light_component::set_radius(const float r)
+{
+	radius = r;
+	quadratic = 1.0f / (radius * radius * 0.01f);
+}
+
+float light_component::calculate_cutoff_radius() const
+{
+	const float max_channel = fmax(fmax(diffuse.r, diffuse.g), diffuse.b);
+
+	return (-linear + sqrtf(linear * linear -
+		4.0f * quadratic * (1.0f - (256.0f / 0.5f) * max_channel * diff_intensity)))
+		/
+		(2.0f * quadratic);
+}
@@ -0,0 +1,450 @@
+#include "rendering/capture_player.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "rendering/recording_backend.h"
+
+namespace
+{
+	float get_float(const std::uint32_t word)
+	{
+		float value;
+		std::memcpy(&value, &word, sizeof(value));
+		return value;
+	}
+
+	//strings are stored as their length and then their bytes, the padding is not a terminator
+	std::string get_string(const std::uint32_t* words)
+	{
+		return std::string(reinterpret_cast<const char*>(words + 1), words[0]);
+	}
+}
+
+bool capture_player::load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open capture " << path << std::endl;
+		return false;
+	}
+
+	std::uint32_t header[6]{};
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	if (!file || header[0] != recording_backend::file_magic || header[1] != recording_backend::file_version)
+	{
+		std::cout << path << " is not a capture this build can read" << std::endl;
+		return false;
+	}
+
+	const unsigned long long payload_size = header[4] | static_cast<unsigned long long>(header[5]) << 32;
+	stream.resize(header[3]);
+	payloads.resize(static_cast<std::size_t>(payload_size));
+
+	file.read(reinterpret_cast<char*>(stream.data()), stream.size() * sizeof(std::uint32_t));
+	file.read(reinterpret_cast<char*>(payloads.data()), payloads.size());
+
+	if (!file)
+	{
+		std::cout << "Capture " << path << " is truncated" << std::endl;
+		return false;
+	}
+
+	//split the stream at the frame marks and note where each range starts reading payloads
+	frames.clear();
+	range current{ 0, 0, 0 };
+	bool is_setup = true;
+	std::size_t payload = 0;
+	std::size_t position = 0;
+
+	while (position < stream.size())
+	{
+		const std::uint32_t entry = stream[position];
+		const backend_command command = static_cast<backend_command>(entry & 0xff);
+		const std::size_t words = entry >> 8;
+
+		if (command >= backend_command::count || position + 1 + words > stream.size())
+		{
+			std::cout << "Capture " << path << " has a broken entry at word " << position << std::endl;
+			return false;
+		}
+
+		const int argument = get_payload_argument(command);
+		if (argument >= 0)
+			payload += stream[position + 1 + argument];
+
+		position += 1 + words;
+
+		if (command != backend_command::end_frame)
+			continue;
+
+		current.end = position;
+		if (is_setup)
+			setup = current;
+		else
+			frames.push_back(current);
+
+		is_setup = false;
+		current = { position, position, payload };
+	}
+
+	if (payload != payloads.size())
+	{
+		std::cout << "Capture " << path << " payloads do not match its stream" << std::endl;
+		return false;
+	}
+
+	if (is_setup)
+	{
+		std::cout << "Capture " << path << " has no frame marks" << std::endl;
+		return false;
+	}
+
+	reset();
+	return true;
+}
+
+unsigned int capture_player::get_frame_count() const
+{
+	return static_cast<unsigned int>(frames.size());
+}
+
+std::size_t capture_player::get_payload_size() const
+{
+	return payloads.size();
+}
+
+void capture_player::play_setup(render_backend& backend)
+{
+	reset();
+	play(setup, backend);
+}
+
+void capture_player::play_frame(const unsigned int frame, render_backend& backend)
+{
+	if (frame < frames.size())
+		play(frames[frame], backend);
+}
+
+void capture_player::play(const range& commands, render_backend& backend)
+{
+	std::size_t payload = commands.payload;
+	std::size_t position = commands.begin;
+	std::string error;
+
+	const auto read_payload = [this, &payload](const std::uint32_t size) -> const void*
+	{
+		if (size == 0)
+			return nullptr;
+
+		const void* data = &payloads[payload];
+		payload += size;
+		return data;
+	};
+
+	while (position < commands.end)
+	{
+		const std::uint32_t entry = stream[position];
+		const backend_command command = static_cast<backend_command>(entry & 0xff);
+		const std::uint32_t words = entry >> 8;
+		const std::uint32_t* args = &stream[position + 1];
+		position += 1 + words;
+
+		switch (command)
+		{
+#pragma region State
+		case backend_command::use_program:
+			current_program = args[0];
+			backend.use_program(get_name(program_object, args[0]));
+			break;
+		case backend_command::bind_vertex_array:
+			backend.bind_vertex_array(get_name(vertex_array_object, args[0]));
+			break;
+		case backend_command::bind_buffer:
+			backend.bind_buffer(args[0], get_name(buffer_object, args[1]));
+			break;
+		case backend_command::active_texture:
+			backend.active_texture(args[0]);
+			break;
+		case backend_command::bind_texture:
+			backend.bind_texture(args[0], get_name(texture_object, args[1]));
+			break;
+		case backend_command::bind_image_texture:
+			backend.bind_image_texture(args[0], get_name(texture_object, args[1]), args[2], args[3]);
+			break;
+		case backend_command::bind_framebuffer:
+			backend.bind_framebuffer(args[0], get_name(framebuffer_object, args[1]));
+			break;
+		case backend_command::set_capability:
+			backend.set_capability(args[0], args[1] != 0);
+			break;
+		case backend_command::cull_face:
+			backend.cull_face(args[0]);
+			break;
+		case backend_command::depth_mask:
+			backend.depth_mask(args[0] != 0);
+			break;
+		case backend_command::stencil_mask:
+			backend.stencil_mask(args[0]);
+			break;
+		case backend_command::stencil_func:
+			backend.stencil_func(args[0], args[1], static_cast<int>(args[2]), args[3]);
+			break;
+		case backend_command::stencil_op:
+			backend.stencil_op(args[0], args[1], args[2], args[3]);
+			break;
+		case backend_command::draw_buffers:
+			backend.draw_buffers(args[0], reinterpret_cast<const GLenum*>(args + 1));
+			break;
+		case backend_command::read_buffer:
+			backend.read_buffer(args[0]);
+			break;
+		case backend_command::clear:
+			backend.clear(args[0]);
+			break;
+		case backend_command::viewport:
+			backend.viewport(static_cast<int>(args[0]), static_cast<int>(args[1]), args[2], args[3]);
+			break;
+		case backend_command::blend_func:
+			backend.blend_func(args[0], args[1]);
+			break;
+		case backend_command::depth_func:
+			backend.depth_func(args[0]);
+			break;
+		case backend_command::polygon_mode:
+			backend.polygon_mode(args[0]);
+			break;
+		case backend_command::blit_framebuffer:
+			backend.blit_framebuffer(args[0], args[1], args[2], args[3], args[4], args[5]);
+			break;
+#pragma endregion
+
+#pragma region Uniforms And Draws
+		case backend_command::get_uniform_location:
+		{
+			const std::string name = get_string(args + 1);
+			const int location = backend.get_uniform_location(get_name(program_object, args[0]), name.c_str());
+			const std::uint32_t captured = args[2 + (args[1] + 3) / 4];
+			locations[static_cast<unsigned long long>(args[0]) << 32 | captured] = location;
+			break;
+		}
+		case backend_command::set_uniform:
+		{
+			//the value count follows from the entry size, so the player does not need the constant sizes
+			values.resize(words - 3);
+			for (std::size_t i = 0; i < values.size(); i++)
+				values[i] = get_float(args[3 + i]);
+			backend.set_uniform(get_location(static_cast<int>(args[0])), static_cast<constant_type>(args[1]), args[2], values.data());
+			break;
+		}
+		case backend_command::set_uniform_int:
+			backend.set_uniform_int(get_location(static_cast<int>(args[0])), static_cast<int>(args[1]));
+			break;
+		case backend_command::draw:
+			backend.draw(args[0] != 0, args[1], args[2]);
+			break;
+		case backend_command::dispatch_compute:
+			backend.dispatch_compute(args[0], args[1], args[2]);
+			break;
+		case backend_command::memory_barrier:
+			backend.memory_barrier(args[0]);
+			break;
+#pragma endregion
+
+#pragma region Resources
+		case backend_command::create_texture:
+			add_name(texture_object, args[0], backend.create_texture());
+			break;
+		case backend_command::delete_texture:
+			backend.delete_texture(get_name(texture_object, args[0]));
+			remove_name(texture_object, args[0]);
+			break;
+		case backend_command::tex_image_2d:
+			backend.tex_image_2d(args[0], static_cast<int>(args[1]), args[2], args[3], args[4], args[5], args[6], read_payload(args[7]));
+			break;
+		case backend_command::tex_image_2d_multisample:
+			backend.tex_image_2d_multisample(args[0], args[1], args[2], args[3]);
+			break;
+		case backend_command::tex_sub_image_2d:
+			backend.tex_sub_image_2d(args[0], args[1], args[2], args[3], args[4], read_payload(args[5]));
+			break;
+		case backend_command::tex_parameter:
+			backend.tex_parameter(args[0], args[1], static_cast<int>(args[2]));
+			break;
+		case backend_command::generate_mipmap:
+			backend.generate_mipmap(args[0]);
+			break;
+
+		case backend_command::create_vertex_array:
+			add_name(vertex_array_object, args[0], backend.create_vertex_array());
+			break;
+		case backend_command::delete_vertex_array:
+			backend.delete_vertex_array(get_name(vertex_array_object, args[0]));
+			remove_name(vertex_array_object, args[0]);
+			break;
+		case backend_command::vertex_attribute:
+			backend.vertex_attribute(args[0], static_cast<int>(args[1]), args[2], args[3]);
+			break;
+		case backend_command::vertex_attribute_divisor:
+			backend.vertex_attribute_divisor(args[0], args[1]);
+			break;
+
+		case backend_command::create_buffer:
+			add_name(buffer_object, args[0], backend.create_buffer());
+			break;
+		case backend_command::delete_buffer:
+			backend.delete_buffer(get_name(buffer_object, args[0]));
+			remove_name(buffer_object, args[0]);
+			break;
+		case backend_command::buffer_data:
+			backend.buffer_data(args[0], args[1], read_payload(args[3]), args[2]);
+			break;
+		case backend_command::buffer_sub_data:
+			backend.buffer_sub_data(args[0], args[1], args[2], read_payload(args[3]));
+			break;
+		case backend_command::bind_buffer_base:
+			backend.bind_buffer_base(args[0], args[1], get_name(buffer_object, args[2]));
+			break;
+
+		case backend_command::create_renderbuffer:
+			add_name(renderbuffer_object, args[0], backend.create_renderbuffer());
+			break;
+		case backend_command::delete_renderbuffer:
+			backend.delete_renderbuffer(get_name(renderbuffer_object, args[0]));
+			remove_name(renderbuffer_object, args[0]);
+			break;
+		case backend_command::bind_renderbuffer:
+			backend.bind_renderbuffer(get_name(renderbuffer_object, args[0]));
+			break;
+		case backend_command::renderbuffer_storage:
+			backend.renderbuffer_storage(args[0], args[1], args[2]);
+			break;
+
+		case backend_command::create_framebuffer:
+			add_name(framebuffer_object, args[0], backend.create_framebuffer());
+			break;
+		case backend_command::delete_framebuffer:
+			backend.delete_framebuffer(get_name(framebuffer_object, args[0]));
+			remove_name(framebuffer_object, args[0]);
+			break;
+		case backend_command::framebuffer_texture_2d:
+			backend.framebuffer_texture_2d(args[0], args[1], get_name(texture_object, args[2]), static_cast<int>(args[3]));
+			break;
+		case backend_command::framebuffer_texture:
+			backend.framebuffer_texture(args[0], get_name(texture_object, args[1]), static_cast<int>(args[2]));
+			break;
+		case backend_command::framebuffer_renderbuffer:
+			backend.framebuffer_renderbuffer(args[0], get_name(renderbuffer_object, args[1]));
+			break;
+		case backend_command::check_framebuffer_status:
+			backend.check_framebuffer_status();
+			break;
+
+		case backend_command::create_shader:
+		{
+			const std::string source = get_string(args + 1);
+			const std::uint32_t captured = args[2 + (args[1] + 3) / 4];
+			add_name(shader_object, captured, backend.create_shader(args[0], source.c_str(), error));
+			if (!error.empty())
+				std::cout << "Replayed shader " << captured << " failed to compile: " << error << std::endl;
+			break;
+		}
+		case backend_command::delete_shader:
+			backend.delete_shader(get_name(shader_object, args[0]));
+			remove_name(shader_object, args[0]);
+			break;
+		case backend_command::create_program:
+		{
+			shaders.resize(args[0]);
+			for (unsigned int i = 0; i < args[0]; i++)
+				shaders[i] = get_name(shader_object, args[1 + i]);
+
+			const std::uint32_t captured = args[1 + args[0]];
+			add_name(program_object, captured, backend.create_program(shaders.data(), args[0], error));
+			if (!error.empty())
+				std::cout << "Replayed program " << captured << " failed to link: " << error << std::endl;
+			break;
+		}
+		case backend_command::delete_program:
+			backend.delete_program(get_name(program_object, args[0]));
+			remove_name(program_object, args[0]);
+			break;
+		case backend_command::uniform_block_binding:
+		{
+			const std::string block = get_string(args + 1);
+			backend.uniform_block_binding(get_name(program_object, args[0]), block.c_str(), args[2 + (args[1] + 3) / 4]);
+			break;
+		}
+
+		case backend_command::create_fence:
+			add_name(fence_object, args[0], backend.create_fence());
+			break;
+		case backend_command::is_fence_signaled:
+			//the replay deletes where the capture did, the answer the target gives does not matter
+			backend.is_fence_signaled(get_name(fence_object, args[0]));
+			break;
+		case backend_command::delete_fence:
+			backend.delete_fence(get_name(fence_object, args[0]));
+			remove_name(fence_object, args[0]);
+			break;
+#pragma endregion
+
+		default:
+			break;
+		}
+	}
+}
+
+void capture_player::reset()
+{
+	for (std::unordered_map<unsigned int, unsigned int>& kind : names)
+		kind.clear();
+
+	locations.clear();
+	current_program = 0;
+}
+
+unsigned int capture_player::get_name(const object_kind kind, const unsigned int captured) const
+{
+	//0 is the default object in every kind and never remapped
+	if (captured == 0)
+		return 0;
+
+	const auto it = names[kind].find(captured);
+	return it != names[kind].end() ? it->second : captured;
+}
+
+void capture_player::add_name(const object_kind kind, const unsigned int captured, const unsigned int name)
+{
+	names[kind][captured] = name;
+}
+
+void capture_player::remove_name(const object_kind kind, const unsigned int captured)
+{
+	names[kind].erase(captured);
+}
+
+int capture_player::get_location(const int captured) const
+{
+	if (captured < 0)
+		return captured;
+
+	const auto it = locations.find(static_cast<unsigned long long>(current_program) << 32 | static_cast<std::uint32_t>(captured));
+	return it != locations.end() ? it->second : captured;
+}
+
+int capture_player::get_payload_argument(const backend_command command)
+{
+	switch (command)
+	{
+	case backend_command::tex_image_2d: return 7;
+	case backend_command::tex_sub_image_2d: return 5;
+	case backend_command::buffer_data: return 3;
+	case backend_command::buffer_sub_data: return 3;
+	default: return -1;
+	}
+}
@@ -0,0 +1,234 @@
+#include "rendering/command_list.h"
+
+#include <algorithm>
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "rendering/render_backend.h"
+#include "rendering/shader_program.h"
+#include "rendering/render_stats.h"
+
+void command_list::reset()
+{
+	commands.clear();
+	constants.clear();
+	packets.clear();
+}
+
+void command_list::begin_packet(const std::uint64_t sort_key)
+{
+	draw_packet packet;
+	packet.sort_key = sort_key;
+	packet.first_command = static_cast<unsigned int>(commands.size());
+	packets.push_back(packet);
+}
+
+void command_list::bind_program(const shader_program* program)
+{
+	command c;
+	c.type = command_type::bind_program;
+	c.program = program;
+	commands.push_back(c);
+}
+
+void command_list::set_constants(const string_id& uniform, const constant_type type, const float* values, const unsigned int count)
+{
+	command c;
+	c.type = command_type::set_constants;
+	c.uniform = uniform;
+	c.constant = type;
+	c.offset = static_cast<unsigned int>(constants.size());
+	c.count = count;
+	commands.push_back(c);
+
+	constants.insert(constants.end(), values, values + get_constant_size(type) * count);
+}
+
+void command_list::set_int(const string_id& uniform, const int value)
+{
+	const float stored = static_cast<float>(value);
+	set_constants(uniform, constant_type::int1, &stored);
+}
+
+void command_list::set_vec2(const string_id& uniform, const glm::vec2& value)
+{
+	set_constants(uniform, constant_type::vec2, glm::value_ptr(value));
+}
+
+void command_list::set_mat4(const string_id& uniform, const glm::mat4& value)
+{
+	set_constants(uniform, constant_type::mat4, glm::value_ptr(value));
+}
+
+void command_list::bind_material(const std::vector<material_slot>* material)
+{
+	command c;
+	c.type = command_type::bind_material;
+	c.material = material;
+	commands.push_back(c);
+}
+
+void command_list::draw(const draw_call& call)
+{
+	command c;
+	c.type = command_type::draw;
+	c.call = call;
+	commands.push_back(c);
+}
+
+void command_list::end_packet()
+{
+	draw_packet& packet = packets.back();
+	packet.command_count = static_cast<unsigned int>(commands.size()) - packet.first_command;
+}
+
+const std::vector<command>& command_list::get_commands() const
+{
+	return commands;
+}
+
+const std::vector<float>& command_list::get_constants() const
+{
+	return constants;
+}
+
+const std::vector<draw_packet>& command_list::get_packets() const
+{
+	return packets;
+}
+
+std::uint64_t command_list::make_sort_key(const unsigned int program, const unsigned int material, const float depth, const bool is_transparent)
+{
+	//24 bits of depth over the first kilometer is plenty for ordering
+	const float normalized = glm::clamp(depth / 1000.0f, 0.0f, 1.0f);
+	std::uint64_t depth_bits = static_cast<std::uint64_t>(normalized * 0xFFFFFF);
+
+	//blending needs the true back to front order across every program and material, depth goes right under
+	//the transparent bit and state only breaks ties between draws at the same depth
+	if (is_transparent)
+	{
+		return (static_cast<std::uint64_t>(1) << 63) |
+			((0xFFFFFF - depth_bits) << 39) |
+			(static_cast<std::uint64_t>(program & 0x7FFF) << 24) |
+			static_cast<std::uint64_t>(material & 0xFFFFFF);
+	}
+
+	return (static_cast<std::uint64_t>(program & 0x7FFF) << 48) |
+		(static_cast<std::uint64_t>(material & 0xFFFFFF) << 24) |
+		depth_bits;
+}
+
+void command_list::sort_packets(const std::vector<command_list>& lists, std::vector<packet_ref>& order)
+{
+	order.clear();
+
+	for (unsigned int l = 0; l < lists.size(); l++)
+	{
+		const auto& packets = lists[l].packets;
+		for (unsigned int p = 0; p < packets.size(); p++)
+			order.push_back(packet_ref{ packets[p].sort_key, l, p });
+	}
+
+	//ties keep recording order like a stable sort would, without the temporary buffer stable_sort allocates every call
+	std::sort(order.begin(), order.end(), [](const packet_ref& a, const packet_ref& b)
+		{
+			if (a.sort_key != b.sort_key)
+				return a.sort_key < b.sort_key;
+			return a.list != b.list ? a.list < b.list : a.packet < b.packet;
+		});
+}
+
+void command_list::submit(const std::vector<command_list>& lists)
+{
+	static std::vector<packet_ref> order;
+	sort_packets(lists, order);
+
+	render_backend& backend = render_backend::get();
+	const shader_program* current_program = nullptr;
+	const std::vector<material_slot>* current_material = nullptr;
+
+	for (const auto& ref : order)
+	{
+		const command_list& list = lists[ref.list];
+		const draw_packet& packet = list.packets[ref.packet];
+
+		for (unsigned int i = packet.first_command; i < packet.first_command + packet.command_count; i++)
+		{
+			const command& c = list.commands[i];
+
+			switch (c.type)
+			{
+			case command_type::bind_program:
+			{
+				if (c.program != current_program)
+				{
+					c.program->use();
+					current_program = c.program;
+					current_material = nullptr;
+				}
+				break;
+			}
+			case command_type::set_constants:
+			{
+				const int location = current_program->get_uniform_location(c.uniform);
+				const float* values = &list.constants[c.offset];
+				backend.set_uniform(location, c.constant, c.count, values);
+				render_stats::counters.uniform_calls++;
+				break;
+			}
+			case command_type::bind_material:
+			{
+				if (c.material == current_material)
+					break;
+
+				for (unsigned int unit = 0; unit < c.material->size(); unit++)
+				{
+					const material_slot& slot = (*c.material)[unit];
+					backend.active_texture(GL_TEXTURE0 + unit);
+					backend.bind_texture(slot.target, slot.texture_id);
+					backend.set_uniform_int(current_program->get_uniform_location(slot.uniform), static_cast<int>(unit));
+					render_stats::counters.texture_binds++;
+					render_stats::counters.uniform_calls++;
+				}
+
+				backend.active_texture(GL_TEXTURE0);
+				current_material = c.material;
+				break;
+			}
+			case command_type::draw:
+			{
+				const draw_call& call = c.call;
+
+				backend.set_capability(GL_CULL_FACE, call.should_cull_face);
+				backend.cull_face(call.cull_face);
+				backend.set_capability(GL_BLEND, call.is_transparent);
+
+				backend.bind_vertex_array(call.vao);
+				render_stats::counters.vao_binds++;
+
+				backend.draw(call.is_indexed, call.element_count, call.instance_count);
+				render_stats::count_draw(call.element_count, call.instance_count);
+				break;
+			}
+			}
+		}
+	}
+
+	backend.bind_vertex_array(0);
+	backend.set_capability(GL_CULL_FACE, false);
+	backend.set_capability(GL_BLEND, false);
+}
+
+unsigned int command_list::get_constant_size(const constant_type type)
+{
+	switch (type)
+	{
+	case constant_type::int1:
+	case constant_type::float1: return 1;
+	case constant_type::vec2: return 2;
+	case constant_type::vec3: return 3;
+	case constant_type::vec4: return 4;
+	case constant_type::mat4: return 16;
+	default: return 1;
+	}
+}
@@ -0,0 +1,70 @@
+#include "rendering/dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+const float dynamic_resolution::SCALE_STEP = 0.05f;
+const float dynamic_resolution::MAX_CHANGE = 0.15f;
+
+namespace
+{
+	//aim a little under the budget and leave a band where nothing changes so the scale doesn't oscillate
+	const float TARGET_SHARE = 0.9f;
+	const float GROW_BELOW_SHARE = 0.75f;
+}
+
+void dynamic_resolution::add_sample(const float gpu_ms)
+{
+	sample_sum += gpu_ms;
+	sample_count++;
+
+	if (sample_count < ADJUST_INTERVAL)
+		return;
+
+	average_ms = sample_sum / static_cast<float>(sample_count);
+	sample_sum = 0;
+	sample_count = 0;
+
+	adjust();
+}
+
+float dynamic_resolution::get_scale() const
+{
+	//the limits can change from the ui between adjustments
+	return is_enabled ? std::min(std::max(scale, min_scale), max_scale) : max_scale;
+}
+
+float dynamic_resolution::get_average_ms() const
+{
+	return average_ms;
+}
+
+float dynamic_resolution::get_headroom() const
+{
+	return budget_ms > 0 ? 1.0f - average_ms / budget_ms : 0.0f;
+}
+
+unsigned int dynamic_resolution::scale_dimension(const unsigned int size) const
+{
+	return std::max(1u, static_cast<unsigned int>(std::lround(size * get_scale())));
+}
+
+void dynamic_resolution::adjust()
+{
+	if (!is_enabled || average_ms <= 0 || budget_ms <= 0)
+		return;
+
+	const bool is_over = average_ms > budget_ms;
+	const bool is_under = average_ms < budget_ms * GROW_BELOW_SHARE;
+
+	if (!is_over && !is_under)
+		return;
+
+	//gpu cost follows pixel count, which goes with the square of the scale
+	const float current = get_scale();
+	float desired = current * std::sqrt(budget_ms * TARGET_SHARE / average_ms);
+	desired = std::min(std::max(desired, current - MAX_CHANGE), current + MAX_CHANGE);
+	desired = std::round(desired / SCALE_STEP) * SCALE_STEP;
+
+	scale = std::min(std::max(desired, min_scale), max_scale);
+}
@@ -1,4 +1,6 @@
 #include "rendering/frame_buffer.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
 
 const frame_buffer* frame_buffer::current_read {nullptr};
 const frame_buffer* frame_buffer::current_draw {nullptr};
@@ -10,7 +12,7 @@ frame_buffer::frame_buffer()
 
 void frame_buffer::generate()
 {
-	glGenFramebuffers(1, &id);
+	id = render_backend::get().create_framebuffer();
 }
 
 void frame_buffer::attach_texture_2d_color(texture& tex, const GLenum attachment)
@@ -20,7 +22,7 @@ void frame_buffer::attach_texture_2d_color(texture& tex, const GLenum attachment
 		std::cout << "Texture color attachment failed" << std::endl;
 		return;
 	}
-	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
+	render_backend::get().framebuffer_texture_2d(attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
 
 	color_attachments.insert(std::pair<GLenum, texture*>(attachment, &tex));
 }
@@ -32,7 +34,7 @@ void frame_buffer::attach_texture_2d_color(texture& tex, const GLenum attachment
 		std::cout << "Texture color attachment failed" << std::endl;
 		return;
 	}
-	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, target, tex.get_id(), mip_level);
+	render_backend::get().framebuffer_texture_2d(attachment, target, tex.get_id(), mip_level);
 
 	const std::map<unsigned, texture*>::iterator it = color_attachments.find(attachment);
 
@@ -50,7 +52,7 @@ void frame_buffer::attach_texture_2d_depth(texture& tex, const GLenum attachment
 		return;
 	}
 
-	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
+	render_backend::get().framebuffer_texture_2d(attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
 
 	depth_attachment = std::make_shared<texture>(tex);
 }
@@ -63,7 +65,7 @@ void frame_buffer::attach_texture_2d_stencil(texture& tex, const GLenum attachme
 		return;
 	}
 
-	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
+	render_backend::get().framebuffer_texture_2d(attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
 
 	stencil_attachment = std::make_shared<texture>(tex);
 }
@@ -76,7 +78,7 @@ void frame_buffer::attach_texture_2d_depth_stencil(texture& tex, const GLenum at
 		return;
 	}
 
-	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
+	render_backend::get().framebuffer_texture_2d(attachment, tex.get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, tex.get_id(), 0);
 
 	depth_attachment = std::make_shared<texture>(tex);
 	stencil_attachment = std::make_shared<texture>(tex);
@@ -102,26 +104,28 @@ void frame_buffer::attach_texture(texture& tex, const GLenum attachment)
 	else
 		color_attachments.insert(std::pair<GLenum, texture*>(attachment, &tex));
 	
-	glFramebufferTexture(GL_FRAMEBUFFER, attachment, tex.get_id(), 0);
+	render_backend::get().framebuffer_texture(attachment, tex.get_id(), 0);
 }
 
 void frame_buffer::attach_render_buffer(render_buffer& rbo, const GLenum attachment)
 {
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, rbo.get_id());
+	render_backend::get().framebuffer_renderbuffer(attachment, rbo.get_id());
 	this->depth_stencil_attachment = std::make_shared<render_buffer>(rbo);
 
 }
 
 void frame_buffer::bind() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, id);
+	render_backend::get().bind_framebuffer(GL_FRAMEBUFFER, id);
+	render_stats::counters.framebuffer_binds++;
 	current_draw = this;
 	current_read = this;
 }
 
 void frame_buffer::unbind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	render_backend::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
+	render_stats::counters.framebuffer_binds++;
 	current_draw = nullptr;
 	current_read = nullptr;
 }
@@ -181,13 +185,12 @@ unsigned frame_buffer::get_stencil_attachment() const
 
 bool frame_buffer::validate()
 {
-	auto a = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-	return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	return render_backend::get().check_framebuffer_status() == GL_FRAMEBUFFER_COMPLETE;
 }
 
 void frame_buffer::delete_buffer() const
 {
-	glDeleteFramebuffers(1, &id);
+	render_backend::get().delete_framebuffer(id);
 }
 
 
@@ -198,7 +201,7 @@ void frame_buffer::set_draw_buffer(const GLenum mode)
 		std::cout << "Unable to set draw buffer, instance is not bound to GL_DRAW_FRAMEBUFFER" << std::endl;
 		return;
 	}
-	glDrawBuffer(mode);
+	render_backend::get().draw_buffers(1, &mode);
 }
 
 void frame_buffer::set_read_buffer(const GLenum mode)
@@ -208,7 +211,7 @@ void frame_buffer::set_read_buffer(const GLenum mode)
 		std::cout << "Unable to set read buffer, instance is not bound to GL_READ_FRAMEBUFFER" << std::endl;
 		return;
 	}
-	glReadBuffer(mode);
+	render_backend::get().read_buffer(mode);
 }
 
 void frame_buffer::set_draw_buffers(const unsigned int count, const GLenum* attachments)
@@ -226,17 +229,19 @@ void frame_buffer::set_draw_buffers(const unsigned int count, const GLenum* atta
 		attachments_v.push_back(color_attachment.first);
 	}
 	
-	glDrawBuffers(count, attachments == nullptr ? &attachments_v[0] : attachments);
+	render_backend::get().draw_buffers(count, attachments == nullptr ? &attachments_v[0] : attachments);
 }
 
 void frame_buffer::bind_draw() const
 {
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, id);
+	render_backend::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, id);
+	render_stats::counters.framebuffer_binds++;
 }
 
 void frame_buffer::bind_read() const
 {
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, id);
+	render_backend::get().bind_framebuffer(GL_READ_FRAMEBUFFER, id);
+	render_stats::counters.framebuffer_binds++;
 }
 
 
@@ -244,25 +249,26 @@ void frame_buffer::bind_read() const
 
 void frame_buffer::clear_color_buffer()
 {
-	glClear(GL_COLOR_BUFFER_BIT);
+	render_backend::get().clear(GL_COLOR_BUFFER_BIT);
 }
 
 void frame_buffer::clear_depth_buffer()
 {
-	glClear(GL_DEPTH_BUFFER_BIT);
+	render_backend::get().clear(GL_DEPTH_BUFFER_BIT);
 }
 
 void frame_buffer::clear_stencil_buffer()
 {
-	glStencilMask(~0);
-	glDisable(GL_SCISSOR_TEST);
-	glClear(GL_STENCIL_BUFFER_BIT);
+	render_backend& backend = render_backend::get();
+	backend.stencil_mask(~0u);
+	backend.set_capability(GL_SCISSOR_TEST, false);
+	backend.clear(GL_STENCIL_BUFFER_BIT);
 }
 
 void frame_buffer::clear_frame()
 {
-	glDisable(GL_SCISSOR_TEST);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	render_backend::get().set_capability(GL_SCISSOR_TEST, false);
+	render_backend::get().clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
 #pragma endregion
@@ -271,25 +277,22 @@ void frame_buffer::clear_frame()
 
 void frame_buffer::enable_depth_testing()
 {
-	glEnable(GL_DEPTH_TEST);
+	render_backend::get().set_capability(GL_DEPTH_TEST, true);
 }
 
 void frame_buffer::disable_depth_testing()
 {
-	glDisable(GL_DEPTH_TEST);
+	render_backend::get().set_capability(GL_DEPTH_TEST, false);
 }
 
 void frame_buffer::set_depth_testing(const bool flag)
 {
-	if (flag)
-		glEnable(GL_DEPTH_TEST);
-	else
-		glDisable(GL_DEPTH_TEST);
+	render_backend::get().set_capability(GL_DEPTH_TEST, flag);
 }
 
 void frame_buffer::set_depth_writing(const bool flag)
 {
-	glDepthMask(flag ? GL_TRUE : GL_FALSE);
+	render_backend::get().depth_mask(flag);
 }
 
 #pragma endregion
@@ -298,45 +301,42 @@ void frame_buffer::set_depth_writing(const bool flag)
 
 void frame_buffer::enable_stencil_testing()
 {
-	glEnable(GL_STENCIL_TEST);
+	render_backend::get().set_capability(GL_STENCIL_TEST, true);
 }
 
 void frame_buffer::disable_stencil_testing()
 {
-	glDisable(GL_STENCIL_TEST);
+	render_backend::get().set_capability(GL_STENCIL_TEST, false);
 }
 
 void frame_buffer::set_stencil_testing(const bool flag)
 {
-	if (flag)
-		glEnable(GL_STENCIL_TEST);
-	else
-		glDisable(GL_STENCIL_TEST);
+	render_backend::get().set_capability(GL_STENCIL_TEST, flag);
 }
 
 void frame_buffer::set_stencil_writing(const bool flag)
 {
-	glStencilMask(flag ? 0xFF : 0x00);
+	render_backend::get().stencil_mask(flag ? 0xFF : 0x00);
 }
 
 void frame_buffer::set_stencil_func(const GLenum func, const GLint ref, const GLuint mask)
 {
-	glStencilFunc(func, ref, mask);
+	render_backend::get().stencil_func(GL_FRONT_AND_BACK, func, ref, mask);
 }
 
 void frame_buffer::set_stencil_func_sep(const GLenum face, const GLenum func, const GLint ref, const GLuint mask)
 {
-	glStencilFuncSeparate(face, func, ref, mask);
+	render_backend::get().stencil_func(face, func, ref, mask);
 }
 
 void frame_buffer::set_stencil_op(const GLenum s_fail, const GLenum dp_fail, const GLenum dp_pass)
 {
-	glStencilOp(s_fail, dp_fail, dp_pass);
+	render_backend::get().stencil_op(GL_FRONT_AND_BACK, s_fail, dp_fail, dp_pass);
 }
 
 void frame_buffer::set_stencil_op_sep(const GLenum face, const GLenum s_fail, const GLenum dp_fail, const GLenum dp_pass)
 {
-	glStencilOpSeparate(face, s_fail, dp_fail, dp_pass);
+	render_backend::get().stencil_op(face, s_fail, dp_fail, dp_pass);
 }
 
 
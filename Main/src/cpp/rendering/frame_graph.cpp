@@ -0,0 +1,543 @@
+#include "rendering/frame_graph.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/gpu_profiler.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
+#include "utils/cpu_profiler.h"
+#include "utils/frame_arena.h"
+
+#include <algorithm>
+#include <iostream>
+
+#pragma region frame_graph_builder
+
+frame_graph_builder::frame_graph_builder(frame_graph& graph, const unsigned int pass) : graph(graph), pass(pass)
+{
+}
+
+frame_graph_resource frame_graph_builder::create(const char* name, const render_target_desc& desc)
+{
+	const frame_graph_resource resource = graph.add_resource(graph.get_name(name));
+	graph.resources[resource].desc = desc;
+	return resource;
+}
+
+frame_graph_resource frame_graph_builder::read(const frame_graph_resource resource)
+{
+	if (resource != INVALID_RESOURCE)
+		graph.passes[pass].reads.push_back(resource);
+
+	return resource;
+}
+
+frame_graph_resource frame_graph_builder::write(const frame_graph_resource resource, const GLenum attachment)
+{
+	if (resource == INVALID_RESOURCE)
+		return resource;
+
+	graph.passes[pass].writes.push_back(resource);
+
+	if (attachment != GL_NONE)
+		graph.passes[pass].attachments.push_back(frame_graph::attachment{ resource, attachment });
+
+	return resource;
+}
+
+void frame_graph_builder::set_side_effect()
+{
+	graph.passes[pass].has_side_effect = true;
+}
+
+#pragma endregion
+
+void frame_graph::reset()
+{
+	passes.clear();
+	resources.clear();
+	current_target = nullptr;
+	is_compiled = false;
+}
+
+frame_graph_resource frame_graph::import_texture(const char* name, texture& tex)
+{
+	const frame_graph_resource resource = add_resource(get_name(name));
+	resources[resource].imported = &tex;
+	gpu_memory::set_owner(gpu_memory_category::render_target, tex.get_id(), resources[resource].name.get_string());
+	resources[resource].desc.width = tex.get_width();
+	resources[resource].desc.height = tex.get_height();
+	return resource;
+}
+
+frame_graph_resource frame_graph::import_backbuffer(const char* name, const unsigned int width, const unsigned int height)
+{
+	const frame_graph_resource resource = add_resource(get_name(name));
+	resources[resource].is_backbuffer = true;
+	resources[resource].desc.width = width;
+	resources[resource].desc.height = height;
+	return resource;
+}
+
+void frame_graph::compile()
+{
+	for (const auto& p : passes)
+	{
+		for (const auto& a : p.attachments)
+		{
+			if (std::find(p.reads.begin(), p.reads.end(), a.resource) != p.reads.end())
+				std::cout << "Frame graph pass " << p.name.get_string() << " samples " << resources[a.resource].name.get_string() << " while rendering to it" << std::endl;
+		}
+	}
+
+	cull_passes();
+	add_resolves();
+	compute_lifetimes();
+	allocate();
+
+	is_compiled = true;
+}
+
+void frame_graph::execute()
+{
+	if (!is_compiled)
+		compile();
+
+	frame_graph_resource backbuffer = INVALID_RESOURCE;
+
+	for (auto& p : passes)
+	{
+		if (p.is_culled)
+			continue;
+
+		//every live pass is a profiler scope, resolves included since they exist for this pass
+		cpu_profile_scope scope(p.name);
+		gpu_profiler::get().push(p.name);
+		render_stats::begin_pass(p.name);
+
+		//gl orders render to texture before sampling on its own, the only transition it needs spelled out is the msaa resolve
+		for (const auto& r : p.resolves)
+			blit(r.source, r.destination, GL_COLOR_BUFFER_BIT);
+
+		bind_pass_target(p);
+		p.execute(p.callback, *this);
+
+		render_stats::end_pass();
+		gpu_profiler::get().pop();
+
+		for (const auto& a : p.attachments)
+		{
+			if (resources[a.resource].is_backbuffer)
+				backbuffer = a.resource;
+		}
+	}
+
+	frame_buffer::unbind();
+	current_target = nullptr;
+
+	if (backbuffer != INVALID_RESOURCE)
+		set_viewport(backbuffer);
+
+	targets.end_frame();
+	delete_framebuffers(targets.take_deleted());
+}
+
+texture* frame_graph::get_texture(const frame_graph_resource resource) const
+{
+	if (resource == INVALID_RESOURCE)
+		return nullptr;
+
+	const frame_graph_resource resolved = resources[resource].resolved;
+	return get_physical(resolved != INVALID_RESOURCE ? resolved : resource);
+}
+
+const render_target_desc& frame_graph::get_desc(const frame_graph_resource resource) const
+{
+	return resources[resource].desc;
+}
+
+frame_graph_resource frame_graph::find(const string_id& name) const
+{
+	for (unsigned int i = 0; i < resources.size(); i++)
+	{
+		if (resources[i].name == name)
+			return i;
+	}
+
+	return INVALID_RESOURCE;
+}
+
+void frame_graph::bind_target(const std::initializer_list<frame_graph_resource> colors, const frame_graph_resource depth)
+{
+	frame_vector<attachment> attachments;
+	attachments.reserve(colors.size() + 1);
+
+	GLenum point = GL_COLOR_ATTACHMENT0;
+	for (const frame_graph_resource color : colors)
+		attachments.push_back(attachment{ color, point++ });
+
+	if (depth != INVALID_RESOURCE)
+		attachments.push_back(attachment{ depth, get_depth_point(depth) });
+
+	bind_framebuffer(attachments);
+}
+
+void frame_graph::blit(const frame_graph_resource source, const frame_graph_resource destination, const GLbitfield mask)
+{
+	const auto bind_side = [this, mask](const frame_graph_resource resource, const GLenum target)
+	{
+		if (resources[resource].is_backbuffer)
+		{
+			render_backend::get().bind_framebuffer(target, 0);
+			render_stats::counters.framebuffer_binds++;
+			return;
+		}
+
+		const GLenum point = (mask & GL_COLOR_BUFFER_BIT) ? GL_COLOR_ATTACHMENT0 : get_depth_point(resource);
+		const frame_buffer& fb = get_framebuffer(frame_vector<attachment>{ attachment{ resource, point } });
+
+		if (target == GL_READ_FRAMEBUFFER)
+			fb.bind_read();
+		else
+			fb.bind_draw();
+	};
+
+	bind_side(source, GL_READ_FRAMEBUFFER);
+	bind_side(destination, GL_DRAW_FRAMEBUFFER);
+
+	const render_target_desc& from = resources[source].desc;
+	const render_target_desc& to = resources[destination].desc;
+	const bool is_scaled = from.width != to.width || from.height != to.height;
+
+	render_backend::get().blit_framebuffer(from.width, from.height, to.width, to.height, mask,
+		is_scaled && mask == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST);
+	render_stats::counters.blits++;
+
+	if (current_target)
+		current_target->bind();
+	else
+		frame_buffer::unbind();
+}
+
+const frame_graph::stats& frame_graph::get_stats() const
+{
+	return frame_stats;
+}
+
+unsigned int frame_graph::get_pass_count() const
+{
+	return static_cast<unsigned int>(passes.size());
+}
+
+const std::string& frame_graph::get_pass_name(const unsigned int pass) const
+{
+	return passes[pass].name.get_string();
+}
+
+bool frame_graph::is_pass_culled(const unsigned int pass) const
+{
+	return passes[pass].is_culled;
+}
+
+void frame_graph::release_unused_targets()
+{
+	targets.release_unused();
+	delete_framebuffers(targets.take_deleted());
+}
+
+void frame_graph::release()
+{
+	targets.release_all();
+	targets.take_deleted();
+
+	for (const auto& fb : framebuffers)
+		fb.second.delete_buffer();
+
+	framebuffers.clear();
+	reset();
+}
+
+string_id frame_graph::get_name(const char* name)
+{
+	const auto it = names.find(name);
+	if (it != names.end())
+		return it->second;
+
+	const string_id id{ std::string(name) };
+	names[name] = id;
+	return id;
+}
+
+unsigned int frame_graph::begin_pass(const char* name, const execute_thunk execute, const void* callback)
+{
+	passes.emplace_back();
+
+	pass& p = passes.back();
+	p.name = get_name(name);
+	p.execute = execute;
+	p.callback = callback;
+
+	return static_cast<unsigned int>(passes.size() - 1);
+}
+
+frame_graph_resource frame_graph::add_resource(const string_id& name)
+{
+	resource r;
+	r.name = name;
+	resources.push_back(r);
+	return static_cast<frame_graph_resource>(resources.size() - 1);
+}
+
+void frame_graph::cull_passes()
+{
+	//walk backwards from the passes with visible results, anything they never read from is dead
+	frame_vector<bool> is_needed(resources.size(), false);
+	frame_stats.culled_count = 0;
+
+	for (unsigned int i = static_cast<unsigned int>(passes.size()); i-- > 0;)
+	{
+		pass& p = passes[i];
+		bool is_alive = p.has_side_effect;
+
+		for (const frame_graph_resource w : p.writes)
+			is_alive = is_alive || is_needed[w] || resources[w].is_backbuffer;
+
+		p.is_culled = !is_alive;
+
+		if (!is_alive)
+		{
+			frame_stats.culled_count++;
+			continue;
+		}
+
+		for (const frame_graph_resource r : p.reads)
+			is_needed[r] = true;
+	}
+
+	frame_stats.pass_count = static_cast<unsigned int>(passes.size());
+}
+
+void frame_graph::add_resolves()
+{
+	//a multisampled target is resolved once, right before the first live pass that samples it
+	frame_stats.resolve_count = 0;
+
+	for (auto& p : passes)
+	{
+		if (p.is_culled)
+			continue;
+
+		for (const frame_graph_resource r : p.reads)
+		{
+			if (resources[r].desc.samples <= 1 || resources[r].imported || resources[r].resolved != INVALID_RESOURCE)
+				continue;
+
+			//the resolved name is built once per target rather than every frame
+			auto name = resolved_names.find(resources[r].name);
+			if (name == resolved_names.end())
+				name = resolved_names.emplace(resources[r].name, string_id(resources[r].name.get_string() + " Resolved")).first;
+
+			const frame_graph_resource resolved = add_resource(name->second);
+			resources[resolved].desc = resources[r].desc;
+			resources[resolved].desc.samples = 0;
+			resources[r].resolved = resolved;
+
+			p.resolves.push_back(resolve{ r, resolved });
+			frame_stats.resolve_count++;
+		}
+	}
+}
+
+void frame_graph::compute_lifetimes()
+{
+	for (auto& r : resources)
+	{
+		r.first_use = -1;
+		r.last_use = -1;
+		r.physical = nullptr;
+	}
+
+	const auto touch = [this](const frame_graph_resource index, const int pass)
+	{
+		resource& r = resources[index];
+		if (r.first_use < 0)
+			r.first_use = pass;
+		r.last_use = pass;
+	};
+
+	for (unsigned int i = 0; i < passes.size(); i++)
+	{
+		const pass& p = passes[i];
+		if (p.is_culled)
+			continue;
+
+		for (const frame_graph_resource r : p.reads)
+		{
+			touch(r, i);
+			if (resources[r].resolved != INVALID_RESOURCE)
+				touch(resources[r].resolved, i);
+		}
+
+		for (const frame_graph_resource w : p.writes)
+			touch(w, i);
+	}
+}
+
+void frame_graph::allocate()
+{
+	frame_stats.resource_count = 0;
+
+	for (unsigned int i = 0; i < passes.size(); i++)
+	{
+		if (passes[i].is_culled)
+			continue;
+
+		for (auto& r : resources)
+		{
+			if (r.first_use != static_cast<int>(i) || r.imported || r.is_backbuffer)
+				continue;
+
+			r.physical = targets.acquire(r.desc);
+			//an aliased target shows up under whichever resource got it last
+			gpu_memory::set_owner(gpu_memory_category::render_target, r.physical->get_id(), r.name.get_string());
+			frame_stats.resource_count++;
+		}
+
+		//anything whose lifetime ended here is free for the next pass to reuse
+		for (auto& r : resources)
+		{
+			if (r.last_use == static_cast<int>(i) && r.physical)
+				targets.release(r.physical);
+		}
+	}
+
+	frame_stats.physical_count = targets.get_count();
+	frame_stats.transient_bytes = targets.get_size_in_bytes();
+}
+
+void frame_graph::bind_pass_target(const pass& p)
+{
+	current_target = nullptr;
+
+	if (p.attachments.empty())
+		return;
+
+	for (const auto& a : p.attachments)
+	{
+		if (resources[a.resource].is_backbuffer)
+		{
+			frame_buffer::unbind();
+			current_target = nullptr;
+			set_viewport(a.resource);
+			return;
+		}
+	}
+
+	bind_framebuffer(p.attachments);
+}
+
+void frame_graph::bind_framebuffer(const frame_vector<attachment>& attachments)
+{
+	const frame_buffer& fb = get_framebuffer(attachments);
+	fb.bind();
+	current_target = &fb;
+	set_viewport(attachments.front().resource);
+}
+
+const frame_buffer& frame_graph::get_framebuffer(const frame_vector<attachment>& attachments)
+{
+	//looked up as a frame_vector, only a new framebuffer copies its key to the heap
+	frame_vector<unsigned int> key;
+	key.reserve(attachments.size() * 2);
+
+	for (const auto& a : attachments)
+	{
+		key.push_back(a.point);
+		key.push_back(get_physical(a.resource)->get_id());
+	}
+
+	const auto it = framebuffers.find(key);
+	if (it != framebuffers.end())
+		return it->second;
+
+	frame_buffer& fb = framebuffers[std::vector<unsigned int>(key.begin(), key.end())];
+	fb.generate();
+	fb.bind();
+
+	unsigned int color_count = 0;
+
+	for (const auto& a : attachments)
+	{
+		texture& tex = *get_physical(a.resource);
+
+		if (tex.get_type() == texture_type::cube)
+			fb.attach_texture(tex, a.point);
+		else if (a.point == GL_DEPTH_STENCIL_ATTACHMENT)
+			fb.attach_texture_2d_depth_stencil(tex, a.point);
+		else if (a.point == GL_DEPTH_ATTACHMENT)
+			fb.attach_texture_2d_depth(tex, a.point);
+		else
+		{
+			fb.attach_texture_2d_color(tex, a.point);
+			color_count++;
+		}
+	}
+
+	if (color_count == 0)
+	{
+		fb.set_draw_buffer(GL_NONE);
+		fb.set_read_buffer(GL_NONE);
+	}
+	else if (color_count > 1)
+		fb.set_draw_buffers(color_count, nullptr);
+
+	if (!frame_buffer::validate())
+		std::cout << "Frame graph framebuffer for " << resources[attachments.front().resource].name.get_string() << " is incomplete" << std::endl;
+
+	if (current_target)
+		current_target->bind();
+	else
+		frame_buffer::unbind();
+
+	return fb;
+}
+
+texture* frame_graph::get_physical(const frame_graph_resource resource) const
+{
+	const frame_graph::resource& r = resources[resource];
+
+	if (r.imported)
+		return r.imported;
+
+	return r.physical;
+}
+
+GLenum frame_graph::get_depth_point(const frame_graph_resource resource) const
+{
+	return resources[resource].desc.format == GL_DEPTH_STENCIL ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+}
+
+void frame_graph::delete_framebuffers(const std::vector<unsigned int>& texture_ids)
+{
+	if (texture_ids.empty())
+		return;
+
+	for (auto it = framebuffers.begin(); it != framebuffers.end();)
+	{
+		bool uses_texture = false;
+		for (unsigned int i = 1; i < it->first.size(); i += 2)
+			uses_texture = uses_texture || std::find(texture_ids.begin(), texture_ids.end(), it->first[i]) != texture_ids.end();
+
+		if (uses_texture)
+		{
+			it->second.delete_buffer();
+			it = framebuffers.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void frame_graph::set_viewport(const frame_graph_resource resource) const
+{
+	const render_target_desc& desc = resources[resource].desc;
+	render_backend::get().viewport(0, 0, desc.width, desc.height);
+}
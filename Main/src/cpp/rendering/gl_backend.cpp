@@ -0,0 +1,410 @@
+#include "rendering/gl_backend.h"
+
+#include <cstddef>
+
+const char* gl_backend::get_name() const
+{
+	return "gl";
+}
+
+#pragma region State
+
+void gl_backend::use_program(const unsigned int program)
+{
+	glUseProgram(program);
+}
+
+void gl_backend::bind_vertex_array(const unsigned int vao)
+{
+	glBindVertexArray(vao);
+}
+
+void gl_backend::bind_buffer(const GLenum target, const unsigned int buffer)
+{
+	glBindBuffer(target, buffer);
+}
+
+void gl_backend::active_texture(const GLenum unit)
+{
+	glActiveTexture(unit);
+}
+
+void gl_backend::bind_texture(const GLenum target, const unsigned int texture)
+{
+	glBindTexture(target, texture);
+}
+
+void gl_backend::bind_image_texture(const unsigned int unit, const unsigned int texture, const GLenum access, const GLenum format)
+{
+	glBindImageTexture(unit, texture, 0, GL_FALSE, 0, access, format);
+}
+
+void gl_backend::bind_framebuffer(const GLenum target, const unsigned int framebuffer)
+{
+	glBindFramebuffer(target, framebuffer);
+}
+
+void gl_backend::set_capability(const GLenum capability, const bool is_enabled)
+{
+	if (is_enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void gl_backend::cull_face(const GLenum face)
+{
+	glCullFace(face);
+}
+
+void gl_backend::depth_mask(const bool is_writing)
+{
+	glDepthMask(is_writing ? GL_TRUE : GL_FALSE);
+}
+
+void gl_backend::stencil_mask(const unsigned int mask)
+{
+	glStencilMask(mask);
+}
+
+void gl_backend::stencil_func(const GLenum face, const GLenum func, const int ref, const unsigned int mask)
+{
+	glStencilFuncSeparate(face, func, ref, mask);
+}
+
+void gl_backend::stencil_op(const GLenum face, const GLenum s_fail, const GLenum dp_fail, const GLenum dp_pass)
+{
+	glStencilOpSeparate(face, s_fail, dp_fail, dp_pass);
+}
+
+void gl_backend::draw_buffers(const unsigned int count, const GLenum* attachments)
+{
+	glDrawBuffers(static_cast<GLsizei>(count), attachments);
+}
+
+void gl_backend::read_buffer(const GLenum mode)
+{
+	glReadBuffer(mode);
+}
+
+void gl_backend::clear(const GLbitfield mask)
+{
+	glClear(mask);
+}
+
+void gl_backend::viewport(const int x, const int y, const unsigned int width, const unsigned int height)
+{
+	glViewport(x, y, width, height);
+}
+
+void gl_backend::blend_func(const GLenum source, const GLenum destination)
+{
+	glBlendFunc(source, destination);
+}
+
+void gl_backend::depth_func(const GLenum func)
+{
+	glDepthFunc(func);
+}
+
+void gl_backend::polygon_mode(const GLenum mode)
+{
+	glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void gl_backend::blit_framebuffer(const unsigned int source_width, const unsigned int source_height, const unsigned int destination_width, const unsigned int destination_height, const GLbitfield mask, const GLenum filter)
+{
+	glBlitFramebuffer(0, 0, source_width, source_height, 0, 0, destination_width, destination_height, mask, filter);
+}
+
+#pragma endregion
+
+#pragma region Uniforms And Draws
+
+int gl_backend::get_uniform_location(const unsigned int program, const char* name)
+{
+	return glGetUniformLocation(program, name);
+}
+
+void gl_backend::set_uniform(const int location, const constant_type type, const unsigned int count, const float* values)
+{
+	const GLsizei size = static_cast<GLsizei>(count);
+
+	switch (type)
+	{
+	case constant_type::int1: glUniform1i(location, static_cast<int>(values[0])); break;
+	case constant_type::float1: glUniform1fv(location, size, values); break;
+	case constant_type::vec2: glUniform2fv(location, size, values); break;
+	case constant_type::vec3: glUniform3fv(location, size, values); break;
+	case constant_type::vec4: glUniform4fv(location, size, values); break;
+	case constant_type::mat4: glUniformMatrix4fv(location, size, GL_FALSE, values); break;
+	}
+}
+
+void gl_backend::set_uniform_int(const int location, const int value)
+{
+	glUniform1i(location, value);
+}
+
+void gl_backend::draw(const bool is_indexed, const unsigned int element_count, const unsigned int instance_count)
+{
+	const GLsizei elements = static_cast<GLsizei>(element_count);
+
+	//single instances keep the plain entry points the renderers always used
+	if (is_indexed)
+	{
+		if (instance_count == 1)
+			glDrawElements(GL_TRIANGLES, elements, GL_UNSIGNED_INT, nullptr);
+		else
+			glDrawElementsInstanced(GL_TRIANGLES, elements, GL_UNSIGNED_INT, nullptr, instance_count);
+	}
+	else
+	{
+		if (instance_count == 1)
+			glDrawArrays(GL_TRIANGLES, 0, elements);
+		else
+			glDrawArraysInstanced(GL_TRIANGLES, 0, elements, instance_count);
+	}
+}
+
+void gl_backend::dispatch_compute(const unsigned int x, const unsigned int y, const unsigned int z)
+{
+	glDispatchCompute(x, y, z);
+}
+
+void gl_backend::memory_barrier(const GLbitfield barriers)
+{
+	glMemoryBarrier(barriers);
+}
+
+#pragma endregion
+
+#pragma region Resources
+
+unsigned int gl_backend::create_texture()
+{
+	unsigned int texture = 0;
+	glGenTextures(1, &texture);
+	return texture;
+}
+
+void gl_backend::delete_texture(const unsigned int texture)
+{
+	glDeleteTextures(1, &texture);
+}
+
+void gl_backend::tex_image_2d(const GLenum target, const int level, const GLenum internal_format, const unsigned int width, const unsigned int height, const GLenum format, const GLenum data_format, const void* data)
+{
+	glTexImage2D(target, level, internal_format, width, height, 0, format, data_format, data);
+}
+
+void gl_backend::tex_image_2d_multisample(const unsigned int samples, const GLenum internal_format, const unsigned int width, const unsigned int height)
+{
+	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, internal_format, width, height, GL_TRUE);
+}
+
+void gl_backend::tex_sub_image_2d(const GLenum target, const unsigned int width, const unsigned int height, const GLenum format, const GLenum data_format, const void* data)
+{
+	glTexSubImage2D(target, 0, 0, 0, width, height, format, data_format, data);
+}
+
+void gl_backend::tex_parameter(const GLenum target, const GLenum name, const int value)
+{
+	glTexParameteri(target, name, value);
+}
+
+void gl_backend::generate_mipmap(const GLenum target)
+{
+	glGenerateMipmap(target);
+}
+
+unsigned int gl_backend::create_vertex_array()
+{
+	unsigned int vao = 0;
+	glGenVertexArrays(1, &vao);
+	return vao;
+}
+
+void gl_backend::delete_vertex_array(const unsigned int vao)
+{
+	glDeleteVertexArrays(1, &vao);
+}
+
+void gl_backend::vertex_attribute(const unsigned int index, const int size, const unsigned int stride, const unsigned int offset)
+{
+	glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(static_cast<std::size_t>(offset)));
+	glEnableVertexAttribArray(index);
+}
+
+void gl_backend::vertex_attribute_divisor(const unsigned int index, const unsigned int divisor)
+{
+	glVertexAttribDivisor(index, divisor);
+}
+
+unsigned int gl_backend::create_buffer()
+{
+	unsigned int buffer = 0;
+	glGenBuffers(1, &buffer);
+	return buffer;
+}
+
+void gl_backend::delete_buffer(const unsigned int buffer)
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+void gl_backend::buffer_data(const GLenum target, const unsigned int size, const void* data, const GLenum usage)
+{
+	glBufferData(target, size, data, usage);
+}
+
+void gl_backend::buffer_sub_data(const GLenum target, const unsigned int offset, const unsigned int size, const void* data)
+{
+	glBufferSubData(target, offset, size, data);
+}
+
+void gl_backend::bind_buffer_base(const GLenum target, const unsigned int index, const unsigned int buffer)
+{
+	glBindBufferBase(target, index, buffer);
+}
+
+unsigned int gl_backend::create_renderbuffer()
+{
+	unsigned int renderbuffer = 0;
+	glGenRenderbuffers(1, &renderbuffer);
+	return renderbuffer;
+}
+
+void gl_backend::delete_renderbuffer(const unsigned int renderbuffer)
+{
+	glDeleteRenderbuffers(1, &renderbuffer);
+}
+
+void gl_backend::bind_renderbuffer(const unsigned int renderbuffer)
+{
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+}
+
+void gl_backend::renderbuffer_storage(const GLenum internal_format, const unsigned int width, const unsigned int height)
+{
+	glRenderbufferStorage(GL_RENDERBUFFER, internal_format, width, height);
+}
+
+unsigned int gl_backend::create_framebuffer()
+{
+	unsigned int framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	return framebuffer;
+}
+
+void gl_backend::delete_framebuffer(const unsigned int framebuffer)
+{
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+void gl_backend::framebuffer_texture_2d(const GLenum attachment, const GLenum target, const unsigned int texture, const int level)
+{
+	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, target, texture, level);
+}
+
+void gl_backend::framebuffer_texture(const GLenum attachment, const unsigned int texture, const int level)
+{
+	glFramebufferTexture(GL_FRAMEBUFFER, attachment, texture, level);
+}
+
+void gl_backend::framebuffer_renderbuffer(const GLenum attachment, const unsigned int renderbuffer)
+{
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderbuffer);
+}
+
+GLenum gl_backend::check_framebuffer_status()
+{
+	return glCheckFramebufferStatus(GL_FRAMEBUFFER);
+}
+
+unsigned int gl_backend::create_shader(const GLenum type, const char* source, std::string& error)
+{
+	const unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	int success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+	error.clear();
+	if (!success)
+	{
+		char info_log[512];
+		glGetShaderInfoLog(shader, 512, nullptr, info_log);
+		error = info_log;
+	}
+
+	return shader;
+}
+
+void gl_backend::delete_shader(const unsigned int shader)
+{
+	glDeleteShader(shader);
+}
+
+unsigned int gl_backend::create_program(const unsigned int* shaders, const unsigned int count, std::string& error)
+{
+	const unsigned int program = glCreateProgram();
+	for (unsigned int i = 0; i < count; i++)
+		glAttachShader(program, shaders[i]);
+	glLinkProgram(program);
+
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+	error.clear();
+	if (!success)
+	{
+		char info_log[512];
+		glGetProgramInfoLog(program, 512, nullptr, info_log);
+		error = info_log;
+	}
+
+	return program;
+}
+
+void gl_backend::delete_program(const unsigned int program)
+{
+	glDeleteProgram(program);
+}
+
+void gl_backend::uniform_block_binding(const unsigned int program, const char* block, const unsigned int binding)
+{
+	const unsigned int index = glGetUniformBlockIndex(program, block);
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, index, binding);
+}
+
+unsigned int gl_backend::create_fence()
+{
+	const unsigned int fence = next_fence++;
+	fences[fence] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	return fence;
+}
+
+bool gl_backend::is_fence_signaled(const unsigned int fence)
+{
+	const auto it = fences.find(fence);
+	if (it == fences.end())
+		return true;
+
+	const GLenum status = glClientWaitSync(it->second, 0, 0);
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void gl_backend::delete_fence(const unsigned int fence)
+{
+	const auto it = fences.find(fence);
+	if (it == fences.end())
+		return;
+
+	glDeleteSync(it->second);
+	fences.erase(it);
+}
+
+#pragma endregion
@@ -0,0 +1,304 @@
+#include "rendering/gpu_memory.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "utils/cpu_profiler.h"
+
+std::unordered_map<unsigned long long, gpu_allocation> gpu_memory::allocations;
+std::size_t gpu_memory::totals[static_cast<unsigned int>(gpu_memory_category::count)]{};
+unsigned int gpu_memory::counts[static_cast<unsigned int>(gpu_memory_category::count)]{};
+std::size_t gpu_memory::budget{ 0 };
+bool gpu_memory::has_warned{ false };
+
+namespace
+{
+	const char* format_to_string(const GLenum internal_format)
+	{
+		switch (internal_format)
+		{
+		case GL_RED: return "R8";
+		case GL_RG: return "RG8";
+		case GL_RGB: return "RGB8";
+		case GL_RGBA: return "RGBA8";
+		case GL_SRGB: return "SRGB8";
+		case GL_SRGB_ALPHA: return "SRGB8_A8";
+		case GL_R16F: return "R16F";
+		case GL_RG16F: return "RG16F";
+		case GL_RGB16F: return "RGB16F";
+		case GL_RGBA16F: return "RGBA16F";
+		case GL_R32F: return "R32F";
+		case GL_RG32F: return "RG32F";
+		case GL_RGB32F: return "RGB32F";
+		case GL_RGBA32F: return "RGBA32F";
+		case GL_DEPTH_COMPONENT: return "DEPTH";
+		case GL_DEPTH_COMPONENT24: return "DEPTH24";
+		case GL_DEPTH_COMPONENT32F: return "DEPTH32F";
+		case GL_DEPTH24_STENCIL8: return "DEPTH24_STENCIL8";
+		case GL_DEPTH32F_STENCIL8: return "DEPTH32F_STENCIL8";
+		case GL_NONE: return "";
+		default: return "other";
+		}
+	}
+
+	double to_mb(const std::size_t bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
+}
+
+void gpu_memory::track(const gpu_memory_category category, const unsigned int name, const std::size_t bytes, const std::string& owner)
+{
+	if (name == 0)
+		return;
+
+	//a name handed out again means the old object is gone, reallocating storage in place ends up here too
+	untrack(category, name);
+
+	gpu_allocation allocation{ category, name, bytes, owner, 0, 0, GL_NONE };
+	allocations.emplace(get_key(get_name_space(category), name), std::move(allocation));
+	totals[static_cast<unsigned int>(category)] += bytes;
+	counts[static_cast<unsigned int>(category)]++;
+}
+
+void gpu_memory::track_texture(const gpu_memory_category category, const unsigned int name, const std::string& owner, const GLenum internal_format,
+	const unsigned int width, const unsigned int height, const unsigned int layers, const unsigned int samples, const bool has_mipmaps)
+{
+	track(category, name, estimate_texture_size(internal_format, width, height, layers, samples, has_mipmaps), owner);
+
+	const auto it = allocations.find(get_key(get_name_space(category), name));
+	if (it == allocations.end())
+		return;
+
+	it->second.width = width;
+	it->second.height = height;
+	it->second.internal_format = internal_format;
+}
+
+void gpu_memory::untrack(const gpu_memory_category category, const unsigned int name)
+{
+	untrack(get_name_space(category), name);
+}
+
+void gpu_memory::untrack(const gpu_name_space name_space, const unsigned int name)
+{
+	const auto it = allocations.find(get_key(name_space, name));
+	if (it == allocations.end())
+		return;
+
+	const unsigned int tracked = static_cast<unsigned int>(it->second.category);
+	totals[tracked] -= it->second.bytes;
+	counts[tracked]--;
+	allocations.erase(it);
+}
+
+void gpu_memory::set_owner(const gpu_memory_category category, const unsigned int name, const std::string& owner)
+{
+	const auto it = allocations.find(get_key(get_name_space(category), name));
+
+	//called every frame for the frame graph targets, the compare keeps it from reallocating the string
+	if (it != allocations.end() && it->second.owner != owner)
+		it->second.owner = owner;
+}
+
+std::string gpu_memory::get_owner(const gpu_memory_category category, const unsigned int name)
+{
+	const auto it = allocations.find(get_key(get_name_space(category), name));
+	return it != allocations.end() ? it->second.owner : std::string();
+}
+
+std::size_t gpu_memory::get_total()
+{
+	std::size_t total = 0;
+
+	for (const std::size_t bytes : totals)
+		total += bytes;
+
+	return total;
+}
+
+std::size_t gpu_memory::get_total(const gpu_memory_category category)
+{
+	return totals[static_cast<unsigned int>(category)];
+}
+
+unsigned int gpu_memory::get_count(const gpu_memory_category category)
+{
+	return counts[static_cast<unsigned int>(category)];
+}
+
+std::vector<gpu_allocation> gpu_memory::get_largest(const unsigned int count, const gpu_memory_category filter)
+{
+	std::vector<gpu_allocation> largest;
+	largest.reserve(allocations.size());
+
+	for (const auto& allocation : allocations)
+	{
+		if (filter == gpu_memory_category::count || allocation.second.category == filter)
+			largest.push_back(allocation.second);
+	}
+
+	const std::size_t kept = std::min<std::size_t>(count, largest.size());
+	std::partial_sort(largest.begin(), largest.begin() + kept, largest.end(), [](const gpu_allocation& a, const gpu_allocation& b)
+	{
+		return a.bytes > b.bytes;
+	});
+	largest.resize(kept);
+
+	return largest;
+}
+
+void gpu_memory::set_budget(const std::size_t bytes)
+{
+	budget = bytes;
+	has_warned = false;
+}
+
+std::size_t gpu_memory::get_budget()
+{
+	return budget;
+}
+
+bool gpu_memory::is_over_budget()
+{
+	return budget > 0 && get_total() > budget;
+}
+
+void gpu_memory::check_budget()
+{
+	if (!is_over_budget())
+	{
+		has_warned = false;
+		return;
+	}
+
+	if (has_warned)
+		return;
+
+	has_warned = true;
+
+	std::cout << "WARNING: GPU MEMORY " << std::fixed << std::setprecision(1) << to_mb(get_total()) << " MB IS OVER THE "
+		<< to_mb(budget) << " MB BUDGET, LARGEST:" << std::endl;
+
+	for (const gpu_allocation& allocation : get_largest(5))
+	{
+		std::cout << "    " << to_mb(allocation.bytes) << " MB " << category_to_string(allocation.category) << " " << allocation.owner;
+		if (allocation.width > 0)
+			std::cout << " " << allocation.width << "x" << allocation.height << " " << format_to_string(allocation.internal_format);
+		std::cout << std::endl;
+	}
+
+	std::cout << std::defaultfloat;
+}
+
+bool gpu_memory::write_json(const std::string& path)
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << path << " for the gpu memory report" << std::endl;
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\n\"total_mb\":" << to_mb(get_total()) << ",\"budget_mb\":" << to_mb(budget) << ",\n\"categories\":{";
+
+	for (unsigned int i = 0; i < static_cast<unsigned int>(gpu_memory_category::count); i++)
+	{
+		file << (i == 0 ? "\n" : ",\n");
+		cpu_profiler::write_json_string(file, category_to_string(static_cast<gpu_memory_category>(i)));
+		file << ":{\"mb\":" << to_mb(totals[i]) << ",\"count\":" << counts[i] << "}";
+	}
+	file << "\n},\n\"allocations\":[";
+
+	const std::vector<gpu_allocation> largest = get_largest(static_cast<unsigned int>(allocations.size()));
+	for (std::size_t i = 0; i < largest.size(); i++)
+	{
+		const gpu_allocation& allocation = largest[i];
+
+		file << (i == 0 ? "\n{\"category\":" : ",\n{\"category\":");
+		cpu_profiler::write_json_string(file, category_to_string(allocation.category));
+		file << ",\"owner\":";
+		cpu_profiler::write_json_string(file, allocation.owner.c_str());
+		file << ",\"name\":" << allocation.name << ",\"bytes\":" << allocation.bytes;
+		if (allocation.width > 0)
+		{
+			file << ",\"width\":" << allocation.width << ",\"height\":" << allocation.height << ",\"format\":";
+			cpu_profiler::write_json_string(file, format_to_string(allocation.internal_format));
+		}
+		file << "}";
+	}
+	file << "\n]\n}\n";
+
+	std::cout << "Wrote " << largest.size() << " gpu allocations to " << path << std::endl;
+	return true;
+}
+
+std::size_t gpu_memory::get_bytes_per_pixel(const GLenum internal_format)
+{
+	//three channel formats are padded to four by every driver worth measuring on
+	switch (internal_format)
+	{
+	case GL_RGBA32F:
+	case GL_RGB32F: return 16;
+	case GL_RGBA16F:
+	case GL_RGB16F:
+	case GL_RG32F:
+	case GL_DEPTH32F_STENCIL8: return 8;
+	case GL_R16F:
+	case GL_RG: return 2;
+	case GL_RED: return 1;
+	default: return 4;
+	}
+}
+
+std::size_t gpu_memory::estimate_texture_size(const GLenum internal_format, unsigned int width, unsigned int height,
+	const unsigned int layers, const unsigned int samples, const bool has_mipmaps)
+{
+	const std::size_t bytes_per_pixel = get_bytes_per_pixel(internal_format) * std::max(samples, 1u) * std::max(layers, 1u);
+	std::size_t bytes = static_cast<std::size_t>(width) * height * bytes_per_pixel;
+
+	while (has_mipmaps && (width > 1 || height > 1))
+	{
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+		bytes += static_cast<std::size_t>(width) * height * bytes_per_pixel;
+	}
+
+	return bytes;
+}
+
+const char* gpu_memory::category_to_string(const gpu_memory_category category)
+{
+	switch (category)
+	{
+	case gpu_memory_category::texture: return "Textures";
+	case gpu_memory_category::render_target: return "Render Targets";
+	case gpu_memory_category::renderbuffer: return "Renderbuffers";
+	case gpu_memory_category::vertex_buffer: return "Vertex Buffers";
+	case gpu_memory_category::index_buffer: return "Index Buffers";
+	case gpu_memory_category::instance_buffer: return "Instance Buffers";
+	case gpu_memory_category::uniform_buffer: return "Uniform Buffers";
+	case gpu_memory_category::storage_buffer: return "Storage Buffers";
+	default: return "error";
+	}
+}
+
+gpu_name_space gpu_memory::get_name_space(const gpu_memory_category category)
+{
+	switch (category)
+	{
+	case gpu_memory_category::texture:
+	case gpu_memory_category::render_target: return gpu_name_space::texture;
+	case gpu_memory_category::renderbuffer: return gpu_name_space::renderbuffer;
+	default: return gpu_name_space::buffer;
+	}
+}
+
+unsigned long long gpu_memory::get_key(const gpu_name_space name_space, const unsigned int name)
+{
+	return static_cast<unsigned long long>(name_space) << 32 | name;
+}
@@ -0,0 +1,102 @@
+#include "rendering/gpu_mesh.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
+
+gpu_mesh::gpu_mesh() = default;
+
+gpu_mesh::gpu_mesh(const mesh& m)
+{
+	upload(m);
+}
+
+std::shared_ptr<gpu_mesh> gpu_mesh::acquire(const mesh& m)
+{
+	const std::shared_ptr<mesh_data> geometry = m.get_geometry();
+	std::shared_ptr<gpu_mesh> gpu = geometry->get_gpu_mesh();
+
+	if (gpu)
+		return gpu;
+
+	gpu = std::make_shared<gpu_mesh>(m);
+	geometry->set_gpu_mesh(gpu);
+	geometry->release();
+	return gpu;
+}
+
+void gpu_mesh::upload(const mesh& m)
+{
+	const std::vector<vertex>& vertices = m.get_vertices();
+	const std::vector<unsigned int>& indices = m.get_indices();
+	
+	vertex_count = static_cast<unsigned int>(vertices.size());
+	index_count = static_cast<unsigned int>(indices.size());
+	is_indexed = m.is_indexed && index_count > 0;
+
+	render_backend& backend = render_backend::get();
+
+	vbo = backend.create_buffer();
+	vertex_buffer = gpu_resource(gpu_resource_type::buffer, vbo, gpu_memory_category::vertex_buffer);
+	backend.bind_buffer(GL_ARRAY_BUFFER, vbo);
+	backend.buffer_data(GL_ARRAY_BUFFER, static_cast<unsigned int>(vertex_count * sizeof(vertex)), vertices.data(), GL_STATIC_DRAW);
+	render_stats::counters.buffer_upload_bytes += vertex_count * sizeof(vertex);
+	gpu_memory::track(gpu_memory_category::vertex_buffer, vbo, vertex_count * sizeof(vertex), "Mesh");
+	backend.bind_buffer(GL_ARRAY_BUFFER, 0);
+
+	if (is_indexed)
+	{
+		//element buffer binding is part of vao state, so the buffer is filled through GL_COPY_WRITE_BUFFER
+		//to avoid clobbering whatever vao is currently bound
+		ebo = backend.create_buffer();
+		index_buffer = gpu_resource(gpu_resource_type::buffer, ebo, gpu_memory_category::index_buffer);
+		backend.bind_buffer(GL_COPY_WRITE_BUFFER, ebo);
+		backend.buffer_data(GL_COPY_WRITE_BUFFER, static_cast<unsigned int>(index_count * sizeof(unsigned int)), indices.data(), GL_STATIC_DRAW);
+		render_stats::counters.buffer_upload_bytes += index_count * sizeof(unsigned int);
+		gpu_memory::track(gpu_memory_category::index_buffer, ebo, index_count * sizeof(unsigned int), "Mesh");
+		backend.bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+}
+
+void gpu_mesh::bind_vertex_buffer() const
+{
+	render_backend::get().bind_buffer(GL_ARRAY_BUFFER, vbo);
+}
+
+void gpu_mesh::bind_index_buffer() const
+{
+	if (is_indexed)
+		render_backend::get().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+}
+
+void gpu_mesh::deallocate()
+{
+	vertex_buffer.reset();
+	index_buffer.reset();
+	vbo = 0;
+	ebo = 0;
+}
+
+unsigned gpu_mesh::get_vbo() const
+{
+	return vbo;
+}
+
+unsigned gpu_mesh::get_ebo() const
+{
+	return ebo;
+}
+
+unsigned gpu_mesh::get_vertex_count() const
+{
+	return vertex_count;
+}
+
+unsigned gpu_mesh::get_index_count() const
+{
+	return index_count;
+}
+
+bool gpu_mesh::get_is_indexed() const
+{
+	return is_indexed;
+}
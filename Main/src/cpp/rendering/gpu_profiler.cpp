@@ -0,0 +1,318 @@
+#include "rendering/gpu_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include <glad/glad.h>
+
+gpu_profiler& gpu_profiler::get()
+{
+	static gpu_profiler profiler;
+	return profiler;
+}
+
+void gpu_profiler::begin_frame()
+{
+	stack.clear();
+
+	//oldest first so history stays in frame order
+	for (unsigned int i = 0; i < LATENCY; i++)
+	{
+		frame_slot& slot = slots[(current + i) % LATENCY];
+
+		if (slot.is_pending)
+			collect(slot);
+	}
+
+	//the gpu is more than LATENCY frames behind, skip this frame rather than wait for it
+	is_recording = is_enabled && !slots[current].is_pending;
+
+	if (!is_recording)
+		return;
+
+	slots[current].segments.clear();
+	slots[current].frame = frame;
+}
+
+void gpu_profiler::end_frame()
+{
+	if (is_recording)
+	{
+		if (!stack.empty())
+		{
+			std::cout << "gpu_profiler: " << stack.size() << " scopes still open at the end of the frame" << std::endl;
+			stop_segment();
+			stack.clear();
+		}
+
+		frame_slot& slot = slots[current];
+		slot.is_pending = !slot.segments.empty();
+		current = (current + 1) % LATENCY;
+	}
+
+	is_recording = false;
+	frame++;
+}
+
+void gpu_profiler::push(const string_id& name)
+{
+	if (is_recording)
+		push_scope(get_scope(name));
+}
+
+void gpu_profiler::push(const char* name)
+{
+	if (!is_recording)
+		return;
+
+	//skips building a std::string to intern the name every time the scope runs
+	auto it = literal_lookup.find(name);
+	if (it == literal_lookup.end())
+		it = literal_lookup.emplace(name, get_scope(string_id(name))).first;
+
+	push_scope(it->second);
+}
+
+void gpu_profiler::push_scope(const unsigned int scope)
+{
+	if (!stack.empty())
+		stop_segment();
+
+	stack.push_back(scope);
+	start_segment(scope);
+}
+
+void gpu_profiler::pop()
+{
+	if (!is_recording || stack.empty())
+		return;
+
+	stop_segment();
+	stack.pop_back();
+
+	//the outer scope picks up where it left off
+	if (!stack.empty())
+		start_segment(stack.back());
+}
+
+void gpu_profiler::release()
+{
+	for (frame_slot& slot : slots)
+	{
+		if (!slot.queries.empty())
+			glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+
+		slot.queries.clear();
+		slot.segments.clear();
+		slot.is_pending = false;
+	}
+
+	is_recording = false;
+	stack.clear();
+}
+
+std::vector<gpu_profiler::scope_stats> gpu_profiler::get_stats() const
+{
+	std::vector<scope_stats> stats;
+
+	if (history_count == 0)
+		return stats;
+
+	const frame_record& newest = history[(history_next + HISTORY - 1) % HISTORY];
+	std::vector<float> samples;
+	samples.reserve(history_count);
+
+	for (unsigned int i = 0; i < scopes.size(); i++)
+	{
+		samples.clear();
+
+		for (unsigned int h = 0; h < history_count; h++)
+		{
+			const frame_record& record = history[h];
+			if (i < record.scope_ms.size() && record.scope_ms[i] >= 0)
+				samples.push_back(record.scope_ms[i]);
+		}
+
+		//culled for the whole window, nothing to show
+		if (samples.empty())
+			continue;
+
+		std::sort(samples.begin(), samples.end());
+
+		float sum = 0;
+		for (const float ms : samples)
+			sum += ms;
+
+		const std::size_t p99 = std::min(samples.size() - 1, static_cast<std::size_t>(std::ceil(samples.size() * 0.99f)) - 1);
+
+		scope_stats s;
+		s.name = scopes[i].name.get_string();
+		s.depth = scopes[i].depth;
+		s.last_ms = i < newest.scope_ms.size() ? std::max(newest.scope_ms[i], 0.0f) : 0.0f;
+		s.min_ms = samples.front();
+		s.avg_ms = sum / static_cast<float>(samples.size());
+		s.p99_ms = samples[p99];
+		stats.push_back(s);
+	}
+
+	return stats;
+}
+
+float gpu_profiler::get_frame_ms() const
+{
+	if (history_count == 0)
+		return 0;
+
+	const frame_record& newest = history[(history_next + HISTORY - 1) % HISTORY];
+
+	float sum = 0;
+	for (const float ms : newest.scope_ms)
+		sum += std::max(ms, 0.0f);
+
+	return sum;
+}
+
+unsigned long long gpu_profiler::get_frame_index() const
+{
+	return frame;
+}
+
+bool gpu_profiler::get_frame_timings(const unsigned long long frame_index, std::vector<std::pair<std::string, float>>& timings) const
+{
+	timings.clear();
+
+	for (unsigned int h = 0; h < history_count; h++)
+	{
+		const frame_record& record = history[h];
+		if (record.frame != frame_index)
+			continue;
+
+		for (unsigned int i = 0; i < record.scope_ms.size(); i++)
+		{
+			if (record.scope_ms[i] >= 0)
+				timings.emplace_back(scopes[i].name.get_string(), record.scope_ms[i]);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool gpu_profiler::export_csv(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << path << " for the gpu profile" << std::endl;
+		return false;
+	}
+
+	file << "frame";
+	for (const scope_info& scope : scopes)
+		file << "," << scope.name.get_string();
+	file << "\n";
+
+	//the ring starts at history_next once it has wrapped
+	const unsigned int start = history_count < HISTORY ? 0 : history_next;
+
+	for (unsigned int i = 0; i < history_count; i++)
+	{
+		const frame_record& record = history[(start + i) % HISTORY];
+		file << record.frame;
+
+		for (unsigned int s = 0; s < scopes.size(); s++)
+		{
+			file << ",";
+			if (s < record.scope_ms.size() && record.scope_ms[s] >= 0)
+				file << record.scope_ms[s];
+		}
+		file << "\n";
+	}
+
+	std::cout << "Wrote " << history_count << " frames of gpu timings to " << path << std::endl;
+	return true;
+}
+
+unsigned int gpu_profiler::get_scope(const string_id& name)
+{
+	const auto it = scope_lookup.find(name);
+	if (it != scope_lookup.end())
+		return it->second;
+
+	const unsigned int index = static_cast<unsigned int>(scopes.size());
+	scopes.push_back({ name, static_cast<unsigned int>(stack.size()) });
+	scope_lookup[name] = index;
+	return index;
+}
+
+void gpu_profiler::start_segment(const unsigned int scope)
+{
+	frame_slot& slot = slots[current];
+
+	//queries are reused frame to frame, only new segments allocate
+	if (slot.segments.size() == slot.queries.size())
+	{
+		unsigned int query;
+		glGenQueries(1, &query);
+		slot.queries.push_back(query);
+	}
+
+	const unsigned int query = slot.queries[slot.segments.size()];
+	slot.segments.push_back({ scope, query });
+	glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void gpu_profiler::stop_segment()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+}
+
+void gpu_profiler::collect(frame_slot& slot)
+{
+	//queries finish in order, the last one being ready means they all are
+	GLint is_available = 0;
+	glGetQueryObjectiv(slot.segments.back().query, GL_QUERY_RESULT_AVAILABLE, &is_available);
+
+	if (!is_available)
+		return;
+
+	//the whole ring up front and records overwritten in place, so reading back a frame does not allocate
+	if (history.empty())
+	{
+		history.resize(HISTORY);
+		for (frame_record& r : history)
+			r.scope_ms.reserve(scopes.size());
+	}
+
+	frame_record& record = history[history_next];
+	record.frame = slot.frame;
+	record.scope_ms.assign(scopes.size(), -1.0f);
+
+	for (const segment& s : slot.segments)
+	{
+		GLuint64 ns = 0;
+		glGetQueryObjectui64v(s.query, GL_QUERY_RESULT, &ns);
+
+		float& ms = record.scope_ms[s.scope];
+		ms = std::max(ms, 0.0f) + static_cast<float>(ns) / 1000000.0f;
+	}
+
+	slot.is_pending = false;
+	if (history_count < HISTORY)
+		history_count++;
+	history_next = (history_next + 1) % HISTORY;
+}
+
+gpu_profile_scope::gpu_profile_scope(const char* name)
+{
+	gpu_profiler::get().push(name);
+}
+
+gpu_profile_scope::~gpu_profile_scope()
+{
+	gpu_profiler::get().pop();
+}
@@ -0,0 +1,233 @@
+#include "rendering/gpu_resource.h"
+
+#include "rendering/gpu_memory.h"
+#include "rendering/render_backend.h"
+
+#pragma region gpu_resources
+
+gpu_resources& gpu_resources::get()
+{
+	//never destroyed, globals holding a texture or a buffer still release into it during static destruction
+	static gpu_resources* instance = new gpu_resources();
+	return *instance;
+}
+
+gpu_handle gpu_resources::create(const gpu_resource_type type, const unsigned int name, const gpu_memory_category category)
+{
+	if (name == 0)
+		return gpu_handle();
+
+	unsigned int index;
+
+	if (free_slots.empty())
+	{
+		index = static_cast<unsigned int>(slots.size());
+		slots.push_back(slot{ 0, 1, 0, type, category });
+	}
+	else
+	{
+		index = free_slots.back();
+		free_slots.pop_back();
+	}
+
+	slot& s = slots[index];
+	s.name = name;
+	s.references = 1;
+	s.type = type;
+	s.category = category;
+	live_count++;
+
+	return gpu_handle{ index, s.generation };
+}
+
+void gpu_resources::add_ref(const gpu_handle handle)
+{
+	if (find(handle))
+		slots[handle.index].references++;
+}
+
+void gpu_resources::release(const gpu_handle handle)
+{
+	if (!find(handle))
+		return;
+
+	slot& s = slots[handle.index];
+
+	if (--s.references > 0)
+		return;
+
+	if (!is_shut_down)
+		released.push_back(pending_object{ s.type, s.name, s.category });
+
+	//the handle goes stale right away, only the gl name waits for the fence
+	s.name = 0;
+	s.generation++;
+	free_slots.push_back(handle.index);
+	live_count--;
+}
+
+unsigned int gpu_resources::get_name(const gpu_handle handle) const
+{
+	const slot* s = find(handle);
+	return s ? s->name : 0;
+}
+
+bool gpu_resources::is_valid(const gpu_handle handle) const
+{
+	return find(handle) != nullptr;
+}
+
+void gpu_resources::end_frame()
+{
+	render_backend& backend = render_backend::get();
+
+	//frames that released nothing need no fence
+	if (!released.empty())
+	{
+		in_flight.push_back(retired_frame{ backend.create_fence(), std::vector<pending_object>() });
+		in_flight.back().objects.swap(released);
+	}
+
+	//fences signal in submission order, the first one that has not means none after it has either
+	while (!in_flight.empty() && backend.is_fence_signaled(in_flight.front().fence))
+	{
+		for (const pending_object& object : in_flight.front().objects)
+			destroy(object);
+
+		backend.delete_fence(in_flight.front().fence);
+		in_flight.pop_front();
+	}
+}
+
+void gpu_resources::shutdown()
+{
+	render_backend& backend = render_backend::get();
+
+	for (const retired_frame& frame : in_flight)
+	{
+		for (const pending_object& object : frame.objects)
+			destroy(object);
+
+		backend.delete_fence(frame.fence);
+	}
+
+	for (const pending_object& object : released)
+		destroy(object);
+
+	in_flight.clear();
+	released.clear();
+	is_shut_down = true;
+}
+
+unsigned int gpu_resources::get_live_count() const
+{
+	return live_count;
+}
+
+unsigned int gpu_resources::get_pending_count() const
+{
+	std::size_t count = released.size();
+
+	for (const retired_frame& frame : in_flight)
+		count += frame.objects.size();
+
+	return static_cast<unsigned int>(count);
+}
+
+const gpu_resources::slot* gpu_resources::find(const gpu_handle handle) const
+{
+	if (handle.index == 0 || handle.index >= slots.size())
+		return nullptr;
+
+	const slot& s = slots[handle.index];
+	return s.generation == handle.generation && s.references > 0 ? &s : nullptr;
+}
+
+void gpu_resources::destroy(const pending_object& object)
+{
+	render_backend& backend = render_backend::get();
+
+	switch (object.type)
+	{
+	case gpu_resource_type::texture:
+		backend.delete_texture(object.name);
+		break;
+	case gpu_resource_type::buffer:
+		backend.delete_buffer(object.name);
+		break;
+	case gpu_resource_type::renderbuffer:
+		backend.delete_renderbuffer(object.name);
+		break;
+	case gpu_resource_type::vertex_array:
+		backend.delete_vertex_array(object.name);
+		break;
+	case gpu_resource_type::program:
+		backend.delete_program(object.name);
+		break;
+	default:
+		break;
+	}
+
+	//the name can be handed out again from here on, the accounting has to go with it
+	if (object.category != gpu_memory_category::count)
+		gpu_memory::untrack(object.category, object.name);
+}
+
+#pragma endregion
+
+gpu_resource::gpu_resource(const gpu_resource_type type, const unsigned int name, const gpu_memory_category category) :
+	handle(gpu_resources::get().create(type, name, category))
+{
+}
+
+gpu_resource::gpu_resource(const gpu_resource& other) : handle(other.handle)
+{
+	gpu_resources::get().add_ref(handle);
+}
+
+gpu_resource::gpu_resource(gpu_resource&& other) noexcept : handle(other.handle)
+{
+	other.handle = gpu_handle();
+}
+
+gpu_resource& gpu_resource::operator=(const gpu_resource& other)
+{
+	//add before release so assigning a resource to itself or to a copy of itself keeps it alive
+	gpu_resources::get().add_ref(other.handle);
+	gpu_resources::get().release(handle);
+	handle = other.handle;
+	return *this;
+}
+
+gpu_resource& gpu_resource::operator=(gpu_resource&& other) noexcept
+{
+	if (this != &other)
+	{
+		gpu_resources::get().release(handle);
+		handle = other.handle;
+		other.handle = gpu_handle();
+	}
+
+	return *this;
+}
+
+gpu_resource::~gpu_resource()
+{
+	gpu_resources::get().release(handle);
+}
+
+unsigned int gpu_resource::get_name() const
+{
+	return gpu_resources::get().get_name(handle);
+}
+
+gpu_handle gpu_resource::get_handle() const
+{
+	return handle;
+}
+
+void gpu_resource::reset()
+{
+	gpu_resources::get().release(handle);
+	handle = gpu_handle();
+}
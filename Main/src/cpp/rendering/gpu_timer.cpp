@@ -0,0 +1,87 @@
+#include "rendering/gpu_timer.h"
+
+#include <glad/glad.h>
+
+void gpu_timer::init()
+{
+	if (queries[0][0] != 0)
+		return;
+
+	glGenQueries(LATENCY * 2, &queries[0][0]);
+}
+
+void gpu_timer::release()
+{
+	if (queries[0][0] == 0)
+		return;
+
+	glDeleteQueries(LATENCY * 2, &queries[0][0]);
+
+	for (unsigned int i = 0; i < LATENCY; i++)
+	{
+		queries[i][0] = queries[i][1] = 0;
+		is_pending[i] = false;
+	}
+}
+
+void gpu_timer::begin()
+{
+	collect();
+
+	//the gpu is more than LATENCY frames behind, drop this measurement rather than wait for it
+	is_skipping = is_pending[current];
+
+	if (!is_skipping)
+		glQueryCounter(queries[current][0], GL_TIMESTAMP);
+}
+
+void gpu_timer::end()
+{
+	if (is_skipping)
+		return;
+
+	glQueryCounter(queries[current][1], GL_TIMESTAMP);
+	is_pending[current] = true;
+	current = (current + 1) % LATENCY;
+}
+
+bool gpu_timer::take_result(float& ms)
+{
+	if (!has_new_result)
+		return false;
+
+	ms = last_ms;
+	has_new_result = false;
+	return true;
+}
+
+float gpu_timer::get_last_ms() const
+{
+	return last_ms;
+}
+
+void gpu_timer::collect()
+{
+	//oldest first so last_ms always ends on the newest result
+	for (unsigned int i = 0; i < LATENCY; i++)
+	{
+		const unsigned int slot = (current + i) % LATENCY;
+
+		if (!is_pending[slot])
+			continue;
+
+		GLint is_available = 0;
+		glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &is_available);
+
+		if (!is_available)
+			continue;
+
+		GLuint64 start = 0, stop = 0;
+		glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &stop);
+
+		last_ms = static_cast<float>(stop - start) / 1000000.0f;
+		has_new_result = true;
+		is_pending[slot] = false;
+	}
+}
@@ -0,0 +1,70 @@
+#include "rendering/image_cache.h"
+
+#include "engine/job_system.h"
+#include "utils/cpu_profiler.h"
+#include "utils/memory_tracker.h"
+#include "stb_image.h"
+
+std::mutex image_cache::mutex;
+std::unordered_map<std::string, decoded_image> image_cache::images;
+
+void image_cache::prefetch(const std::vector<std::string>& paths, const std::vector<std::string>& hdr_paths)
+{
+	//set once up front, the flag is global to stb_image and not safe to flip from the jobs
+	stbi_set_flip_vertically_on_load(true);
+
+	const unsigned int count = static_cast<unsigned int>(paths.size() + hdr_paths.size());
+
+	job_system::get().parallel_for(count, 1, [&paths, &hdr_paths](const unsigned int begin, const unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const bool is_hdr = i >= paths.size();
+			const std::string& path = is_hdr ? hdr_paths[i - paths.size()] : paths[i];
+			const decoded_image image = decode(path, is_hdr);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			images[path] = image;
+		}
+	});
+}
+
+decoded_image image_cache::acquire(const std::string& path, const bool is_hdr)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const auto it = images.find(path);
+
+		if (it != images.end() && it->second.is_hdr == is_hdr)
+		{
+			const decoded_image image = it->second;
+			images.erase(it);
+			return image;
+		}
+	}
+
+	stbi_set_flip_vertically_on_load(true);
+	return decode(path, is_hdr);
+}
+
+void image_cache::release(decoded_image& image)
+{
+	stbi_image_free(image.data);
+	image.data = nullptr;
+}
+
+decoded_image image_cache::decode(const std::string& path, const bool is_hdr)
+{
+	cpu_profile_scope scope("Decode Image");
+	memory_tag_scope tag(memory_tag::textures);
+
+	decoded_image image;
+	image.is_hdr = is_hdr;
+
+	if (is_hdr)
+		image.data = stbi_loadf(path.c_str(), &image.width, &image.height, &image.channels, 0);
+	else
+		image.data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+
+	return image;
+}
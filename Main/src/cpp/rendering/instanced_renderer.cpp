@@ -1,4 +1,7 @@
 #include "rendering/instanced_renderer.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
 
 instanced_renderer::instanced_renderer() : renderer()
 {
@@ -9,67 +12,61 @@ instanced_renderer::instanced_renderer() : renderer()
 instanced_renderer::instanced_renderer(std::shared_ptr<mesh> m, void* instanced_data, const unsigned int buffer_size)
 {
 	mesh_ptr = std::move(m);
-	vbo = 0;
+	gpu_mesh_ptr = gpu_mesh::acquire(*mesh_ptr);
 	vao = 0;
-	ebo = 0;
 	this->instanced_data = instanced_data;
 	this->buffer_size = buffer_size;
 	
 	setup();
 }
 
-void instanced_renderer::setup()
+instanced_renderer::instanced_renderer(std::shared_ptr<mesh> m, std::shared_ptr<gpu_mesh> gpu, void* instanced_data, const unsigned int buffer_size)
 {
-	//generate buffers
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-	glGenBuffers(1, &matrices_vbo);
-
-	if (mesh_ptr->is_indexed)
-		glGenBuffers(1, &ebo);
-
+	mesh_ptr = std::move(m);
+	gpu_mesh_ptr = std::move(gpu);
+	vao = 0;
+	this->instanced_data = instanced_data;
+	this->buffer_size = buffer_size;
 
-	glBindVertexArray(vao);
+	setup();
+}
 
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, mesh_ptr->vertices.size() * sizeof(vertex), &mesh_ptr->vertices[0], GL_STATIC_DRAW);
+void instanced_renderer::setup()
+{
+	//vertex and index buffers come from the shared gpu_mesh, only the per instance matrices are owned here
+	render_backend& backend = render_backend::get();
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(vertex), nullptr);
-	glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(3 * sizeof(float)));
-	glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(6 * sizeof(float)));
-	glVertexAttribPointer(3, 3, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(8 * sizeof(float)));
-	glVertexAttribPointer(4, 3, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(11 * sizeof(float)));
+	vao = backend.create_vertex_array();
+	vertex_array = gpu_resource(gpu_resource_type::vertex_array, vao);
+	matrices_vbo = backend.create_buffer();
+	matrices = gpu_resource(gpu_resource_type::buffer, matrices_vbo, gpu_memory_category::instance_buffer);
 
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
-	glEnableVertexAttribArray(4);
+	backend.bind_vertex_array(vao);
 
-	glBindBuffer(GL_ARRAY_BUFFER, matrices_vbo);
-	glBufferData(GL_ARRAY_BUFFER, buffer_size, instanced_data, GL_STATIC_DRAW);
+	gpu_mesh_ptr->bind_vertex_buffer();
 
-	const size_t size = sizeof(glm::vec4);
-	glVertexAttribPointer(5, 4, GL_FLOAT, false, 4 * size, nullptr);
-	glVertexAttribPointer(6, 4, GL_FLOAT, false, 4 * size, reinterpret_cast<void*>(1 * size));
-	glVertexAttribPointer(7, 4, GL_FLOAT, false, 4 * size, reinterpret_cast<void*>(2 * size));
-	glVertexAttribPointer(8, 4, GL_FLOAT, false, 4 * size, reinterpret_cast<void*>(3 * size));
-	glEnableVertexAttribArray(5);
-	glEnableVertexAttribArray(6);
-	glEnableVertexAttribArray(7);
-	glEnableVertexAttribArray(8);
+	backend.vertex_attribute(0, 3, sizeof(vertex), 0);
+	backend.vertex_attribute(1, 3, sizeof(vertex), 3 * sizeof(float));
+	backend.vertex_attribute(2, 2, sizeof(vertex), 6 * sizeof(float));
+	backend.vertex_attribute(3, 3, sizeof(vertex), 8 * sizeof(float));
+	backend.vertex_attribute(4, 3, sizeof(vertex), 11 * sizeof(float));
 
-	glVertexAttribDivisor(5, 1);
-	glVertexAttribDivisor(6, 1);
-	glVertexAttribDivisor(7, 1);
-	glVertexAttribDivisor(8, 1);
+	backend.bind_buffer(GL_ARRAY_BUFFER, matrices_vbo);
+	backend.buffer_data(GL_ARRAY_BUFFER, buffer_size, instanced_data, GL_STATIC_DRAW);
+	render_stats::counters.buffer_upload_bytes += buffer_size;
+	gpu_memory::track(gpu_memory_category::instance_buffer, matrices_vbo, buffer_size, "Instance Matrices");
 
-	if (mesh_ptr->is_indexed)
+	//one mat4 per instance, spread over four vec4 attributes
+	const unsigned int size = sizeof(glm::vec4);
+	for (unsigned int column = 0; column < 4; column++)
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * mesh_ptr->indices.size(), &mesh_ptr->indices[0], GL_STATIC_DRAW);
+		backend.vertex_attribute(5 + column, 4, 4 * size, column * size);
+		backend.vertex_attribute_divisor(5 + column, 1);
 	}
 
-	glBindVertexArray(0);
+	gpu_mesh_ptr->bind_index_buffer();
+
+	backend.bind_vertex_array(0);
+	backend.bind_buffer(GL_ARRAY_BUFFER, 0);
 }
 
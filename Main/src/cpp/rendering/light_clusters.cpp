@@ -0,0 +1,444 @@
+#include "rendering/light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/job_system.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
+#include "rendering/shader_program.h"
+#include "utils/cpu_profiler.h"
+#include "utils/frame_arena.h"
+#include "utils/string_id.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define LIGHT_CLUSTERS_SSE
+#endif
+
+//out of class definitions so the constants can be bound to references, std::min takes them by const&
+constexpr unsigned int light_clusters::TILES_X;
+constexpr unsigned int light_clusters::TILES_Y;
+constexpr unsigned int light_clusters::SLICES;
+constexpr unsigned int light_clusters::CLUSTER_COUNT;
+constexpr unsigned int light_clusters::MAX_LIGHTS;
+constexpr unsigned int light_clusters::MAX_LIGHTS_PER_CLUSTER;
+constexpr unsigned int light_clusters::INDEX_CAPACITY;
+constexpr unsigned int light_clusters::LIGHT_BINDING;
+constexpr unsigned int light_clusters::CLUSTER_BINDING;
+constexpr unsigned int light_clusters::INDEX_BINDING;
+constexpr unsigned int light_clusters::COUNTER_BINDING;
+
+void light_clusters::init()
+{
+	const auto create = [](unsigned int& buffer, gpu_resource& resource, const unsigned int capacity, const char* owner)
+	{
+		buffer = render_backend::get().create_buffer();
+		resource = gpu_resource(gpu_resource_type::buffer, buffer, gpu_memory_category::storage_buffer);
+		upload(buffer, capacity, nullptr, 0);
+		gpu_memory::track(gpu_memory_category::storage_buffer, buffer, capacity, owner);
+	};
+
+	create(light_buffer, light_resource, MAX_LIGHTS * sizeof(cluster_light), "Cluster Lights");
+	create(cluster_buffer, cluster_resource, CLUSTER_COUNT * sizeof(cluster_range), "Cluster Ranges");
+	create(index_buffer, index_resource, INDEX_CAPACITY * sizeof(unsigned int), "Cluster Light Indices");
+	create(counter_buffer, counter_resource, sizeof(unsigned int), "Cluster Index Counter");
+
+	//everything is sized once here so building the lists never touches the heap
+	lights.reserve(MAX_LIGHTS);
+	for (std::vector<float>* v : { &view_space.x, &view_space.y, &view_space.depth, &view_space.range,
+		&view_space.dir_x, &view_space.dir_y, &view_space.dir_depth, &view_space.cos_outer, &view_space.sin_outer })
+		v->reserve(MAX_LIGHTS);
+	scratch.resize(CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER);
+	scratch_counts.resize(CLUSTER_COUNT);
+	ranges.resize(CLUSTER_COUNT);
+	indices.reserve(INDEX_CAPACITY);
+}
+
+void light_clusters::set_compute_program(const shader_program* program)
+{
+	compute_program = program;
+}
+
+bool light_clusters::has_compute_program() const
+{
+	return compute_program != nullptr;
+}
+
+void light_clusters::begin_frame()
+{
+	lights.clear();
+}
+
+void light_clusters::add_point_light(const glm::vec3& position, const float range, const glm::vec3& diffuse, const glm::vec3& specular,
+	const float linear, const float quadratic)
+{
+	if (lights.size() == MAX_LIGHTS)
+		return;
+
+	lights.push_back(cluster_light{ glm::vec4(position, range), glm::vec4(diffuse, linear), glm::vec4(specular, quadratic),
+		glm::vec4(0, 0, 0, -1), glm::vec4(0, 1, 0, 0) });
+}
+
+void light_clusters::add_spot_light(const glm::vec3& position, const float range, const glm::vec3& direction, const float cos_outer,
+	const float cos_inner, const glm::vec3& diffuse, const glm::vec3& specular, const float linear, const float quadratic)
+{
+	if (lights.size() == MAX_LIGHTS)
+		return;
+
+	//full brightness inside the inner cutoff, nothing past the outer one
+	const float fade_scale = 1.0f / std::max(cos_inner - cos_outer, 0.0001f);
+	const float sin_outer = std::sqrt(std::max(1.0f - cos_outer * cos_outer, 0.0f));
+
+	lights.push_back(cluster_light{ glm::vec4(position, range), glm::vec4(diffuse, linear), glm::vec4(specular, quadratic),
+		glm::vec4(glm::normalize(direction), cos_outer), glm::vec4(fade_scale, -cos_outer * fade_scale, sin_outer, 0) });
+}
+
+void light_clusters::build(const glm::mat4& view, const float fov, const float aspect, const float near_plane, const float far_plane)
+{
+	cpu_profile_scope scope("Light Clusters");
+
+	slice_near = near_plane;
+	slice_far = far_plane;
+	upload_lights();
+
+	if (is_using_compute && compute_program)
+	{
+		dispatch(view, fov, aspect);
+		return;
+	}
+
+	update_bounds(fov, aspect, near_plane, far_plane);
+
+	for (std::vector<float>* v : { &view_space.x, &view_space.y, &view_space.depth, &view_space.range,
+		&view_space.dir_x, &view_space.dir_y, &view_space.dir_depth, &view_space.cos_outer, &view_space.sin_outer })
+		v->resize(lights.size());
+
+	for (unsigned int i = 0; i < lights.size(); i++)
+	{
+		const glm::vec4 p = view * glm::vec4(glm::vec3(lights[i].position_range), 1.0f);
+		view_space.x[i] = p.x;
+		view_space.y[i] = p.y;
+		view_space.depth[i] = -p.z;
+		view_space.range[i] = lights[i].position_range.w;
+
+		const glm::vec4 d = view * glm::vec4(glm::vec3(lights[i].direction_cos_outer), 0.0f);
+		view_space.dir_x[i] = d.x;
+		view_space.dir_y[i] = d.y;
+		view_space.dir_depth[i] = -d.z;
+		view_space.cos_outer[i] = lights[i].direction_cos_outer.w;
+		view_space.sin_outer[i] = lights[i].cone.z;
+	}
+
+	//slices share nothing, every cluster writes only its own scratch slots
+	job_system::get().parallel_for(SLICES, 1, [this](const unsigned int begin, const unsigned int end)
+	{
+		for (unsigned int slice = begin; slice < end; slice++)
+			assign_slice(slice);
+	});
+
+	compact();
+
+	upload(cluster_buffer, CLUSTER_COUNT * sizeof(cluster_range), ranges.data(), CLUSTER_COUNT * sizeof(cluster_range));
+	upload(index_buffer, INDEX_CAPACITY * sizeof(unsigned int), indices.data(), static_cast<unsigned int>(indices.size() * sizeof(unsigned int)));
+}
+
+void light_clusters::upload_lights()
+{
+	stats = light_cluster_stats();
+	stats.light_count = static_cast<unsigned int>(lights.size());
+
+	upload(light_buffer, MAX_LIGHTS * sizeof(cluster_light), lights.data(), stats.light_count * sizeof(cluster_light));
+}
+
+void light_clusters::bind(const shader_program& program, const unsigned int width, const unsigned int height) const
+{
+	static const string_id grid_name("clusterGrid");
+	static const string_id tile_size_name("clusterTileSize");
+	static const string_id slicing_name("clusterSlicing");
+
+	bind_lights();
+
+	render_backend& backend = render_backend::get();
+	backend.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, CLUSTER_BINDING, cluster_buffer);
+	backend.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, INDEX_BINDING, index_buffer);
+
+	program.use();
+	program.set_vec3(grid_name, glm::vec3(TILES_X, TILES_Y, SLICES));
+	program.set_vec2(tile_size_name, glm::vec2(width / static_cast<float>(TILES_X), height / static_cast<float>(TILES_Y)));
+	program.set_vec2(slicing_name, glm::vec2(get_slice_scale(), get_slice_bias()));
+}
+
+void light_clusters::bind_lights() const
+{
+	render_backend::get().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, LIGHT_BINDING, light_buffer);
+}
+
+unsigned int light_clusters::get_light_count() const
+{
+	return static_cast<unsigned int>(lights.size());
+}
+
+const light_cluster_stats& light_clusters::get_stats() const
+{
+	return stats;
+}
+
+void light_clusters::update_bounds(const float fov, const float aspect, const float near_plane, const float far_plane)
+{
+	if (fov == bounds_fov && aspect == bounds_aspect && near_plane == bounds_near && far_plane == bounds_far && !bounds.min_x.empty())
+		return;
+
+	bounds_fov = fov;
+	bounds_aspect = aspect;
+	bounds_near = near_plane;
+	bounds_far = far_plane;
+
+	for (std::vector<float>* v : { &bounds.min_x, &bounds.min_y, &bounds.min_z, &bounds.max_x, &bounds.max_y, &bounds.max_z,
+		&bounds.center_x, &bounds.center_y, &bounds.center_z, &bounds.radius })
+		v->resize(CLUSTER_COUNT);
+
+	const float tan_y = std::tan(glm::radians(fov) * 0.5f);
+	const float tan_x = tan_y * aspect;
+
+	for (unsigned int slice = 0; slice < SLICES; slice++)
+	{
+		const float z0 = near_plane * std::pow(far_plane / near_plane, slice / static_cast<float>(SLICES));
+		const float z1 = near_plane * std::pow(far_plane / near_plane, (slice + 1) / static_cast<float>(SLICES));
+
+		for (unsigned int ty = 0; ty < TILES_Y; ty++)
+		{
+			const float y0 = -1.0f + 2.0f * ty / TILES_Y;
+			const float y1 = -1.0f + 2.0f * (ty + 1) / TILES_Y;
+
+			for (unsigned int tx = 0; tx < TILES_X; tx++)
+			{
+				const float x0 = -1.0f + 2.0f * tx / TILES_X;
+				const float x1 = -1.0f + 2.0f * (tx + 1) / TILES_X;
+				const unsigned int c = tx + TILES_X * (ty + TILES_Y * slice);
+
+				//the tile's side planes go through the eye, so each side is widest at whichever end of the slice is further out
+				bounds.min_x[c] = std::min(x0 * tan_x * z0, x0 * tan_x * z1);
+				bounds.max_x[c] = std::max(x1 * tan_x * z0, x1 * tan_x * z1);
+				bounds.min_y[c] = std::min(y0 * tan_y * z0, y0 * tan_y * z1);
+				bounds.max_y[c] = std::max(y1 * tan_y * z0, y1 * tan_y * z1);
+				bounds.min_z[c] = z0;
+				bounds.max_z[c] = z1;
+
+				const glm::vec3 box_min(bounds.min_x[c], bounds.min_y[c], z0);
+				const glm::vec3 box_max(bounds.max_x[c], bounds.max_y[c], z1);
+				const glm::vec3 center = (box_min + box_max) * 0.5f;
+				bounds.center_x[c] = center.x;
+				bounds.center_y[c] = center.y;
+				bounds.center_z[c] = center.z;
+				bounds.radius[c] = glm::length(box_max - center);
+			}
+		}
+	}
+}
+
+void light_clusters::assign_slice(const unsigned int slice)
+{
+	const unsigned int tiles = TILES_X * TILES_Y;
+	const unsigned int first = slice * tiles;
+	const float z0 = bounds.min_z[first];
+	const float z1 = bounds.max_z[first];
+
+	//lights reaching into the slice's depth range, padded to a multiple of four with lights that never pass
+	frame_vector<float> x, y, depth, range, range_sq;
+	frame_vector<float> dir_x, dir_y, dir_depth, cos_outer, sin_outer;
+	frame_vector<unsigned int> index;
+	const std::size_t reserved = view_space.x.size() + 3;
+	for (frame_vector<float>* v : { &x, &y, &depth, &range, &range_sq, &dir_x, &dir_y, &dir_depth, &cos_outer, &sin_outer })
+		v->reserve(reserved);
+	index.reserve(reserved);
+
+	for (unsigned int i = 0; i < view_space.x.size(); i++)
+	{
+		const float r = view_space.range[i];
+		if (view_space.depth[i] + r < z0 || view_space.depth[i] - r > z1)
+			continue;
+
+		x.push_back(view_space.x[i]);
+		y.push_back(view_space.y[i]);
+		depth.push_back(view_space.depth[i]);
+		range.push_back(r);
+		range_sq.push_back(r * r);
+		dir_x.push_back(view_space.dir_x[i]);
+		dir_y.push_back(view_space.dir_y[i]);
+		dir_depth.push_back(view_space.dir_depth[i]);
+		cos_outer.push_back(view_space.cos_outer[i]);
+		sin_outer.push_back(view_space.sin_outer[i]);
+		index.push_back(i);
+	}
+
+	const unsigned int count = static_cast<unsigned int>(index.size());
+	while (index.size() % 4 != 0)
+	{
+		for (frame_vector<float>* v : { &x, &y, &depth, &range, &dir_x, &dir_y, &dir_depth, &cos_outer, &sin_outer })
+			v->push_back(0);
+		range_sq.push_back(-1.0f);
+		index.push_back(0);
+	}
+
+	for (unsigned int c = first; c < first + tiles; c++)
+	{
+		unsigned int* out = &scratch[c * MAX_LIGHTS_PER_CLUSTER];
+		unsigned int found = 0;
+
+		const auto add = [out, &found](const unsigned int light)
+		{
+			//past the cap only the count goes up, compact reports the difference as dropped
+			if (found < MAX_LIGHTS_PER_CLUSTER)
+				out[found] = light;
+			found++;
+		};
+
+#ifdef LIGHT_CLUSTERS_SSE
+		//sphere against box, four lights at a time: distance from the center to the box along each axis, zero inside
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 min_x = _mm_set1_ps(bounds.min_x[c]);
+		const __m128 min_y = _mm_set1_ps(bounds.min_y[c]);
+		const __m128 min_z = _mm_set1_ps(bounds.min_z[c]);
+		const __m128 max_x = _mm_set1_ps(bounds.max_x[c]);
+		const __m128 max_y = _mm_set1_ps(bounds.max_y[c]);
+		const __m128 max_z = _mm_set1_ps(bounds.max_z[c]);
+		const __m128 center_x = _mm_set1_ps(bounds.center_x[c]);
+		const __m128 center_y = _mm_set1_ps(bounds.center_y[c]);
+		const __m128 center_z = _mm_set1_ps(bounds.center_z[c]);
+		const __m128 radius = _mm_set1_ps(bounds.radius[c]);
+		const __m128 neg_radius = _mm_set1_ps(-bounds.radius[c]);
+
+		for (unsigned int i = 0; i < count; i += 4)
+		{
+			const __m128 lx = _mm_loadu_ps(&x[i]);
+			const __m128 ly = _mm_loadu_ps(&y[i]);
+			const __m128 lz = _mm_loadu_ps(&depth[i]);
+
+			const __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min_x, lx), zero), _mm_max_ps(_mm_sub_ps(lx, max_x), zero));
+			const __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min_y, ly), zero), _mm_max_ps(_mm_sub_ps(ly, max_y), zero));
+			const __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min_z, lz), zero), _mm_max_ps(_mm_sub_ps(lz, max_z), zero));
+			const __m128 distance_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+			int mask = _mm_movemask_ps(_mm_cmple_ps(distance_sq, _mm_loadu_ps(&range_sq[i])));
+			if (mask == 0)
+				continue;
+
+			//cone against the box's bounding sphere: the sphere has to reach the cone's side, sit in front of the apex
+			//and not past the range along the axis
+			const __m128 vx = _mm_sub_ps(center_x, lx);
+			const __m128 vy = _mm_sub_ps(center_y, ly);
+			const __m128 vz = _mm_sub_ps(center_z, lz);
+			const __m128 v_len_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+			const __m128 v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&dir_x[i])), _mm_mul_ps(vy, _mm_loadu_ps(&dir_y[i]))),
+				_mm_mul_ps(vz, _mm_loadu_ps(&dir_depth[i])));
+			const __m128 side = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(v_len_sq, _mm_mul_ps(v1, v1)), zero));
+			const __m128 closest = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&cos_outer[i]), side), _mm_mul_ps(v1, _mm_loadu_ps(&sin_outer[i])));
+
+			const __m128 in_cone = _mm_and_ps(_mm_cmple_ps(closest, radius),
+				_mm_and_ps(_mm_cmple_ps(v1, _mm_add_ps(radius, _mm_loadu_ps(&range[i]))), _mm_cmpge_ps(v1, neg_radius)));
+			mask &= _mm_movemask_ps(in_cone);
+			if (mask == 0)
+				continue;
+
+			for (unsigned int lane = 0; lane < 4; lane++)
+			{
+				if (mask & (1 << lane))
+					add(index[i + lane]);
+			}
+		}
+#else
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const float dx = std::max(bounds.min_x[c] - x[i], 0.0f) + std::max(x[i] - bounds.max_x[c], 0.0f);
+			const float dy = std::max(bounds.min_y[c] - y[i], 0.0f) + std::max(y[i] - bounds.max_y[c], 0.0f);
+			const float dz = std::max(bounds.min_z[c] - depth[i], 0.0f) + std::max(depth[i] - bounds.max_z[c], 0.0f);
+
+			if (dx * dx + dy * dy + dz * dz > range_sq[i])
+				continue;
+
+			const float r = bounds.radius[c];
+			const float vx = bounds.center_x[c] - x[i];
+			const float vy = bounds.center_y[c] - y[i];
+			const float vz = bounds.center_z[c] - depth[i];
+			const float v1 = vx * dir_x[i] + vy * dir_y[i] + vz * dir_depth[i];
+			const float closest = cos_outer[i] * std::sqrt(std::max(vx * vx + vy * vy + vz * vz - v1 * v1, 0.0f)) - v1 * sin_outer[i];
+
+			if (closest <= r && v1 <= r + range[i] && v1 >= -r)
+				add(index[i]);
+		}
+#endif
+
+		scratch_counts[c] = found;
+	}
+}
+
+void light_clusters::compact()
+{
+	indices.clear();
+
+	for (unsigned int c = 0; c < CLUSTER_COUNT; c++)
+	{
+		const unsigned int found = scratch_counts[c];
+		const unsigned int room = INDEX_CAPACITY - static_cast<unsigned int>(indices.size());
+		const unsigned int kept = std::min(found < MAX_LIGHTS_PER_CLUSTER ? found : MAX_LIGHTS_PER_CLUSTER, room);
+		const unsigned int* first = &scratch[c * MAX_LIGHTS_PER_CLUSTER];
+
+		ranges[c] = cluster_range{ static_cast<unsigned int>(indices.size()), kept };
+		indices.insert(indices.end(), first, first + kept);
+
+		stats.dropped += found - kept;
+		stats.max_per_cluster = std::max(stats.max_per_cluster, found);
+		stats.empty_clusters += found == 0 ? 1 : 0;
+	}
+
+	stats.index_count = static_cast<unsigned int>(indices.size());
+}
+
+void light_clusters::upload(const unsigned int buffer, const unsigned int capacity, const void* data, const unsigned int size)
+{
+	render_backend& backend = render_backend::get();
+
+	backend.bind_buffer(GL_SHADER_STORAGE_BUFFER, buffer);
+	backend.buffer_data(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+	if (size > 0)
+		backend.buffer_sub_data(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+	backend.bind_buffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	render_stats::counters.buffer_upload_bytes += size;
+}
+
+void light_clusters::dispatch(const glm::mat4& view, const float fov, const float aspect) const
+{
+	static const unsigned int zero = 0;
+	upload(counter_buffer, sizeof(unsigned int), &zero, sizeof(unsigned int));
+
+	render_backend& backend = render_backend::get();
+	backend.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, LIGHT_BINDING, light_buffer);
+	backend.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, CLUSTER_BINDING, cluster_buffer);
+	backend.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, INDEX_BINDING, index_buffer);
+	backend.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING, counter_buffer);
+
+	const float tan_y = std::tan(glm::radians(fov) * 0.5f);
+
+	compute_program->use();
+	compute_program->set_matrix("clusterView", view);
+	compute_program->set_vec4("clusterFrustum", glm::vec4(tan_y * aspect, tan_y, slice_near, slice_far));
+	compute_program->set_int("lightCount", static_cast<int>(lights.size()));
+	compute_program->set_int("indexCapacity", static_cast<int>(INDEX_CAPACITY));
+
+	//one group per slice, one invocation per tile
+	backend.dispatch_compute(1, 1, SLICES);
+	backend.memory_barrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+float light_clusters::get_slice_scale() const
+{
+	return SLICES / std::log(slice_far / slice_near);
+}
+
+float light_clusters::get_slice_bias() const
+{
+	return -(SLICES * std::log(slice_near)) / std::log(slice_far / slice_near);
+}
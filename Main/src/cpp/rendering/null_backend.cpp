@@ -0,0 +1,348 @@
+#include "rendering/null_backend.h"
+
+const char* null_backend::get_name() const
+{
+	return "null";
+}
+
+unsigned long long null_backend::get_count(const backend_command command) const
+{
+	return counts[static_cast<unsigned int>(command)];
+}
+
+unsigned long long null_backend::get_total() const
+{
+	unsigned long long total = 0;
+	for (const unsigned long long count : counts)
+		total += count;
+	return total;
+}
+
+void null_backend::reset()
+{
+	for (unsigned long long& count : counts)
+		count = 0;
+}
+
+void null_backend::add(const backend_command command)
+{
+	counts[static_cast<unsigned int>(command)]++;
+}
+
+void null_backend::use_program(const unsigned int /*program*/)
+{
+	add(backend_command::use_program);
+}
+
+void null_backend::bind_vertex_array(const unsigned int /*vao*/)
+{
+	add(backend_command::bind_vertex_array);
+}
+
+void null_backend::bind_buffer(const GLenum /*target*/, const unsigned int /*buffer*/)
+{
+	add(backend_command::bind_buffer);
+}
+
+void null_backend::active_texture(const GLenum /*unit*/)
+{
+	add(backend_command::active_texture);
+}
+
+void null_backend::bind_texture(const GLenum /*target*/, const unsigned int /*texture*/)
+{
+	add(backend_command::bind_texture);
+}
+
+void null_backend::bind_image_texture(const unsigned int /*unit*/, const unsigned int /*texture*/, const GLenum /*access*/, const GLenum /*format*/)
+{
+	add(backend_command::bind_image_texture);
+}
+
+void null_backend::bind_framebuffer(const GLenum /*target*/, const unsigned int /*framebuffer*/)
+{
+	add(backend_command::bind_framebuffer);
+}
+
+void null_backend::set_capability(const GLenum /*capability*/, const bool /*is_enabled*/)
+{
+	add(backend_command::set_capability);
+}
+
+void null_backend::cull_face(const GLenum /*face*/)
+{
+	add(backend_command::cull_face);
+}
+
+void null_backend::depth_mask(const bool /*is_writing*/)
+{
+	add(backend_command::depth_mask);
+}
+
+void null_backend::stencil_mask(const unsigned int /*mask*/)
+{
+	add(backend_command::stencil_mask);
+}
+
+void null_backend::stencil_func(const GLenum /*face*/, const GLenum /*func*/, const int /*ref*/, const unsigned int /*mask*/)
+{
+	add(backend_command::stencil_func);
+}
+
+void null_backend::stencil_op(const GLenum /*face*/, const GLenum /*s_fail*/, const GLenum /*dp_fail*/, const GLenum /*dp_pass*/)
+{
+	add(backend_command::stencil_op);
+}
+
+void null_backend::draw_buffers(const unsigned int /*count*/, const GLenum* /*attachments*/)
+{
+	add(backend_command::draw_buffers);
+}
+
+void null_backend::read_buffer(const GLenum /*mode*/)
+{
+	add(backend_command::read_buffer);
+}
+
+void null_backend::clear(const GLbitfield /*mask*/)
+{
+	add(backend_command::clear);
+}
+
+void null_backend::viewport(const int /*x*/, const int /*y*/, const unsigned int /*width*/, const unsigned int /*height*/)
+{
+	add(backend_command::viewport);
+}
+
+void null_backend::blend_func(const GLenum /*source*/, const GLenum /*destination*/)
+{
+	add(backend_command::blend_func);
+}
+
+void null_backend::depth_func(const GLenum /*func*/)
+{
+	add(backend_command::depth_func);
+}
+
+void null_backend::polygon_mode(const GLenum /*mode*/)
+{
+	add(backend_command::polygon_mode);
+}
+
+void null_backend::blit_framebuffer(const unsigned int /*source_width*/, const unsigned int /*source_height*/, const unsigned int /*destination_width*/, const unsigned int /*destination_height*/, const GLbitfield /*mask*/, const GLenum /*filter*/)
+{
+	add(backend_command::blit_framebuffer);
+}
+
+int null_backend::get_uniform_location(const unsigned int /*program*/, const char* /*name*/)
+{
+	add(backend_command::get_uniform_location);
+	return 0;
+}
+
+void null_backend::set_uniform(const int /*location*/, const constant_type /*type*/, const unsigned int /*count*/, const float* /*values*/)
+{
+	add(backend_command::set_uniform);
+}
+
+void null_backend::set_uniform_int(const int /*location*/, const int /*value*/)
+{
+	add(backend_command::set_uniform_int);
+}
+
+void null_backend::draw(const bool /*is_indexed*/, const unsigned int /*element_count*/, const unsigned int /*instance_count*/)
+{
+	add(backend_command::draw);
+}
+
+void null_backend::dispatch_compute(const unsigned int /*x*/, const unsigned int /*y*/, const unsigned int /*z*/)
+{
+	add(backend_command::dispatch_compute);
+}
+
+void null_backend::memory_barrier(const GLbitfield /*barriers*/)
+{
+	add(backend_command::memory_barrier);
+}
+
+unsigned int null_backend::create_texture()
+{
+	add(backend_command::create_texture);
+	return next_name++;
+}
+
+void null_backend::delete_texture(const unsigned int /*texture*/)
+{
+	add(backend_command::delete_texture);
+}
+
+void null_backend::tex_image_2d(const GLenum /*target*/, const int /*level*/, const GLenum /*internal_format*/, const unsigned int /*width*/, const unsigned int /*height*/, const GLenum /*format*/, const GLenum /*data_format*/, const void* /*data*/)
+{
+	add(backend_command::tex_image_2d);
+}
+
+void null_backend::tex_image_2d_multisample(const unsigned int /*samples*/, const GLenum /*internal_format*/, const unsigned int /*width*/, const unsigned int /*height*/)
+{
+	add(backend_command::tex_image_2d_multisample);
+}
+
+void null_backend::tex_sub_image_2d(const GLenum /*target*/, const unsigned int /*width*/, const unsigned int /*height*/, const GLenum /*format*/, const GLenum /*data_format*/, const void* /*data*/)
+{
+	add(backend_command::tex_sub_image_2d);
+}
+
+void null_backend::tex_parameter(const GLenum /*target*/, const GLenum /*name*/, const int /*value*/)
+{
+	add(backend_command::tex_parameter);
+}
+
+void null_backend::generate_mipmap(const GLenum /*target*/)
+{
+	add(backend_command::generate_mipmap);
+}
+
+unsigned int null_backend::create_vertex_array()
+{
+	add(backend_command::create_vertex_array);
+	return next_name++;
+}
+
+void null_backend::delete_vertex_array(const unsigned int /*vao*/)
+{
+	add(backend_command::delete_vertex_array);
+}
+
+void null_backend::vertex_attribute(const unsigned int /*index*/, const int /*size*/, const unsigned int /*stride*/, const unsigned int /*offset*/)
+{
+	add(backend_command::vertex_attribute);
+}
+
+void null_backend::vertex_attribute_divisor(const unsigned int /*index*/, const unsigned int /*divisor*/)
+{
+	add(backend_command::vertex_attribute_divisor);
+}
+
+unsigned int null_backend::create_buffer()
+{
+	add(backend_command::create_buffer);
+	return next_name++;
+}
+
+void null_backend::delete_buffer(const unsigned int /*buffer*/)
+{
+	add(backend_command::delete_buffer);
+}
+
+void null_backend::buffer_data(const GLenum /*target*/, const unsigned int /*size*/, const void* /*data*/, const GLenum /*usage*/)
+{
+	add(backend_command::buffer_data);
+}
+
+void null_backend::buffer_sub_data(const GLenum /*target*/, const unsigned int /*offset*/, const unsigned int /*size*/, const void* /*data*/)
+{
+	add(backend_command::buffer_sub_data);
+}
+
+void null_backend::bind_buffer_base(const GLenum /*target*/, const unsigned int /*index*/, const unsigned int /*buffer*/)
+{
+	add(backend_command::bind_buffer_base);
+}
+
+unsigned int null_backend::create_renderbuffer()
+{
+	add(backend_command::create_renderbuffer);
+	return next_name++;
+}
+
+void null_backend::delete_renderbuffer(const unsigned int /*renderbuffer*/)
+{
+	add(backend_command::delete_renderbuffer);
+}
+
+void null_backend::bind_renderbuffer(const unsigned int /*renderbuffer*/)
+{
+	add(backend_command::bind_renderbuffer);
+}
+
+void null_backend::renderbuffer_storage(const GLenum /*internal_format*/, const unsigned int /*width*/, const unsigned int /*height*/)
+{
+	add(backend_command::renderbuffer_storage);
+}
+
+unsigned int null_backend::create_framebuffer()
+{
+	add(backend_command::create_framebuffer);
+	return next_name++;
+}
+
+void null_backend::delete_framebuffer(const unsigned int /*framebuffer*/)
+{
+	add(backend_command::delete_framebuffer);
+}
+
+void null_backend::framebuffer_texture_2d(const GLenum /*attachment*/, const GLenum /*target*/, const unsigned int /*texture*/, const int /*level*/)
+{
+	add(backend_command::framebuffer_texture_2d);
+}
+
+void null_backend::framebuffer_texture(const GLenum /*attachment*/, const unsigned int /*texture*/, const int /*level*/)
+{
+	add(backend_command::framebuffer_texture);
+}
+
+void null_backend::framebuffer_renderbuffer(const GLenum /*attachment*/, const unsigned int /*renderbuffer*/)
+{
+	add(backend_command::framebuffer_renderbuffer);
+}
+
+GLenum null_backend::check_framebuffer_status()
+{
+	add(backend_command::check_framebuffer_status);
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+unsigned int null_backend::create_shader(const GLenum /*type*/, const char* /*source*/, std::string& error)
+{
+	add(backend_command::create_shader);
+	error.clear();
+	return next_name++;
+}
+
+void null_backend::delete_shader(const unsigned int /*shader*/)
+{
+	add(backend_command::delete_shader);
+}
+
+unsigned int null_backend::create_program(const unsigned int* /*shaders*/, const unsigned int /*count*/, std::string& error)
+{
+	add(backend_command::create_program);
+	error.clear();
+	return next_name++;
+}
+
+void null_backend::delete_program(const unsigned int /*program*/)
+{
+	add(backend_command::delete_program);
+}
+
+void null_backend::uniform_block_binding(const unsigned int /*program*/, const char* /*block*/, const unsigned int /*binding*/)
+{
+	add(backend_command::uniform_block_binding);
+}
+
+unsigned int null_backend::create_fence()
+{
+	add(backend_command::create_fence);
+	return next_name++;
+}
+
+bool null_backend::is_fence_signaled(const unsigned int /*fence*/)
+{
+	add(backend_command::is_fence_signaled);
+	return true;
+}
+
+void null_backend::delete_fence(const unsigned int /*fence*/)
+{
+	add(backend_command::delete_fence);
+}
@@ -0,0 +1,219 @@
+#include "rendering/quality_governor.h"
+
+#include <algorithm>
+#include <iostream>
+
+quality_governor::quality_governor()
+{
+	//blur passes stay even so the bloom result ends in the first ping pong target
+	tiers = {
+		{ "Ultra", 10, 2048, 2, true, true },
+		{ "High", 6, 2048, 1, true, true },
+		{ "Medium", 4, 1024, 1, false, true },
+		{ "Low", 2, 1024, 0, false, false },
+		{ "Minimum", 2, 512, 0, false, false },
+	};
+
+	tier_savings.resize(tiers.size(), 0.0f);
+}
+
+void quality_governor::init()
+{
+	for (gpu_timer& timer : feature_timers)
+		timer.init();
+}
+
+void quality_governor::release()
+{
+	for (gpu_timer& timer : feature_timers)
+		timer.release();
+}
+
+void quality_governor::begin(const quality_feature feature)
+{
+	feature_timers[static_cast<unsigned int>(feature)].begin();
+}
+
+void quality_governor::end(const quality_feature feature)
+{
+	feature_timers[static_cast<unsigned int>(feature)].end();
+}
+
+void quality_governor::add_sample(const float gpu_ms, const bool can_lower)
+{
+	collect_features();
+
+	if (settle_frames > 0)
+	{
+		//results still in flight were rendered at the previous tier
+		settle_frames--;
+		return;
+	}
+
+	sample_sum += gpu_ms;
+	sample_count++;
+
+	if (sample_count < WINDOW)
+		return;
+
+	average_ms = sample_sum / static_cast<float>(sample_count);
+	sample_sum = 0;
+	sample_count = 0;
+
+	for (unsigned int i = 0; i < FEATURE_COUNT; i++)
+	{
+		//a feature that never ran this window costs nothing
+		feature_ms[i] = feature_samples[i] > 0 ? feature_sum[i] / static_cast<float>(feature_samples[i]) : 0.0f;
+		feature_sum[i] = 0;
+		feature_samples[i] = 0;
+	}
+
+	if (is_measuring_saving)
+	{
+		tier_savings[tier] = std::max(ms_before_lowering - average_ms, 0.0f);
+		is_measuring_saving = false;
+	}
+
+	if (is_enabled)
+		evaluate(can_lower);
+}
+
+void quality_governor::set_tier(const unsigned int index)
+{
+	if (index >= tiers.size() || index == tier)
+		return;
+
+	is_measuring_saving = false;
+	quiet_windows = 0;
+	change_tier(index, "manual");
+}
+
+const quality_tier& quality_governor::get_tier() const
+{
+	return tiers[tier];
+}
+
+unsigned int quality_governor::get_tier_index() const
+{
+	return tier;
+}
+
+unsigned int quality_governor::get_tier_count() const
+{
+	return static_cast<unsigned int>(tiers.size());
+}
+
+const quality_tier& quality_governor::get_tier(const unsigned int index) const
+{
+	return tiers[index];
+}
+
+float quality_governor::get_average_ms() const
+{
+	return average_ms;
+}
+
+float quality_governor::get_feature_ms(const quality_feature feature) const
+{
+	return feature_ms[static_cast<unsigned int>(feature)];
+}
+
+const char* quality_governor::feature_to_string(const quality_feature feature)
+{
+	switch (feature)
+	{
+	case quality_feature::shadows: return "Shadows";
+	case quality_feature::bloom: return "Bloom";
+	case quality_feature::shading: return "Shading";
+	default: return "Unknown";
+	}
+}
+
+void quality_governor::collect_features()
+{
+	for (unsigned int i = 0; i < FEATURE_COUNT; i++)
+	{
+		float ms;
+		if (!feature_timers[i].take_result(ms))
+			continue;
+
+		feature_sum[i] += ms;
+		feature_samples[i]++;
+	}
+}
+
+void quality_governor::evaluate(const bool can_lower)
+{
+	if (average_ms > budget_ms)
+	{
+		quiet_windows = 0;
+
+		if (!can_lower || tier + 1 >= tiers.size())
+			return;
+
+		ms_before_lowering = average_ms;
+		is_measuring_saving = true;
+		change_tier(tier + 1, "over budget");
+		return;
+	}
+
+	if (average_ms > budget_ms * raise_share || tier == 0)
+	{
+		quiet_windows = 0;
+		return;
+	}
+
+	if (++quiet_windows < RAISE_WINDOWS)
+		return;
+
+	//what we saved stepping down is what stepping back up will cost
+	const float cost = tier_savings[tier] > 0 ? tier_savings[tier] : estimate_saving(tier - 1, tier);
+
+	if (average_ms + cost > budget_ms * raise_share)
+		return;
+
+	quiet_windows = 0;
+	change_tier(tier - 1, "headroom");
+}
+
+float quality_governor::estimate_saving(const unsigned int from, const unsigned int to) const
+{
+	//the feature costs were measured at the current tier, scale them by how much work each tier asks for
+	//shadow maps cost goes with texel count, bloom with blur passes; shading changes are only known once measured
+	const quality_tier& current = tiers[tier];
+
+	const auto shadow_cost = [&](const quality_tier& t)
+	{
+		const float ratio = static_cast<float>(t.shadow_resolution) / static_cast<float>(current.shadow_resolution);
+		return get_feature_ms(quality_feature::shadows) * ratio * ratio;
+	};
+
+	const auto bloom_cost = [&](const quality_tier& t)
+	{
+		return get_feature_ms(quality_feature::bloom) * static_cast<float>(t.bloom_blur_passes) / static_cast<float>(current.bloom_blur_passes);
+	};
+
+	return shadow_cost(tiers[from]) - shadow_cost(tiers[to]) + bloom_cost(tiers[from]) - bloom_cost(tiers[to]);
+}
+
+void quality_governor::change_tier(const unsigned int index, const char* reason)
+{
+	std::cout << "Quality tier " << tiers[tier].name << " -> " << tiers[index].name << " (" << reason << ", gpu "
+		<< average_ms << " ms / " << budget_ms << " ms";
+
+	for (unsigned int i = 0; i < FEATURE_COUNT; i++)
+		std::cout << ", " << feature_to_string(static_cast<quality_feature>(i)) << " " << feature_ms[i] << " ms";
+
+	std::cout << ")" << std::endl;
+
+	tier = index;
+	sample_sum = 0;
+	sample_count = 0;
+	settle_frames = gpu_timer::LATENCY;
+
+	for (unsigned int i = 0; i < FEATURE_COUNT; i++)
+	{
+		feature_sum[i] = 0;
+		feature_samples[i] = 0;
+	}
+}
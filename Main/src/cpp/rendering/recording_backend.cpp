@@ -0,0 +1,1014 @@
+#include "rendering/recording_backend.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+recording_backend::recording_backend(render_backend& target) : next(&target)
+{
+}
+
+void recording_backend::set_target(render_backend& target)
+{
+	next = &target;
+}
+
+const std::vector<std::uint32_t>& recording_backend::get_stream() const
+{
+	return stream;
+}
+
+const std::vector<std::uint8_t>& recording_backend::get_payloads() const
+{
+	return payloads;
+}
+
+unsigned int recording_backend::get_mark_count() const
+{
+	return mark_count;
+}
+
+unsigned int recording_backend::get_command_count() const
+{
+	return command_count;
+}
+
+unsigned int recording_backend::get_count(const backend_command command) const
+{
+	return counts[static_cast<unsigned int>(command)];
+}
+
+void recording_backend::clear_stream()
+{
+	stream.clear();
+	payloads.clear();
+	mark_count = 0;
+	command_count = 0;
+	for (unsigned int& count : counts)
+		count = 0;
+}
+
+void recording_backend::mark_frame()
+{
+	if (!is_recording)
+		return;
+
+	begin(backend_command::end_frame);
+	end();
+	mark_count++;
+}
+
+bool recording_backend::write(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << path << " for the capture" << std::endl;
+		return false;
+	}
+
+	const unsigned long long payload_size = payloads.size();
+	const std::uint32_t header[6]
+	{
+		file_magic,
+		file_version,
+		mark_count,
+		static_cast<std::uint32_t>(stream.size()),
+		static_cast<std::uint32_t>(payload_size & 0xffffffff),
+		static_cast<std::uint32_t>(payload_size >> 32)
+	};
+
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(stream.data()), stream.size() * sizeof(std::uint32_t));
+	file.write(reinterpret_cast<const char*>(payloads.data()), payloads.size());
+
+	return file.good();
+}
+
+const char* recording_backend::get_name() const
+{
+	return "recording";
+}
+
+void recording_backend::begin(const backend_command command)
+{
+	header = stream.size();
+	stream.push_back(static_cast<std::uint32_t>(command));
+	counts[static_cast<unsigned int>(command)]++;
+	command_count++;
+}
+
+void recording_backend::push(const std::uint32_t word)
+{
+	stream.push_back(word);
+}
+
+void recording_backend::push_float(const float value)
+{
+	std::uint32_t word;
+	std::memcpy(&word, &value, sizeof(word));
+	stream.push_back(word);
+}
+
+void recording_backend::push_string(const char* value)
+{
+	const std::size_t length = std::strlen(value);
+	const std::size_t words = (length + 3) / 4;
+
+	stream.push_back(static_cast<std::uint32_t>(length));
+	const std::size_t start = stream.size();
+	stream.resize(start + words, 0);
+	std::memcpy(&stream[start], value, length);
+}
+
+void recording_backend::push_payload(const void* data, const std::size_t size)
+{
+	if (data == nullptr || !is_capturing_payloads)
+	{
+		stream.push_back(0);
+		return;
+	}
+
+	stream.push_back(static_cast<std::uint32_t>(size));
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+	payloads.insert(payloads.end(), bytes, bytes + size);
+}
+
+void recording_backend::end()
+{
+	const std::size_t words = stream.size() - header - 1;
+	stream[header] |= static_cast<std::uint32_t>(words) << 8;
+}
+
+std::size_t recording_backend::get_image_size(const unsigned int width, const unsigned int height, const GLenum format, const GLenum data_format)
+{
+	std::size_t components;
+	switch (format)
+	{
+	case GL_RG: components = 2; break;
+	case GL_RGB: components = 3; break;
+	case GL_RGBA: components = 4; break;
+	default: components = 1; break;
+	}
+
+	std::size_t component_size;
+	switch (data_format)
+	{
+	case GL_FLOAT:
+	case GL_UNSIGNED_INT:
+	case GL_INT:
+		component_size = 4;
+		break;
+	case GL_HALF_FLOAT:
+	case GL_UNSIGNED_SHORT:
+	case GL_SHORT:
+		component_size = 2;
+		break;
+	//packed types hold the whole pixel
+	case GL_UNSIGNED_INT_24_8:
+		component_size = 4;
+		components = 1;
+		break;
+	default:
+		component_size = 1;
+		break;
+	}
+
+	const std::size_t row = (width * components * component_size + 3) & ~static_cast<std::size_t>(3);
+	return row * height;
+}
+
+void recording_backend::use_program(const unsigned int program)
+{
+	next->use_program(program);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::use_program);
+	push(static_cast<std::uint32_t>(program));
+	end();
+}
+
+void recording_backend::bind_vertex_array(const unsigned int vao)
+{
+	next->bind_vertex_array(vao);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_vertex_array);
+	push(static_cast<std::uint32_t>(vao));
+	end();
+}
+
+void recording_backend::bind_buffer(const GLenum target, const unsigned int buffer)
+{
+	next->bind_buffer(target, buffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_buffer);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(buffer));
+	end();
+}
+
+void recording_backend::active_texture(const GLenum unit)
+{
+	next->active_texture(unit);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::active_texture);
+	push(static_cast<std::uint32_t>(unit));
+	end();
+}
+
+void recording_backend::bind_texture(const GLenum target, const unsigned int texture)
+{
+	next->bind_texture(target, texture);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_texture);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(texture));
+	end();
+}
+
+void recording_backend::bind_image_texture(const unsigned int unit, const unsigned int texture, const GLenum access, const GLenum format)
+{
+	next->bind_image_texture(unit, texture, access, format);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_image_texture);
+	push(static_cast<std::uint32_t>(unit));
+	push(static_cast<std::uint32_t>(texture));
+	push(static_cast<std::uint32_t>(access));
+	push(static_cast<std::uint32_t>(format));
+	end();
+}
+
+void recording_backend::bind_framebuffer(const GLenum target, const unsigned int framebuffer)
+{
+	next->bind_framebuffer(target, framebuffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_framebuffer);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(framebuffer));
+	end();
+}
+
+void recording_backend::set_capability(const GLenum capability, const bool is_enabled)
+{
+	next->set_capability(capability, is_enabled);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::set_capability);
+	push(static_cast<std::uint32_t>(capability));
+	push(is_enabled ? 1 : 0);
+	end();
+}
+
+void recording_backend::cull_face(const GLenum face)
+{
+	next->cull_face(face);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::cull_face);
+	push(static_cast<std::uint32_t>(face));
+	end();
+}
+
+void recording_backend::depth_mask(const bool is_writing)
+{
+	next->depth_mask(is_writing);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::depth_mask);
+	push(is_writing ? 1 : 0);
+	end();
+}
+
+void recording_backend::stencil_mask(const unsigned int mask)
+{
+	next->stencil_mask(mask);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::stencil_mask);
+	push(static_cast<std::uint32_t>(mask));
+	end();
+}
+
+void recording_backend::stencil_func(const GLenum face, const GLenum func, const int ref, const unsigned int mask)
+{
+	next->stencil_func(face, func, ref, mask);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::stencil_func);
+	push(static_cast<std::uint32_t>(face));
+	push(static_cast<std::uint32_t>(func));
+	push(static_cast<std::uint32_t>(ref));
+	push(static_cast<std::uint32_t>(mask));
+	end();
+}
+
+void recording_backend::stencil_op(const GLenum face, const GLenum s_fail, const GLenum dp_fail, const GLenum dp_pass)
+{
+	next->stencil_op(face, s_fail, dp_fail, dp_pass);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::stencil_op);
+	push(static_cast<std::uint32_t>(face));
+	push(static_cast<std::uint32_t>(s_fail));
+	push(static_cast<std::uint32_t>(dp_fail));
+	push(static_cast<std::uint32_t>(dp_pass));
+	end();
+}
+
+void recording_backend::draw_buffers(const unsigned int count, const GLenum* attachments)
+{
+	next->draw_buffers(count, attachments);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::draw_buffers);
+	push(static_cast<std::uint32_t>(count));
+	for (unsigned int i = 0; i < count; i++)
+		push(attachments[i]);
+	end();
+}
+
+void recording_backend::read_buffer(const GLenum mode)
+{
+	next->read_buffer(mode);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::read_buffer);
+	push(static_cast<std::uint32_t>(mode));
+	end();
+}
+
+void recording_backend::clear(const GLbitfield mask)
+{
+	next->clear(mask);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::clear);
+	push(static_cast<std::uint32_t>(mask));
+	end();
+}
+
+void recording_backend::viewport(const int x, const int y, const unsigned int width, const unsigned int height)
+{
+	next->viewport(x, y, width, height);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::viewport);
+	push(static_cast<std::uint32_t>(x));
+	push(static_cast<std::uint32_t>(y));
+	push(static_cast<std::uint32_t>(width));
+	push(static_cast<std::uint32_t>(height));
+	end();
+}
+
+void recording_backend::blend_func(const GLenum source, const GLenum destination)
+{
+	next->blend_func(source, destination);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::blend_func);
+	push(static_cast<std::uint32_t>(source));
+	push(static_cast<std::uint32_t>(destination));
+	end();
+}
+
+void recording_backend::depth_func(const GLenum func)
+{
+	next->depth_func(func);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::depth_func);
+	push(static_cast<std::uint32_t>(func));
+	end();
+}
+
+void recording_backend::polygon_mode(const GLenum mode)
+{
+	next->polygon_mode(mode);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::polygon_mode);
+	push(static_cast<std::uint32_t>(mode));
+	end();
+}
+
+void recording_backend::blit_framebuffer(const unsigned int source_width, const unsigned int source_height, const unsigned int destination_width, const unsigned int destination_height, const GLbitfield mask, const GLenum filter)
+{
+	next->blit_framebuffer(source_width, source_height, destination_width, destination_height, mask, filter);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::blit_framebuffer);
+	push(static_cast<std::uint32_t>(source_width));
+	push(static_cast<std::uint32_t>(source_height));
+	push(static_cast<std::uint32_t>(destination_width));
+	push(static_cast<std::uint32_t>(destination_height));
+	push(static_cast<std::uint32_t>(mask));
+	push(static_cast<std::uint32_t>(filter));
+	end();
+}
+
+int recording_backend::get_uniform_location(const unsigned int program, const char* name)
+{
+	const int result = next->get_uniform_location(program, name);
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::get_uniform_location);
+	push(static_cast<std::uint32_t>(program));
+	push_string(name);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::set_uniform(const int location, const constant_type type, const unsigned int count, const float* values)
+{
+	next->set_uniform(location, type, count, values);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::set_uniform);
+	push(static_cast<std::uint32_t>(location));
+	push(static_cast<std::uint32_t>(type));
+	push(static_cast<std::uint32_t>(count));
+	for (unsigned int i = 0; i < count * command_list::get_constant_size(type); i++)
+		push_float(values[i]);
+	end();
+}
+
+void recording_backend::set_uniform_int(const int location, const int value)
+{
+	next->set_uniform_int(location, value);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::set_uniform_int);
+	push(static_cast<std::uint32_t>(location));
+	push(static_cast<std::uint32_t>(value));
+	end();
+}
+
+void recording_backend::draw(const bool is_indexed, const unsigned int element_count, const unsigned int instance_count)
+{
+	next->draw(is_indexed, element_count, instance_count);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::draw);
+	push(is_indexed ? 1 : 0);
+	push(static_cast<std::uint32_t>(element_count));
+	push(static_cast<std::uint32_t>(instance_count));
+	end();
+}
+
+void recording_backend::dispatch_compute(const unsigned int x, const unsigned int y, const unsigned int z)
+{
+	next->dispatch_compute(x, y, z);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::dispatch_compute);
+	push(static_cast<std::uint32_t>(x));
+	push(static_cast<std::uint32_t>(y));
+	push(static_cast<std::uint32_t>(z));
+	end();
+}
+
+void recording_backend::memory_barrier(const GLbitfield barriers)
+{
+	next->memory_barrier(barriers);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::memory_barrier);
+	push(static_cast<std::uint32_t>(barriers));
+	end();
+}
+
+unsigned int recording_backend::create_texture()
+{
+	const unsigned int result = next->create_texture();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_texture);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_texture(const unsigned int texture)
+{
+	next->delete_texture(texture);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_texture);
+	push(static_cast<std::uint32_t>(texture));
+	end();
+}
+
+void recording_backend::tex_image_2d(const GLenum target, const int level, const GLenum internal_format, const unsigned int width, const unsigned int height, const GLenum format, const GLenum data_format, const void* data)
+{
+	next->tex_image_2d(target, level, internal_format, width, height, format, data_format, data);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::tex_image_2d);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(level));
+	push(static_cast<std::uint32_t>(internal_format));
+	push(static_cast<std::uint32_t>(width));
+	push(static_cast<std::uint32_t>(height));
+	push(static_cast<std::uint32_t>(format));
+	push(static_cast<std::uint32_t>(data_format));
+	push_payload(data, get_image_size(width, height, format, data_format));
+	end();
+}
+
+void recording_backend::tex_image_2d_multisample(const unsigned int samples, const GLenum internal_format, const unsigned int width, const unsigned int height)
+{
+	next->tex_image_2d_multisample(samples, internal_format, width, height);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::tex_image_2d_multisample);
+	push(static_cast<std::uint32_t>(samples));
+	push(static_cast<std::uint32_t>(internal_format));
+	push(static_cast<std::uint32_t>(width));
+	push(static_cast<std::uint32_t>(height));
+	end();
+}
+
+void recording_backend::tex_sub_image_2d(const GLenum target, const unsigned int width, const unsigned int height, const GLenum format, const GLenum data_format, const void* data)
+{
+	next->tex_sub_image_2d(target, width, height, format, data_format, data);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::tex_sub_image_2d);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(width));
+	push(static_cast<std::uint32_t>(height));
+	push(static_cast<std::uint32_t>(format));
+	push(static_cast<std::uint32_t>(data_format));
+	push_payload(data, get_image_size(width, height, format, data_format));
+	end();
+}
+
+void recording_backend::tex_parameter(const GLenum target, const GLenum name, const int value)
+{
+	next->tex_parameter(target, name, value);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::tex_parameter);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(name));
+	push(static_cast<std::uint32_t>(value));
+	end();
+}
+
+void recording_backend::generate_mipmap(const GLenum target)
+{
+	next->generate_mipmap(target);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::generate_mipmap);
+	push(static_cast<std::uint32_t>(target));
+	end();
+}
+
+unsigned int recording_backend::create_vertex_array()
+{
+	const unsigned int result = next->create_vertex_array();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_vertex_array);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_vertex_array(const unsigned int vao)
+{
+	next->delete_vertex_array(vao);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_vertex_array);
+	push(static_cast<std::uint32_t>(vao));
+	end();
+}
+
+void recording_backend::vertex_attribute(const unsigned int index, const int size, const unsigned int stride, const unsigned int offset)
+{
+	next->vertex_attribute(index, size, stride, offset);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::vertex_attribute);
+	push(static_cast<std::uint32_t>(index));
+	push(static_cast<std::uint32_t>(size));
+	push(static_cast<std::uint32_t>(stride));
+	push(static_cast<std::uint32_t>(offset));
+	end();
+}
+
+void recording_backend::vertex_attribute_divisor(const unsigned int index, const unsigned int divisor)
+{
+	next->vertex_attribute_divisor(index, divisor);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::vertex_attribute_divisor);
+	push(static_cast<std::uint32_t>(index));
+	push(static_cast<std::uint32_t>(divisor));
+	end();
+}
+
+unsigned int recording_backend::create_buffer()
+{
+	const unsigned int result = next->create_buffer();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_buffer);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_buffer(const unsigned int buffer)
+{
+	next->delete_buffer(buffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_buffer);
+	push(static_cast<std::uint32_t>(buffer));
+	end();
+}
+
+void recording_backend::buffer_data(const GLenum target, const unsigned int size, const void* data, const GLenum usage)
+{
+	next->buffer_data(target, size, data, usage);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::buffer_data);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(size));
+	push(static_cast<std::uint32_t>(usage));
+	push_payload(data, size);
+	end();
+}
+
+void recording_backend::buffer_sub_data(const GLenum target, const unsigned int offset, const unsigned int size, const void* data)
+{
+	next->buffer_sub_data(target, offset, size, data);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::buffer_sub_data);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(offset));
+	push(static_cast<std::uint32_t>(size));
+	push_payload(data, size);
+	end();
+}
+
+void recording_backend::bind_buffer_base(const GLenum target, const unsigned int index, const unsigned int buffer)
+{
+	next->bind_buffer_base(target, index, buffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_buffer_base);
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(index));
+	push(static_cast<std::uint32_t>(buffer));
+	end();
+}
+
+unsigned int recording_backend::create_renderbuffer()
+{
+	const unsigned int result = next->create_renderbuffer();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_renderbuffer);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_renderbuffer(const unsigned int renderbuffer)
+{
+	next->delete_renderbuffer(renderbuffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_renderbuffer);
+	push(static_cast<std::uint32_t>(renderbuffer));
+	end();
+}
+
+void recording_backend::bind_renderbuffer(const unsigned int renderbuffer)
+{
+	next->bind_renderbuffer(renderbuffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::bind_renderbuffer);
+	push(static_cast<std::uint32_t>(renderbuffer));
+	end();
+}
+
+void recording_backend::renderbuffer_storage(const GLenum internal_format, const unsigned int width, const unsigned int height)
+{
+	next->renderbuffer_storage(internal_format, width, height);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::renderbuffer_storage);
+	push(static_cast<std::uint32_t>(internal_format));
+	push(static_cast<std::uint32_t>(width));
+	push(static_cast<std::uint32_t>(height));
+	end();
+}
+
+unsigned int recording_backend::create_framebuffer()
+{
+	const unsigned int result = next->create_framebuffer();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_framebuffer);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_framebuffer(const unsigned int framebuffer)
+{
+	next->delete_framebuffer(framebuffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_framebuffer);
+	push(static_cast<std::uint32_t>(framebuffer));
+	end();
+}
+
+void recording_backend::framebuffer_texture_2d(const GLenum attachment, const GLenum target, const unsigned int texture, const int level)
+{
+	next->framebuffer_texture_2d(attachment, target, texture, level);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::framebuffer_texture_2d);
+	push(static_cast<std::uint32_t>(attachment));
+	push(static_cast<std::uint32_t>(target));
+	push(static_cast<std::uint32_t>(texture));
+	push(static_cast<std::uint32_t>(level));
+	end();
+}
+
+void recording_backend::framebuffer_texture(const GLenum attachment, const unsigned int texture, const int level)
+{
+	next->framebuffer_texture(attachment, texture, level);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::framebuffer_texture);
+	push(static_cast<std::uint32_t>(attachment));
+	push(static_cast<std::uint32_t>(texture));
+	push(static_cast<std::uint32_t>(level));
+	end();
+}
+
+void recording_backend::framebuffer_renderbuffer(const GLenum attachment, const unsigned int renderbuffer)
+{
+	next->framebuffer_renderbuffer(attachment, renderbuffer);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::framebuffer_renderbuffer);
+	push(static_cast<std::uint32_t>(attachment));
+	push(static_cast<std::uint32_t>(renderbuffer));
+	end();
+}
+
+GLenum recording_backend::check_framebuffer_status()
+{
+	const GLenum result = next->check_framebuffer_status();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::check_framebuffer_status);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+unsigned int recording_backend::create_shader(const GLenum type, const char* source, std::string& error)
+{
+	const unsigned int result = next->create_shader(type, source, error);
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_shader);
+	push(static_cast<std::uint32_t>(type));
+	push_string(source);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_shader(const unsigned int shader)
+{
+	next->delete_shader(shader);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_shader);
+	push(static_cast<std::uint32_t>(shader));
+	end();
+}
+
+unsigned int recording_backend::create_program(const unsigned int* shaders, const unsigned int count, std::string& error)
+{
+	const unsigned int result = next->create_program(shaders, count, error);
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_program);
+	push(static_cast<std::uint32_t>(count));
+	for (unsigned int i = 0; i < count; i++)
+		push(shaders[i]);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_program(const unsigned int program)
+{
+	next->delete_program(program);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_program);
+	push(static_cast<std::uint32_t>(program));
+	end();
+}
+
+void recording_backend::uniform_block_binding(const unsigned int program, const char* block, const unsigned int binding)
+{
+	next->uniform_block_binding(program, block, binding);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::uniform_block_binding);
+	push(static_cast<std::uint32_t>(program));
+	push_string(block);
+	push(static_cast<std::uint32_t>(binding));
+	end();
+}
+
+unsigned int recording_backend::create_fence()
+{
+	const unsigned int result = next->create_fence();
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::create_fence);
+	push(static_cast<std::uint32_t>(result));
+	end();
+
+	return result;
+}
+
+bool recording_backend::is_fence_signaled(const unsigned int fence)
+{
+	const bool result = next->is_fence_signaled(fence);
+
+	if (!is_recording)
+		return result;
+
+	begin(backend_command::is_fence_signaled);
+	push(static_cast<std::uint32_t>(fence));
+	push(result ? 1u : 0u);
+	end();
+
+	return result;
+}
+
+void recording_backend::delete_fence(const unsigned int fence)
+{
+	next->delete_fence(fence);
+
+	if (!is_recording)
+		return;
+
+	begin(backend_command::delete_fence);
+	push(static_cast<std::uint32_t>(fence));
+	end();
+}
@@ -0,0 +1,90 @@
+#include "rendering/render_backend.h"
+
+#include "rendering/gl_backend.h"
+
+namespace
+{
+	gl_backend default_backend;
+}
+
+render_backend* render_backend::current{ &default_backend };
+
+render_backend& render_backend::get()
+{
+	return *current;
+}
+
+void render_backend::set(render_backend* backend)
+{
+	current = backend != nullptr ? backend : &default_backend;
+}
+
+const char* render_backend::command_to_string(const backend_command command)
+{
+	switch (command)
+	{
+	case backend_command::use_program: return "use_program";
+	case backend_command::bind_vertex_array: return "bind_vertex_array";
+	case backend_command::bind_buffer: return "bind_buffer";
+	case backend_command::active_texture: return "active_texture";
+	case backend_command::bind_texture: return "bind_texture";
+	case backend_command::bind_image_texture: return "bind_image_texture";
+	case backend_command::bind_framebuffer: return "bind_framebuffer";
+	case backend_command::set_capability: return "set_capability";
+	case backend_command::cull_face: return "cull_face";
+	case backend_command::depth_mask: return "depth_mask";
+	case backend_command::stencil_mask: return "stencil_mask";
+	case backend_command::stencil_func: return "stencil_func";
+	case backend_command::stencil_op: return "stencil_op";
+	case backend_command::draw_buffers: return "draw_buffers";
+	case backend_command::read_buffer: return "read_buffer";
+	case backend_command::clear: return "clear";
+	case backend_command::viewport: return "viewport";
+	case backend_command::blend_func: return "blend_func";
+	case backend_command::depth_func: return "depth_func";
+	case backend_command::polygon_mode: return "polygon_mode";
+	case backend_command::blit_framebuffer: return "blit_framebuffer";
+	case backend_command::get_uniform_location: return "get_uniform_location";
+	case backend_command::set_uniform: return "set_uniform";
+	case backend_command::set_uniform_int: return "set_uniform_int";
+	case backend_command::draw: return "draw";
+	case backend_command::dispatch_compute: return "dispatch_compute";
+	case backend_command::memory_barrier: return "memory_barrier";
+	case backend_command::create_texture: return "create_texture";
+	case backend_command::delete_texture: return "delete_texture";
+	case backend_command::tex_image_2d: return "tex_image_2d";
+	case backend_command::tex_image_2d_multisample: return "tex_image_2d_multisample";
+	case backend_command::tex_sub_image_2d: return "tex_sub_image_2d";
+	case backend_command::tex_parameter: return "tex_parameter";
+	case backend_command::generate_mipmap: return "generate_mipmap";
+	case backend_command::create_vertex_array: return "create_vertex_array";
+	case backend_command::delete_vertex_array: return "delete_vertex_array";
+	case backend_command::vertex_attribute: return "vertex_attribute";
+	case backend_command::vertex_attribute_divisor: return "vertex_attribute_divisor";
+	case backend_command::create_buffer: return "create_buffer";
+	case backend_command::delete_buffer: return "delete_buffer";
+	case backend_command::buffer_data: return "buffer_data";
+	case backend_command::buffer_sub_data: return "buffer_sub_data";
+	case backend_command::bind_buffer_base: return "bind_buffer_base";
+	case backend_command::create_renderbuffer: return "create_renderbuffer";
+	case backend_command::delete_renderbuffer: return "delete_renderbuffer";
+	case backend_command::bind_renderbuffer: return "bind_renderbuffer";
+	case backend_command::renderbuffer_storage: return "renderbuffer_storage";
+	case backend_command::create_framebuffer: return "create_framebuffer";
+	case backend_command::delete_framebuffer: return "delete_framebuffer";
+	case backend_command::framebuffer_texture_2d: return "framebuffer_texture_2d";
+	case backend_command::framebuffer_texture: return "framebuffer_texture";
+	case backend_command::framebuffer_renderbuffer: return "framebuffer_renderbuffer";
+	case backend_command::check_framebuffer_status: return "check_framebuffer_status";
+	case backend_command::create_shader: return "create_shader";
+	case backend_command::delete_shader: return "delete_shader";
+	case backend_command::create_program: return "create_program";
+	case backend_command::delete_program: return "delete_program";
+	case backend_command::uniform_block_binding: return "uniform_block_binding";
+	case backend_command::create_fence: return "create_fence";
+	case backend_command::is_fence_signaled: return "is_fence_signaled";
+	case backend_command::delete_fence: return "delete_fence";
+	case backend_command::end_frame: return "end_frame";
+	default: return "error";
+	}
+}
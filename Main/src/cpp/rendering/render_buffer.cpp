@@ -1,4 +1,6 @@
 #include "rendering/render_buffer.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/render_backend.h"
 
 render_buffer::render_buffer(const GLenum internal_format, const unsigned int width, const unsigned int height)
 {
@@ -6,10 +8,12 @@ render_buffer::render_buffer(const GLenum internal_format, const unsigned int wi
 	this->width = width;
 	this->height = height;
 	
-	glGenRenderbuffers(1, &id);
+	id = render_backend::get().create_renderbuffer();
+	resource = gpu_resource(gpu_resource_type::renderbuffer, id, gpu_memory_category::renderbuffer);
 	bind();
 
-	glRenderbufferStorage(GL_RENDERBUFFER, internal_format, width, height);
+	render_backend::get().renderbuffer_storage(internal_format, width, height);
+	gpu_memory::track_texture(gpu_memory_category::renderbuffer, id, "unnamed", internal_format, width, height, 1, 0, false);
 
 	unbind();
 }
@@ -19,19 +23,21 @@ void render_buffer::reallocate(const GLenum internal_format, const unsigned int
 	bind();
 	this->width = width;
 	this->height = height;
-	glRenderbufferStorage(GL_RENDERBUFFER, internal_format, width, height);
+	render_backend::get().renderbuffer_storage(internal_format, width, height);
+	gpu_memory::track_texture(gpu_memory_category::renderbuffer, id, gpu_memory::get_owner(gpu_memory_category::renderbuffer, id),
+		internal_format, width, height, 1, 0, false);
 	unbind();
 }
 
 
 void render_buffer::bind() const
 {
-	glBindRenderbuffer(GL_RENDERBUFFER, id);
+	render_backend::get().bind_renderbuffer(id);
 }
 
 void render_buffer::unbind() 
 {
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	render_backend::get().bind_renderbuffer(0);
 }
 
 unsigned render_buffer::get_id() const
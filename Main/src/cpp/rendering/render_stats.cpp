@@ -0,0 +1,81 @@
+#include "rendering/render_stats.h"
+
+render_counters render_stats::counters;
+render_counters render_stats::last_frame;
+std::vector<pass_counters> render_stats::passes;
+std::vector<pass_counters> render_stats::last_passes;
+render_counters render_stats::pass_start;
+
+render_counters render_counters::operator-(const render_counters& other) const
+{
+	render_counters result;
+	result.draw_calls = draw_calls - other.draw_calls;
+	result.instances = instances - other.instances;
+	result.triangles = triangles - other.triangles;
+	result.program_binds = program_binds - other.program_binds;
+	result.vao_binds = vao_binds - other.vao_binds;
+	result.texture_binds = texture_binds - other.texture_binds;
+	result.framebuffer_binds = framebuffer_binds - other.framebuffer_binds;
+	result.uniform_calls = uniform_calls - other.uniform_calls;
+	result.uniform_lookups = uniform_lookups - other.uniform_lookups;
+	result.buffer_upload_bytes = buffer_upload_bytes - other.buffer_upload_bytes;
+	result.blits = blits - other.blits;
+	return result;
+}
+
+render_counters& render_counters::operator+=(const render_counters& other)
+{
+	draw_calls += other.draw_calls;
+	instances += other.instances;
+	triangles += other.triangles;
+	program_binds += other.program_binds;
+	vao_binds += other.vao_binds;
+	texture_binds += other.texture_binds;
+	framebuffer_binds += other.framebuffer_binds;
+	uniform_calls += other.uniform_calls;
+	uniform_lookups += other.uniform_lookups;
+	buffer_upload_bytes += other.buffer_upload_bytes;
+	blits += other.blits;
+	return *this;
+}
+
+void render_stats::begin_frame()
+{
+	counters = render_counters();
+	passes.clear();
+}
+
+void render_stats::end_frame()
+{
+	last_frame = counters;
+	last_passes.swap(passes);
+}
+
+void render_stats::begin_pass(const string_id& name)
+{
+	passes.push_back({ name, render_counters() });
+	pass_start = counters;
+}
+
+void render_stats::end_pass()
+{
+	if (!passes.empty())
+		passes.back().counters = counters - pass_start;
+}
+
+void render_stats::count_draw(const unsigned int element_count, const unsigned int instance_count)
+{
+	counters.draw_calls++;
+	counters.instances += instance_count;
+	counters.triangles += static_cast<unsigned long long>(element_count / 3) * instance_count;
+}
+
+const render_counters& render_stats::get_frame()
+{
+	return last_frame;
+}
+
+const std::vector<pass_counters>& render_stats::get_passes()
+{
+	return last_passes;
+}
@@ -0,0 +1,158 @@
+#include "rendering/render_target_pool.h"
+
+#include <tuple>
+
+#include "rendering/gpu_memory.h"
+
+#pragma region render_target_desc
+
+bool render_target_desc::operator==(const render_target_desc& other) const
+{
+	return width == other.width && height == other.height && format == other.format &&
+		internal_format == other.internal_format && data_format == other.data_format && samples == other.samples;
+}
+
+bool render_target_desc::operator<(const render_target_desc& other) const
+{
+	return std::tie(internal_format, width, height, samples, format, data_format) <
+		std::tie(other.internal_format, other.width, other.height, other.samples, other.format, other.data_format);
+}
+
+bool render_target_desc::is_depth() const
+{
+	return format == GL_DEPTH_COMPONENT || format == GL_DEPTH_STENCIL;
+}
+
+std::size_t render_target_desc::get_size_in_bytes() const
+{
+	return gpu_memory::estimate_texture_size(internal_format, width, height, 1, samples, false);
+}
+
+#pragma endregion
+
+render_target_pool::~render_target_pool()
+{
+	release_all();
+}
+
+texture* render_target_pool::acquire(const render_target_desc& desc)
+{
+	auto& bucket = buckets[desc];
+
+	for (auto& target : bucket)
+	{
+		if (target->is_in_use)
+			continue;
+
+		target->is_in_use = true;
+		target->last_used_frame = frame;
+		return &target->tex;
+	}
+
+	const texture_type type = desc.is_depth() ? texture_type::depth : texture_type::color;
+
+	std::unique_ptr<pooled_target> target = std::make_unique<pooled_target>();
+	target->tex = desc.samples > 1 ?
+		texture(type, desc.width, desc.height, desc.format, desc.internal_format, desc.data_format, false, desc.samples) :
+		texture(type, desc.width, desc.height, desc.format, desc.internal_format, desc.data_format, false);
+	target->is_in_use = true;
+	target->last_used_frame = frame;
+
+	bucket.push_back(std::move(target));
+	return &bucket.back()->tex;
+}
+
+void render_target_pool::release(const texture* target)
+{
+	for (auto& bucket : buckets)
+	{
+		for (auto& pooled : bucket.second)
+		{
+			if (&pooled->tex != target)
+				continue;
+
+			pooled->is_in_use = false;
+			pooled->last_used_frame = frame;
+			return;
+		}
+	}
+}
+
+void render_target_pool::end_frame()
+{
+	const unsigned long long current = frame;
+
+	delete_if([current](const pooled_target& target)
+	{
+		return !target.is_in_use && current - target.last_used_frame > IDLE_FRAMES;
+	});
+
+	frame++;
+}
+
+void render_target_pool::release_unused()
+{
+	delete_if([](const pooled_target& target)
+	{
+		return !target.is_in_use;
+	});
+}
+
+void render_target_pool::release_all()
+{
+	delete_if([](const pooled_target&)
+	{
+		return true;
+	});
+}
+
+std::vector<unsigned int> render_target_pool::take_deleted()
+{
+	std::vector<unsigned int> ids;
+	ids.swap(deleted);
+	return ids;
+}
+
+unsigned int render_target_pool::get_count() const
+{
+	unsigned int count = 0;
+
+	for (const auto& bucket : buckets)
+		count += static_cast<unsigned int>(bucket.second.size());
+
+	return count;
+}
+
+std::size_t render_target_pool::get_size_in_bytes() const
+{
+	std::size_t bytes = 0;
+
+	for (const auto& bucket : buckets)
+		bytes += bucket.first.get_size_in_bytes() * bucket.second.size();
+
+	return bytes;
+}
+
+template<typename predicate>
+void render_target_pool::delete_if(predicate should_delete)
+{
+	for (auto it = buckets.begin(); it != buckets.end();)
+	{
+		auto& bucket = it->second;
+
+		for (unsigned int i = static_cast<unsigned int>(bucket.size()); i-- > 0;)
+		{
+			if (!should_delete(*bucket[i]))
+				continue;
+
+			deleted.push_back(bucket[i]->tex.get_id());
+			bucket[i]->tex.delete_texture();
+			bucket.erase(bucket.begin() + i);
+		}
+
+		if (bucket.empty())
+			it = buckets.erase(it);
+		else
+			++it;
+	}
+}
@@ -2,6 +2,8 @@
 
 
 #include "rendering/renderer.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
 
 renderer::renderer() = default;
 
@@ -9,25 +11,27 @@ renderer::renderer() = default;
 renderer::renderer(std::shared_ptr<mesh> mesh)
 {
 	mesh_ptr = std::move(mesh);
-	vbo = 0;
+	gpu_mesh_ptr = gpu_mesh::acquire(*mesh_ptr);
+	vao = 0;
+
+	renderer::setup();
+}
+
+renderer::renderer(std::shared_ptr<mesh> mesh, std::shared_ptr<gpu_mesh> gpu)
+{
+	mesh_ptr = std::move(mesh);
+	gpu_mesh_ptr = std::move(gpu);
 	vao = 0;
-	ebo = 0;
 
 	renderer::setup();
 }
 
 void renderer::draw(const shader_program &program) const
 {
-	if(mesh_ptr->should_cull_face)
-	{
-		glEnable(GL_CULL_FACE);
-	}
-	else
-	{
-		glDisable(GL_CULL_FACE);
-	}
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_CULL_FACE, mesh_ptr->should_cull_face);
 
-	glCullFace(mesh_ptr->cull_face);
+	backend.cull_face(mesh_ptr->cull_face);
 
 	program.use();
 	
@@ -36,21 +40,13 @@ void renderer::draw(const shader_program &program) const
 	unsigned int reflection_number = -1;
 	unsigned int normal_number = -1;
 
-	const std::vector<texture>::size_type size = mesh_ptr->textures.size();
-	std::vector<unsigned int> nums(15, -1);
-	
-
-	std::string setting_name;
-	std::string texture_type_str;
+	//textures seen so far per type, the next one of a type gets that index
+	unsigned int nums[static_cast<unsigned int>(texture_type::hdr) + 1]{};
 
 	for (int i = 0; i < mesh_ptr->textures.size(); i++)
 	{
-		setting_name.clear();
-		setting_name.append("mat.");
 		const texture_type tex_type = mesh_ptr->textures[i].get_type();
-		std::string tex_type_str = texture::type_to_string(tex_type);
-
-		std::string number = std::to_string(++(nums[static_cast<unsigned int>(tex_type)]));
+		const string_id& name = texture::get_uniform_name(tex_type, nums[static_cast<unsigned int>(tex_type)]++);
 		/*switch (tex_type)
 		{
 			case texture_type::diffuse:
@@ -88,33 +84,28 @@ void renderer::draw(const shader_program &program) const
 		}*/
 
 		texture::activate(GL_TEXTURE0 + i);
-		glBindTexture(mesh_ptr->textures[i].get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE: GL_TEXTURE_2D, 0);
+		backend.bind_texture(mesh_ptr->textures[i].get_is_multi_sampled() ? GL_TEXTURE_2D_MULTISAMPLE: GL_TEXTURE_2D, 0);
+		render_stats::counters.texture_binds++;
 		mesh_ptr->textures[i].bind();
-		program.set_int(setting_name.append(tex_type_str).append(number), i);
+		program.set_int(name, i);
 	}
 
 	texture::activate(GL_TEXTURE0);
 
-	if (mesh_ptr->is_indexed)
+	if (gpu_mesh_ptr->get_is_indexed())
 		draw_with_indices();
 	else
 		draw_with_raw_vertices();
 
 	if (mesh_ptr->should_cull_face)
-		glDisable(GL_CULL_FACE);
+		backend.set_capability(GL_CULL_FACE, false);
 }
 
 void renderer::draw_instanced(const shader_program& program, const unsigned int count) const
 {
-	if (mesh_ptr->should_cull_face)
-	{
-		glEnable(GL_CULL_FACE);
-	}
-	else
-	{
-		glDisable(GL_CULL_FACE);
-	}
-	glCullFace(mesh_ptr->cull_face);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_CULL_FACE, mesh_ptr->should_cull_face);
+	backend.cull_face(mesh_ptr->cull_face);
 
 	program.use();
 
@@ -182,13 +173,13 @@ void renderer::draw_instanced(const shader_program& program, const unsigned int
 
 	texture::activate(GL_TEXTURE0);
 
-	if (mesh_ptr->is_indexed)
+	if (gpu_mesh_ptr->get_is_indexed())
 		draw_with_indices_instanced(count);
 	else
 		draw_with_raw_vertices_instanced(count);
 
 	if (mesh_ptr->should_cull_face)
-		glDisable(GL_CULL_FACE);
+		backend.set_capability(GL_CULL_FACE, false);
 }
 
 void renderer::draw_cube_map(const shader_program& program) const
@@ -202,10 +193,11 @@ void renderer::draw_cube_map(const shader_program& program) const
 	program.use();
 
 	texture::activate(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, mesh_ptr->textures[0].get_id());
+	render_backend::get().bind_texture(GL_TEXTURE_CUBE_MAP, mesh_ptr->textures[0].get_id());
+	render_stats::counters.texture_binds++;
 	program.set_int("cubeMap", 0);
 
-	if (mesh_ptr->is_indexed)
+	if (gpu_mesh_ptr->get_is_indexed())
 		draw_with_indices();
 	else
 		draw_with_raw_vertices();
@@ -217,95 +209,80 @@ void renderer::draw_cube_map(const shader_program& program) const
 
 void renderer::draw_with_indices() const
 {
-	if (mesh_ptr->is_transparent)
-		glEnable(GL_BLEND);
-	else
-		glDisable(GL_BLEND);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_BLEND, mesh_ptr->is_transparent);
 	
-	glBindVertexArray(vao);
-	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh_ptr->indices.size()), GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
+	backend.bind_vertex_array(vao);
+	backend.draw(true, gpu_mesh_ptr->get_index_count(), 1);
+	render_stats::counters.vao_binds++;
+	render_stats::count_draw(gpu_mesh_ptr->get_index_count(), 1);
+	backend.bind_vertex_array(0);
 
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
 
 void renderer::draw_with_raw_vertices() const
 {
-	if (mesh_ptr->is_transparent)
-		glEnable(GL_BLEND);
-	else
-		glDisable(GL_BLEND);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_BLEND, mesh_ptr->is_transparent);
 	
-	glBindVertexArray(vao);
-	glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh_ptr->vertices.size()));
-	glBindVertexArray(0);
+	backend.bind_vertex_array(vao);
+	backend.draw(false, gpu_mesh_ptr->get_vertex_count(), 1);
+	render_stats::counters.vao_binds++;
+	render_stats::count_draw(gpu_mesh_ptr->get_vertex_count(), 1);
+	backend.bind_vertex_array(0);
 
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
 
 void renderer::draw_with_indices_instanced(const unsigned int count) const
 {
-	if (mesh_ptr->is_transparent)
-		glEnable(GL_BLEND);
-	else
-		glDisable(GL_BLEND);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_BLEND, mesh_ptr->is_transparent);
 
-	glBindVertexArray(vao);
-	glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(mesh_ptr->indices.size()), GL_UNSIGNED_INT, nullptr, count );
-	glBindVertexArray(0);
+	backend.bind_vertex_array(vao);
+	backend.draw(true, gpu_mesh_ptr->get_index_count(), count);
+	render_stats::counters.vao_binds++;
+	render_stats::count_draw(gpu_mesh_ptr->get_index_count(), count);
+	backend.bind_vertex_array(0);
 
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
 
 void renderer::draw_with_raw_vertices_instanced(const unsigned count) const
 {
-	if (mesh_ptr->is_transparent)
-		glEnable(GL_BLEND);
-	else
-		glDisable(GL_BLEND);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_BLEND, mesh_ptr->is_transparent);
 
-	glBindVertexArray(vao);
-	glDrawArraysInstanced(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh_ptr->vertices.size()), count);
-	glBindVertexArray(0);
+	backend.bind_vertex_array(vao);
+	backend.draw(false, gpu_mesh_ptr->get_vertex_count(), count);
+	render_stats::counters.vao_binds++;
+	render_stats::count_draw(gpu_mesh_ptr->get_vertex_count(), count);
+	backend.bind_vertex_array(0);
 
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
 
 void renderer::setup()
 {
-	//generate buffers
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-
-	if (mesh_ptr->is_indexed)
-		glGenBuffers(1, &ebo);
-
+	//only the vertex array object is owned by the renderer, buffers live in the shared gpu_mesh
+	render_backend& backend = render_backend::get();
+	vao = backend.create_vertex_array();
+	vertex_array = gpu_resource(gpu_resource_type::vertex_array, vao);
+	backend.bind_vertex_array(vao);
 	
-	glBindVertexArray(vao);
+	gpu_mesh_ptr->bind_vertex_buffer();
 	
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, mesh_ptr->vertices.size() * sizeof(vertex), &mesh_ptr->vertices[0], GL_STATIC_DRAW);
+	backend.vertex_attribute(0, 3, sizeof(vertex), 0);
+	backend.vertex_attribute(1, 3, sizeof(vertex), 3 * sizeof(float));
+	backend.vertex_attribute(2, 2, sizeof(vertex), 6 * sizeof(float));
+	backend.vertex_attribute(3, 3, sizeof(vertex), 8 * sizeof(float));
+	backend.vertex_attribute(4, 3, sizeof(vertex), 11 * sizeof(float));
 
-	
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(vertex), nullptr);
-	glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(3 * sizeof(float)));
-	glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(6 * sizeof(float)));
-	glVertexAttribPointer(3, 3, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(8 * sizeof(float)));
-	glVertexAttribPointer(4, 3, GL_FLOAT, false, sizeof(vertex), reinterpret_cast<void*>(11 * sizeof(float)));
-
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
-	glEnableVertexAttribArray(4);
-
-	if(mesh_ptr->is_indexed)
-	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER,  sizeof(unsigned int) * mesh_ptr->indices.size(), &mesh_ptr->indices[0], GL_STATIC_DRAW);
-	}
+	gpu_mesh_ptr->bind_index_buffer();
 
-	glBindVertexArray(0);
+	backend.bind_vertex_array(0);
+	backend.bind_buffer(GL_ARRAY_BUFFER, 0);
 }
 
 std::shared_ptr<mesh> renderer::get_mesh_ptr() const
@@ -313,16 +290,37 @@ std::shared_ptr<mesh> renderer::get_mesh_ptr() const
 	return mesh_ptr;
 }
 
+std::shared_ptr<gpu_mesh> renderer::get_gpu_mesh_ptr() const
+{
+	return gpu_mesh_ptr;
+}
 
-renderer::~renderer() = default;
+draw_call renderer::get_draw_call() const
+{
+	draw_call call;
+	call.vao = vao;
+	call.is_indexed = gpu_mesh_ptr->get_is_indexed();
+	call.element_count = call.is_indexed ? gpu_mesh_ptr->get_index_count() : gpu_mesh_ptr->get_vertex_count();
+	call.should_cull_face = mesh_ptr->should_cull_face;
+	call.cull_face = mesh_ptr->cull_face;
+	call.is_transparent = mesh_ptr->is_transparent;
+	return call;
+}
 
-void renderer::deallocate() const
+const std::vector<material_slot>& renderer::get_material_slots() const
 {
-	glDeleteVertexArrays(1, &vao);
-	glDeleteBuffers(1, &vbo);
+	return mesh_ptr->get_material_slots();
+}
+
+
+renderer::~renderer() = default;
 
-	if(mesh_ptr->is_indexed)
-		glDeleteBuffers(1, &ebo);
+void renderer::deallocate()
+{
+	//other renderers may share the gpu_mesh, its buffers go with the last of them
+	vertex_array.reset();
+	vao = 0;
+	gpu_mesh_ptr.reset();
 }
 
 
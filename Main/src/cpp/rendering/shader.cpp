@@ -1,4 +1,6 @@
 #include "rendering/shader.h"
+#include "rendering/render_backend.h"
+#include "utils/cpu_profiler.h"
 #include <strstream>
 #include <iosfwd>
 #include <fstream>
@@ -7,13 +9,23 @@
 
 shader::shader(const std::string &path, const GLenum shader_type, const bool relative)
 {
+	cpu_profile_scope scope("Compile Shader");
+
 	std::string actual;
 
 	if(relative)
 	{
-		actual = std::string("res/shaders/")
-			.append(shader_type == GL_GEOMETRY_SHADER ? "geometry/" : (shader_type == GL_VERTEX_SHADER ? "vertex/" : "pixel/"))
-			.append(path).append(".glsl");
+		const char* folder;
+
+		switch (shader_type)
+		{
+		case GL_VERTEX_SHADER: folder = "vertex/"; break;
+		case GL_GEOMETRY_SHADER: folder = "geometry/"; break;
+		case GL_COMPUTE_SHADER: folder = "compute/"; break;
+		default: folder = "pixel/"; break;
+		}
+
+		actual = std::string("res/shaders/").append(folder).append(path).append(".glsl");
 	}
 	else
 	{
@@ -41,20 +53,12 @@ shader::shader(const std::string &path, const GLenum shader_type, const bool rel
 
 	inf.close();
 
-	const char* shader_code = shader_string.c_str();
-	int success;
-	char info_log[512];
-
-	id = glCreateShader(shader_type);
-	glShaderSource(id, 1, &shader_code, nullptr);
-	glCompileShader(id);
-
-	glGetShaderiv(id, GL_COMPILE_STATUS, &success);
+	std::string error;
+	id = render_backend::get().create_shader(shader_type, shader_string.c_str(), error);
 
-	if(!success)
+	if(!error.empty())
 	{
-		glGetShaderInfoLog(id, 512, nullptr, info_log);
-		std::cout << "FAILED TO COMPILE SHADER" << info_log << std::endl;
+		std::cout << "FAILED TO COMPILE SHADER" << error << std::endl;
 	}
 }
 
@@ -1,29 +1,17 @@
 #include "rendering/shader_program.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
+#include "utils/cpu_profiler.h"
 #include <glm/gtc/type_ptr.hpp>
 
-//TODO implement caching of uniform locations
 shader_program::shader_program(const shader* vertex_shader, const shader* fragment_shader) :
 	vertex_shader(vertex_shader),
 	fragment_shader(fragment_shader), geometry_shader(nullptr)
 {
-	int success;
-	char info_log[512];
+	cpu_profile_scope scope("Link Shader Program");
 
-	id = glCreateProgram();
-	glAttachShader(id, this->vertex_shader->id);
-	glAttachShader(id, this->fragment_shader->id);
-	glLinkProgram(id);
-
-	glGetProgramiv(id, GL_LINK_STATUS, &success);
-
-	if (!success)
-	{
-		glGetProgramInfoLog(id, 512, nullptr, info_log);
-		std::cout << "FAILED TO LINK SHADER PROGRAM " << info_log << std::endl;
-	}
-
-	glDeleteShader(this->vertex_shader->id);
-	glDeleteShader(this->fragment_shader->id);
+	const unsigned int shaders[] = { this->vertex_shader->id, this->fragment_shader->id };
+	link(shaders, 2);
 }
 
 shader_program::shader_program(const shader* vertex_shader, const shader* fragment_shader, const shader* geometry_shader) :
@@ -31,86 +19,143 @@ shader_program::shader_program(const shader* vertex_shader, const shader* fragme
 	fragment_shader(fragment_shader),
 	geometry_shader(geometry_shader)
 {
-	int success;
-	char info_log[512];
-
-	id = glCreateProgram();
-	glAttachShader(id, this->vertex_shader->id);
-	glAttachShader(id, this->fragment_shader->id);
-	glAttachShader(id, this->geometry_shader->id);
-	glLinkProgram(id);
+	cpu_profile_scope scope("Link Shader Program");
 
-	glGetProgramiv(id, GL_LINK_STATUS, &success);
+	const unsigned int shaders[] = { this->vertex_shader->id, this->fragment_shader->id, this->geometry_shader->id };
+	link(shaders, 3);
+}
 
-	if (!success)
-	{
-		glGetProgramInfoLog(id, 512, nullptr, info_log);
-		std::cout << "FAILED TO LINK SHADER PROGRAM " << info_log << std::endl;
-	}
+shader_program::shader_program(const shader* compute_shader) :
+	vertex_shader(nullptr),
+	fragment_shader(nullptr),
+	geometry_shader(nullptr)
+{
+	cpu_profile_scope scope("Link Shader Program");
 
-	glDeleteShader(this->vertex_shader->id);
-	glDeleteShader(this->fragment_shader->id);
-	glDeleteShader(this->geometry_shader->id);
+	link(&compute_shader->id, 1);
 }
 
-shader_program::~shader_program()
+void shader_program::link(const unsigned int* shaders, const unsigned int count)
 {
-	glDeleteProgram(id);
+	render_backend& backend = render_backend::get();
+	std::string error;
+
+	id = backend.create_program(shaders, count, error);
+	resource = gpu_resource(gpu_resource_type::program, id);
+
+	if (!error.empty())
+		std::cout << "FAILED TO LINK SHADER PROGRAM " << error << std::endl;
+
+	for (unsigned int i = 0; i < count; i++)
+		backend.delete_shader(shaders[i]);
 }
 
 void shader_program::use() const
 {
-	glUseProgram(id);
+	render_backend::get().use_program(id);
+	render_stats::counters.program_binds++;
+}
+
+int shader_program::get_uniform_location(const std::string& name) const
+{
+	const auto it = uniform_locations.find(name);
+	if (it != uniform_locations.end())
+		return it->second;
+
+	const int location = render_backend::get().get_uniform_location(id, name.c_str());
+	render_stats::counters.uniform_lookups++;
+	uniform_locations.emplace(name, location);
+	return location;
+}
+
+int shader_program::get_uniform_location(const string_id& name) const
+{
+	const auto it = id_locations.find(name.get_id());
+	if (it != id_locations.end())
+		return it->second;
+
+	const int location = get_uniform_location(name.get_string());
+	id_locations.emplace(name.get_id(), location);
+	return location;
 }
 
 void shader_program::set_bool(const std::string& name, const bool value) const
 {
-	glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+	render_backend::get().set_uniform_int(get_uniform_location(name), value);
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_float(const std::string& name, const float value) const
 {
-	const auto loc = glGetUniformLocation(id, name.c_str());
-	glUniform1f(glGetUniformLocation(id, name.c_str()), value);
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::float1, 1, &value);
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_int(const std::string& name, const int value) const
 {
-	const auto loc = glGetUniformLocation(id, name.c_str());
-	glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+	render_backend::get().set_uniform_int(get_uniform_location(name), value);
+	render_stats::counters.uniform_calls++;
+}
+
+void shader_program::set_int(const string_id& name, const int value) const
+{
+	render_backend::get().set_uniform_int(get_uniform_location(name), value);
+	render_stats::counters.uniform_calls++;
+}
+
+void shader_program::set_float(const string_id& name, const float value) const
+{
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::float1, 1, &value);
+	render_stats::counters.uniform_calls++;
+}
+
+void shader_program::set_vec2(const string_id& name, const glm::vec2& value) const
+{
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::vec2, 1, glm::value_ptr(value));
+	render_stats::counters.uniform_calls++;
+}
+
+void shader_program::set_vec3(const string_id& name, const glm::vec3& value) const
+{
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::vec3, 1, glm::value_ptr(value));
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_matrix(const std::string& name, const glm::mat4 matrix) const
 {
-	auto loc = glGetUniformLocation(id, name.c_str());
-	glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::mat4, 1, glm::value_ptr(matrix));
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_vec2(const std::string& name, const glm::vec2 value) const
 {
-	glUniform2f(glGetUniformLocation(id, name.c_str()), value.x, value.y);
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::vec2, 1, glm::value_ptr(value));
+	render_stats::counters.uniform_calls++;
 }
 
 
 void shader_program::set_vec3(const std::string& name, const glm::vec3 value) const
 {
-	const GLint loc = glGetUniformLocation(id, name.c_str());
-	glUniform3f(glGetUniformLocation(id, name.c_str()), value.x, value.y, value.z);
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::vec3, 1, glm::value_ptr(value));
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_vec4(const std::string& name, const glm::vec4 value) const
 {
-	glUniform4f(glGetUniformLocation(id, name.c_str()), value.x, value.y, value.z, value.w);
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::vec4, 1, glm::value_ptr(value));
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_float_array(const std::string& name, const unsigned int count, float* value) const
 {
-	glUniform1fv(glGetUniformLocation(id, name.c_str()), count, value);
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::float1, count, value);
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_vec2_array(const std::string& name, const unsigned int count, float* value) const
 {
-	glUniform2fv(glGetUniformLocation(id, name.c_str()), count, value);
+	render_backend::get().set_uniform(get_uniform_location(name), constant_type::vec2, count, value);
+	render_stats::counters.uniform_calls++;
 }
 
 void shader_program::set_mvp(const mvp matrix) const
@@ -1,5 +1,11 @@
 #include "rendering/texture.h"
 
+#include "rendering/gpu_memory.h"
+#include "rendering/image_cache.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
+#include "utils/cpu_profiler.h"
+
 
 texture::texture() = default;
 
@@ -7,6 +13,9 @@ texture::texture() = default;
 texture::texture(const std::string& absolute_path, const texture_type type, const GLenum data_format, 
                  const bool generate_mipmaps)
 {
+	cpu_profile_scope scope("Load Texture");
+	render_backend& backend = render_backend::get();
+
 	id = 0;
 	
 	this->wrap_mode = GL_REPEAT;
@@ -16,22 +25,19 @@ texture::texture(const std::string& absolute_path, const texture_type type, cons
 	this->type = type;
 	is_multi_sampled = false;
 
-	glGenTextures(1, &id);
+	id = backend.create_texture();
+	resource = gpu_resource(gpu_resource_type::texture, id, gpu_memory_category::texture);
 
 	this->bind();
 
-	int temp_width;
-	int temp_height;
-	int temp_number_of_channels;
-
-	stbi_set_flip_vertically_on_load(true);
-	stbi_uc* const data = stbi_load(absolute_path.c_str(), &temp_width, &temp_height, &temp_number_of_channels, 0);
+	decoded_image image = image_cache::acquire(absolute_path, false);
+	void* const data = image.data;
 
 	if(data)
 	{
-		this->width = temp_width;
-		this->height = temp_height;
-		this->channels = temp_number_of_channels;
+		this->width = image.width;
+		this->height = image.height;
+		this->channels = image.channels;
 
 		GLenum format = 0;
 		GLenum internal_format = 0;
@@ -48,9 +54,10 @@ texture::texture(const std::string& absolute_path, const texture_type type, cons
 			internal_format = type == texture_type::diffuse ? GL_SRGB_ALPHA : GL_RGBA;
 		}
 
-		glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, data_format, data);
+		backend.tex_image_2d(GL_TEXTURE_2D, 0, internal_format, width, height, format, data_format, data);
 		if (generate_mipmaps)
-			glGenerateMipmap(GL_TEXTURE_2D);
+			backend.generate_mipmap(GL_TEXTURE_2D);
+		gpu_memory::track_texture(gpu_memory_category::texture, id, absolute_path, internal_format, width, height, 1, 0, generate_mipmaps);
 
 		
 		set_wrap_mode(GL_REPEAT);
@@ -62,11 +69,14 @@ texture::texture(const std::string& absolute_path, const texture_type type, cons
 		std::cout << "ERROR: FAILED TO LOAD TEXTURE" << std::endl;
 	}
 
-	stbi_image_free(data);
+	image_cache::release(image);
 }
 
 texture::texture(const std::string& absolute_path, const texture_type type, const GLenum format, const GLenum internal_format, const GLenum data_format, const bool generate_mipmaps)
 {
+	cpu_profile_scope scope("Load Texture");
+	render_backend& backend = render_backend::get();
+
 	id = 0;
 
 	this->wrap_mode = GL_REPEAT;
@@ -76,38 +86,31 @@ texture::texture(const std::string& absolute_path, const texture_type type, cons
 	this->type = type;
 	is_multi_sampled = false;
 
-	glGenTextures(1, &id);
+	id = backend.create_texture();
+	resource = gpu_resource(gpu_resource_type::texture, id, gpu_memory_category::texture);
 
 	this->bind();
 
-	int temp_width;
-	int temp_height;
-	int temp_number_of_channels;
-
-	stbi_set_flip_vertically_on_load(true);
-
-	void* data;
-	if(type==texture_type::hdr)
-		data = stbi_loadf(absolute_path.c_str(), &temp_width, &temp_height, &temp_number_of_channels, 0);
-	else
-		data = stbi_load(absolute_path.c_str(), &temp_width, &temp_height, &temp_number_of_channels, 0);
+	decoded_image image = image_cache::acquire(absolute_path, type == texture_type::hdr);
+	void* const data = image.data;
 
 	if (data)
 	{
-		this->width = temp_width;
-		this->height = temp_height;
-		this->channels = temp_number_of_channels;
+		this->width = image.width;
+		this->height = image.height;
+		this->channels = image.channels;
 
-		glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, data_format, data);
+		backend.tex_image_2d(GL_TEXTURE_2D, 0, internal_format, width, height, format, data_format, data);
 		
 		if (generate_mipmaps)
-			glGenerateMipmap(GL_TEXTURE_2D);
+			backend.generate_mipmap(GL_TEXTURE_2D);
+		gpu_memory::track_texture(gpu_memory_category::texture, id, absolute_path, internal_format, width, height, 1, 0, generate_mipmaps);
 
 
 		set_wrap_mode(GL_CLAMP_TO_EDGE);
 		set_filter_mag(GL_LINEAR);
 		set_filter_min(GL_LINEAR);
-		stbi_image_free(data);
+		image_cache::release(image);
 	}
 	else
 	{
@@ -117,6 +120,7 @@ texture::texture(const std::string& absolute_path, const texture_type type, cons
 
 texture::texture(const texture_type type, const unsigned int width, const unsigned int height, const GLenum format, const GLenum internal_format, const GLenum data_format, const bool generate_mipmaps)
 {
+	render_backend& backend = render_backend::get();
 	id = 0;
 
 	if(type == texture_type::cube)
@@ -144,21 +148,24 @@ texture::texture(const texture_type type, const unsigned int width, const unsign
 	this->type = type;
 	is_multi_sampled = false;
 
-	glGenTextures(1, &id);
+	id = backend.create_texture();
+	resource = gpu_resource(gpu_resource_type::texture, id, gpu_memory_category::render_target);
 
 	bind();
 	if(type == texture_type::cube)
 	{
 		for (int i = 0;i < 6; i++)
 		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internal_format, width, height, 0, format, data_format, nullptr);
+			backend.tex_image_2d(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internal_format, width, height, format, data_format, nullptr);
 		}
 	}
 	else
-		glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, data_format, nullptr);
+		backend.tex_image_2d(GL_TEXTURE_2D, 0, internal_format, width, height, format, data_format, nullptr);
 	
 	if (generate_mipmaps)
-		glGenerateMipmap(type == texture_type::cube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D);
+		backend.generate_mipmap(type == texture_type::cube ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D);
+	gpu_memory::track_texture(gpu_memory_category::render_target, id, "unnamed", internal_format, width, height,
+		type == texture_type::cube ? 6 : 1, 0, generate_mipmaps);
 
 	switch (format)
 	{
@@ -194,6 +201,7 @@ texture::texture(const texture_type type, const unsigned int width, const unsign
 
 texture::texture(const texture_type type, const unsigned int width, const unsigned int height, const GLenum format, GLenum const internal_format, const GLenum data_format, const bool generate_mipmaps, const unsigned int samples)
 {
+	render_backend& backend = render_backend::get();
 	id = 0;
 	this->wrap_mode = GL_REPEAT;
 	this->filter_mag = GL_LINEAR;
@@ -204,14 +212,16 @@ texture::texture(const texture_type type, const unsigned int width, const unsign
 	this->type = type;
 	is_multi_sampled = true;
 
-	glGenTextures(1, &id);
+	id = backend.create_texture();
+	resource = gpu_resource(gpu_resource_type::texture, id, gpu_memory_category::render_target);
 
 	bind();
 
-	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, internal_format, width, height, GL_TRUE);
+	backend.tex_image_2d_multisample(samples, internal_format, width, height);
+	gpu_memory::track_texture(gpu_memory_category::render_target, id, "unnamed", internal_format, width, height, 1, samples, false);
 
 	if (generate_mipmaps)
-		glGenerateMipmap(GL_TEXTURE_2D_MULTISAMPLE);
+		backend.generate_mipmap(GL_TEXTURE_2D_MULTISAMPLE);
 
 	switch (format)
 	{
@@ -248,6 +258,9 @@ texture::texture(const texture_type type, const unsigned int width, const unsign
 //used for cube_maps
 texture::texture(const std::vector<std::string>& paths, const texture_type type, const GLenum internal_format, const GLenum format, const GLenum data_format, const unsigned int dimension, const bool generate_mipmaps, const GLenum filter_min)
 {
+	cpu_profile_scope scope("Load Cube Map");
+	render_backend& backend = render_backend::get();
+
 	id = 0;
 	
 	this->wrap_mode = GL_CLAMP_TO_EDGE;
@@ -257,50 +270,54 @@ texture::texture(const std::vector<std::string>& paths, const texture_type type,
 	this->type = type;
 	is_multi_sampled = false;
 
-	glGenTextures(1, &id);
+	id = backend.create_texture();
+	resource = gpu_resource(gpu_resource_type::texture, id, paths.size() == 6 ? gpu_memory_category::texture : gpu_memory_category::render_target);
 	bind();
 
-	int temp_width;
-	int temp_height;
-	int temp_number_of_channels;
-
 	const bool should_load = paths.size() == 6;
-	
-	stbi_set_flip_vertically_on_load(true);
+
+	if (should_load)
+		image_cache::prefetch(paths);
+
 	for (int i = 0; i < 6; i++)
 	{
 		if(should_load)
 		{
-			stbi_uc* data = stbi_load(paths[i].c_str(), &temp_width, &temp_height, &temp_number_of_channels, 0);
-			if (data)
+			decoded_image image = image_cache::acquire(paths[i], false);
+			if (image.data)
 			{
-				this->width = temp_width;
-				this->height = temp_height;
-				this->channels = temp_number_of_channels;
-				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internal_format, temp_width, temp_height, 0, format, data_format, data);
+				this->width = image.width;
+				this->height = image.height;
+				this->channels = image.channels;
+				backend.tex_image_2d(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internal_format, image.width, image.height, format, data_format, image.data);
 			}
 			else
 			{
 				std::cout << "ERROR: FAILED TO LOAD TEXTURE" << std::endl;
 			}
-			stbi_image_free(data);
+			image_cache::release(image);
 		}
 		else
 		{
 			this->width = dimension;
 			this->height = dimension;
 			this->channels = 3;
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internal_format, dimension, dimension, 0, format, data_format, nullptr);
+			backend.tex_image_2d(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internal_format, dimension, dimension, format, data_format, nullptr);
 		}
 	}
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, filter_min);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, filter_min);
+	backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
 	if (generate_mipmaps)
-		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+		backend.generate_mipmap(GL_TEXTURE_CUBE_MAP);
+
+	if (should_load)
+		gpu_memory::track_texture(gpu_memory_category::texture, id, paths[0], internal_format, width, height, 6, 0, generate_mipmaps);
+	else
+		gpu_memory::track_texture(gpu_memory_category::render_target, id, "unnamed", internal_format, width, height, 6, 0, generate_mipmaps);
 }
 
 
@@ -350,16 +367,34 @@ unsigned texture::get_height() const
 }
 
 void texture::bind() const
+{
+	render_backend::get().bind_texture(get_target(), this->id);
+	render_stats::counters.texture_binds++;
+}
+
+void texture::delete_texture()
+{
+	resource.reset();
+	id = 0;
+}
+
+void texture::set_data(const void* pixels, const GLenum format, const GLenum data_format) const
+{
+	bind();
+	render_backend::get().tex_sub_image_2d(GL_TEXTURE_2D, width, height, format, data_format, pixels);
+}
+
+GLenum texture::get_target() const
 {
 	if (type == texture_type::cube)
-		glBindTexture(GL_TEXTURE_CUBE_MAP, this->id);
-	else
-		glBindTexture(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, this->id);
+		return GL_TEXTURE_CUBE_MAP;
+
+	return is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
 }
 
 void texture::activate(GLenum texture_location)
 {
-	glActiveTexture(texture_location);
+	render_backend::get().active_texture(texture_location);
 }
 
 std::string texture::type_to_string(const texture_type type)
@@ -381,21 +416,34 @@ std::string texture::type_to_string(const texture_type type)
 	}
 }
 
+const string_id& texture::get_uniform_name(const texture_type type, const unsigned int index)
+{
+	//grows to the most textures of a type any mesh has, after that a draw builds no strings
+	static std::vector<string_id> names[static_cast<unsigned int>(texture_type::hdr) + 1];
+	std::vector<string_id>& of_type = names[static_cast<unsigned int>(type)];
+
+	while (of_type.size() <= index)
+		of_type.emplace_back(std::string("mat.").append(type_to_string(type)).append(std::to_string(of_type.size())));
+
+	return of_type[index];
+}
+
 void texture::set_wrap_mode(const GLint wrap_mode)
 {
+	render_backend& backend = render_backend::get();
 	this->wrap_mode = wrap_mode;
 
 	if(type == texture_type::cube)
 	{
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, this->wrap_mode);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, this->wrap_mode);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, this->wrap_mode);
+		backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, this->wrap_mode);
+		backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, this->wrap_mode);
+		backend.tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, this->wrap_mode);
 	}
 	else
 	{
-		glTexParameteri(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->wrap_mode);
-		glTexParameteri(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, this->wrap_mode);
-		glTexParameteri(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->wrap_mode);
+		backend.tex_parameter(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->wrap_mode);
+		backend.tex_parameter(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, this->wrap_mode);
+		backend.tex_parameter(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->wrap_mode);
 	}
 }
 
@@ -404,10 +452,10 @@ void texture::set_filter_mag(const GLint filter_mag)
 	this->filter_mag = filter_mag;
 	if(type == texture_type::cube)
 	{
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, filter_mag);
+		render_backend::get().tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, filter_mag);
 	}
 	else
-		glTexParameteri(is_multi_sampled ?  GL_TEXTURE_2D_MULTISAMPLE :  GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter_mag);
+		render_backend::get().tex_parameter(is_multi_sampled ?  GL_TEXTURE_2D_MULTISAMPLE :  GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter_mag);
 }
 
 void texture::set_filter_min(const GLint filter_min)
@@ -415,8 +463,8 @@ void texture::set_filter_min(const GLint filter_min)
 	this->filter_min = filter_min;
 	if (type == texture_type::cube)
 	{
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, filter_min);
+		render_backend::get().tex_parameter(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, filter_min);
 	}
 	else
-	glTexParameteri(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter_min);
+	render_backend::get().tex_parameter(is_multi_sampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter_min);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "rendering/transparent_renderer.h"
+#include "rendering/render_backend.h"
 
 transparent_renderer::transparent_renderer(const std::shared_ptr<mesh>& m) : renderer(m)
 {
@@ -36,8 +37,10 @@ GLenum transparent_renderer::to_gl_enum(blend_factor factor)
 
 void transparent_renderer::draw(const shader_program& program) const
 {
-	glEnable(GL_BLEND);
-	glBlendFunc(to_gl_enum(src_factor), to_gl_enum(dst_factor));
+	render_backend& backend = render_backend::get();
+
+	backend.set_capability(GL_BLEND, true);
+	backend.blend_func(to_gl_enum(src_factor), to_gl_enum(dst_factor));
 	renderer::draw(program);
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
\ No newline at end of file
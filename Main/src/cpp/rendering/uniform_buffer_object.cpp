@@ -1,4 +1,7 @@
 #include "rendering/uniform_buffer_object.h"
+#include "rendering/gpu_memory.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
 
 uniform_buffer_object::uniform_buffer_object() = default;
 
@@ -6,23 +9,27 @@ uniform_buffer_object::uniform_buffer_object(const unsigned int size, const GLen
 {
 	this->usage = usage;
 	this->size = size;
-	glGenBuffers(1, &id);
+	id = render_backend::get().create_buffer();
+	resource = gpu_resource(gpu_resource_type::buffer, id, gpu_memory_category::uniform_buffer);
 	bind();
-	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, usage);
+	render_backend::get().buffer_data(GL_UNIFORM_BUFFER, size, nullptr, usage);
+	gpu_memory::track(gpu_memory_category::uniform_buffer, id, size, "unnamed");
 	unbind();
 }
 
 void uniform_buffer_object::buffer_data(void* data) const
 {
 	bind();
-	glBufferData(GL_UNIFORM_BUFFER, size, data, usage);
+	render_backend::get().buffer_data(GL_UNIFORM_BUFFER, size, data, usage);
+	render_stats::counters.buffer_upload_bytes += this->size;
 	unbind();
 }
 
 void uniform_buffer_object::buffer_data_range(const unsigned int offset, const unsigned int size, void* data) const
 {
 	bind();
-	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+	render_backend::get().buffer_sub_data(GL_UNIFORM_BUFFER, offset, size, data);
+	render_stats::counters.buffer_upload_bytes += size;
 	unbind();
 }
 
@@ -30,12 +37,12 @@ void uniform_buffer_object::buffer_data_range(const unsigned int offset, const u
 
 void uniform_buffer_object::bind() const
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, id);
+	render_backend::get().bind_buffer(GL_UNIFORM_BUFFER, id);
 }
 
 void uniform_buffer_object::unbind()
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	render_backend::get().bind_buffer(GL_UNIFORM_BUFFER, 0);
 }
 
 unsigned uniform_buffer_object::get_id() const
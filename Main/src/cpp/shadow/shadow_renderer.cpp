@@ -1,4 +1,6 @@
 #include "shadow/shadow_renderer.h"
+#include "rendering/render_backend.h"
+#include "rendering/render_stats.h"
 
 shadow_renderer::shadow_renderer() = default;
 
@@ -6,50 +8,45 @@ shadow_renderer::shadow_renderer() = default;
 shadow_renderer::shadow_renderer(std::shared_ptr<mesh> mesh)
 {
 	mesh_ptr = std::move(mesh);
-	vbo = 0;
+	gpu_mesh_ptr = gpu_mesh::acquire(*mesh_ptr);
 	vao = 0;
-	ebo = 0;
 
 	setup();
 }
 
-void shadow_renderer::setup()
+shadow_renderer::shadow_renderer(std::shared_ptr<mesh> mesh, std::shared_ptr<gpu_mesh> gpu)
 {
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
+	mesh_ptr = std::move(mesh);
+	gpu_mesh_ptr = std::move(gpu);
+	vao = 0;
 
-	if (mesh_ptr->is_indexed)
-		glGenBuffers(1, &ebo);
+	setup();
+}
 
-	glBindVertexArray(vao);
+void shadow_renderer::setup()
+{
+	//position only view over the shared gpu_mesh buffers
+	render_backend& backend = render_backend::get();
+	vao = backend.create_vertex_array();
+	vertex_array = gpu_resource(gpu_resource_type::vertex_array, vao);
+	backend.bind_vertex_array(vao);
 
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, mesh_ptr->vertices.size() * sizeof(vertex), &mesh_ptr->vertices[0], GL_STATIC_DRAW);
+	gpu_mesh_ptr->bind_vertex_buffer();
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(vertex), nullptr);
-	glEnableVertexAttribArray(0);
+	backend.vertex_attribute(0, 3, sizeof(vertex), 0);
 
-	if (mesh_ptr->is_indexed)
-	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * mesh_ptr->indices.size(), &mesh_ptr->indices[0], GL_STATIC_DRAW);
-	}
+	gpu_mesh_ptr->bind_index_buffer();
 
-	glBindVertexArray(0);
+	backend.bind_vertex_array(0);
+	backend.bind_buffer(GL_ARRAY_BUFFER, 0);
 }
 
 void shadow_renderer::draw(const shader_program& program) const
 {
-	if (mesh_ptr->should_cull_face)
-	{
-		glEnable(GL_CULL_FACE);
-	}
-	else
-	{
-		glDisable(GL_CULL_FACE);
-	}
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_CULL_FACE, mesh_ptr->should_cull_face);
 
-	glCullFace(mesh_ptr->cull_face);
+	backend.cull_face(mesh_ptr->cull_face);
 
 	/*program.use();
 
@@ -111,41 +108,51 @@ void shadow_renderer::draw(const shader_program& program) const
 
 	texture::activate(GL_TEXTURE0);*/
 
-	if (mesh_ptr->is_indexed)
+	if (gpu_mesh_ptr->get_is_indexed())
 		draw_with_indices();
 	else
 		draw_with_raw_vertices();
 
 	if (mesh_ptr->should_cull_face)
-		glDisable(GL_CULL_FACE);
+		backend.set_capability(GL_CULL_FACE, false);
 }
 
 void shadow_renderer::draw_with_indices() const
 {
-	if (mesh_ptr->is_transparent)
-		glEnable(GL_BLEND);
-	else
-		glDisable(GL_BLEND);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_BLEND, mesh_ptr->is_transparent);
 
-	glBindVertexArray(vao);
-	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh_ptr->indices.size()), GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
+	backend.bind_vertex_array(vao);
+	backend.draw(true, gpu_mesh_ptr->get_index_count(), 1);
+	render_stats::counters.vao_binds++;
+	render_stats::count_draw(gpu_mesh_ptr->get_index_count(), 1);
+	backend.bind_vertex_array(0);
 
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
 
 void shadow_renderer::draw_with_raw_vertices() const
 {
-	if (mesh_ptr->is_transparent)
-		glEnable(GL_BLEND);
-	else
-		glDisable(GL_BLEND);
+	render_backend& backend = render_backend::get();
+	backend.set_capability(GL_BLEND, mesh_ptr->is_transparent);
 
-	glBindVertexArray(vao);
-	glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(mesh_ptr->vertices.size()));
-	glBindVertexArray(0);
+	backend.bind_vertex_array(vao);
+	backend.draw(false, gpu_mesh_ptr->get_vertex_count(), 1);
+	render_stats::counters.vao_binds++;
+	render_stats::count_draw(gpu_mesh_ptr->get_vertex_count(), 1);
+	backend.bind_vertex_array(0);
 
-	glDisable(GL_BLEND);
+	backend.set_capability(GL_BLEND, false);
 }
 
-
+draw_call shadow_renderer::get_draw_call() const
+{
+	draw_call call;
+	call.vao = vao;
+	call.is_indexed = gpu_mesh_ptr->get_is_indexed();
+	call.element_count = call.is_indexed ? gpu_mesh_ptr->get_index_count() : gpu_mesh_ptr->get_vertex_count();
+	call.should_cull_face = mesh_ptr->should_cull_face;
+	call.cull_face = mesh_ptr->cull_face;
+	call.is_transparent = mesh_ptr->is_transparent;
+	return call;
+}
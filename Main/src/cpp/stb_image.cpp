@@ -1,2 +1,9 @@
+#include "utils/memory_tracker.h"
+
+//decoded pixels show up under whatever tag the decoding thread has, normally textures
+#define STBI_MALLOC(size) memory_tracker::allocate(size, reinterpret_cast<const void*>(&stbi_load))
+#define STBI_REALLOC(block, size) memory_tracker::reallocate(block, size, reinterpret_cast<const void*>(&stbi_load))
+#define STBI_FREE(block) memory_tracker::release(block)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
\ No newline at end of file
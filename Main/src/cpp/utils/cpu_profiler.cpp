@@ -0,0 +1,229 @@
+#include "utils/cpu_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::atomic<bool> cpu_profiler::enabled{ true };
+
+cpu_profiler& cpu_profiler::get()
+{
+	static cpu_profiler profiler;
+	return profiler;
+}
+
+bool cpu_profiler::is_enabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void cpu_profiler::set_enabled(const bool flag)
+{
+	enabled.store(flag, std::memory_order_relaxed);
+}
+
+void cpu_profiler::begin_frame()
+{
+	//the frame that just finished is the one the flame view shows
+	const unsigned long long now = now_ns();
+	frame_start.store(frame_end.load());
+	frame_end.store(now);
+}
+
+void cpu_profiler::push(const char* name)
+{
+	if (!is_enabled())
+		return;
+
+	get_thread_buffer().open.emplace_back(name, now_ns());
+}
+
+void cpu_profiler::pop()
+{
+	//no enabled check, a span opened before the profiler was switched off still has to close
+	thread_buffer& buffer = get_thread_buffer();
+
+	if (!buffer.open.empty())
+		buffer.close();
+}
+
+unsigned long long cpu_profiler::get_frame_start_ns() const
+{
+	return frame_start.load();
+}
+
+unsigned long long cpu_profiler::get_frame_end_ns() const
+{
+	return frame_end.load();
+}
+
+unsigned int cpu_profiler::get_thread_count() const
+{
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	return static_cast<unsigned int>(threads.size());
+}
+
+void cpu_profiler::get_events(const unsigned int thread, const unsigned long long start_ns, const unsigned long long end_ns, std::vector<event>& events) const
+{
+	events.clear();
+
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	if (thread >= threads.size())
+		return;
+
+	const thread_buffer& buffer = *threads[thread];
+	const unsigned long long count = buffer.count.load(std::memory_order_acquire);
+	const unsigned long long oldest = count - std::min(count, static_cast<unsigned long long>(EVENTS_PER_THREAD));
+
+	//events land in the ring as their scope closes so end times only grow, walk back from the newest until one ends before the window
+	unsigned long long first = count;
+	while (first > oldest && buffer.events[static_cast<std::size_t>((first - 1) % EVENTS_PER_THREAD)].end_ns > start_ns)
+		first--;
+
+	for (unsigned long long i = first; i < count; i++)
+		events.push_back(buffer.events[static_cast<std::size_t>(i % EVENTS_PER_THREAD)]);
+
+	//the owning thread keeps writing, anything it lapped while we copied holds newer events in an old slot
+	const unsigned long long written = buffer.count.load(std::memory_order_acquire);
+	if (written - first > EVENTS_PER_THREAD)
+	{
+		const unsigned long long lapped = std::min(written - EVENTS_PER_THREAD, count) - first;
+		events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(lapped));
+	}
+
+	events.erase(std::remove_if(events.begin(), events.end(), [end_ns](const event& e)
+	{
+		return e.start_ns >= end_ns;
+	}), events.end());
+}
+
+bool cpu_profiler::export_chrome_trace(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open " << path << " for the cpu trace" << std::endl;
+		return false;
+	}
+
+	file << "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"cpu\"}}";
+	const std::size_t written = write_trace_events(file, 0, ~0ull);
+	file << "\n]}\n";
+
+	std::cout << "Wrote " << written << " cpu events to " << path << std::endl;
+	return true;
+}
+
+std::size_t cpu_profiler::write_trace_events(std::ostream& out, const unsigned long long start_ns, const unsigned long long end_ns) const
+{
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	std::size_t written = 0;
+
+	//timestamps are microseconds since boot, the default six significant digits would round them to seconds
+	out << std::fixed << std::setprecision(3);
+
+	for (const auto& thread : threads)
+	{
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread->index
+			<< ",\"args\":{\"name\":\"" << (thread->index == 0 ? "main" : "thread ") << thread->index << "\"}}";
+
+		for (const event& e : copy_events(*thread))
+		{
+			if (e.end_ns <= start_ns || e.start_ns >= end_ns)
+				continue;
+
+			out << ",\n{\"name\":";
+			write_json_string(out, e.name);
+			out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread->index
+				<< ",\"ts\":" << e.start_ns / 1000.0 << ",\"dur\":" << (e.end_ns - e.start_ns) / 1000.0 << "}";
+			written++;
+		}
+	}
+
+	return written;
+}
+
+void cpu_profiler::write_json_string(std::ostream& out, const char* str)
+{
+	out << '"';
+
+	for (const char* c = str; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			out << '\\';
+		out << *c;
+	}
+
+	out << '"';
+}
+
+unsigned long long cpu_profiler::now_ns()
+{
+	return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+cpu_profiler::thread_buffer& cpu_profiler::get_thread_buffer()
+{
+	thread_local thread_buffer* buffer = nullptr;
+
+	if (buffer)
+		return *buffer;
+
+	//only the first scope on each thread takes the lock
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	threads.push_back(std::make_unique<thread_buffer>());
+	buffer = threads.back().get();
+	buffer->events.resize(EVENTS_PER_THREAD);
+	buffer->open.reserve(64);
+	buffer->index = static_cast<unsigned int>(threads.size() - 1);
+	return *buffer;
+}
+
+std::vector<cpu_profiler::event> cpu_profiler::copy_events(const thread_buffer& buffer) const
+{
+	//a thread still writing may overwrite the oldest entries mid copy, fine for a debug view
+	const unsigned long long count = buffer.count.load(std::memory_order_acquire);
+	const unsigned long long size = std::min(count, static_cast<unsigned long long>(EVENTS_PER_THREAD));
+
+	std::vector<event> events;
+	events.reserve(static_cast<std::size_t>(size));
+
+	for (unsigned long long i = count - size; i < count; i++)
+		events.push_back(buffer.events[static_cast<std::size_t>(i % EVENTS_PER_THREAD)]);
+
+	return events;
+}
+
+void cpu_profiler::thread_buffer::close()
+{
+	const unsigned long long end_ns = now_ns();
+	const std::pair<const char*, unsigned long long> scope = open.back();
+	open.pop_back();
+
+	const unsigned long long written = count.load(std::memory_order_relaxed);
+	events[static_cast<std::size_t>(written % EVENTS_PER_THREAD)] = { scope.first, scope.second, end_ns, static_cast<unsigned int>(open.size()) };
+	count.store(written + 1, std::memory_order_release);
+}
+
+cpu_profile_scope::cpu_profile_scope(const char* name)
+{
+	if (!cpu_profiler::is_enabled())
+		return;
+
+	buffer = &cpu_profiler::get().get_thread_buffer();
+	buffer->open.emplace_back(name, cpu_profiler::now_ns());
+}
+
+cpu_profile_scope::cpu_profile_scope(const string_id& name) : cpu_profile_scope(name.c_str())
+{
+}
+
+cpu_profile_scope::~cpu_profile_scope()
+{
+	if (buffer && !buffer->open.empty())
+		buffer->close();
+}
@@ -0,0 +1,137 @@
+#include "utils/frame_arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace
+{
+	const unsigned char POISON = 0xCD;
+
+	std::atomic<unsigned long long> current_frame{ 0 };
+	std::atomic<unsigned int> thread_count{ 0 };
+	std::atomic<std::size_t> total_capacity{ 0 };
+	std::atomic<std::size_t> peak_bytes{ 0 };
+	std::atomic<unsigned long long> overflow_count{ 0 };
+	std::atomic<bool> is_poisoning{ false };
+
+	std::size_t align_up(const std::size_t value, const std::size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+frame_arena& frame_arena::get()
+{
+	//freed with its thread, nothing allocated from it may outlive the frame let alone the thread
+	thread_local frame_arena arena;
+	return arena;
+}
+
+frame_arena::frame_arena() : frame(current_frame.load(std::memory_order_relaxed))
+{
+	reset();
+	thread_count++;
+}
+
+frame_arena::~frame_arena()
+{
+	for (void* block : overflow)
+		::operator delete(block);
+
+	::operator delete(slab);
+	total_capacity -= capacity;
+	thread_count--;
+}
+
+void frame_arena::end_frame()
+{
+	current_frame.fetch_add(1, std::memory_order_release);
+}
+
+void* frame_arena::allocate(const std::size_t size, const std::size_t alignment)
+{
+	const unsigned long long now = current_frame.load(std::memory_order_acquire);
+	if (frame != now)
+	{
+		reset();
+		frame = now;
+	}
+
+	//the slab comes from operator new and is aligned for anything, offsets only have to keep that up
+	const std::size_t offset = align_up(used, alignment);
+
+	if (offset + size <= capacity)
+	{
+		used = offset + size;
+		return slab + offset;
+	}
+
+	//heap for the rest of this frame, the slab grows to fit it on the next reset
+	//operator new only promises max_align_t, so pad and align inside the block; reset frees the raw pointer
+	unsigned char* block = static_cast<unsigned char*>(::operator new(size + alignment - 1));
+	overflow.push_back(block);
+	overflow_bytes += size + alignment;
+	overflow_count++;
+	return block + (align_up(reinterpret_cast<std::uintptr_t>(block), alignment) - reinterpret_cast<std::uintptr_t>(block));
+}
+
+unsigned int frame_arena::get_thread_count()
+{
+	return thread_count;
+}
+
+std::size_t frame_arena::get_capacity()
+{
+	return total_capacity;
+}
+
+std::size_t frame_arena::get_peak_bytes()
+{
+	return peak_bytes;
+}
+
+unsigned long long frame_arena::get_overflow_count()
+{
+	return overflow_count;
+}
+
+void frame_arena::set_is_poisoning(const bool poisoning)
+{
+	is_poisoning = poisoning;
+}
+
+void frame_arena::reset()
+{
+	const std::size_t frame_bytes = used + overflow_bytes;
+
+	std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+	while (frame_bytes > peak && !peak_bytes.compare_exchange_weak(peak, frame_bytes, std::memory_order_relaxed))
+	{
+	}
+
+	if (is_poisoning && slab)
+		std::memset(slab, POISON, used);
+
+	for (void* block : overflow)
+		::operator delete(block);
+
+	overflow.clear();
+
+	//first use or last frame did not fit, size up so the same frame fits without the heap
+	if (frame_bytes > capacity || !slab)
+	{
+		std::size_t grown = capacity > 0 ? capacity : SLAB_SIZE;
+		while (grown < frame_bytes)
+			grown *= 2;
+
+		::operator delete(slab);
+		slab = static_cast<unsigned char*>(::operator new(grown));
+		total_capacity += grown - capacity;
+		capacity = grown;
+	}
+
+	used = 0;
+	overflow_bytes = 0;
+}
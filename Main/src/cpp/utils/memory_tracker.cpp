@@ -0,0 +1,434 @@
+#include "utils/memory_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <dbghelp.h>
+#include <intrin.h>
+#pragma comment(lib, "dbghelp.lib")
+#define MEMORY_TRACKER_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define MEMORY_TRACKER_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace
+{
+	//16 bytes keeps the alignment malloc gives the caller
+	const std::size_t HEADER_SIZE = 16;
+
+	struct block_header
+	{
+		std::size_t size;
+		std::uint32_t callsite;
+		memory_tag tag;
+	};
+
+	static_assert(sizeof(block_header) <= HEADER_SIZE, "block header has to fit in front of the block");
+
+	//everything below is zero initialized before any constructor runs, so allocations during static init are fine
+	struct tag_counters
+	{
+		std::atomic<long long> live_bytes;
+		std::atomic<long long> peak_bytes;
+		std::atomic<long long> live_allocations;
+		std::atomic<unsigned long long> total_allocations;
+		std::atomic<unsigned long long> frame_allocations;
+		std::atomic<unsigned long long> frame_bytes;
+	};
+
+	struct callsite_counters
+	{
+		std::atomic<const void*> address;
+		std::atomic<unsigned char> tag;
+		std::atomic<long long> live_bytes;
+		std::atomic<long long> live_allocations;
+		std::atomic<unsigned long long> total_allocations;
+		std::atomic<unsigned long long> frame_allocations;
+	};
+
+	const unsigned int TAG_COUNT = static_cast<unsigned int>(memory_tag::count);
+	//the slot past the table takes whatever does not fit
+	const std::uint32_t OVERFLOW_CALLSITE = memory_tracker::CALLSITE_CAPACITY;
+	const unsigned int CALLSITE_PROBES = 32;
+
+	tag_counters tags[TAG_COUNT];
+	callsite_counters callsites[memory_tracker::CALLSITE_CAPACITY + 1];
+
+	//published by end_frame, main thread only
+	unsigned long long last_frame_allocations[TAG_COUNT];
+	unsigned long long last_frame_bytes[TAG_COUNT];
+	unsigned long long last_callsite_allocations[memory_tracker::CALLSITE_CAPACITY + 1];
+
+	thread_local memory_tag current_tag = memory_tag::other;
+
+	std::uint32_t find_callsite(const void* address)
+	{
+		if (address == nullptr)
+			return OVERFLOW_CALLSITE;
+
+		std::uintptr_t hash = reinterpret_cast<std::uintptr_t>(address);
+		hash ^= hash >> 17;
+		hash *= 0x9e3779b1u;
+
+		for (unsigned int probe = 0; probe < CALLSITE_PROBES; probe++)
+		{
+			const std::uint32_t index = static_cast<std::uint32_t>((hash + probe) % memory_tracker::CALLSITE_CAPACITY);
+			const void* current = callsites[index].address.load(std::memory_order_relaxed);
+
+			if (current == address)
+				return index;
+
+			if (current == nullptr)
+			{
+				const void* expected = nullptr;
+				if (callsites[index].address.compare_exchange_strong(expected, address, std::memory_order_relaxed) || expected == address)
+				{
+					callsites[index].tag.store(static_cast<unsigned char>(current_tag), std::memory_order_relaxed);
+					return index;
+				}
+			}
+		}
+
+		return OVERFLOW_CALLSITE;
+	}
+
+	void count_allocation(const block_header& header)
+	{
+		const long long size = static_cast<long long>(header.size);
+		tag_counters& tag = tags[static_cast<unsigned int>(header.tag)];
+
+		const long long live = tag.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+		long long peak = tag.peak_bytes.load(std::memory_order_relaxed);
+		while (live > peak && !tag.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+
+		tag.live_allocations.fetch_add(1, std::memory_order_relaxed);
+		tag.total_allocations.fetch_add(1, std::memory_order_relaxed);
+		tag.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+		tag.frame_bytes.fetch_add(header.size, std::memory_order_relaxed);
+
+		callsite_counters& site = callsites[header.callsite];
+		site.live_bytes.fetch_add(size, std::memory_order_relaxed);
+		site.live_allocations.fetch_add(1, std::memory_order_relaxed);
+		site.total_allocations.fetch_add(1, std::memory_order_relaxed);
+		site.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void count_release(const block_header& header)
+	{
+		const long long size = static_cast<long long>(header.size);
+		tag_counters& tag = tags[static_cast<unsigned int>(header.tag)];
+		tag.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+		tag.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+
+		callsite_counters& site = callsites[header.callsite];
+		site.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+		site.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	block_header* get_header(void* block)
+	{
+		return reinterpret_cast<block_header*>(static_cast<char*>(block) - HEADER_SIZE);
+	}
+}
+
+bool memory_tracker::is_hooked()
+{
+#ifdef MEMORY_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+void* memory_tracker::allocate(const std::size_t size, const void* callsite)
+{
+	void* raw = std::malloc(size + HEADER_SIZE);
+	if (raw == nullptr)
+		return nullptr;
+
+	block_header* header = static_cast<block_header*>(raw);
+	header->size = size;
+	header->tag = current_tag;
+	header->callsite = find_callsite(callsite);
+	count_allocation(*header);
+
+	return static_cast<char*>(raw) + HEADER_SIZE;
+}
+
+void* memory_tracker::reallocate(void* block, const std::size_t size, const void* callsite)
+{
+	if (block == nullptr)
+		return allocate(size, callsite);
+
+	block_header* header = get_header(block);
+	const block_header previous = *header;
+
+	void* raw = std::realloc(header, size + HEADER_SIZE);
+	if (raw == nullptr)
+		return nullptr;
+
+	//the grown block counts as a new allocation of the current tag and callsite
+	count_release(previous);
+	header = static_cast<block_header*>(raw);
+	header->size = size;
+	header->tag = current_tag;
+	header->callsite = find_callsite(callsite);
+	count_allocation(*header);
+
+	return static_cast<char*>(raw) + HEADER_SIZE;
+}
+
+void memory_tracker::release(void* block)
+{
+	if (block == nullptr)
+		return;
+
+	block_header* header = get_header(block);
+	count_release(*header);
+	std::free(header);
+}
+
+memory_tag memory_tracker::get_tag()
+{
+	return current_tag;
+}
+
+void memory_tracker::set_tag(const memory_tag tag)
+{
+	current_tag = tag;
+}
+
+void memory_tracker::end_frame()
+{
+	for (unsigned int i = 0; i < TAG_COUNT; i++)
+	{
+		last_frame_allocations[i] = tags[i].frame_allocations.exchange(0, std::memory_order_relaxed);
+		last_frame_bytes[i] = tags[i].frame_bytes.exchange(0, std::memory_order_relaxed);
+	}
+
+	for (unsigned int i = 0; i <= CALLSITE_CAPACITY; i++)
+		last_callsite_allocations[i] = callsites[i].frame_allocations.exchange(0, std::memory_order_relaxed);
+}
+
+memory_tag_stats memory_tracker::get_stats(const memory_tag tag)
+{
+	const unsigned int index = static_cast<unsigned int>(tag);
+	const tag_counters& counters = tags[index];
+
+	memory_tag_stats stats;
+	stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+	stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+	stats.live_allocations = counters.live_allocations.load(std::memory_order_relaxed);
+	stats.total_allocations = counters.total_allocations.load(std::memory_order_relaxed);
+	stats.frame_allocations = last_frame_allocations[index];
+	stats.frame_bytes = last_frame_bytes[index];
+	return stats;
+}
+
+unsigned long long memory_tracker::get_frame_allocations()
+{
+	unsigned long long total = 0;
+	for (const unsigned long long count : last_frame_allocations)
+		total += count;
+	return total;
+}
+
+std::vector<memory_callsite> memory_tracker::get_callsites()
+{
+	std::vector<memory_callsite> result;
+
+	for (unsigned int i = 0; i <= CALLSITE_CAPACITY; i++)
+	{
+		const callsite_counters& site = callsites[i];
+		const unsigned long long total = site.total_allocations.load(std::memory_order_relaxed);
+		if (total == 0)
+			continue;
+
+		result.push_back({
+			site.address.load(std::memory_order_relaxed),
+			static_cast<memory_tag>(site.tag.load(std::memory_order_relaxed)),
+			site.live_bytes.load(std::memory_order_relaxed),
+			site.live_allocations.load(std::memory_order_relaxed),
+			total,
+			last_callsite_allocations[i]
+		});
+	}
+
+	return result;
+}
+
+std::string memory_tracker::get_callsite_name(const void* address)
+{
+	if (address == nullptr)
+		return "(other callsites)";
+
+#ifdef _WIN32
+	//dbghelp is single threaded
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+
+	const HANDLE process = GetCurrentProcess();
+	static const bool has_symbols = SymInitialize(process, nullptr, TRUE) != FALSE;
+
+	if (has_symbols)
+	{
+		char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+		SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(buffer);
+		symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+		symbol->MaxNameLen = MAX_SYM_NAME;
+
+		const DWORD64 key = reinterpret_cast<DWORD64>(address);
+		DWORD64 displacement = 0;
+
+		if (SymFromAddr(process, key, &displacement, symbol))
+		{
+			std::string name(symbol->Name);
+
+			IMAGEHLP_LINE64 line{};
+			line.SizeOfStruct = sizeof(line);
+			DWORD line_displacement = 0;
+			if (SymGetLineFromAddr64(process, key, &line_displacement, &line))
+			{
+				const std::string file(line.FileName);
+				name.append(" ").append(file.substr(file.find_last_of("\\/") + 1)).append(":").append(std::to_string(line.LineNumber));
+			}
+
+			return name;
+		}
+	}
+#endif
+
+	char text[32];
+	std::snprintf(text, sizeof(text), "%p", address);
+	return text;
+}
+
+void memory_tracker::write_leak_report(std::ostream& out, const unsigned int callsite_count)
+{
+	long long live_bytes = 0;
+	long long live_allocations = 0;
+
+	out << "Memory still allocated at exit:" << std::endl;
+	for (unsigned int i = 0; i < TAG_COUNT; i++)
+	{
+		const memory_tag_stats stats = get_stats(static_cast<memory_tag>(i));
+		live_bytes += stats.live_bytes;
+		live_allocations += stats.live_allocations;
+
+		out << "  " << std::left << std::setw(14) << tag_to_string(static_cast<memory_tag>(i)) << std::right
+			<< std::setw(12) << stats.live_bytes << " bytes in " << stats.live_allocations << " blocks, peak " << stats.peak_bytes << std::endl;
+	}
+	out << "  " << live_bytes << " bytes in " << live_allocations << " blocks" << std::endl;
+
+	std::vector<memory_callsite> sites = get_callsites();
+	sites.erase(std::remove_if(sites.begin(), sites.end(), [](const memory_callsite& site) { return site.live_allocations <= 0; }), sites.end());
+	std::sort(sites.begin(), sites.end(), [](const memory_callsite& a, const memory_callsite& b) { return a.live_bytes > b.live_bytes; });
+
+	if (sites.size() > callsite_count)
+		sites.resize(callsite_count);
+
+	for (const memory_callsite& site : sites)
+		out << "  " << std::setw(12) << site.live_bytes << " bytes in " << site.live_allocations << " blocks from "
+			<< get_callsite_name(site.address) << " (" << tag_to_string(site.tag) << ")" << std::endl;
+}
+
+const char* memory_tracker::tag_to_string(const memory_tag tag)
+{
+	switch (tag)
+	{
+	case memory_tag::other: return "Other";
+	case memory_tag::asset_import: return "Asset Import";
+	case memory_tag::meshes: return "Meshes";
+	case memory_tag::textures: return "Textures";
+	case memory_tag::rendering: return "Rendering";
+	case memory_tag::imgui: return "ImGui";
+	default: return "error";
+	}
+}
+
+memory_tag_scope::memory_tag_scope(const memory_tag tag) : previous(current_tag)
+{
+	current_tag = tag;
+}
+
+memory_tag_scope::~memory_tag_scope()
+{
+	current_tag = previous;
+}
+
+#ifdef MEMORY_TRACKING
+
+#pragma region Global Allocation Hooks
+
+void* operator new(const std::size_t size)
+{
+	void* block = memory_tracker::allocate(size, MEMORY_TRACKER_RETURN_ADDRESS());
+	if (block == nullptr)
+		throw std::bad_alloc();
+	return block;
+}
+
+void* operator new[](const std::size_t size)
+{
+	void* block = memory_tracker::allocate(size, MEMORY_TRACKER_RETURN_ADDRESS());
+	if (block == nullptr)
+		throw std::bad_alloc();
+	return block;
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept
+{
+	return memory_tracker::allocate(size, MEMORY_TRACKER_RETURN_ADDRESS());
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept
+{
+	return memory_tracker::allocate(size, MEMORY_TRACKER_RETURN_ADDRESS());
+}
+
+void operator delete(void* block) noexcept
+{
+	memory_tracker::release(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	memory_tracker::release(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+	memory_tracker::release(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+	memory_tracker::release(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+	memory_tracker::release(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+	memory_tracker::release(block);
+}
+
+#pragma endregion
+
+#endif
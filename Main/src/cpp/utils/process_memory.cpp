@@ -0,0 +1,31 @@
+#include "utils/process_memory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+unsigned long long get_process_memory_bytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return counters.WorkingSetSize;
+#else
+	//second field of statm is the resident set in pages
+	std::ifstream statm("/proc/self/statm");
+	unsigned long long size = 0, resident = 0;
+
+	if (!(statm >> size >> resident))
+		return 0;
+
+	return resident * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+#endif
+}
@@ -0,0 +1,74 @@
+#include "utils/string_id.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	//id 0 is the empty string so a default string_id is valid
+	//strings live in a deque so references handed out stay valid while other threads intern
+	struct string_table
+	{
+		std::mutex mutex;
+		std::unordered_map<std::string, unsigned int> ids{ { std::string(), 0 } };
+		std::deque<std::string> strings{ std::string() };
+	};
+
+	string_table& get_table()
+	{
+		static string_table table;
+		return table;
+	}
+}
+
+string_id::string_id() = default;
+
+string_id::string_id(const std::string& str)
+{
+	auto& table = get_table();
+	std::lock_guard<std::mutex> lock(table.mutex);
+	const auto it = table.ids.find(str);
+
+	if (it != table.ids.end())
+	{
+		id = it->second;
+		return;
+	}
+
+	id = static_cast<unsigned int>(table.strings.size());
+	table.strings.push_back(str);
+	table.ids.emplace(str, id);
+}
+
+unsigned int string_id::get_id() const
+{
+	return id;
+}
+
+const std::string& string_id::get_string() const
+{
+	auto& table = get_table();
+	std::lock_guard<std::mutex> lock(table.mutex);
+	return table.strings[id];
+}
+
+const char* string_id::c_str() const
+{
+	return get_string().c_str();
+}
+
+bool string_id::operator==(const string_id& other) const
+{
+	return id == other.id;
+}
+
+bool string_id::operator!=(const string_id& other) const
+{
+	return id != other.id;
+}
+
+bool string_id::operator<(const string_id& other) const
+{
+	return id < other.id;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cfloat>
+#include <glm/glm.hpp>
+
+struct aabb
+{
+	//starts inverted so the first expand sets both corners
+	glm::vec3 min{ FLT_MAX };
+	glm::vec3 max{ -FLT_MAX };
+
+	bool is_valid() const;
+	glm::vec3 get_center() const;
+	glm::vec3 get_extents() const;
+
+	void expand(const glm::vec3& point);
+	void expand(const aabb& other);
+
+	//bounds of this box after it went through the given matrix
+	aabb transformed(const glm::mat4& matrix) const;
+};
+
+struct frustum
+{
+	//left, right, bottom, top, near, far, xyz is the normal pointing inwards
+	glm::vec4 planes[6];
+
+	static frustum from_matrix(const glm::mat4& view_proj);
+	bool intersects(const aabb& box) const;
+};
@@ -1,15 +1,16 @@
 #pragma once
+#include <memory>
 #include <vector>
 
 #include "vertex.h"
+#include "data/mesh_data.h"
+#include "rendering/material_slot.h"
 #include "rendering/texture.h"
 
 class mesh
 {
 	public:
 	
-	std::vector<vertex> vertices;
-	std::vector<unsigned int> indices;
 	std::vector<texture> textures;
 
 	bool is_transparent{ false };
@@ -21,8 +22,25 @@ class mesh
 	mesh(const std::vector<vertex> &, std::vector<unsigned int>&);
 	mesh(const std::vector<vertex> &, std::vector<texture>&);
 	mesh(const std::vector<vertex> &, std::vector<unsigned int>& , std::vector<texture>&);
+	explicit mesh(std::shared_ptr<mesh_data> geometry);
+	mesh(std::shared_ptr<mesh_data> geometry, std::vector<texture> textures);
 
 	void replace_textures(const std::vector<texture>& textures);
 	void insert_texture(const texture& texture);
 
+	const std::vector<vertex>& get_vertices() const;
+	const std::vector<unsigned int>& get_indices() const;
+	std::shared_ptr<mesh_data> get_geometry() const;
+
+	void set_cpu_access(bool flag) const;
+	bool get_cpu_access() const;
+
+	//sampler bindings for the current textures, same naming the renderer uses
+	const std::vector<material_slot>& get_material_slots() const;
+
+private:
+	std::shared_ptr<mesh_data> geometry;
+	std::vector<material_slot> material_slots;
+
+	void rebuild_material_slots();
 };
@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "bounds.h"
+#include "vertex.h"
+
+class gpu_mesh;
+
+//immutable geometry shared by every copy of a mesh
+//the cpu copy is dropped once the geometry lives on the gpu, unless cpu access was requested (physics, picking)
+class mesh_data
+{
+public:
+	mesh_data(std::vector<vertex> vertices, std::vector<unsigned int> indices);
+
+	const std::vector<vertex>& get_vertices() const;
+	const std::vector<unsigned int>& get_indices() const;
+	unsigned int get_vertex_count() const;
+	unsigned int get_index_count() const;
+	//computed on construction so it survives release()
+	const aabb& get_bounds() const;
+
+	bool get_is_resident() const;
+	bool get_cpu_access() const;
+	void set_cpu_access(bool flag);
+	void release();
+
+	std::shared_ptr<gpu_mesh> get_gpu_mesh() const;
+	void set_gpu_mesh(const std::shared_ptr<gpu_mesh>& gpu);
+
+private:
+	std::vector<vertex> vertices;
+	std::vector<unsigned int> indices;
+	unsigned int vertex_count{ 0 };
+	unsigned int index_count{ 0 };
+	bool cpu_access{ false };
+	aabb bounds;
+
+	std::shared_ptr<gpu_mesh> gpu;
+};
@@ -24,13 +24,23 @@ public:
 	void draw(const shader_program& program);
 	void draw_instanced(const shader_program &program, const unsigned int count);
 	void draw_shadow(const shader_program& program);
+	//records one packet per mesh instead of drawing, safe to call from jobs
+	void record(command_list& list, const shader_program& program, const glm::mat4& model_matrix, const tiling_and_offset* tiling, float depth) const;
+	void record_shadow(command_list& list, const shader_program& program, const glm::mat4& model_matrix) const;
 	void load(const std::string &path);
 	void deallocate();
-	std::vector<mesh> get_meshes() const;
+	const std::vector<std::shared_ptr<mesh>>& get_meshes() const;
 	mesh* get_mesh_ptr(int index);
+	//local space bounds of every mesh
+	aabb get_bounds() const;
+	//keeps the cpu copy of the geometry after upload, has to be set before the model is loaded
+	void set_cpu_access(bool flag);
+
+	//vertex and index conversion of process_mesh, textures aside
+	static void convert_geometry(const aiMesh* m, std::vector<vertex>& vertices, std::vector<unsigned int>& indices);
 
 private:
-	std::vector<mesh> meshes;
+	std::vector<std::shared_ptr<mesh>> meshes;
 	std::vector<renderer> renderers;
 	std::vector<instanced_renderer> instanced_renderers;
 	std::vector<shadow_renderer> shadow_renderers;
@@ -43,10 +53,12 @@ private:
 	void load_model(const std::string& path);
 	void process_node(aiNode* node, const aiScene* scene);
 	mesh process_mesh(aiMesh* m, const aiScene* scene);
+	void add_mesh(const std::shared_ptr<mesh>& m);
 	std::vector<texture> load_material_textures(aiMaterial* mat, aiTextureType type,texture_type tex_type);
 
 	bool is_texture_loaded(const std::string& path);
 	bool is_model_loaded{false};
 	bool is_instanced{ false };
 	bool is_shadow{false};
+	bool cpu_access{false};
 };
@@ -6,11 +6,18 @@
 class primitive
 {
 public:
-	static mesh get_sphere();
-	static mesh get_quad();
-	static mesh get_cube();
+	static const mesh& get_sphere();
+	static const mesh& get_quad();
+	static const mesh& get_cube();
+
+	//fresh geometry without the cache, no gl needed
+	static mesh create_cube();
+	static mesh create_quad();
 
 private:
+	//loads a model, needs a gl context
+	static mesh create_sphere();
+
 	primitive() = delete;
 	static bool is_initialized;
 	static mesh sphere_cache;
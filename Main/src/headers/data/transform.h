@@ -2,50 +2,57 @@
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtx/euler_angles.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include "data/transform_system.h"
+
+// handle to a slot in the transform_system, refcounted so the slot lives as long as any handle to it
+// copying a transform does NOT copy its values: the copy and the original are the same transform and a
+// set_position on either moves both, which is how entities share their model's transform
+// use clone() for an independent transform that starts out with the same values
 class transform
 {
 private:
-	glm::vec3 _position{ 0,0,0 };
-	glm::vec3 _rotation{ 0,0,0 };
-	glm::vec3 _scale{ 1,1,1 };
-	glm::vec3 _forward{ 0,0,1 };
-	glm::vec3 _up{ 0,1,0 };
-	glm::vec3 _right{ 1,0,0 };
-
-	glm::mat4x4 _rotation_mat;
-
-
-	glm::vec3 right_basis = glm::vec3(1, 0, 0);
-	glm::vec3 forward_basis = glm::vec3(0, 0, 1);
-	glm::vec3 up_basis = glm::vec3(0, 1, 0);
-
-	void recalculate_directions();
+	unsigned int index;
 
 public:
 	transform(const glm::vec3, const glm::vec3, const glm::vec3);
 	transform();
+	//both alias the other's slot, see clone()
+	transform(const transform& other);
+	transform& operator=(const transform& other);
+	~transform();
+
+	//a new slot holding the same values
+	transform clone() const;
+
+	unsigned int get_index() const;
 
 	glm::vec3 position() const;
 	glm::vec3 rotation() const;
+	glm::quat rotation_quat() const;
 	glm::vec3 scale() const;
 	glm::mat4x4 rotation_mat() const;
 
 	glm::vec3 forward() const;
 	glm::vec3 up() const;
 	glm::vec3 right() const;
-	
+
+	//pointers are for immediate edits (imgui), they mark the transform dirty
 	glm::vec3* position_ptr();
 	glm::vec3* rotation_ptr();
 	glm::vec3* scale_ptr();
 	glm::vec3* forward_ptr();
-	
-	
 
 	void set_position(const glm::vec3 pos);
 	void set_rotation(const glm::vec3 rot);
+	void set_rotation(const glm::quat& rot);
 	void set_scale(const glm::vec3 scale);
 
+	void set_parent(const transform* parent);
+	bool has_parent() const;
+
 	glm::mat4 get_model_matrix() const;
+	//skips the lazy update, for jobs that run after transform_system::update()
+	const glm::mat4& get_cached_model_matrix() const;
 };
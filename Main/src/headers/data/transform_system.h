@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// owns every transform's data in contiguous arrays, a transform is just an index into them
+// local matrices are rebuilt only for dirty slots and world matrices are propagated parent-first
+class transform_system
+{
+	friend class transform;
+
+public:
+	static const int NO_PARENT = -1;
+	//levels smaller than this are not worth handing to the job system
+	static const unsigned int PARALLEL_BATCH = 256;
+
+	static transform_system& get();
+
+	unsigned int create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+	void retain(unsigned int index);
+	void release(unsigned int index);
+
+	void set_parent(unsigned int index, int parent);
+	int get_parent(unsigned int index) const;
+
+	void mark_dirty(unsigned int index);
+	bool has_dirty() const;
+
+	//recomputes every dirty local matrix and every world matrix affected by it
+	void update();
+
+	//update in pieces, one hierarchy level at a time so a level can be split across threads
+	void rebuild_order();
+	unsigned int get_level_count() const;
+	void get_level_range(unsigned int level, unsigned int& begin, unsigned int& end) const;
+	void update_range(unsigned int begin, unsigned int end);
+	void clear_dirty();
+
+	//current even when update() has not run since the last edit, composed from the slot and its parents without
+	//touching the caches, so it is slower than the cached matrix and meant for code outside the frame update
+	glm::mat4 get_world_matrix(unsigned int index) const;
+	//no lazy update, safe to call from jobs once update() ran this frame
+	const glm::mat4& get_cached_world_matrix(unsigned int index) const;
+	unsigned int get_count() const;
+
+private:
+	enum dirty_bits : unsigned char
+	{
+		LOCAL_DIRTY = 1,
+		EULER_DIRTY = 2,
+		WORLD_CHANGED = 4
+	};
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> euler_angles;
+	std::vector<glm::quat> rotations;
+	std::vector<glm::vec3> scales;
+	std::vector<glm::vec3> forwards;
+	std::vector<glm::vec3> ups;
+	std::vector<glm::vec3> rights;
+	std::vector<glm::mat4> local_matrices;
+	std::vector<glm::mat4> world_matrices;
+	std::vector<int> parents;
+	std::vector<unsigned int> depths;
+	std::vector<unsigned char> flags;
+	std::vector<unsigned int> ref_counts;
+
+	std::vector<unsigned int> free_slots;
+
+	//live slots sorted by depth, level_offsets[d] is where depth d starts in order
+	std::vector<unsigned int> order;
+	std::vector<unsigned int> level_offsets;
+	bool is_order_dirty{ true };
+	unsigned int dirty_count{};
+
+	transform_system() = default;
+
+	void recalculate_directions(unsigned int index);
+	unsigned int compute_depth(unsigned int index) const;
+
+	static glm::quat euler_to_quat(const glm::vec3& euler_degrees);
+	static void compose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& out);
+	//local matrices of four slots at once, one sse lane each
+	void compose_batch(const unsigned int* indices);
+	static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out);
+};
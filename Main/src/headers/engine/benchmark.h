@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "engine/stress_scene.h"
+#include "rendering/render_stats.h"
+#include "utils/config.h"
+
+// scripted run for reproducible numbers: fixed resolution, camera driven by a recorded path,
+// a set number of frames after a warmup, then a json report and an optional check against a baseline
+class benchmark
+{
+public:
+	struct settings
+	{
+		bool is_enabled{ false };
+		//hidden window, nothing is shown and no input is read
+		bool is_headless{ false };
+		//ask glfw for an egl context, the route to mesa without a display server
+		bool use_egl{ false };
+		//submit to the null backend during the loop, what is left is the engine's own cpu cost per draw
+		bool use_null_backend{ false };
+		unsigned int frames{ 600 };
+		unsigned int warmup_frames{ 60 };
+		unsigned int width{ 1280 };
+		unsigned int height{ 720 };
+		std::string camera_path;
+		std::string output{ "benchmark.json" };
+		std::string baseline;
+		//allowed growth over the baseline per metric, 0.1 is 10%
+		float tolerance{ 0.1f };
+		//synthetic objects on top of the regular scene, off while object_count is 0
+		stress_scene::settings stress;
+		//backend calls from startup through capture_frames frames are written here for the Replay tool, off while empty
+		std::string capture_path;
+		unsigned int capture_frames{ 10 };
+		//not benchmark only, applies to every run
+		unsigned int gpu_budget_mb{ config::GPU_MEMORY_BUDGET_MB };
+		//after the warmup any heap allocation tagged rendering is reported with its callsite and fails the run
+		bool assert_no_allocations{ false };
+	};
+
+	//resident memory is sampled this often, reading it is a syscall
+	static const unsigned int MEMORY_SAMPLE_INTERVAL = 30;
+
+	//differences smaller than this never count as a regression, timer noise on tiny passes
+	static const float NOISE_FLOOR;
+
+	//false on a bad command line, usage has been printed
+	static bool parse_args(int argc, char** argv, settings& out);
+
+	explicit benchmark(const settings& s);
+
+	const settings& get_settings() const;
+	bool is_done() const;
+	bool is_measuring() const;
+	//0 to 1 over the whole run, warmup included, for sampling the camera path
+	float get_progress() const;
+
+	void add_gpu_sample(float gpu_ms);
+	void end_frame(float cpu_ms, const render_counters& total, const std::vector<pass_counters>& passes);
+
+	bool write_report(const std::string& renderer, const std::string& backend) const;
+	//prints every compared metric, false when any of them regressed past the tolerance
+	bool compare_baseline() const;
+
+private:
+	settings config;
+	unsigned int frame{ 0 };
+
+	std::vector<float> cpu_ms;
+	std::vector<float> gpu_ms;
+	render_counters totals;
+	std::vector<pass_counters> pass_totals;
+	unsigned long long peak_memory{ 0 };
+	unsigned long long allocations{ 0 };
+	std::size_t peak_gpu_memory{ 0 };
+
+	std::vector<std::pair<std::string, double>> get_metrics() const;
+	static bool read_metrics(const std::string& path, std::vector<std::pair<std::string, double>>& metrics);
+	static float percentile(std::vector<float> samples, float p);
+};
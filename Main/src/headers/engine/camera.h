@@ -7,6 +7,8 @@ public:
 	float fov;
 	float near;
 	float far;
+	//follows the window, set from the framebuffer resize callback
+	float aspect;
 
 	camera();
 	camera(float fov, float near, float far);
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// a camera fly-through as timed keyframes of position and euler rotation, recorded from the free camera
+// and played back by the benchmark so every run renders the same views
+class camera_path
+{
+public:
+	struct keyframe
+	{
+		float time;
+		glm::vec3 position;
+		glm::vec3 rotation;
+	};
+
+	//one keyframe per line: time, position xyz, rotation xyz
+	bool load(const std::string& path);
+	bool save(const std::string& path) const;
+
+	void clear();
+	//keyframes have to come in increasing time
+	void add(float time, const glm::vec3& position, const glm::vec3& rotation);
+
+	//time counts from the first keyframe, linear between the surrounding ones and clamped to the ends
+	keyframe sample(float time) const;
+
+	float get_duration() const;
+	bool is_empty() const;
+
+private:
+	std::vector<keyframe> keyframes;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+
+#include "entity.h"
+
+class component_pool_base
+{
+public:
+	virtual ~component_pool_base() = default;
+	virtual void remove(entity e) = 0;
+	virtual bool has(entity e) const = 0;
+};
+
+//sparse set, components are packed densely so a pass over them is a straight walk through memory
+//removing swaps the last component into the hole, so order is not stable
+template <typename T>
+class component_pool final : public component_pool_base
+{
+public:
+	T& add(const entity e, T component)
+	{
+		if (e.index >= sparse.size())
+			sparse.resize(e.index + 1, INVALID);
+
+		if (sparse[e.index] != INVALID)
+		{
+			entities[sparse[e.index]] = e;
+			components[sparse[e.index]] = std::move(component);
+			return components[sparse[e.index]];
+		}
+
+		sparse[e.index] = static_cast<unsigned int>(components.size());
+		entities.push_back(e);
+		components.push_back(std::move(component));
+		return components.back();
+	}
+
+	void remove(const entity e) override
+	{
+		if (!has(e))
+			return;
+
+		const unsigned int dense = sparse[e.index];
+		const unsigned int last = static_cast<unsigned int>(components.size()) - 1;
+
+		if (dense != last)
+		{
+			components[dense] = std::move(components[last]);
+			entities[dense] = entities[last];
+			sparse[entities[dense].index] = dense;
+		}
+
+		components.pop_back();
+		entities.pop_back();
+		sparse[e.index] = INVALID;
+	}
+
+	bool has(const entity e) const override
+	{
+		return e.index < sparse.size() && sparse[e.index] != INVALID && entities[sparse[e.index]] == e;
+	}
+
+	T* get(const entity e)
+	{
+		return has(e) ? &components[sparse[e.index]] : nullptr;
+	}
+
+	const T* get(const entity e) const
+	{
+		return has(e) ? &components[sparse[e.index]] : nullptr;
+	}
+
+	unsigned int size() const
+	{
+		return static_cast<unsigned int>(components.size());
+	}
+
+	std::vector<T>& get_components()
+	{
+		return components;
+	}
+
+	const std::vector<T>& get_components() const
+	{
+		return components;
+	}
+
+	const std::vector<entity>& get_entities() const
+	{
+		return entities;
+	}
+
+private:
+	static constexpr unsigned int INVALID = 0xFFFFFFFF;
+
+	std::vector<unsigned int> sparse;
+	std::vector<entity> entities;
+	std::vector<T> components;
+};
+
+//the project builds as c++14 where constexpr members are not implicitly inline, resize odr-uses it
+template<typename T>
+constexpr unsigned int component_pool<T>::INVALID;
@@ -0,0 +1,25 @@
+#pragma once
+#include "data/bounds.h"
+#include "data/model.h"
+#include "utils/string_id.h"
+
+struct name_component
+{
+	string_id name;
+};
+
+struct mesh_renderer_component
+{
+	model source;
+	//tile the material by the object's scale, for floors and walls
+	bool use_scale_tiling{ false };
+	bool casts_shadow{ true };
+	bool is_active{ true };
+};
+
+struct bounds_component
+{
+	aabb local;
+	aabb world;
+	bool is_visible{ true };
+};
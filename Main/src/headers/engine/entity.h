@@ -0,0 +1,25 @@
+#pragma once
+
+//index into the registry plus the generation it was created with, stale handles fail is_alive
+struct entity
+{
+	static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+	unsigned int index{ INVALID_INDEX };
+	unsigned int generation{ 0 };
+
+	bool is_null() const
+	{
+		return index == INVALID_INDEX;
+	}
+
+	bool operator==(const entity& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const entity& other) const
+	{
+		return !(*this == other);
+	}
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+// always-on history of the last FRAME_COUNT frames: cpu frame time, named counters and which gpu profiler
+// frame they belong to. a frame over the threshold (or a manual trigger) schedules a dump that is written
+// CONTEXT_AFTER frames later as a chrome trace holding the spike, the frames around it and their cpu scopes
+class flight_recorder
+{
+public:
+	static const unsigned int FRAME_COUNT = 300;
+	static const unsigned int CONTEXT_BEFORE = 120;
+	static const unsigned int CONTEXT_AFTER = 30;
+	//the first frames after startup are always slow and never count as hitches
+	static const unsigned int WARMUP_FRAMES = 60;
+
+	bool is_enabled{ true };
+	//a frame is a hitch past either limit: an absolute time, or a multiple of the running average
+	float threshold_ms{ 50.0f };
+	float spike_ratio{ 3.0f };
+
+	flight_recorder();
+
+	void begin_frame(unsigned long long gpu_frame);
+	//counter names are kept by pointer, use string literals
+	void set_counter(const char* name, float value);
+	void end_frame();
+
+	//kept by pointer like the counter names
+	void trigger(const char* reason);
+
+	unsigned int get_dump_count() const;
+	const std::string& get_last_dump() const;
+	float get_average_ms() const;
+
+private:
+	struct frame_record
+	{
+		unsigned long long number{ 0 };
+		unsigned long long gpu_frame{ 0 };
+		unsigned long long start_ns{ 0 };
+		unsigned long long end_ns{ 0 };
+		std::vector<std::pair<const char*, float>> counters;
+	};
+
+	std::vector<frame_record> frames;
+	unsigned long long frame_count{ 0 };
+	float average_ms{ 0 };
+
+	bool is_dump_pending{ false };
+	unsigned long long spike_frame{ 0 };
+	const char* spike_reason{ "" };
+
+	unsigned int dump_count{ 0 };
+	std::string last_dump;
+
+	frame_record& get_current();
+	void write_dump();
+};
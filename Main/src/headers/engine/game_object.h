@@ -8,7 +8,7 @@ class game_object
 {
 protected:
 	std::string name;
-	std::shared_ptr<transform> _transform;
+	transform _transform;
 
 public:
 
@@ -17,7 +17,8 @@ public:
 	explicit game_object(const transform &t_form);
 	explicit game_object();
 
-	transform* get_transform() const;
+	transform* get_transform();
+	const transform* get_transform() const;
 	std::string get_name() const;
 	void set_name(const std::string& name);
 	
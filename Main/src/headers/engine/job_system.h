@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//a unit of work, it is done once its own function and all of its children have run
+struct job
+{
+	std::function<void()> function;
+	job* parent{ nullptr };
+	std::atomic<int> unfinished{ 0 };
+};
+
+//work-stealing scheduler, every thread (the main thread is index 0) owns a deque
+//owners push and pop at the back, idle threads steal from the front of someone else's deque
+//waiting on a job runs other jobs instead of blocking so the main thread helps too
+class job_system
+{
+public:
+	static job_system& get();
+
+	//0 workers means one per hardware thread minus the main thread
+	void init(unsigned int worker_count = 0);
+	void shutdown();
+
+	//a job's slot is reused once it is done, do not hold on to the pointer past waiting on it
+	job* create(std::function<void()> function, job* parent = nullptr);
+	void run(job* j);
+	void wait(const job* j);
+	static bool is_done(const job* j);
+
+	//splits [0, count) into batches and calls function(begin, end) on each, returns once all are done
+	//batches grow past batch_size when there would be more than MAX_PARALLEL_JOBS of them
+	template<typename F>
+	void parallel_for(unsigned int count, unsigned int batch_size, const F& function);
+
+	unsigned int get_worker_count() const;
+	unsigned int get_thread_count() const;
+	static unsigned int get_thread_index();
+
+	//jobs run by each thread since the last reset, shows how the work spreads across cores
+	unsigned int get_jobs_executed(unsigned int thread) const;
+	void reset_stats();
+
+	~job_system();
+
+private:
+	static const unsigned int JOBS_PER_THREAD = 4096;
+	//an eighth of a ring so nested parallel_fors still fit
+	static const unsigned int MAX_PARALLEL_JOBS = JOBS_PER_THREAD / 8;
+
+	struct worker_queue
+	{
+		std::mutex mutex;
+		std::deque<job*> jobs;
+		std::vector<job> pool;
+		unsigned int next_job{ 0 };
+		std::atomic<unsigned int> executed{ 0 };
+	};
+
+	std::vector<std::unique_ptr<worker_queue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<bool> is_running{ false };
+	std::atomic<int> pending{ 0 };
+	std::mutex sleep_mutex;
+	std::condition_variable wake_condition;
+
+	job_system() = default;
+
+	void run_batches(unsigned int count, unsigned int batch_size, const std::function<void(unsigned int, unsigned int)>& function);
+	void worker_loop(unsigned int index);
+	job* get_job();
+	void execute(job* j);
+	void finish(job* j);
+};
+
+template<typename F>
+void job_system::parallel_for(const unsigned int count, const unsigned int batch_size, const F& function)
+{
+	//only a reference goes into the std::function, small enough for its inline buffer however much the caller captured
+	run_batches(count, batch_size, [&function](const unsigned int begin, const unsigned int end) { function(begin, end); });
+}
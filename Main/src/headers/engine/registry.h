@@ -0,0 +1,121 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "component_pool.h"
+#include "entity.h"
+
+//owns every entity and one packed pool per component type
+class registry
+{
+public:
+	entity create();
+	void destroy(entity e);
+	bool is_alive(entity e) const;
+	unsigned int get_entity_count() const;
+
+	template <typename T>
+	component_pool<T>& get_pool();
+
+	template <typename T>
+	T& add(entity e, T component);
+
+	template <typename T>
+	void remove(entity e);
+
+	template <typename T>
+	bool has(entity e);
+
+	template <typename T>
+	T* get(entity e);
+
+	//calls f(entity, T&) for every T in pool order
+	template <typename T, typename F>
+	void each(F&& f);
+
+	//walks the T pool and calls f(entity, T&, U&) for the entities that also have a U
+	template <typename T, typename U, typename F>
+	void each(F&& f);
+
+private:
+	std::vector<unsigned int> generations;
+	std::vector<unsigned int> free_indices;
+	std::vector<std::unique_ptr<component_pool_base>> pools;
+
+	static unsigned int next_type_id();
+
+	template <typename T>
+	static unsigned int type_id();
+};
+
+template <typename T>
+unsigned int registry::type_id()
+{
+	static const unsigned int id = next_type_id();
+	return id;
+}
+
+template <typename T>
+component_pool<T>& registry::get_pool()
+{
+	const unsigned int id = type_id<T>();
+
+	if (id >= pools.size())
+		pools.resize(id + 1);
+
+	if (!pools[id])
+		pools[id] = std::make_unique<component_pool<T>>();
+
+	return *static_cast<component_pool<T>*>(pools[id].get());
+}
+
+template <typename T>
+T& registry::add(const entity e, T component)
+{
+	return get_pool<T>().add(e, std::move(component));
+}
+
+template <typename T>
+void registry::remove(const entity e)
+{
+	get_pool<T>().remove(e);
+}
+
+template <typename T>
+bool registry::has(const entity e)
+{
+	return get_pool<T>().has(e);
+}
+
+template <typename T>
+T* registry::get(const entity e)
+{
+	return get_pool<T>().get(e);
+}
+
+template <typename T, typename F>
+void registry::each(F&& f)
+{
+	auto& pool = get_pool<T>();
+	auto& components = pool.get_components();
+	const auto& entities = pool.get_entities();
+
+	for (unsigned int i = 0; i < pool.size(); i++)
+		f(entities[i], components[i]);
+}
+
+template <typename T, typename U, typename F>
+void registry::each(F&& f)
+{
+	auto& pool = get_pool<T>();
+	auto& other = get_pool<U>();
+	auto& components = pool.get_components();
+	const auto& entities = pool.get_entities();
+
+	for (unsigned int i = 0; i < pool.size(); i++)
+	{
+		U* u = other.get(entities[i]);
+		if (u)
+			f(entities[i], components[i], *u);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "rendering/color.h"
+
+// seeded synthetic layout for scaling tests: objects on a jittered grid, point lights scattered over it
+// and a palette of material colors. only data, the caller turns placements into entities and textures
+class stress_scene
+{
+public:
+	struct settings
+	{
+		unsigned int object_count{ 0 };
+		unsigned int light_count{ 0 };
+		unsigned int material_count{ 1 };
+		unsigned int seed{ 1 };
+		//distance between grid cells, the layout grows with sqrt of the object count
+		float spacing{ 3.0f };
+	};
+
+	struct object_placement
+	{
+		unsigned int prototype;
+		unsigned int material;
+		glm::vec3 position;
+		glm::vec3 rotation;
+		float scale;
+	};
+
+	struct light_placement
+	{
+		glm::vec3 position;
+		color diffuse;
+		float radius;
+	};
+
+	//same settings and prototype count always give the same layout
+	static stress_scene generate(const settings& s, unsigned int prototype_count);
+
+	const std::vector<object_placement>& get_objects() const;
+	const std::vector<light_placement>& get_lights() const;
+	const std::vector<color>& get_material_colors() const;
+
+	//half the side of the square the objects cover, centered on the origin
+	float get_half_extent() const;
+
+private:
+	std::vector<object_placement> objects;
+	std::vector<light_placement> lights;
+	std::vector<color> material_colors;
+	float half_extent{ 0 };
+};
@@ -1,7 +0,0 @@
-#pragma once
-#include "light.h"
-
-class directional_light: public light
-{
-	
-};
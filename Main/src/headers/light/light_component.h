@@ -0,0 +1,39 @@
+#pragma once
+#include <glm/vec3.hpp>
+
+#include "rendering/color.h"
+
+enum class light_type
+{
+	directional,
+	point,
+	spot
+};
+
+//plain light data, position comes from the entity's transform and its x scale is the range of point and spot lights
+struct light_component
+{
+	light_type type{ light_type::point };
+
+	color diffuse{ color::WHITE };
+	color specular{ color::WHITE };
+	float diff_intensity{ 1.0f };
+	float spec_intensity{ 1.0f };
+
+	//point lights
+	float linear{ 0.0f };
+	float quadratic{ 1.0f };
+	float radius{ 1.0f };
+
+	//spot lights, the direction is in world space
+	glm::vec3 spot_direction{ 0, 0, 1 };
+	float cutoff_angle{ 20.0f };
+	float inner_cutoff_angle{ 10.0f };
+
+	bool casts_shadow{ false };
+	bool is_active{ true };
+
+	void set_radius(float r);
+	//distance at which the light's contribution drops below one 8-bit step
+	float calculate_cutoff_radius() const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rendering/render_backend.h"
+
+// reads a capture written by recording_backend::write and submits it to another backend
+// the setup (everything before the first frame mark) runs once, the frames can then be played in any count
+// object names and uniform locations in the capture are mapped to the ones the target hands out
+class capture_player
+{
+public:
+	bool load(const std::string& path);
+
+	unsigned int get_frame_count() const;
+	std::size_t get_payload_size() const;
+
+	void play_setup(render_backend& backend);
+	void play_frame(unsigned int frame, render_backend& backend);
+
+private:
+	enum object_kind
+	{
+		texture_object,
+		buffer_object,
+		vertex_array_object,
+		framebuffer_object,
+		renderbuffer_object,
+		shader_object,
+		program_object,
+		fence_object,
+		object_kind_count
+	};
+
+	//words of the stream and the first payload byte the range reads from
+	struct range
+	{
+		std::size_t begin;
+		std::size_t end;
+		std::size_t payload;
+	};
+
+	std::vector<std::uint32_t> stream;
+	std::vector<std::uint8_t> payloads;
+	range setup{};
+	std::vector<range> frames;
+
+	std::unordered_map<unsigned int, unsigned int> names[object_kind_count];
+	//keyed by the captured program in the high word and the captured location in the low one
+	std::unordered_map<unsigned long long, int> locations;
+	unsigned int current_program{ 0 };
+	//scratch for set_uniform values and create_program shaders
+	std::vector<float> values;
+	std::vector<unsigned int> shaders;
+
+	void play(const range& commands, render_backend& backend);
+	void reset();
+
+	unsigned int get_name(object_kind kind, unsigned int captured) const;
+	void add_name(object_kind kind, unsigned int captured, unsigned int name);
+	void remove_name(object_kind kind, unsigned int captured);
+	int get_location(int captured) const;
+
+	//argument index of the payload byte count, -1 for commands without one
+	static int get_payload_argument(backend_command command);
+};
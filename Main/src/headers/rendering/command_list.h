@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/material_slot.h"
+#include "utils/string_id.h"
+
+class shader_program;
+
+enum class command_type : unsigned char
+{
+	bind_program,
+	set_constants,
+	bind_material,
+	draw
+};
+
+enum class constant_type : unsigned char
+{
+	int1,
+	float1,
+	vec2,
+	vec3,
+	vec4,
+	mat4
+};
+
+//everything needed to issue one draw, captured from a renderer at record time
+struct draw_call
+{
+	unsigned int vao{ 0 };
+	unsigned int element_count{ 0 };
+	unsigned int instance_count{ 1 };
+	bool is_indexed{ false };
+	bool should_cull_face{ true };
+	unsigned int cull_face{ 0 };
+	bool is_transparent{ false };
+};
+
+struct command
+{
+	command_type type{ command_type::draw };
+
+	//bind_program
+	const shader_program* program{ nullptr };
+
+	//set_constants, values live in the list's constant buffer at [offset, offset + count * size)
+	string_id uniform;
+	constant_type constant{ constant_type::float1 };
+	unsigned int offset{ 0 };
+	unsigned int count{ 0 };
+
+	//bind_material
+	const std::vector<material_slot>* material{ nullptr };
+
+	//draw
+	draw_call call;
+};
+
+//a run of commands that is sorted and replayed as one unit
+struct draw_packet
+{
+	std::uint64_t sort_key{ 0 };
+	unsigned int first_command{ 0 };
+	unsigned int command_count{ 0 };
+};
+
+//plain data, recording touches no gl state so any thread can fill its own list
+//the gl thread merges every list, sorts the packets and replays them with submit()
+class command_list
+{
+public:
+	//where a packet sits once every list is merged
+	struct packet_ref
+	{
+		std::uint64_t sort_key;
+		unsigned int list;
+		unsigned int packet;
+	};
+
+	void reset();
+
+	void begin_packet(std::uint64_t sort_key);
+	void bind_program(const shader_program* program);
+	void set_constants(const string_id& uniform, constant_type type, const float* values, unsigned int count = 1);
+	void set_int(const string_id& uniform, int value);
+	void set_vec2(const string_id& uniform, const glm::vec2& value);
+	void set_mat4(const string_id& uniform, const glm::mat4& value);
+	void bind_material(const std::vector<material_slot>* material);
+	void draw(const draw_call& call);
+	void end_packet();
+
+	const std::vector<command>& get_commands() const;
+	const std::vector<float>& get_constants() const;
+	const std::vector<draw_packet>& get_packets() const;
+
+	//transparent last and back to front, everything else grouped by program then material then front to back
+	static std::uint64_t make_sort_key(unsigned int program, unsigned int material, float depth, bool is_transparent);
+
+	//merges the packets of every list in sort order, stable so equal keys keep recording order
+	static void sort_packets(const std::vector<command_list>& lists, std::vector<packet_ref>& order);
+
+	//replays every packet of every list in sort order, gl thread only
+	static void submit(const std::vector<command_list>& lists);
+
+	//floats per value of a constant type
+	static unsigned int get_constant_size(constant_type type);
+
+private:
+	std::vector<command> commands;
+	std::vector<float> constants;
+	std::vector<draw_packet> packets;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+// picks the internal render scale that keeps gpu frame time under budget
+// samples are averaged over ADJUST_INTERVAL frames, the scale moves in SCALE_STEP increments
+// so the render target pool sees a handful of sizes instead of a new one every frame
+class dynamic_resolution
+{
+public:
+	static const unsigned int ADJUST_INTERVAL = 10;
+	static const float SCALE_STEP;
+	static const float MAX_CHANGE;
+
+	bool is_enabled{ true };
+	float budget_ms{ 12.0f };
+	float min_scale{ 0.5f };
+	float max_scale{ 1.0f };
+
+	//feed one gpu frame time per finished frame
+	void add_sample(float gpu_ms);
+
+	float get_scale() const;
+	float get_average_ms() const;
+	//share of the budget left unused, negative when over budget
+	float get_headroom() const;
+
+	unsigned int scale_dimension(unsigned int size) const;
+
+private:
+	float scale{ 1.0f };
+	float sample_sum{ 0 };
+	unsigned int sample_count{ 0 };
+	float average_ms{ 0 };
+
+	void adjust();
+};
@@ -3,6 +3,7 @@
 #include "rendering/texture.h"
 #include <iostream>
 #include <map>
+#include <memory>
 #include <vector>
 
 
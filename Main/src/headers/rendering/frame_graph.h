@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <map>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <glad/glad.h>
+
+#include "rendering/frame_buffer.h"
+#include "rendering/render_target_pool.h"
+#include "rendering/texture.h"
+#include "utils/frame_arena.h"
+#include "utils/string_id.h"
+
+typedef unsigned int frame_graph_resource;
+
+static const frame_graph_resource INVALID_RESOURCE = ~0u;
+
+class frame_graph;
+
+//handed to a pass while it declares what it touches
+class frame_graph_builder
+{
+public:
+	frame_graph_builder(frame_graph& graph, unsigned int pass);
+
+	frame_graph_resource create(const char* name, const render_target_desc& desc);
+	frame_graph_resource read(frame_graph_resource resource);
+	//attachment GL_NONE means the pass binds the target itself
+	frame_graph_resource write(frame_graph_resource resource, GLenum attachment = GL_NONE);
+	//the pass has effects outside the graph and is never culled
+	void set_side_effect();
+
+private:
+	frame_graph& graph;
+	unsigned int pass;
+};
+
+// passes declare their reads and writes every frame, compile() culls the ones nothing depends on,
+// gives each transient target a lifetime and lets targets with disjoint lifetimes share one pooled texture
+// rebuilding it does not touch the heap once the first frames have run: per pass data lives in the frame arena
+// and names are kept by pointer, use string literals
+class frame_graph
+{
+	friend class frame_graph_builder;
+
+public:
+	struct stats
+	{
+		unsigned int pass_count{ 0 };
+		unsigned int culled_count{ 0 };
+		unsigned int resource_count{ 0 };
+		unsigned int physical_count{ 0 };
+		unsigned int resolve_count{ 0 };
+		std::size_t transient_bytes{ 0 };
+	};
+
+	frame_graph() = default;
+	frame_graph(const frame_graph&) = delete;
+	frame_graph& operator=(const frame_graph&) = delete;
+
+	void reset();
+
+	frame_graph_resource import_texture(const char* name, texture& tex);
+	//the default framebuffer, passes writing it are what keeps the rest of the graph alive
+	frame_graph_resource import_backbuffer(const char* name, unsigned int width, unsigned int height);
+
+	//setup runs right away, execute is copied into the frame arena and never destroyed so it has to capture by reference
+	template<typename Setup, typename Execute>
+	void add_pass(const char* name, const Setup& setup, const Execute& execute);
+
+	void compile();
+	void execute();
+
+	//only valid while the graph executes, multisampled targets come back resolved
+	texture* get_texture(frame_graph_resource resource) const;
+	const render_target_desc& get_desc(frame_graph_resource resource) const;
+	frame_graph_resource find(const string_id& name) const;
+
+	void bind_target(std::initializer_list<frame_graph_resource> colors, frame_graph_resource depth = INVALID_RESOURCE);
+	void blit(frame_graph_resource source, frame_graph_resource destination, GLbitfield mask);
+
+	const stats& get_stats() const;
+	unsigned int get_pass_count() const;
+	const std::string& get_pass_name(unsigned int pass) const;
+	bool is_pass_culled(unsigned int pass) const;
+
+	//the output size changed, nothing pooled at the old size is coming back
+	void release_unused_targets();
+	//frees every pooled texture and framebuffer
+	void release();
+
+private:
+	struct attachment
+	{
+		frame_graph_resource resource;
+		GLenum point;
+	};
+
+	struct resolve
+	{
+		frame_graph_resource source;
+		frame_graph_resource destination;
+	};
+
+	typedef void (*execute_thunk)(const void* callback, frame_graph& graph);
+
+	struct pass
+	{
+		string_id name;
+		execute_thunk execute{ nullptr };
+		const void* callback{ nullptr };
+		frame_vector<frame_graph_resource> reads;
+		frame_vector<frame_graph_resource> writes;
+		frame_vector<attachment> attachments;
+		frame_vector<resolve> resolves;
+		bool has_side_effect{ false };
+		bool is_culled{ false };
+	};
+
+	//orders framebuffer keys, lets a frame_vector key look up the stored ones without copying it
+	struct key_less
+	{
+		typedef void is_transparent;
+
+		template<typename A, typename B>
+		bool operator()(const A& a, const B& b) const
+		{
+			return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+		}
+	};
+
+	struct resource
+	{
+		string_id name;
+		render_target_desc desc;
+		texture* imported{ nullptr };
+		bool is_backbuffer{ false };
+		frame_graph_resource resolved{ INVALID_RESOURCE };
+
+		//live pass range and backing texture, set by compile
+		int first_use{ -1 };
+		int last_use{ -1 };
+		texture* physical{ nullptr };
+	};
+
+	std::vector<pass> passes;
+	std::vector<resource> resources;
+	render_target_pool targets;
+
+	//keyed by attachment point and texture id pairs
+	std::map<std::vector<unsigned int>, frame_buffer, key_less> framebuffers;
+	//interned names by literal and of the resolved copies, both only grow while new names show up
+	std::map<const char*, string_id> names;
+	std::map<string_id, string_id> resolved_names;
+	const frame_buffer* current_target{ nullptr };
+	bool is_compiled{ false };
+	stats frame_stats;
+
+	string_id get_name(const char* name);
+	unsigned int begin_pass(const char* name, execute_thunk execute, const void* callback);
+	frame_graph_resource add_resource(const string_id& name);
+	void cull_passes();
+	void add_resolves();
+	void compute_lifetimes();
+	void allocate();
+	void bind_pass_target(const pass& p);
+	void bind_framebuffer(const frame_vector<attachment>& attachments);
+	const frame_buffer& get_framebuffer(const frame_vector<attachment>& attachments);
+	texture* get_physical(frame_graph_resource resource) const;
+	GLenum get_depth_point(frame_graph_resource resource) const;
+	void delete_framebuffers(const std::vector<unsigned int>& texture_ids);
+	void set_viewport(frame_graph_resource resource) const;
+};
+
+template<typename Setup, typename Execute>
+void frame_graph::add_pass(const char* name, const Setup& setup, const Execute& execute)
+{
+	static_assert(std::is_trivially_destructible<Execute>::value, "the arena never runs destructors, capture by reference");
+
+	void* const storage = frame_arena::get().allocate(sizeof(Execute), alignof(Execute));
+	const Execute* const callback = new (storage) Execute(execute);
+
+	frame_graph_builder builder(*this, begin_pass(name, [](const void* c, frame_graph& graph)
+	{
+		(*static_cast<const Execute*>(c))(graph);
+	}, callback));
+	setup(builder);
+}
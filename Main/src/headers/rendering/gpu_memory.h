@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+enum class gpu_memory_category : unsigned char
+{
+	//loaded from disk
+	texture,
+	//rendered into, frame graph targets, shadow maps and the ibl maps
+	render_target,
+	renderbuffer,
+	vertex_buffer,
+	index_buffer,
+	instance_buffer,
+	uniform_buffer,
+	storage_buffer,
+	count
+};
+
+//gl namespaces a name is unique in, texture names cover both textures and render targets
+enum class gpu_name_space : unsigned char
+{
+	texture,
+	renderbuffer,
+	buffer
+};
+
+struct gpu_allocation
+{
+	gpu_memory_category category;
+	//gl name, textures and render targets share one namespace and the buffers another
+	unsigned int name;
+	std::size_t bytes;
+	std::string owner;
+	unsigned int width;
+	unsigned int height;
+	GLenum internal_format;
+};
+
+// estimated size of every live gl object by category and owner, main thread only like the rest of the gl calls
+// the wrappers report what they create and delete, the size is what the object needs at its format,
+// drivers add padding and alignment on top so the real figure is somewhat higher
+class gpu_memory
+{
+public:
+	static void track(gpu_memory_category category, unsigned int name, std::size_t bytes, const std::string& owner);
+	static void track_texture(gpu_memory_category category, unsigned int name, const std::string& owner, GLenum internal_format,
+		unsigned int width, unsigned int height, unsigned int layers, unsigned int samples, bool has_mipmaps);
+	//by gl name, the entry goes whatever category it was tracked under, so a render target is
+	//untracked as a texture and an index buffer as any buffer; the category only picks the namespace
+	static void untrack(gpu_memory_category category, unsigned int name);
+	static void untrack(gpu_name_space name_space, unsigned int name);
+	//keeps the size, for objects only the caller knows a name for
+	static void set_owner(gpu_memory_category category, unsigned int name, const std::string& owner);
+	//empty when the object is not tracked
+	static std::string get_owner(gpu_memory_category category, unsigned int name);
+
+	static std::size_t get_total();
+	static std::size_t get_total(gpu_memory_category category);
+	static unsigned int get_count(gpu_memory_category category);
+	//biggest first, any category when filter is count
+	static std::vector<gpu_allocation> get_largest(unsigned int count, gpu_memory_category filter = gpu_memory_category::count);
+
+	//0 turns the warning off
+	static void set_budget(std::size_t bytes);
+	static std::size_t get_budget();
+	static bool is_over_budget();
+	//prints a warning with the largest allocations once each time the total crosses the budget, call once per frame
+	static void check_budget();
+
+	static bool write_json(const std::string& path);
+
+	static std::size_t get_bytes_per_pixel(GLenum internal_format);
+	static std::size_t estimate_texture_size(GLenum internal_format, unsigned int width, unsigned int height,
+		unsigned int layers, unsigned int samples, bool has_mipmaps);
+	static const char* category_to_string(gpu_memory_category category);
+	static gpu_name_space get_name_space(gpu_memory_category category);
+
+private:
+	static std::unordered_map<unsigned long long, gpu_allocation> allocations;
+	static std::size_t totals[static_cast<unsigned int>(gpu_memory_category::count)];
+	static unsigned int counts[static_cast<unsigned int>(gpu_memory_category::count)];
+	static std::size_t budget;
+	static bool has_warned;
+
+	//allocations are keyed by namespace and name, never by category
+	static unsigned long long get_key(gpu_name_space name_space, unsigned int name);
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "data/mesh.h"
+#include "rendering/gpu_resource.h"
+
+//owns the vertex and index buffers of a single mesh on the gpu
+//renderers only create their own vertex array objects that reference these buffers
+class gpu_mesh
+{
+public:
+	gpu_mesh();
+	explicit gpu_mesh(const mesh& m);
+
+	//returns the buffers already uploaded for the mesh geometry, uploading them on first use
+	//the cpu copy of the geometry is released afterwards unless the mesh asked for cpu access
+	static std::shared_ptr<gpu_mesh> acquire(const mesh& m);
+
+	void bind_vertex_buffer() const;
+	void bind_index_buffer() const;
+	//drops the buffers, they are deleted once the frames using them are done on the gpu
+	void deallocate();
+
+	unsigned int get_vbo() const;
+	unsigned int get_ebo() const;
+	unsigned int get_vertex_count() const;
+	unsigned int get_index_count() const;
+	bool get_is_indexed() const;
+
+private:
+	unsigned int vbo{ 0 };
+	unsigned int ebo{ 0 };
+	unsigned int vertex_count{ 0 };
+	unsigned int index_count{ 0 };
+	bool is_indexed{ false };
+	gpu_resource vertex_buffer;
+	gpu_resource index_buffer;
+
+	void upload(const mesh& m);
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/string_id.h"
+
+// per scope gpu time from GL_TIME_ELAPSED queries, read back LATENCY frames later so the cpu never waits
+// only one elapsed query can run at a time, so opening a scope inside another pauses the outer one:
+// every scope reports its exclusive time and a pass minus its children is what the pass itself cost
+class gpu_profiler
+{
+public:
+	static const unsigned int LATENCY = 3;
+	static const unsigned int HISTORY = 240;
+
+	struct scope_stats
+	{
+		std::string name;
+		unsigned int depth;
+		float last_ms;
+		float min_ms;
+		float avg_ms;
+		float p99_ms;
+	};
+
+	static gpu_profiler& get();
+
+	bool is_enabled{ true };
+
+	void begin_frame();
+	void end_frame();
+
+	void push(const string_id& name);
+	//kept by pointer, use string literals
+	void push(const char* name);
+	void pop();
+
+	void release();
+
+	//rolling stats over the frames kept in history, in first seen order
+	std::vector<scope_stats> get_stats() const;
+	float get_frame_ms() const;
+
+	//the number the next begin_frame records under
+	unsigned long long get_frame_index() const;
+	//exclusive ms per scope for one frame, false once it has left history or was never read back
+	bool get_frame_timings(unsigned long long frame_index, std::vector<std::pair<std::string, float>>& timings) const;
+
+	//one row per frame in history, one column per scope, blank where a scope did not run
+	bool export_csv(const std::string& path) const;
+
+	gpu_profiler(const gpu_profiler&) = delete;
+	gpu_profiler& operator=(const gpu_profiler&) = delete;
+
+private:
+	struct segment
+	{
+		unsigned int scope;
+		unsigned int query;
+	};
+
+	struct frame_slot
+	{
+		std::vector<unsigned int> queries;
+		std::vector<segment> segments;
+		unsigned long long frame{ 0 };
+		bool is_pending{ false };
+	};
+
+	struct frame_record
+	{
+		unsigned long long frame;
+		//exclusive ms per scope, negative when the scope did not run
+		std::vector<float> scope_ms;
+	};
+
+	struct scope_info
+	{
+		string_id name;
+		unsigned int depth;
+	};
+
+	gpu_profiler() = default;
+
+	frame_slot slots[LATENCY];
+	unsigned int current{ 0 };
+	unsigned long long frame{ 0 };
+	bool is_recording{ false };
+
+	std::vector<scope_info> scopes;
+	std::map<string_id, unsigned int> scope_lookup;
+	std::map<const char*, unsigned int> literal_lookup;
+	std::vector<unsigned int> stack;
+
+	//a ring of HISTORY records allocated on the first read back, only the first history_count hold frames
+	std::vector<frame_record> history;
+	unsigned int history_count{ 0 };
+	unsigned int history_next{ 0 };
+
+	unsigned int get_scope(const string_id& name);
+	void push_scope(unsigned int scope);
+	void start_segment(unsigned int scope);
+	void stop_segment();
+	void collect(frame_slot& slot);
+};
+
+//times everything until the end of the enclosing block
+class gpu_profile_scope
+{
+public:
+	explicit gpu_profile_scope(const char* name);
+	~gpu_profile_scope();
+
+	gpu_profile_scope(const gpu_profile_scope&) = delete;
+	gpu_profile_scope& operator=(const gpu_profile_scope&) = delete;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <deque>
+#include <vector>
+
+#include "rendering/gpu_memory.h"
+
+enum class gpu_resource_type : unsigned char
+{
+	texture,
+	buffer,
+	renderbuffer,
+	vertex_array,
+	program,
+	count
+};
+
+//slot and the generation it had when handed out, a handle whose slot was reused since resolves to nothing
+struct gpu_handle
+{
+	unsigned int index{ 0 };
+	unsigned int generation{ 0 };
+};
+
+// refcounted table of every gl object the wrappers own, main thread only like the rest of the gl calls
+// an object whose last reference goes is deleted once the fence of the frame it went in has signaled,
+// so nothing already submitted can still be using it and the delete never makes the driver wait
+class gpu_resources
+{
+public:
+	static gpu_resources& get();
+
+	//category is what gpu_memory tracks the object under, count for objects it does not account
+	gpu_handle create(gpu_resource_type type, unsigned int name, gpu_memory_category category);
+	void add_ref(gpu_handle handle);
+	void release(gpu_handle handle);
+
+	//0 for a stale handle
+	unsigned int get_name(gpu_handle handle) const;
+	bool is_valid(gpu_handle handle) const;
+
+	//fences this frame's releases and deletes everything whose fence signaled, call once per frame after the swap
+	void end_frame();
+	//deletes everything queued right away, from then on releases only free their slot
+	//since the context and what is left in it are about to go together
+	void shutdown();
+
+	unsigned int get_live_count() const;
+	//released but still waiting on a fence
+	unsigned int get_pending_count() const;
+
+	gpu_resources(const gpu_resources&) = delete;
+	gpu_resources& operator=(const gpu_resources&) = delete;
+
+private:
+	struct slot
+	{
+		unsigned int name;
+		unsigned int generation;
+		unsigned int references;
+		gpu_resource_type type;
+		gpu_memory_category category;
+	};
+
+	struct pending_object
+	{
+		gpu_resource_type type;
+		unsigned int name;
+		gpu_memory_category category;
+	};
+
+	struct retired_frame
+	{
+		unsigned int fence;
+		std::vector<pending_object> objects;
+	};
+
+	//slot 0 is never handed out so a default handle is always stale
+	std::vector<slot> slots{ slot{ 0, 0, 0, gpu_resource_type::count, gpu_memory_category::count } };
+	std::vector<unsigned int> free_slots;
+	std::vector<pending_object> released;
+	std::deque<retired_frame> in_flight;
+	unsigned int live_count{ 0 };
+	bool is_shut_down{ false };
+
+	gpu_resources() = default;
+
+	const slot* find(gpu_handle handle) const;
+	static void destroy(const pending_object& object);
+};
+
+// one reference to a gl object in gpu_resources, copies share the object and the last one to go queues its delete
+class gpu_resource
+{
+public:
+	gpu_resource() = default;
+	//takes over a freshly created object, category is where gpu_memory accounts it and it is untracked from there on delete
+	gpu_resource(gpu_resource_type type, unsigned int name, gpu_memory_category category = gpu_memory_category::count);
+	gpu_resource(const gpu_resource& other);
+	gpu_resource(gpu_resource&& other) noexcept;
+	gpu_resource& operator=(const gpu_resource& other);
+	gpu_resource& operator=(gpu_resource&& other) noexcept;
+	~gpu_resource();
+
+	unsigned int get_name() const;
+	gpu_handle get_handle() const;
+	//drops this reference, the object stays for as long as a copy holds it
+	void reset();
+
+private:
+	gpu_handle handle;
+};
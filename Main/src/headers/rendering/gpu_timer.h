@@ -0,0 +1,33 @@
+#pragma once
+
+// gpu time between begin() and end(), read back LATENCY frames later so the cpu never waits on the query
+// uses timestamp queries so it can wrap code that runs its own GL_TIME_ELAPSED queries
+class gpu_timer
+{
+public:
+	static const unsigned int LATENCY = 3;
+
+	gpu_timer() = default;
+	gpu_timer(const gpu_timer&) = delete;
+	gpu_timer& operator=(const gpu_timer&) = delete;
+
+	void init();
+	void release();
+
+	void begin();
+	void end();
+
+	//true once per finished measurement, the newest one lands in ms
+	bool take_result(float& ms);
+	float get_last_ms() const;
+
+private:
+	unsigned int queries[LATENCY][2]{};
+	bool is_pending[LATENCY]{};
+	unsigned int current{ 0 };
+	bool is_skipping{ false };
+	bool has_new_result{ false };
+	float last_ms{ 0 };
+
+	void collect();
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//pixels decoded on the cpu, waiting to be uploaded
+struct decoded_image
+{
+	void* data{ nullptr };
+	int width{ 0 };
+	int height{ 0 };
+	int channels{ 0 };
+	bool is_hdr{ false };
+};
+
+//decodes image files off the main thread so texture creation only has to upload
+class image_cache
+{
+public:
+	//decodes every path as a job, hdr paths are decoded to floats
+	static void prefetch(const std::vector<std::string>& paths, const std::vector<std::string>& hdr_paths = {});
+
+	//hands over the prefetched pixels or decodes them right away, free with release()
+	static decoded_image acquire(const std::string& path, bool is_hdr);
+	static void release(decoded_image& image);
+
+private:
+	static std::mutex mutex;
+	static std::unordered_map<std::string, decoded_image> images;
+
+	static decoded_image decode(const std::string& path, bool is_hdr);
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/gpu_resource.h"
+
+class shader_program;
+
+//one point or spot light as the shaders read it from the light buffer, std430 so every member is a whole vec4
+struct cluster_light
+{
+	//world position, the distance the light stops at in w
+	glm::vec4 position_range;
+	//colors are premultiplied by their intensity, linear and quadratic attenuation ride along in w
+	glm::vec4 diffuse_linear;
+	glm::vec4 specular_quadratic;
+	//the way a spot light points and the cos of its outer cutoff, point lights are (0, 0, 0, -1)
+	glm::vec4 direction_cos_outer;
+	//the cone fades as dot(light to fragment, direction) * x + y, sin of the outer cutoff in z for culling
+	//point lights are (0, 1, 0, 0) so they never fade
+	glm::vec4 cone;
+};
+
+//where a cluster's lights start in the index list and how many there are
+struct cluster_range
+{
+	unsigned int offset;
+	unsigned int count;
+};
+
+struct light_cluster_stats
+{
+	unsigned int light_count{ 0 };
+	unsigned int index_count{ 0 };
+	unsigned int max_per_cluster{ 0 };
+	unsigned int empty_clusters{ 0 };
+	//references that did not fit a cluster or the index list and were left out
+	unsigned int dropped{ 0 };
+};
+
+// splits the view frustum into froxels, screen tiles times exponentially growing depth slices, and lists
+// the point and spot lights reaching each one so a fragment only shades the lights its froxel touches
+// the lists are built on the cpu a slice per job with sse, or by a compute shader, and read from storage buffers
+class light_clusters
+{
+public:
+	static constexpr unsigned int TILES_X = 16;
+	static constexpr unsigned int TILES_Y = 9;
+	static constexpr unsigned int SLICES = 24;
+	static constexpr unsigned int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+	static constexpr unsigned int MAX_LIGHTS = 4096;
+	static constexpr unsigned int MAX_LIGHTS_PER_CLUSTER = 256;
+	//size of the index list, 64 lights per cluster on average before references get dropped
+	static constexpr unsigned int INDEX_CAPACITY = CLUSTER_COUNT * 64;
+
+	//storage buffer bindings, 1 is the VP uniform block
+	static constexpr unsigned int LIGHT_BINDING = 2;
+	static constexpr unsigned int CLUSTER_BINDING = 3;
+	static constexpr unsigned int INDEX_BINDING = 4;
+	static constexpr unsigned int COUNTER_BINDING = 5;
+
+	//builds the lists on the gpu when a compute program was set, the cpu lists and stats then stay empty
+	bool is_using_compute{ false };
+
+	//creates the buffers, needs the context
+	void init();
+	void set_compute_program(const shader_program* program);
+	bool has_compute_program() const;
+
+	//lights past MAX_LIGHTS are ignored
+	void begin_frame();
+	void add_point_light(const glm::vec3& position, float range, const glm::vec3& diffuse, const glm::vec3& specular, float linear, float quadratic);
+	//cutoffs are the cos of the half angles, the direction is normalized here
+	void add_spot_light(const glm::vec3& position, float range, const glm::vec3& direction, float cos_outer, float cos_inner,
+		const glm::vec3& diffuse, const glm::vec3& specular, float linear, float quadratic);
+
+	//assigns this frame's lights to the froxels of a perspective camera and uploads everything
+	void build(const glm::mat4& view, float fov, float aspect, float near_plane, float far_plane);
+	//only the light list, for passes that cull it themselves
+	void upload_lights();
+	//buffers and the uniforms that find a fragment's cluster, width and height are the target being drawn
+	void bind(const shader_program& program, unsigned int width, unsigned int height) const;
+	void bind_lights() const;
+
+	unsigned int get_light_count() const;
+	const light_cluster_stats& get_stats() const;
+
+private:
+	//view space boxes with depth positive into the screen, one float per cluster in each array so sse reads four at once
+	struct cluster_bounds
+	{
+		std::vector<float> min_x, min_y, min_z;
+		std::vector<float> max_x, max_y, max_z;
+		//bounding spheres of the boxes for the spot light cone test
+		std::vector<float> center_x, center_y, center_z, radius;
+	};
+
+	//view space copies of the lights in the same layout, depth positive like the bounds
+	struct view_lights
+	{
+		std::vector<float> x, y, depth, range;
+		//cone axis and outer cutoff, point lights have no axis and a cos of -1 so the cone test always passes
+		std::vector<float> dir_x, dir_y, dir_depth, cos_outer, sin_outer;
+	};
+
+	std::vector<cluster_light> lights;
+	view_lights view_space;
+	cluster_bounds bounds;
+	//MAX_LIGHTS_PER_CLUSTER slots per cluster, filled in parallel and compacted into indices afterwards
+	std::vector<unsigned int> scratch;
+	std::vector<unsigned int> scratch_counts;
+	std::vector<cluster_range> ranges;
+	std::vector<unsigned int> indices;
+	light_cluster_stats stats;
+
+	float bounds_fov{ 0 };
+	float bounds_aspect{ 0 };
+	float bounds_near{ 0 };
+	float bounds_far{ 0 };
+	float slice_near{ 0.1f };
+	float slice_far{ 100.0f };
+
+	const shader_program* compute_program{ nullptr };
+	unsigned int light_buffer{ 0 };
+	unsigned int cluster_buffer{ 0 };
+	unsigned int index_buffer{ 0 };
+	unsigned int counter_buffer{ 0 };
+	gpu_resource light_resource;
+	gpu_resource cluster_resource;
+	gpu_resource index_resource;
+	gpu_resource counter_resource;
+
+	void update_bounds(float fov, float aspect, float near_plane, float far_plane);
+	void assign_slice(unsigned int slice);
+	void compact();
+	//orphans the whole buffer and writes the used part so the frame still reading the old contents never stalls it
+	static void upload(unsigned int buffer, unsigned int capacity, const void* data, unsigned int size);
+	void dispatch(const glm::mat4& view, float fov, float aspect) const;
+
+	//slice = log(depth) * scale + bias
+	float get_slice_scale() const;
+	float get_slice_bias() const;
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "utils/string_id.h"
+
+//one texture of a material, resolved once so draws don't rebuild sampler names
+struct material_slot
+{
+	string_id uniform;
+	unsigned int target{ 0 };
+	unsigned int texture_id{ 0 };
+};
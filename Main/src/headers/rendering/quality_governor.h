@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "rendering/gpu_timer.h"
+
+//groups of passes the governor times on their own
+enum class quality_feature
+{
+	shadows,
+	bloom,
+	shading,
+	count
+};
+
+//one rung of the quality ladder, index 0 is full quality
+struct quality_tier
+{
+	std::string name;
+	unsigned int bloom_blur_passes;
+	unsigned int shadow_resolution;
+	int pcf_half_kernel;
+	bool allow_parallax;
+	bool allow_ibl;
+};
+
+// steps down the tier ladder while the gpu is over budget and back up once there is headroom again
+// decisions are made once per WINDOW frames; raising needs RAISE_WINDOWS quiet windows in a row and
+// a measured (or estimated from feature costs) saving that still fits the budget, so it doesn't flap
+class quality_governor
+{
+public:
+	static const unsigned int WINDOW = 30;
+	static const unsigned int RAISE_WINDOWS = 4;
+
+	bool is_enabled{ true };
+	float budget_ms{ 12.0f };
+	//raise only while the frame sits below this share of the budget
+	float raise_share{ 0.7f };
+
+	quality_governor();
+	quality_governor(const quality_governor&) = delete;
+	quality_governor& operator=(const quality_governor&) = delete;
+
+	void init();
+	void release();
+
+	void begin(quality_feature feature);
+	void end(quality_feature feature);
+
+	//feed one gpu frame time per finished frame, can_lower is false while something cheaper can still absorb the overrun
+	void add_sample(float gpu_ms, bool can_lower);
+	void set_tier(unsigned int index);
+
+	const quality_tier& get_tier() const;
+	unsigned int get_tier_index() const;
+	unsigned int get_tier_count() const;
+	const quality_tier& get_tier(unsigned int index) const;
+	float get_average_ms() const;
+	float get_feature_ms(quality_feature feature) const;
+
+	static const char* feature_to_string(quality_feature feature);
+
+private:
+	static const unsigned int FEATURE_COUNT = static_cast<unsigned int>(quality_feature::count);
+
+	std::vector<quality_tier> tiers;
+	//measured drop in frame time when entering each tier from the one above, 0 until seen
+	std::vector<float> tier_savings;
+	unsigned int tier{ 0 };
+
+	gpu_timer feature_timers[FEATURE_COUNT];
+	float feature_sum[FEATURE_COUNT]{};
+	unsigned int feature_samples[FEATURE_COUNT]{};
+	float feature_ms[FEATURE_COUNT]{};
+
+	float sample_sum{ 0 };
+	unsigned int sample_count{ 0 };
+	float average_ms{ 0 };
+	unsigned int quiet_windows{ 0 };
+	unsigned int settle_frames{ 0 };
+
+	//frame time just before the last step down, used to measure what that step saved
+	float ms_before_lowering{ 0 };
+	bool is_measuring_saving{ false };
+
+	void collect_features();
+	void evaluate(bool can_lower);
+	float estimate_saving(unsigned int from, unsigned int to) const;
+	void change_tier(unsigned int index, const char* reason);
+};
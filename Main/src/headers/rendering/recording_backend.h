@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rendering/render_backend.h"
+
+// sits in front of another backend and appends every call to a word stream before forwarding it
+// an entry is a header word (command in the low byte, argument word count above it) and its arguments;
+// floats are stored bitwise, strings as their length and then their bytes padded to whole words
+// pixel and buffer data is recorded as its byte count, the bytes themselves go to a separate payload block
+// in order when is_capturing_payloads is set; a count of 0 means there was no data or it was not captured
+class recording_backend final : public render_backend
+{
+public:
+	explicit recording_backend(render_backend& target);
+
+	//"GLCS" at the start of a written capture, the version goes up whenever the entries change
+	static const std::uint32_t file_magic = 0x53434c47;
+	static const std::uint32_t file_version = 4;
+
+	bool is_recording{ true };
+	//off for the single frame capture where only the calls matter, on for a capture that gets replayed
+	bool is_capturing_payloads{ false };
+
+	void set_target(render_backend& target);
+
+	const std::vector<std::uint32_t>& get_stream() const;
+	const std::vector<std::uint8_t>& get_payloads() const;
+	unsigned int get_mark_count() const;
+	unsigned int get_command_count() const;
+	unsigned int get_count(backend_command command) const;
+	void clear_stream();
+	//the first mark ends the setup the player runs once, every later one ends a frame
+	void mark_frame();
+	//header words, the stream and then the payload bytes, read back by capture_player
+	bool write(const std::string& path) const;
+
+	const char* get_name() const override;
+
+	void use_program(unsigned int program) override;
+	void bind_vertex_array(unsigned int vao) override;
+	void bind_buffer(GLenum target, unsigned int buffer) override;
+	void active_texture(GLenum unit) override;
+	void bind_texture(GLenum target, unsigned int texture) override;
+	void bind_image_texture(unsigned int unit, unsigned int texture, GLenum access, GLenum format) override;
+	void bind_framebuffer(GLenum target, unsigned int framebuffer) override;
+	void set_capability(GLenum capability, bool is_enabled) override;
+	void cull_face(GLenum face) override;
+	void depth_mask(bool is_writing) override;
+	void stencil_mask(unsigned int mask) override;
+	void stencil_func(GLenum face, GLenum func, int ref, unsigned int mask) override;
+	void stencil_op(GLenum face, GLenum s_fail, GLenum dp_fail, GLenum dp_pass) override;
+	void draw_buffers(unsigned int count, const GLenum* attachments) override;
+	void read_buffer(GLenum mode) override;
+	void clear(GLbitfield mask) override;
+	void viewport(int x, int y, unsigned int width, unsigned int height) override;
+	void blend_func(GLenum source, GLenum destination) override;
+	void depth_func(GLenum func) override;
+	void polygon_mode(GLenum mode) override;
+	void blit_framebuffer(unsigned int source_width, unsigned int source_height, unsigned int destination_width, unsigned int destination_height, GLbitfield mask, GLenum filter) override;
+	int get_uniform_location(unsigned int program, const char* name) override;
+	void set_uniform(int location, constant_type type, unsigned int count, const float* values) override;
+	void set_uniform_int(int location, int value) override;
+	void draw(bool is_indexed, unsigned int element_count, unsigned int instance_count) override;
+	void dispatch_compute(unsigned int x, unsigned int y, unsigned int z) override;
+	void memory_barrier(GLbitfield barriers) override;
+	unsigned int create_texture() override;
+	void delete_texture(unsigned int texture) override;
+	void tex_image_2d(GLenum target, int level, GLenum internal_format, unsigned int width, unsigned int height, GLenum format, GLenum data_format, const void* data) override;
+	void tex_image_2d_multisample(unsigned int samples, GLenum internal_format, unsigned int width, unsigned int height) override;
+	void tex_sub_image_2d(GLenum target, unsigned int width, unsigned int height, GLenum format, GLenum data_format, const void* data) override;
+	void tex_parameter(GLenum target, GLenum name, int value) override;
+	void generate_mipmap(GLenum target) override;
+	unsigned int create_vertex_array() override;
+	void delete_vertex_array(unsigned int vao) override;
+	void vertex_attribute(unsigned int index, int size, unsigned int stride, unsigned int offset) override;
+	void vertex_attribute_divisor(unsigned int index, unsigned int divisor) override;
+	unsigned int create_buffer() override;
+	void delete_buffer(unsigned int buffer) override;
+	void buffer_data(GLenum target, unsigned int size, const void* data, GLenum usage) override;
+	void buffer_sub_data(GLenum target, unsigned int offset, unsigned int size, const void* data) override;
+	void bind_buffer_base(GLenum target, unsigned int index, unsigned int buffer) override;
+	unsigned int create_renderbuffer() override;
+	void delete_renderbuffer(unsigned int renderbuffer) override;
+	void bind_renderbuffer(unsigned int renderbuffer) override;
+	void renderbuffer_storage(GLenum internal_format, unsigned int width, unsigned int height) override;
+	unsigned int create_framebuffer() override;
+	void delete_framebuffer(unsigned int framebuffer) override;
+	void framebuffer_texture_2d(GLenum attachment, GLenum target, unsigned int texture, int level) override;
+	void framebuffer_texture(GLenum attachment, unsigned int texture, int level) override;
+	void framebuffer_renderbuffer(GLenum attachment, unsigned int renderbuffer) override;
+	GLenum check_framebuffer_status() override;
+	unsigned int create_shader(GLenum type, const char* source, std::string& error) override;
+	void delete_shader(unsigned int shader) override;
+	unsigned int create_program(const unsigned int* shaders, unsigned int count, std::string& error) override;
+	void delete_program(unsigned int program) override;
+	void uniform_block_binding(unsigned int program, const char* block, unsigned int binding) override;
+	unsigned int create_fence() override;
+	bool is_fence_signaled(unsigned int fence) override;
+	void delete_fence(unsigned int fence) override;
+
+private:
+	render_backend* next;
+	std::vector<std::uint32_t> stream;
+	std::vector<std::uint8_t> payloads;
+	unsigned int mark_count{ 0 };
+	unsigned int counts[static_cast<unsigned int>(backend_command::count)]{};
+	unsigned int command_count{ 0 };
+	std::size_t header{ 0 };
+
+	void begin(backend_command command);
+	void push(std::uint32_t word);
+	void push_float(float value);
+	void push_string(const char* value);
+	void push_payload(const void* data, std::size_t size);
+	void end();
+
+	//bytes glTexImage2D reads for the upload with the default unpack alignment of 4
+	static std::size_t get_image_size(unsigned int width, unsigned int height, GLenum format, GLenum data_format);
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <string>
+#include <glad/glad.h>
+
+#include "rendering/command_list.h"
+
+//one entry per backend call, used by the null backend's counts and the recorder's stream
+enum class backend_command : unsigned char
+{
+	use_program,
+	bind_vertex_array,
+	bind_buffer,
+	active_texture,
+	bind_texture,
+	bind_image_texture,
+	bind_framebuffer,
+	set_capability,
+	cull_face,
+	depth_mask,
+	stencil_mask,
+	stencil_func,
+	stencil_op,
+	draw_buffers,
+	read_buffer,
+	clear,
+	viewport,
+	blend_func,
+	depth_func,
+	polygon_mode,
+	blit_framebuffer,
+	get_uniform_location,
+	set_uniform,
+	set_uniform_int,
+	draw,
+	dispatch_compute,
+	memory_barrier,
+	create_texture,
+	delete_texture,
+	tex_image_2d,
+	tex_image_2d_multisample,
+	tex_sub_image_2d,
+	tex_parameter,
+	generate_mipmap,
+	create_vertex_array,
+	delete_vertex_array,
+	vertex_attribute,
+	vertex_attribute_divisor,
+	create_buffer,
+	delete_buffer,
+	buffer_data,
+	buffer_sub_data,
+	bind_buffer_base,
+	create_renderbuffer,
+	delete_renderbuffer,
+	bind_renderbuffer,
+	renderbuffer_storage,
+	create_framebuffer,
+	delete_framebuffer,
+	framebuffer_texture_2d,
+	framebuffer_texture,
+	framebuffer_renderbuffer,
+	check_framebuffer_status,
+	create_shader,
+	delete_shader,
+	create_program,
+	delete_program,
+	uniform_block_binding,
+	create_fence,
+	is_fence_signaled,
+	delete_fence,
+	//not a gl call, the recorder's marker between frames
+	end_frame,
+	count
+};
+
+// every gl call the engine makes outside of the imgui backend and the timer queries goes through here
+// gl_backend is what normally sits behind it; null_backend swaps in to time the engine without a driver
+// and recording_backend sits in front of another backend to capture what a frame asks for
+class render_backend
+{
+public:
+	virtual ~render_backend() = default;
+
+	//the backend every wrapper submits to, gl unless something else was set
+	static render_backend& get();
+	//nullptr goes back to gl, the caller keeps ownership and has to outlive its use
+	static void set(render_backend* backend);
+
+	static const char* command_to_string(backend_command command);
+
+	virtual const char* get_name() const = 0;
+
+#pragma region State
+	virtual void use_program(unsigned int program) = 0;
+	virtual void bind_vertex_array(unsigned int vao) = 0;
+	virtual void bind_buffer(GLenum target, unsigned int buffer) = 0;
+	virtual void active_texture(GLenum unit) = 0;
+	virtual void bind_texture(GLenum target, unsigned int texture) = 0;
+	//level 0 of a 2d texture for image loads and stores from a compute shader
+	virtual void bind_image_texture(unsigned int unit, unsigned int texture, GLenum access, GLenum format) = 0;
+	virtual void bind_framebuffer(GLenum target, unsigned int framebuffer) = 0;
+	virtual void set_capability(GLenum capability, bool is_enabled) = 0;
+	virtual void cull_face(GLenum face) = 0;
+	virtual void depth_mask(bool is_writing) = 0;
+	virtual void stencil_mask(unsigned int mask) = 0;
+	virtual void stencil_func(GLenum face, GLenum func, int ref, unsigned int mask) = 0;
+	virtual void stencil_op(GLenum face, GLenum s_fail, GLenum dp_fail, GLenum dp_pass) = 0;
+	virtual void draw_buffers(unsigned int count, const GLenum* attachments) = 0;
+	virtual void read_buffer(GLenum mode) = 0;
+	virtual void clear(GLbitfield mask) = 0;
+	virtual void viewport(int x, int y, unsigned int width, unsigned int height) = 0;
+	virtual void blend_func(GLenum source, GLenum destination) = 0;
+	virtual void depth_func(GLenum func) = 0;
+	//front and back together, the only way the engine sets it
+	virtual void polygon_mode(GLenum mode) = 0;
+	//from the bound read framebuffer to the bound draw framebuffer, both rectangles start at the origin
+	virtual void blit_framebuffer(unsigned int source_width, unsigned int source_height, unsigned int destination_width, unsigned int destination_height, GLbitfield mask, GLenum filter) = 0;
+#pragma endregion
+
+#pragma region Uniforms And Draws
+	virtual int get_uniform_location(unsigned int program, const char* name) = 0;
+	//int1 values are stored as floats like the command_list constants
+	virtual void set_uniform(int location, constant_type type, unsigned int count, const float* values) = 0;
+	virtual void set_uniform_int(int location, int value) = 0;
+	//triangles from the bound vertex array, indices are unsigned ints starting at 0
+	virtual void draw(bool is_indexed, unsigned int element_count, unsigned int instance_count) = 0;
+	//work groups of the program in use
+	virtual void dispatch_compute(unsigned int x, unsigned int y, unsigned int z) = 0;
+	virtual void memory_barrier(GLbitfield barriers) = 0;
+#pragma endregion
+
+#pragma region Resources
+	virtual unsigned int create_texture() = 0;
+	virtual void delete_texture(unsigned int texture) = 0;
+	virtual void tex_image_2d(GLenum target, int level, GLenum internal_format, unsigned int width, unsigned int height, GLenum format, GLenum data_format, const void* data) = 0;
+	virtual void tex_image_2d_multisample(unsigned int samples, GLenum internal_format, unsigned int width, unsigned int height) = 0;
+	virtual void tex_sub_image_2d(GLenum target, unsigned int width, unsigned int height, GLenum format, GLenum data_format, const void* data) = 0;
+	virtual void tex_parameter(GLenum target, GLenum name, int value) = 0;
+	virtual void generate_mipmap(GLenum target) = 0;
+
+	virtual unsigned int create_vertex_array() = 0;
+	virtual void delete_vertex_array(unsigned int vao) = 0;
+	//float attribute read from the bound array buffer, enabled as it is set
+	virtual void vertex_attribute(unsigned int index, int size, unsigned int stride, unsigned int offset) = 0;
+	virtual void vertex_attribute_divisor(unsigned int index, unsigned int divisor) = 0;
+
+	virtual unsigned int create_buffer() = 0;
+	virtual void delete_buffer(unsigned int buffer) = 0;
+	//data may be null to only allocate
+	virtual void buffer_data(GLenum target, unsigned int size, const void* data, GLenum usage) = 0;
+	virtual void buffer_sub_data(GLenum target, unsigned int offset, unsigned int size, const void* data) = 0;
+	virtual void bind_buffer_base(GLenum target, unsigned int index, unsigned int buffer) = 0;
+
+	virtual unsigned int create_renderbuffer() = 0;
+	virtual void delete_renderbuffer(unsigned int renderbuffer) = 0;
+	virtual void bind_renderbuffer(unsigned int renderbuffer) = 0;
+	virtual void renderbuffer_storage(GLenum internal_format, unsigned int width, unsigned int height) = 0;
+
+	virtual unsigned int create_framebuffer() = 0;
+	virtual void delete_framebuffer(unsigned int framebuffer) = 0;
+	virtual void framebuffer_texture_2d(GLenum attachment, GLenum target, unsigned int texture, int level) = 0;
+	virtual void framebuffer_texture(GLenum attachment, unsigned int texture, int level) = 0;
+	virtual void framebuffer_renderbuffer(GLenum attachment, unsigned int renderbuffer) = 0;
+	virtual GLenum check_framebuffer_status() = 0;
+
+	//error is left empty on success and holds the info log on failure, the object is returned either way
+	virtual unsigned int create_shader(GLenum type, const char* source, std::string& error) = 0;
+	virtual void delete_shader(unsigned int shader) = 0;
+	virtual unsigned int create_program(const unsigned int* shaders, unsigned int count, std::string& error) = 0;
+	virtual void delete_program(unsigned int program) = 0;
+	virtual void uniform_block_binding(unsigned int program, const char* block, unsigned int binding) = 0;
+
+	//fences are handed out as names like every other object, signaled once the gpu finished everything before it
+	virtual unsigned int create_fence() = 0;
+	//never waits
+	virtual bool is_fence_signaled(unsigned int fence) = 0;
+	virtual void delete_fence(unsigned int fence) = 0;
+#pragma endregion
+
+private:
+	static render_backend* current;
+};
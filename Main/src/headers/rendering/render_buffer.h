@@ -1,6 +1,8 @@
 #pragma once
 #include <glad/glad.h>
 
+#include "rendering/gpu_resource.h"
+
 class render_buffer
 {
 public:
@@ -19,4 +21,5 @@ private:
 	unsigned int width;
 	unsigned int height;
 	unsigned int id;
+	gpu_resource resource;
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+
+#include "utils/string_id.h"
+
+//work submitted to gl, counted by the wrappers at the call site
+struct render_counters
+{
+	unsigned int draw_calls{ 0 };
+	unsigned int instances{ 0 };
+	unsigned long long triangles{ 0 };
+	unsigned int program_binds{ 0 };
+	unsigned int vao_binds{ 0 };
+	unsigned int texture_binds{ 0 };
+	unsigned int framebuffer_binds{ 0 };
+	unsigned int uniform_calls{ 0 };
+	//cache misses in shader_program, anything above zero after the first frames is a regression
+	unsigned int uniform_lookups{ 0 };
+	unsigned long long buffer_upload_bytes{ 0 };
+	unsigned int blits{ 0 };
+
+	render_counters operator-(const render_counters& other) const;
+	render_counters& operator+=(const render_counters& other);
+};
+
+struct pass_counters
+{
+	string_id name;
+	render_counters counters;
+};
+
+// per frame and per pass render counters, main thread only like the rest of the gl calls
+// the wrappers bump render_stats::counters directly; end_frame publishes the finished frame
+class render_stats
+{
+public:
+	static render_counters counters;
+
+	static void begin_frame();
+	static void end_frame();
+	static void begin_pass(const string_id& name);
+	static void end_pass();
+
+	static void count_draw(unsigned int element_count, unsigned int instance_count);
+
+	//totals and per pass numbers of the last finished frame
+	static const render_counters& get_frame();
+	static const std::vector<pass_counters>& get_passes();
+
+private:
+	static render_counters last_frame;
+	static std::vector<pass_counters> passes;
+	static std::vector<pass_counters> last_passes;
+	static render_counters pass_start;
+};
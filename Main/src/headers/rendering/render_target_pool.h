@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+
+#include "rendering/texture.h"
+
+//what a pooled target looks like, two targets with equal descs are interchangeable
+struct render_target_desc
+{
+	unsigned int width{ 0 };
+	unsigned int height{ 0 };
+	GLenum format{ GL_RGBA };
+	GLenum internal_format{ GL_RGBA16F };
+	GLenum data_format{ GL_FLOAT };
+	unsigned int samples{ 0 };
+
+	bool operator==(const render_target_desc& other) const;
+	bool operator<(const render_target_desc& other) const;
+	bool is_depth() const;
+	std::size_t get_size_in_bytes() const;
+};
+
+// screen sized textures bucketed by (format, size, samples)
+// a released target goes back to its bucket for the next acquire with the same desc,
+// targets nobody acquired for IDLE_FRAMES frames are deleted so memory follows the output size
+class render_target_pool
+{
+public:
+	static const unsigned int IDLE_FRAMES = 120;
+
+	render_target_pool() = default;
+	render_target_pool(const render_target_pool&) = delete;
+	render_target_pool& operator=(const render_target_pool&) = delete;
+	~render_target_pool();
+
+	texture* acquire(const render_target_desc& desc);
+	void release(const texture* target);
+
+	//deletes targets idle for longer than IDLE_FRAMES, call once per frame
+	void end_frame();
+	//deletes every target not acquired right now, used when the output size changes
+	void release_unused();
+	void release_all();
+
+	//ids of textures deleted since the last call, anything caching them has to let go
+	std::vector<unsigned int> take_deleted();
+
+	unsigned int get_count() const;
+	std::size_t get_size_in_bytes() const;
+
+private:
+	struct pooled_target
+	{
+		texture tex;
+		bool is_in_use{ false };
+		unsigned long long last_used_frame{ 0 };
+	};
+
+	std::map<render_target_desc, std::vector<std::unique_ptr<pooled_target>>> buckets;
+	std::vector<unsigned int> deleted;
+	unsigned long long frame{ 0 };
+
+	template<typename predicate>
+	void delete_if(predicate should_delete);
+};
@@ -2,16 +2,19 @@
 #include <memory>
 
 #include "data/mesh.h"
+#include "rendering/command_list.h"
+#include "rendering/gpu_mesh.h"
+#include "rendering/gpu_resource.h"
 #include "rendering/shader_program.h"
 
 class renderer
 {
 protected:
 	std::shared_ptr<mesh> mesh_ptr;
+	std::shared_ptr<gpu_mesh> gpu_mesh_ptr;
 	virtual void setup();
 	unsigned int vao{0};
-	unsigned int vbo{0};
-	unsigned int ebo{0};
+	gpu_resource vertex_array;
 
 	void draw_with_indices() const;
 	void draw_with_raw_vertices() const;
@@ -22,10 +25,17 @@ public:
 
 	renderer();
 	explicit renderer(std::shared_ptr<mesh>);
+	renderer(std::shared_ptr<mesh>, std::shared_ptr<gpu_mesh>);
 	virtual void draw(const shader_program &program) const;
 	void draw_instanced(const shader_program& program, const unsigned int count) const;
 	void draw_cube_map(const shader_program& program) const;
-	void deallocate() const;
+	//drops the vertex array and this renderer's share of the mesh buffers
+	void deallocate();
 	virtual ~renderer();
 	std::shared_ptr<mesh> get_mesh_ptr() const;
+	std::shared_ptr<gpu_mesh> get_gpu_mesh_ptr() const;
+
+	//the same draw as draw() but as data for a command_list
+	draw_call get_draw_call() const;
+	const std::vector<material_slot>& get_material_slots() const;
 };
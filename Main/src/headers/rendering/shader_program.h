@@ -1,8 +1,12 @@
 #pragma once
+#include <unordered_map>
+
 #include "shader.h"
 #include "data/mvp.h"
 #include "data/tiling_and_offset.h"
+#include "rendering/gpu_resource.h"
 #include "glm/glm.hpp"
+#include "utils/string_id.h"
 
 class shader_program
 {
@@ -13,10 +17,15 @@ public:
 	const shader* geometry_shader;
 	shader_program(const shader* vertex_shader, const shader* fragment_shader);
 	shader_program(const shader* vertex_shader, const shader* fragment_shader, const shader* geometry_shader);
-	~shader_program();
+	//compute only, the other stages stay null
+	explicit shader_program(const shader* compute_shader);
 
 	void use() const;
 
+	//locations are looked up once per name and cached, lookups have to happen on the gl thread
+	int get_uniform_location(const std::string& name) const;
+	int get_uniform_location(const string_id& name) const;
+
 	void set_bool(const std::string& name, const bool value) const;
 	void set_int(const std::string& name, const int value) const;
 	void set_float(const std::string& name, const float value) const;
@@ -24,6 +33,11 @@ public:
 	void set_vec2(const std::string& name, const glm::vec2 value) const;
 	void set_vec3(const std::string& name, const glm::vec3 value) const;
 	void set_vec4(const std::string& name, const glm::vec4 value) const;
+	//for names built at runtime, the string_id is made once and kept instead of building a string per call
+	void set_int(const string_id& name, int value) const;
+	void set_float(const string_id& name, float value) const;
+	void set_vec2(const string_id& name, const glm::vec2& value) const;
+	void set_vec3(const string_id& name, const glm::vec3& value) const;
 	void set_float_array(const std::string& name, const unsigned int count, float* value) const;
 	void set_vec2_array(const std::string& name, const unsigned int count, float* value) const;
 	void set_mvp(const mvp matrix) const;
@@ -31,4 +45,13 @@ public:
 	void set_view(const glm::mat4 matrix) const;
 	void set_proj(const glm::mat4 matrix) const;
 	void set_tiling_and_offset(const tiling_and_offset& tiling_and_offset) const;
+
+private:
+	//links the shaders into id and deletes them, they are not needed once linked
+	void link(const unsigned int* shaders, unsigned int count);
+
+	//copies share the program, it goes once the last of them does
+	gpu_resource resource;
+	mutable std::unordered_map<std::string, int> uniform_locations;
+	mutable std::unordered_map<unsigned int, int> id_locations;
 };
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include <vector>
 
 #include "stb_image.h"
+#include "rendering/gpu_resource.h"
+#include "utils/string_id.h"
 #include "utils/config.h"
 
 
@@ -21,6 +23,8 @@ private:
 	unsigned int channels{0};
 	texture_type type {texture_type::diffuse};
 	bool is_multi_sampled{false};
+	//copies share the gl texture, it goes once the last of them does
+	gpu_resource resource;
 
 public:
 	unsigned int get_id() const;
@@ -32,14 +36,21 @@ public:
 	unsigned int get_channels() const;
 	texture_type get_type() const;
 	bool get_is_multi_sampled() const;
+	GLenum get_target() const;
 
 	void set_wrap_mode(GLint wrap_mode);
 	void set_filter_mag(GLint filter_mag);
 	void set_filter_min(GLint filter_min);
 
 	void bind() const;
+	//drops this copy's reference, the texture is deleted when no other copy holds it
+	void delete_texture();
+	//replaces the whole base level of a 2d texture, format and data_format describe the pixels
+	void set_data(const void* pixels, GLenum format, GLenum data_format) const;
 	static void activate(GLenum texture_location);
 	static std::string type_to_string(const texture_type type);
+	//"mat." followed by the type and the index among the mesh's textures of that type
+	static const string_id& get_uniform_name(texture_type type, unsigned int index);
 
 	texture();
 	explicit  texture(const std::string& absolute_path, texture_type type, GLenum data_format, bool generate_mipmaps);
@@ -1,6 +1,8 @@
 #pragma once
 #include <glad/glad.h>
 
+#include "rendering/gpu_resource.h"
+
 class uniform_buffer_object
 {
 public:
@@ -17,5 +19,6 @@ private:
 	GLenum usage {GL_STATIC_DRAW};
 	unsigned int size{ 0 };
 	unsigned int id{0};
-	
+	gpu_resource resource;
+
 };
\ No newline at end of file
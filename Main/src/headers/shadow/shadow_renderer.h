@@ -1,6 +1,9 @@
 #pragma once
 #include <memory>
 #include "data/mesh.h"
+#include "rendering/command_list.h"
+#include "rendering/gpu_mesh.h"
+#include "rendering/gpu_resource.h"
 #include "rendering/shader_program.h"
 
 class shadow_renderer
@@ -8,15 +11,17 @@ class shadow_renderer
 public:
 	shadow_renderer();
 	explicit shadow_renderer(std::shared_ptr<mesh> mesh);
+	shadow_renderer(std::shared_ptr<mesh> mesh, std::shared_ptr<gpu_mesh> gpu);
 	void draw(const shader_program& program) const;
+	draw_call get_draw_call() const;
 
 protected:
 
 	std::shared_ptr<mesh> mesh_ptr;
+	std::shared_ptr<gpu_mesh> gpu_mesh_ptr;
 	void setup();
 	unsigned int vao{ 0 };
-	unsigned int vbo{ 0 };
-	unsigned int ebo{ 0 };
+	gpu_resource vertex_array;
 	
 	void draw_with_indices() const;
 	void draw_with_raw_vertices() const;
@@ -17,4 +17,6 @@ public:
 	static const std::string FRAGMENT_SHADER_DEFAULT;
 	constexpr static const float MOVE_SPEED{ 5.0f };
 	constexpr static const float MOUSE_SENSITIVITY{ 0.05f };
+	//estimated gpu memory above this prints a warning, 0 turns it off
+	static const unsigned int GPU_MEMORY_BUDGET_MB{ 2048 };
 };
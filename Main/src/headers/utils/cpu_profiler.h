@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/string_id.h"
+
+// nested cpu scopes with nanosecond timestamps, every thread writes into its own ring buffer without locking
+// names are kept by pointer, so pass string literals or the c_str of a string_id
+// while disabled a scope costs one relaxed load and a branch
+class cpu_profiler
+{
+public:
+	static const unsigned int EVENTS_PER_THREAD = 1 << 16;
+
+	struct event
+	{
+		const char* name;
+		unsigned long long start_ns;
+		unsigned long long end_ns;
+		unsigned int depth;
+	};
+
+	static cpu_profiler& get();
+
+	static bool is_enabled();
+	static void set_enabled(bool flag);
+
+	//marks the frame boundary the flame view slices on
+	void begin_frame();
+
+	//for spans that are not a block, like the startup sections of main; scopes use the same stack
+	void push(const char* name);
+	void pop();
+
+	unsigned long long get_frame_start_ns() const;
+	unsigned long long get_frame_end_ns() const;
+	unsigned int get_thread_count() const;
+	//events of one thread that overlap [start_ns, end_ns), oldest first; only the tail of the ring back to start_ns is read
+	//events is cleared first and keeps its capacity, so a caller polling every frame can reuse one vector
+	void get_events(unsigned int thread, unsigned long long start_ns, unsigned long long end_ns, std::vector<event>& events) const;
+
+	//chrome://tracing and perfetto read this, times are in microseconds
+	bool export_chrome_trace(const std::string& path) const;
+	//appends every event overlapping [start_ns, end_ns) to an open traceEvents array, each prefixed with a comma
+	std::size_t write_trace_events(std::ostream& out, unsigned long long start_ns, unsigned long long end_ns) const;
+	static void write_json_string(std::ostream& out, const char* str);
+
+	static unsigned long long now_ns();
+
+	cpu_profiler(const cpu_profiler&) = delete;
+	cpu_profiler& operator=(const cpu_profiler&) = delete;
+
+private:
+	friend class cpu_profile_scope;
+
+	struct thread_buffer
+	{
+		std::vector<event> events;
+		//total events ever written, the ring index is count % EVENTS_PER_THREAD
+		std::atomic<unsigned long long> count{ 0 };
+		//names and start times of the scopes still open on this thread
+		std::vector<std::pair<const char*, unsigned long long>> open;
+		unsigned int index{ 0 };
+
+		void close();
+	};
+
+	cpu_profiler() = default;
+
+	static std::atomic<bool> enabled;
+
+	mutable std::mutex threads_mutex;
+	std::vector<std::unique_ptr<thread_buffer>> threads;
+
+	std::atomic<unsigned long long> frame_start{ 0 };
+	std::atomic<unsigned long long> frame_end{ 0 };
+
+	thread_buffer& get_thread_buffer();
+	std::vector<event> copy_events(const thread_buffer& buffer) const;
+};
+
+//times everything until the end of the enclosing block
+class cpu_profile_scope
+{
+public:
+	explicit cpu_profile_scope(const char* name);
+	explicit cpu_profile_scope(const string_id& name);
+	~cpu_profile_scope();
+
+	cpu_profile_scope(const cpu_profile_scope&) = delete;
+	cpu_profile_scope& operator=(const cpu_profile_scope&) = delete;
+
+private:
+	cpu_profiler::thread_buffer* buffer{ nullptr };
+};
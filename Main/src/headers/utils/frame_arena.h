@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+// bump allocator for data that only lives until the end of the frame, one slab per thread so job workers never contend
+// a slab starts over on the first allocation of its thread after end_frame; what did not fit goes to the heap
+// for that frame and the slab grows to hold it from the next one on, so steady frames never touch the heap
+// anything allocated here must be done with before the frame ends, including work a job started
+class frame_arena
+{
+public:
+	static const std::size_t SLAB_SIZE = 256 * 1024;
+
+	//the calling thread's arena
+	static frame_arena& get();
+	//starts a new frame for every thread, main thread only
+	static void end_frame();
+
+	void* allocate(std::size_t size, std::size_t alignment);
+
+	//over all live threads
+	static unsigned int get_thread_count();
+	static std::size_t get_capacity();
+	//most any single thread used in one frame
+	static std::size_t get_peak_bytes();
+	//allocations that did not fit a slab and went to the heap, nonzero only while the slabs are still growing
+	static unsigned long long get_overflow_count();
+
+	//fills memory that is given back with a pattern so anything still reading it after the frame shows garbage
+	static void set_is_poisoning(bool is_poisoning);
+
+	frame_arena(const frame_arena&) = delete;
+	frame_arena& operator=(const frame_arena&) = delete;
+
+private:
+	unsigned char* slab{ nullptr };
+	std::size_t capacity{ 0 };
+	std::size_t used{ 0 };
+	std::vector<void*> overflow;
+	std::size_t overflow_bytes{ 0 };
+	unsigned long long frame{ 0 };
+
+	frame_arena();
+	~frame_arena();
+
+	void reset();
+};
+
+//stateless, every allocation goes to the arena of the thread making it and freeing is a no-op
+template<typename T>
+class frame_allocator
+{
+public:
+	using value_type = T;
+
+	frame_allocator() = default;
+
+	template<typename U>
+	frame_allocator(const frame_allocator<U>&)
+	{
+	}
+
+	T* allocate(const std::size_t count)
+	{
+		return static_cast<T*>(frame_arena::get().allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, std::size_t)
+	{
+	}
+
+	template<typename U>
+	bool operator==(const frame_allocator<U>&) const
+	{
+		return true;
+	}
+
+	template<typename U>
+	bool operator!=(const frame_allocator<U>&) const
+	{
+		return false;
+	}
+};
+
+template<typename T>
+using frame_vector = std::vector<T, frame_allocator<T>>;
+
+template<typename K, typename V, typename Compare = std::less<K>>
+using frame_map = std::map<K, V, Compare, frame_allocator<std::pair<const K, V>>>;
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+//what an allocation was made for, taken from the innermost memory_tag_scope of the allocating thread
+enum class memory_tag : unsigned char
+{
+	other,
+	asset_import,
+	meshes,
+	textures,
+	rendering,
+	imgui,
+	count
+};
+
+struct memory_tag_stats
+{
+	long long live_bytes{ 0 };
+	long long peak_bytes{ 0 };
+	long long live_allocations{ 0 };
+	unsigned long long total_allocations{ 0 };
+	//of the last finished frame
+	unsigned long long frame_allocations{ 0 };
+	unsigned long long frame_bytes{ 0 };
+};
+
+struct memory_callsite
+{
+	//return address of the allocating call, null for the slot that takes everything once the table is full
+	const void* address;
+	memory_tag tag;
+	long long live_bytes;
+	long long live_allocations;
+	unsigned long long total_allocations;
+	unsigned long long frame_allocations;
+};
+
+// counts every allocation made through it by tag and by callsite, lock free and safe from any thread
+// blocks carry a small header with their size, tag and callsite so a free is counted against what allocated it
+// with MEMORY_TRACKING defined the global operator new and delete are routed here, imgui and stb_image always are
+class memory_tracker
+{
+public:
+	static const unsigned int CALLSITE_CAPACITY = 4096;
+
+	//true when the global operator new is hooked, without it only imgui and stb_image allocations are seen
+	static bool is_hooked();
+
+	static void* allocate(std::size_t size, const void* callsite);
+	static void* reallocate(void* block, std::size_t size, const void* callsite);
+	static void release(void* block);
+
+	static memory_tag get_tag();
+	static void set_tag(memory_tag tag);
+
+	//publishes the per frame counts, main thread only
+	static void end_frame();
+
+	static memory_tag_stats get_stats(memory_tag tag);
+	//allocations over all tags in the last finished frame
+	static unsigned long long get_frame_allocations();
+	static std::vector<memory_callsite> get_callsites();
+	//function and line where debug symbols are available, otherwise the address
+	static std::string get_callsite_name(const void* address);
+
+	//live bytes per tag and the callsites still holding the most, meant for exit after everything was released
+	static void write_leak_report(std::ostream& out, unsigned int callsite_count = 16);
+
+	static const char* tag_to_string(memory_tag tag);
+};
+
+//tags everything this thread allocates until the end of the enclosing block
+class memory_tag_scope
+{
+public:
+	explicit memory_tag_scope(memory_tag tag);
+	~memory_tag_scope();
+
+	memory_tag_scope(const memory_tag_scope&) = delete;
+	memory_tag_scope& operator=(const memory_tag_scope&) = delete;
+
+private:
+	memory_tag previous;
+};
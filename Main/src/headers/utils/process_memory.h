@@ -0,0 +1,4 @@
+#pragma once
+
+//resident memory of this process in bytes, 0 where the platform query is unavailable
+unsigned long long get_process_memory_bytes();
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+//interned string, compares as an integer
+class string_id
+{
+public:
+	string_id();
+	explicit string_id(const std::string& str);
+
+	unsigned int get_id() const;
+	const std::string& get_string() const;
+	const char* c_str() const;
+
+	bool operator==(const string_id& other) const;
+	bool operator!=(const string_id& other) const;
+	bool operator<(const string_id& other) const;
+
+private:
+	unsigned int id{ 0 };
+};
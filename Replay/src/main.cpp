@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "rendering/capture_player.h"
+#include "rendering/gl_backend.h"
+
+namespace
+{
+	void print_usage()
+	{
+		std::cout << "usage: Replay capture [--loops n] [--width w] [--height h] [--egl]" << std::endl;
+	}
+
+	bool read_unsigned(const int argc, char** argv, int& i, unsigned int& out)
+	{
+		if (i + 1 >= argc)
+			return false;
+
+		char* end;
+		const unsigned long value = std::strtoul(argv[++i], &end, 10);
+		if (*end != '\0' || value == 0)
+			return false;
+
+		out = static_cast<unsigned int>(value);
+		return true;
+	}
+
+	double elapsed_ms(const std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+// plays a capture written by Main --capture against the driver with nothing of the engine around it,
+// so driver and gpu cost can be timed and compared between machines without the scene or its assets
+int main(const int argc, char** argv)
+{
+	std::string path;
+	unsigned int loops = 100;
+	unsigned int width = 1280;
+	unsigned int height = 720;
+	bool use_egl = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool is_valid = true;
+
+		if (std::strcmp(argv[i], "--loops") == 0)
+			is_valid = read_unsigned(argc, argv, i, loops);
+		else if (std::strcmp(argv[i], "--width") == 0)
+			is_valid = read_unsigned(argc, argv, i, width);
+		else if (std::strcmp(argv[i], "--height") == 0)
+			is_valid = read_unsigned(argc, argv, i, height);
+		else if (std::strcmp(argv[i], "--egl") == 0)
+			use_egl = true;
+		else if (argv[i][0] != '-' && path.empty())
+			path = argv[i];
+		else
+			is_valid = false;
+
+		if (!is_valid)
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (path.empty())
+	{
+		print_usage();
+		return 1;
+	}
+
+	capture_player player;
+	if (!player.load(path))
+		return 1;
+
+	if (!glfwInit())
+		return 1;
+
+	//same context as Main, hidden since only the timings matter
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	if (use_egl)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+
+	GLFWwindow* window = glfwCreateWindow(width, height, "Replay", nullptr, nullptr);
+
+	if (!window)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	std::cout << "Replaying " << path << " on " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << ", "
+		<< player.get_frame_count() << " frames, " << player.get_payload_size() / (1024 * 1024) << " MB of data" << std::endl;
+
+	gl_backend backend;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	player.play_setup(backend);
+	glFinish();
+	std::cout << "setup " << elapsed_ms(start) << " ms" << std::endl;
+
+	//glFinish closes each loop so the time covers the gpu work and not only the submission
+	std::vector<double> loop_ms;
+	loop_ms.reserve(loops);
+
+	for (unsigned int loop = 0; loop < loops; loop++)
+	{
+		start = std::chrono::steady_clock::now();
+		for (unsigned int frame = 0; frame < player.get_frame_count(); frame++)
+			player.play_frame(frame, backend);
+		glFinish();
+		loop_ms.push_back(elapsed_ms(start));
+	}
+
+	const unsigned int frames = std::max(player.get_frame_count(), 1u);
+	double total = 0.0;
+	for (const double ms : loop_ms)
+		total += ms;
+
+	std::sort(loop_ms.begin(), loop_ms.end());
+	std::cout << "frame ms: avg " << total / loop_ms.size() / frames
+		<< ", min " << loop_ms.front() / frames
+		<< ", median " << loop_ms[loop_ms.size() / 2] / frames
+		<< ", max " << loop_ms.back() / frames << std::endl;
+
+	glfwTerminate();
+	return 0;
+}